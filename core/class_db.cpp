@@ -263,6 +263,7 @@ ClassDB::ClassInfo::ClassInfo() {
 	api = API_NONE;
 	creation_func = NULL;
 	inherits_ptr = NULL;
+	class_ptr = NULL;
 	disabled = false;
 	exposed = false;
 }
@@ -285,6 +286,16 @@ bool ClassDB::is_parent_class(const StringName &p_class, const StringName &p_inh
 
 	return false;
 }
+
+void *ClassDB::get_class_ptr(const StringName &p_class) {
+
+	OBJTYPE_RLOCK;
+
+	ClassInfo *ti = classes.getptr(p_class);
+	ERR_FAIL_COND_V(!ti, NULL);
+	return ti->class_ptr;
+}
+
 void ClassDB::get_class_list(List<StringName> *p_classes) {
 
 	OBJTYPE_RLOCK;
@@ -535,7 +546,7 @@ bool ClassDB::can_instance(const StringName &p_class) {
 	return (!ti->disabled && ti->creation_func != NULL);
 }
 
-void ClassDB::_add_class2(const StringName &p_class, const StringName &p_inherits) {
+void ClassDB::_add_class2(const StringName &p_class, const StringName &p_inherits, void *p_class_ptr) {
 
 	OBJTYPE_WLOCK;
 
@@ -548,6 +559,7 @@ void ClassDB::_add_class2(const StringName &p_class, const StringName &p_inherit
 	ti.name = name;
 	ti.inherits = p_inherits;
 	ti.api = current_api;
+	ti.class_ptr = p_class_ptr;
 
 	if (ti.inherits) {
 
@@ -1103,6 +1115,20 @@ int ClassDB::get_property_index(const StringName &p_class, const StringName &p_p
 	return -1;
 }
 
+const ClassDB::PropertySetGet *ClassDB::get_property_setget(const StringName &p_class, const StringName &p_property) {
+
+	ClassInfo *check = classes.getptr(p_class);
+	while (check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg)
+			return psg;
+
+		check = check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
 Variant::Type ClassDB::get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
 
 	ClassInfo *type = classes.getptr(p_class);
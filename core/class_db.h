@@ -137,6 +137,7 @@ public:
 		bool disabled;
 		bool exposed;
 		Object *(*creation_func)();
+		void *class_ptr;
 		ClassInfo();
 		~ClassInfo();
 	};
@@ -159,7 +160,7 @@ public:
 
 	static APIType current_api;
 
-	static void _add_class2(const StringName &p_class, const StringName &p_inherits);
+	static void _add_class2(const StringName &p_class, const StringName &p_inherits, void *p_class_ptr);
 
 	static HashMap<StringName, HashMap<StringName, Variant> > default_values;
 
@@ -168,7 +169,7 @@ public:
 	template <class T>
 	static void _add_class() {
 
-		_add_class2(T::get_class_static(), T::get_parent_class_static());
+		_add_class2(T::get_class_static(), T::get_parent_class_static(), T::get_class_ptr_static());
 	}
 
 	template <class T>
@@ -218,6 +219,7 @@ public:
 	static StringName get_parent_class(const StringName &p_class);
 	static bool class_exists(const StringName &p_class);
 	static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
+	static void *get_class_ptr(const StringName &p_class);
 	static bool can_instance(const StringName &p_class);
 	static Object *instance(const StringName &p_class);
 	static APIType get_api_type(const StringName &p_class);
@@ -333,6 +335,7 @@ public:
 	static bool get_property(Object *p_object, const StringName &p_property, Variant &r_value);
 	static bool has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance = false);
 	static int get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid = NULL);
+	static const PropertySetGet *get_property_setget(const StringName &p_class, const StringName &p_property);
 	static Variant::Type get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid = NULL);
 	static StringName get_property_setter(StringName p_class, const StringName p_property);
 	static StringName get_property_getter(StringName p_class, const StringName p_property);
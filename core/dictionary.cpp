@@ -27,35 +27,377 @@
 /* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
-
 #include "dictionary.h"
 
-#include "core/ordered_hash_map.h"
+#include "core/hashfuncs.h"
+#include "core/os/copymem.h"
 #include "core/safe_refcount.h"
 #include "core/variant.h"
 
+
+// The entries live in segments that are never moved or reallocated, segment n
+// holding MIN_CAPACITY << n entries, so pointers to keys and values stay valid
+// until their key is erased. Erased entries are reused by later insertions.
+//
+// The insertion order is kept apart, as an array of entry indices. Erasing
+// leaves a hole in it, holes are compacted when it would otherwise grow. Small
+// dictionaries find keys by comparing them one by one, without hashing them.
+// Larger ones also keep an open addressing table (linear probing) with the
+// index of each entry.
+
 struct DictionaryPrivate {
 
+	struct Entry {
+		Variant key;
+		Variant value;
+		uint32_t hash; // Only set while there is a table.
+		uint32_t position; // In the order array, or the next free entry once erased.
+	};
+
+	enum {
+		SMALL_SIZE = 4,
+		MIN_CAPACITY = 4,
+		MAX_SEGMENTS = 28,
+		MIN_TABLE_SIZE = 16,
+		EMPTY_SLOT = 0xFFFFFFFF,
+		DELETED_SLOT = 0xFFFFFFFE
+	};
+
 	SafeRefCount refcount;
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> variant_map;
+
+	Entry *segments[MAX_SEGMENTS];
+	uint32_t segment_count;
+	uint32_t entry_count; // Entries constructed so far, in use or free.
+	uint32_t free_entry; // EMPTY_SLOT if there is none.
+
+	uint32_t *order; // Entry indices in insertion order, EMPTY_SLOT once erased.
+	uint32_t order_capacity;
+	uint32_t used; // Including erased positions.
+	uint32_t count;
+
+	uint32_t *table; // NULL while the dictionary is small.
+	uint32_t table_size; // A power of two.
+	uint32_t table_filled; // Slots that aren't empty, including deleted ones.
+
+	static _FORCE_INLINE_ uint32_t _log2(uint32_t p_value) {
+
+#if defined(__GNUC__)
+		return 31 - __builtin_clz(p_value);
+#else
+		uint32_t log = 0;
+		while (p_value >>= 1) {
+			log++;
+		}
+		return log;
+#endif
+	}
+
+	_FORCE_INLINE_ Entry &entry(uint32_t p_index) const {
+
+		if (p_index < MIN_CAPACITY) {
+			return segments[0][p_index];
+		}
+		uint32_t segment = _log2(p_index / MIN_CAPACITY + 1);
+		return segments[segment][p_index - MIN_CAPACITY * ((1 << segment) - 1)];
+	}
+
+	_FORCE_INLINE_ Entry &entry_at(uint32_t p_position) const {
+
+		return entry(order[p_position]);
+	}
+
+	int find(const Variant &p_key) const {
+
+		if (!table) {
+			Variant::Type type = p_key.get_type();
+			for (uint32_t i = 0; i < used; i++) {
+				if (order[i] == EMPTY_SLOT) {
+					continue;
+				}
+				const Entry &e = entry(order[i]);
+				if (e.key.get_type() == type && VariantComparator::compare(e.key, p_key)) {
+					return order[i];
+				}
+			}
+			return -1;
+		}
+
+		uint32_t hash = VariantHasher::hash(p_key);
+		uint32_t mask = table_size - 1;
+
+		for (uint32_t pos = hash & mask;; pos = (pos + 1) & mask) {
+
+			uint32_t slot = table[pos];
+			if (slot == EMPTY_SLOT) {
+				return -1;
+			}
+			if (slot != DELETED_SLOT) {
+				const Entry &e = entry(slot);
+				if (e.hash == hash && VariantComparator::compare(e.key, p_key)) {
+					return slot;
+				}
+			}
+		}
+	}
+
+	// Index of the entry holding this key, if it points inside the segments.
+	int find_pointer(const Variant *p_key) const {
+
+		for (uint32_t i = 0; i < segment_count; i++) {
+
+			uint32_t size = MIN_CAPACITY << i;
+			if (p_key < &segments[i][0].key || p_key > &segments[i][size - 1].key) {
+				continue;
+			}
+
+			uint32_t offset = (const uint8_t *)p_key - (const uint8_t *)segments[i];
+			if (offset % sizeof(Entry) != 0) {
+				return -1;
+			}
+
+			uint32_t index = MIN_CAPACITY * ((1 << i) - 1) + offset / sizeof(Entry);
+			if (index >= entry_count) {
+				return -1;
+			}
+			const Entry &e = entry(index);
+			return e.position < used && order[e.position] == index ? (int)index : -1;
+		}
+		return -1;
+	}
+
+	_FORCE_INLINE_ int next_position(uint32_t p_from) const {
+
+		for (uint32_t i = p_from; i < used; i++) {
+			if (order[i] != EMPTY_SLOT) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	void _table_insert(uint32_t p_index) {
+
+		uint32_t mask = table_size - 1;
+		uint32_t pos = entry(p_index).hash & mask;
+
+		while (table[pos] != EMPTY_SLOT && table[pos] != DELETED_SLOT) {
+			pos = (pos + 1) & mask;
+		}
+
+		if (table[pos] == EMPTY_SLOT) {
+			table_filled++;
+		}
+		table[pos] = p_index;
+	}
+
+	void _rebuild_table() {
+
+		uint32_t size = MIN_TABLE_SIZE;
+		while (size < count * 2) {
+			size <<= 1;
+		}
+
+		if (size != table_size) {
+			if (table) {
+				memfree(table);
+			}
+			table = (uint32_t *)memalloc(sizeof(uint32_t) * size);
+			table_size = size;
+		}
+
+		for (uint32_t i = 0; i < table_size; i++) {
+			table[i] = EMPTY_SLOT;
+		}
+		table_filled = 0;
+
+		for (uint32_t i = 0; i < used; i++) {
+			if (order[i] != EMPTY_SLOT) {
+				_table_insert(order[i]);
+			}
+		}
+	}
+
+	void _create_table() {
+
+		for (uint32_t i = 0; i < used; i++) {
+			if (order[i] != EMPTY_SLOT) {
+				Entry &e = entry(order[i]);
+				e.hash = VariantHasher::hash(e.key);
+			}
+		}
+		_rebuild_table();
+	}
+
+	void _compact_order() {
+
+		uint32_t to = 0;
+		for (uint32_t from = 0; from < used; from++) {
+			if (order[from] == EMPTY_SLOT) {
+				continue;
+			}
+			order[to] = order[from];
+			entry(order[to]).position = to;
+			to++;
+		}
+		used = to;
+	}
+
+	void reserve(uint32_t p_capacity) {
+
+		while (MIN_CAPACITY * ((1u << segment_count) - 1) < p_capacity) {
+			CRASH_COND(segment_count == MAX_SEGMENTS);
+			segments[segment_count] = (Entry *)memalloc(sizeof(Entry) * (MIN_CAPACITY << segment_count));
+			segment_count++;
+		}
+
+		if (p_capacity > order_capacity) {
+			order = (uint32_t *)memrealloc(order, sizeof(uint32_t) * p_capacity);
+			order_capacity = p_capacity;
+		}
+	}
+
+	uint32_t _new_entry() {
+
+		if (free_entry != EMPTY_SLOT) {
+			uint32_t index = free_entry;
+			free_entry = entry(index).position;
+			return index;
+		}
+
+		reserve(entry_count + 1);
+		uint32_t index = entry_count++;
+		Entry &e = entry(index);
+		memnew_placement(&e.key, Variant);
+		memnew_placement(&e.value, Variant);
+		return index;
+	}
+
+	uint32_t insert(const Variant &p_key, const Variant &p_value) {
+
+		// Entries never move, the key or the value can come from this dictionary.
+		if (used == order_capacity) {
+			if (used && count <= used / 2) {
+				_compact_order();
+			} else {
+				reserve(MAX(order_capacity * 2, (uint32_t)MIN_CAPACITY));
+			}
+		}
+
+		uint32_t index = _new_entry();
+		Entry &e = entry(index);
+		e.key = p_key;
+		e.value = p_value;
+		e.hash = 0;
+		e.position = used;
+		order[used++] = index;
+		count++;
+
+		if (table) {
+			e.hash = VariantHasher::hash(e.key);
+			if ((table_filled + 1) * 4 > table_size * 3) {
+				_rebuild_table();
+			} else {
+				_table_insert(index);
+			}
+		} else if (used > SMALL_SIZE) {
+			_create_table();
+		}
+
+		return index;
+	}
+
+	void erase(uint32_t p_index) {
+
+		Entry &e = entry(p_index);
+
+		if (table) {
+			uint32_t mask = table_size - 1;
+			uint32_t pos = e.hash & mask;
+			while (table[pos] != p_index) {
+				pos = (pos + 1) & mask;
+			}
+			table[pos] = DELETED_SLOT;
+		}
+
+		order[e.position] = EMPTY_SLOT;
+		e.key = Variant();
+		e.value = Variant();
+		e.position = free_entry;
+		free_entry = p_index;
+		count--;
+
+		// Holes at the end can be reused right away.
+		while (used > 0 && order[used - 1] == EMPTY_SLOT) {
+			used--;
+		}
+	}
+
+	void clear() {
+
+		for (uint32_t i = 0; i < entry_count; i++) {
+			Entry &e = entry(i);
+			e.key.~Variant();
+			e.value.~Variant();
+		}
+		entry_count = 0;
+		free_entry = EMPTY_SLOT;
+		used = 0;
+		count = 0;
+
+		if (table) {
+			memfree(table);
+			table = NULL;
+			table_size = 0;
+			table_filled = 0;
+		}
+	}
+
+	DictionaryPrivate() {
+
+		segment_count = 0;
+		entry_count = 0;
+		free_entry = EMPTY_SLOT;
+		order = NULL;
+		order_capacity = 0;
+		used = 0;
+		count = 0;
+		table = NULL;
+		table_size = 0;
+		table_filled = 0;
+	}
+
+	~DictionaryPrivate() {
+
+		clear();
+		for (uint32_t i = 0; i < segment_count; i++) {
+			memfree(segments[i]);
+		}
+		if (order) {
+			memfree(order);
+		}
+	}
 };
 
 void Dictionary::get_key_list(List<Variant> *p_keys) const {
 
-	if (_p->variant_map.empty())
-		return;
-
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		p_keys->push_back(E.key());
+	for (int i = _p->next_position(0); i >= 0; i = _p->next_position(i + 1)) {
+		p_keys->push_back(_p->entry_at(i).key);
 	}
 }
 
 Variant Dictionary::get_key_at_index(int p_index) const {
 
+	if (p_index < 0 || p_index >= (int)_p->count) {
+		return Variant();
+	}
+	if (_p->used == _p->count) {
+		return _p->entry_at(p_index).key;
+	}
+
 	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (int i = _p->next_position(0); i >= 0; i = _p->next_position(i + 1)) {
 		if (index == p_index) {
-			return E.key();
+			return _p->entry_at(i).key;
 		}
 		index++;
 	}
@@ -65,10 +407,17 @@ Variant Dictionary::get_key_at_index(int p_index) const {
 
 Variant Dictionary::get_value_at_index(int p_index) const {
 
+	if (p_index < 0 || p_index >= (int)_p->count) {
+		return Variant();
+	}
+	if (_p->used == _p->count) {
+		return _p->entry_at(p_index).value;
+	}
+
 	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
+	for (int i = _p->next_position(0); i >= 0; i = _p->next_position(i + 1)) {
 		if (index == p_index) {
-			return E.value();
+			return _p->entry_at(i).value;
 		}
 		index++;
 	}
@@ -78,38 +427,46 @@ Variant Dictionary::get_value_at_index(int p_index) const {
 
 Variant &Dictionary::operator[](const Variant &p_key) {
 
-	return _p->variant_map[p_key];
+	int index = _p->find(p_key);
+	if (index < 0) {
+		// consistent with Map behaviour
+		index = _p->insert(p_key, Variant());
+	}
+	return _p->entry(index).value;
 }
 
 const Variant &Dictionary::operator[](const Variant &p_key) const {
 
-	return _p->variant_map[p_key];
+	int index = _p->find(p_key);
+	CRASH_COND(index < 0);
+	return _p->entry(index).value;
 }
+
 const Variant *Dictionary::getptr(const Variant &p_key) const {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
+	int index = _p->find(p_key);
 
-	if (!E)
+	if (index < 0)
 		return NULL;
-	return &E.get();
+	return &_p->entry(index).value;
 }
 
 Variant *Dictionary::getptr(const Variant &p_key) {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(p_key);
+	int index = _p->find(p_key);
 
-	if (!E)
+	if (index < 0)
 		return NULL;
-	return &E.get();
+	return &_p->entry(index).value;
 }
 
 Variant Dictionary::get_valid(const Variant &p_key) const {
 
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
+	int index = _p->find(p_key);
 
-	if (!E)
+	if (index < 0)
 		return Variant();
-	return E.get();
+	return _p->entry(index).value;
 }
 
 Variant Dictionary::get(const Variant &p_key, const Variant &p_default) const {
@@ -123,16 +480,16 @@ Variant Dictionary::get(const Variant &p_key, const Variant &p_default) const {
 
 int Dictionary::size() const {
 
-	return _p->variant_map.size();
+	return _p->count;
 }
 bool Dictionary::empty() const {
 
-	return !_p->variant_map.size();
+	return !_p->count;
 }
 
 bool Dictionary::has(const Variant &p_key) const {
 
-	return _p->variant_map.has(p_key);
+	return _p->find(p_key) >= 0;
 }
 
 bool Dictionary::has_all(const Array &p_keys) const {
@@ -146,7 +503,12 @@ bool Dictionary::has_all(const Array &p_keys) const {
 
 bool Dictionary::erase(const Variant &p_key) {
 
-	return _p->variant_map.erase(p_key);
+	int index = _p->find(p_key);
+
+	if (index < 0)
+		return false;
+	_p->erase(index);
+	return true;
 }
 
 bool Dictionary::operator==(const Dictionary &p_dictionary) const {
@@ -177,7 +539,7 @@ void Dictionary::_ref(const Dictionary &p_from) const {
 
 void Dictionary::clear() {
 
-	_p->variant_map.clear();
+	_p->clear();
 }
 
 void Dictionary::_unref() const {
@@ -192,13 +554,10 @@ uint32_t Dictionary::hash() const {
 
 	uint32_t h = hash_djb2_one_32(Variant::DICTIONARY);
 
-	List<Variant> keys;
-	get_key_list(&keys);
-
-	for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+	for (int i = _p->next_position(0); i >= 0; i = _p->next_position(i + 1)) {
 
-		h = hash_djb2_one_32(E->get().hash(), h);
-		h = hash_djb2_one_32(operator[](E->get()).hash(), h);
+		h = hash_djb2_one_32(_p->entry_at(i).key.hash(), h);
+		h = hash_djb2_one_32(_p->entry_at(i).value.hash(), h);
 	}
 
 	return h;
@@ -208,13 +567,11 @@ Array Dictionary::keys() const {
 
 	Array varr;
 	varr.resize(size());
-	if (_p->variant_map.empty())
-		return varr;
 
-	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		varr[i] = E.key();
-		i++;
+	int j = 0;
+	for (int i = _p->next_position(0); i >= 0; i = _p->next_position(i + 1)) {
+		varr[j] = _p->entry_at(i).key;
+		j++;
 	}
 
 	return varr;
@@ -224,13 +581,11 @@ Array Dictionary::values() const {
 
 	Array varr;
 	varr.resize(size());
-	if (_p->variant_map.empty())
-		return varr;
 
-	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		varr[i] = E.get();
-		i++;
+	int j = 0;
+	for (int i = _p->next_position(0); i >= 0; i = _p->next_position(i + 1)) {
+		varr[j] = _p->entry_at(i).value;
+		j++;
 	}
 
 	return varr;
@@ -240,26 +595,52 @@ const Variant *Dictionary::next(const Variant *p_key) const {
 
 	if (p_key == NULL) {
 		// caller wants to get the first element
-		if (_p->variant_map.front())
-			return &_p->variant_map.front().key();
+		int first = _p->next_position(0);
+		if (first >= 0)
+			return &_p->entry_at(first).key;
 		return NULL;
 	}
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(*p_key);
 
-	if (E && E.next())
-		return &E.next().key();
+	// Usually the key returned by the previous call, no need to look it up then.
+	int index = _p->find_pointer(p_key);
+	if (index < 0) {
+		index = _p->find(*p_key);
+	}
+
+	if (index < 0)
+		return NULL;
+
+	int next = _p->next_position(_p->entry(index).position + 1);
+	if (next >= 0)
+		return &_p->entry_at(next).key;
 	return NULL;
 }
 
 Dictionary Dictionary::duplicate(bool p_deep) const {
 
 	Dictionary n;
+	n._p->reserve(_p->count);
+
+	// The keys are already unique, copy the entries without looking them up.
+	for (int i = _p->next_position(0); i >= 0; i = _p->next_position(i + 1)) {
+
+		const DictionaryPrivate::Entry &e = _p->entry_at(i);
+		uint32_t index = n._p->entry_count++;
+		DictionaryPrivate::Entry &copy = n._p->entry(index);
+		memnew_placement(&copy.key, Variant(e.key));
+		memnew_placement(&copy.value, Variant(p_deep ? e.value.duplicate(p_deep) : e.value));
+		copy.hash = e.hash;
+		copy.position = n._p->used;
+		n._p->order[n._p->used++] = index;
+	}
+	n._p->count = n._p->used;
 
-	List<Variant> keys;
-	get_key_list(&keys);
-
-	for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
-		n[E->get()] = p_deep ? operator[](E->get()).duplicate(p_deep) : operator[](E->get());
+	if (n._p->used > DictionaryPrivate::SMALL_SIZE) {
+		if (_p->table) {
+			n._p->_rebuild_table();
+		} else {
+			n._p->_create_table();
+		}
 	}
 
 	return n;
@@ -81,7 +81,7 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	buffer.resize(block_size);
 	read_ptr = buffer.ptrw();
 	f->get_buffer(comp_buffer.ptrw(), read_blocks[0].csize);
-	at_end = false;
+	at_end = read_total == 0;
 	read_eof = false;
 	read_block_count = bc;
 	read_block_size = read_blocks.size() == 1 ? read_total : block_size;
@@ -205,9 +205,11 @@ void FileAccessCompressed::seek(size_t p_position) {
 	} else {
 
 		ERR_FAIL_COND(p_position > read_total);
+		read_eof = false;
 		if (p_position == read_total) {
 			at_end = true;
 		} else {
+			at_end = false;
 
 			int block_idx = p_position / block_size;
 			if (block_idx != read_block) {
@@ -289,6 +291,9 @@ uint8_t FileAccessCompressed::get_8() const {
 			Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
 			read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
 			read_pos = 0;
+			// the last block is empty when the size is a multiple of the block size
+			if (read_block_size == 0)
+				at_end = true;
 
 		} else {
 			read_block--;
@@ -321,13 +326,20 @@ int FileAccessCompressed::get_buffer(uint8_t *p_dst, int p_length) const {
 				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
 				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
 				read_pos = 0;
+				// the last block is empty when the size is a multiple of the block size
+				if (read_block_size == 0) {
+					at_end = true;
+					if (i < p_length - 1)
+						read_eof = true;
+					return i + 1;
+				}
 
 			} else {
 				read_block--;
 				at_end = true;
 				if (i < p_length - 1)
 					read_eof = true;
-				return i;
+				return i + 1;
 			}
 		}
 	}
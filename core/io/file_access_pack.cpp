@@ -30,12 +30,12 @@
 
 #include "file_access_pack.h"
 
+#include "core/io/file_access_compressed.h"
+#include "core/io/marshalls.h"
 #include "core/version.h"
 
 #include <stdio.h>
 
-#define PACK_VERSION 1
-
 Error PackedData::add_pack(const String &p_path) {
 
 	for (int i = 0; i < sources.size(); i++) {
@@ -49,7 +49,7 @@ Error PackedData::add_pack(const String &p_path) {
 	return ERR_FILE_UNRECOGNIZED;
 };
 
-void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src) {
+void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, bool p_compressed) {
 
 	PathMD5 pmd5(path.md5_buffer());
 	//printf("adding path %ls, %lli, %lli\n", path.c_str(), pmd5.a, pmd5.b);
@@ -63,38 +63,160 @@ void PackedData::add_path(const String &pkg_path, const String &path, uint64_t o
 	for (int i = 0; i < 16; i++)
 		pf.md5[i] = p_md5[i];
 	pf.src = p_src;
+	pf.compressed = p_compressed;
 
 	files[pmd5] = pf;
 
 	if (!exists) {
-		//search for dir
-		String p = path.replace_first("res://", "");
-		PackedDir *cd = root;
+		MutexLock lock(tree_mutex);
+		_add_to_tree(path);
+	}
+}
 
-		if (p.find("/") != -1) { //in a subdir
+void PackedData::_add_to_tree(const String &p_path) {
 
-			Vector<String> ds = p.get_base_dir().split("/");
+	//search for dir
+	String p = p_path.replace_first("res://", "");
+	PackedDir *cd = root;
 
-			for (int j = 0; j < ds.size(); j++) {
+	if (p.find("/") != -1) { //in a subdir
 
-				if (!cd->subdirs.has(ds[j])) {
+		Vector<String> ds = p.get_base_dir().split("/");
 
-					PackedDir *pd = memnew(PackedDir);
-					pd->name = ds[j];
-					pd->parent = cd;
-					cd->subdirs[pd->name] = pd;
-					cd = pd;
-				} else {
-					cd = cd->subdirs[ds[j]];
-				}
+		for (int j = 0; j < ds.size(); j++) {
+
+			if (!cd->subdirs.has(ds[j])) {
+
+				PackedDir *pd = memnew(PackedDir);
+				pd->name = ds[j];
+				pd->parent = cd;
+				cd->subdirs[pd->name] = pd;
+				cd = pd;
+			} else {
+				cd = cd->subdirs[ds[j]];
 			}
 		}
-		String filename = path.get_file();
-		// Don't add as a file if the path points to a directoryy
-		if (!filename.empty()) {
-			cd->files.insert(filename);
+	}
+	String filename = p_path.get_file();
+	// Don't add as a file if the path points to a directoryy
+	if (!filename.empty()) {
+		cd->files.insert(filename);
+	}
+}
+
+void PackedData::add_pack_index(PackIndex *p_index) {
+
+	// The new pack overrides the files loaded before it.
+	Vector<PathMD5> overridden;
+	for (Map<PathMD5, PackedFile>::Element *E = files.front(); E; E = E->next()) {
+
+		uint8_t md5[16];
+		memcpy(&md5[0], &E->key().a, 8);
+		memcpy(&md5[8], &E->key().b, 8);
+		if (p_index->find(md5) != -1) {
+			overridden.push_back(E->key());
+		}
+	}
+	for (int i = 0; i < overridden.size(); i++) {
+		files.erase(overridden[i]);
+	}
+
+	MutexLock lock(tree_mutex);
+	p_index->in_tree = false;
+	indices.push_back(p_index);
+}
+
+PackedData::PackedDir *PackedData::_get_root() {
+
+	MutexLock lock(tree_mutex);
+
+	for (int i = 0; i < indices.size(); i++) {
+
+		PackIndex *index = indices[i];
+		if (index->in_tree)
+			continue;
+		index->in_tree = true;
+
+		FileAccess *f = FileAccess::open(index->pack, FileAccess::READ);
+		ERR_CONTINUE(!f);
+
+		CharString strings;
+		strings.resize(index->strings_size + 1);
+		f->seek(index->strings_offset);
+		int read = f->get_buffer((uint8_t *)strings.ptrw(), index->strings_size);
+		strings[MAX(read, 0)] = 0;
+		memdelete(f);
+
+		const uint8_t *entries = index->entries.ptr();
+		for (int j = 0; j < index->file_count; j++) {
+
+			uint32_t ofs = decode_uint32(&entries[j * PACK_INDEX_ENTRY_SIZE + 52]);
+			ERR_CONTINUE(ofs >= index->strings_size);
+			String path;
+			path.parse_utf8(strings.ptr() + ofs);
+			_add_to_tree(path);
+		}
+	}
+
+	return root;
+}
+
+bool PackedData::_find_path(const String &p_path, PackedFile *r_file) {
+
+	Vector<uint8_t> md5 = p_path.md5_buffer();
+
+	Map<PathMD5, PackedFile>::Element *E = files.find(PathMD5(md5));
+	if (E) {
+		if (r_file)
+			*r_file = E->get();
+		return true;
+	}
+
+	for (int i = indices.size() - 1; i >= 0; i--) {
+
+		int idx = indices[i]->find(md5.ptr());
+		if (idx != -1) {
+			if (r_file)
+				indices[i]->get_file(idx, r_file);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int PackedData::PackIndex::find(const uint8_t *p_path_md5) const {
+
+	const uint8_t *e = entries.ptr();
+	int low = 0;
+	int high = file_count - 1;
+
+	while (low <= high) {
+
+		int middle = (low + high) / 2;
+		int cmp = memcmp(&e[middle * PACK_INDEX_ENTRY_SIZE], p_path_md5, 16);
+		if (cmp < 0) {
+			low = middle + 1;
+		} else if (cmp > 0) {
+			high = middle - 1;
+		} else {
+			return middle;
 		}
 	}
+
+	return -1;
+}
+
+void PackedData::PackIndex::get_file(int p_index, PackedFile *r_file) const {
+
+	const uint8_t *e = &entries[p_index * PACK_INDEX_ENTRY_SIZE];
+
+	r_file->pack = pack;
+	r_file->offset = base + decode_uint64(&e[16]);
+	r_file->size = decode_uint64(&e[24]);
+	memcpy(r_file->md5, &e[32], 16);
+	r_file->compressed = decode_uint32(&e[48]) & PACK_FILE_COMPRESSED;
+	r_file->src = src;
 }
 
 void PackedData::add_pack_source(PackSource *p_source) {
@@ -111,6 +233,7 @@ PackedData::PackedData() {
 	singleton = this;
 	root = memnew(PackedDir);
 	root->parent = NULL;
+	tree_mutex = Mutex::create();
 	disabled = false;
 
 	add_pack_source(memnew(PackedSourcePCK));
@@ -128,7 +251,12 @@ PackedData::~PackedData() {
 	for (int i = 0; i < sources.size(); i++) {
 		memdelete(sources[i]);
 	}
+	for (int i = 0; i < indices.size(); i++) {
+		memdelete(indices[i]);
+	}
 	_free_packed_dirs(root);
+	if (tree_mutex)
+		memdelete(tree_mutex);
 }
 
 //////////////////////////////////////////////////////////////////
@@ -143,12 +271,12 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 
 	uint32_t magic = f->get_32();
 
-	if (magic != 0x43504447) {
+	if (magic != PACK_HEADER_MAGIC) {
 		//maybe at he end.... self contained exe
 		f->seek_end();
 		f->seek(f->get_position() - 4);
 		magic = f->get_32();
-		if (magic != 0x43504447) {
+		if (magic != PACK_HEADER_MAGIC) {
 
 			memdelete(f);
 			return false;
@@ -159,22 +287,36 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 		f->seek(f->get_position() - ds - 8);
 
 		magic = f->get_32();
-		if (magic != 0x43504447) {
+		if (magic != PACK_HEADER_MAGIC) {
 
 			memdelete(f);
 			return false;
 		}
 	}
 
+	uint64_t base = f->get_position() - 4;
+
 	uint32_t version = f->get_32();
 	uint32_t ver_major = f->get_32();
 	uint32_t ver_minor = f->get_32();
 	f->get_32(); // ver_rev
 
-	ERR_EXPLAIN("Pack version unsupported: " + itos(version));
-	ERR_FAIL_COND_V(version != PACK_VERSION, false);
-	ERR_EXPLAIN("Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor));
-	ERR_FAIL_COND_V(ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR), false);
+	if (version < 1 || version > PACK_FORMAT_VERSION) {
+		memdelete(f);
+		ERR_EXPLAIN("Pack version unsupported: " + itos(version));
+		ERR_FAIL_V(false);
+	}
+	if (ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR)) {
+		memdelete(f);
+		ERR_EXPLAIN("Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor));
+		ERR_FAIL_V(false);
+	}
+
+	if (version == 2) {
+		bool ok = _open_index(f, p_path, base);
+		memdelete(f);
+		return ok;
+	}
 
 	for (int i = 0; i < 16; i++) {
 		//reserved
@@ -201,12 +343,59 @@ bool PackedSourcePCK::try_open_pack(const String &p_path) {
 		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this);
 	};
 
+	memdelete(f);
 	return true;
 };
 
+bool PackedSourcePCK::_open_index(FileAccess *f, const String &p_path, uint64_t p_base) {
+
+	f->get_32(); // flags
+	uint64_t index_ofs = f->get_64();
+
+	f->seek(p_base + index_ofs);
+	uint32_t file_count = f->get_32();
+	uint32_t strings_size = f->get_32();
+
+	ERR_FAIL_COND_V(f->eof_reached(), false);
+	ERR_FAIL_COND_V(file_count > (uint32_t)(f->get_len() / PACK_INDEX_ENTRY_SIZE), false);
+
+	PackedData::PackIndex *index = memnew(PackedData::PackIndex);
+	index->pack = p_path;
+	index->base = p_base;
+	index->src = this;
+	index->file_count = file_count;
+	index->entries.resize(file_count * PACK_INDEX_ENTRY_SIZE);
+	int size = index->entries.size();
+	if (f->get_buffer(index->entries.ptrw(), size) != size) {
+		memdelete(index);
+		ERR_EXPLAIN("Pack file table is truncated: " + p_path);
+		ERR_FAIL_V(false);
+	}
+	index->strings_offset = f->get_position();
+	index->strings_size = strings_size;
+
+	PackedData::get_singleton()->add_pack_index(index);
+
+	return true;
+}
+
 FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFile *p_file) {
 
-	return memnew(FileAccessPack(p_path, *p_file));
+	FileAccessPack *fp = memnew(FileAccessPack(p_path, *p_file));
+	if (!p_file->compressed)
+		return fp;
+
+	uint8_t magic[4];
+	if (fp->get_buffer(magic, 4) != 4 || memcmp(magic, PACK_COMPRESSED_MAGIC, 4) != 0) {
+		memdelete(fp);
+		ERR_EXPLAIN("Compressed pack file is corrupt: " + p_path);
+		ERR_FAIL_V(NULL);
+	}
+
+	FileAccessCompressed *fc = memnew(FileAccessCompressed);
+	fc->configure(PACK_COMPRESSED_MAGIC);
+	fc->open_after_magic(fp); // takes ownership of fp
+	return fc;
 };
 
 //////////////////////////////////////////////////////////////////
@@ -267,6 +456,34 @@ uint8_t FileAccessPack::get_8() const {
 	return f->get_8();
 }
 
+// The wrapped file applies the same endianness, so whole values can be read from it.
+uint16_t FileAccessPack::get_16() const {
+
+	if (pos + 2 > pf.size)
+		return FileAccess::get_16();
+
+	pos += 2;
+	return f->get_16();
+}
+
+uint32_t FileAccessPack::get_32() const {
+
+	if (pos + 4 > pf.size)
+		return FileAccess::get_32();
+
+	pos += 4;
+	return f->get_32();
+}
+
+uint64_t FileAccessPack::get_64() const {
+
+	if (pos + 8 > pf.size)
+		return FileAccess::get_64();
+
+	pos += 8;
+	return f->get_64();
+}
+
 int FileAccessPack::get_buffer(uint8_t *p_dst, int p_length) const {
 
 	if (eof)
@@ -287,6 +504,17 @@ int FileAccessPack::get_buffer(uint8_t *p_dst, int p_length) const {
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::map_buffer(int p_length) const {
+
+	if (eof || p_length < 0 || pos + p_length > pf.size)
+		return NULL;
+
+	const uint8_t *ptr = f->map_buffer(p_length);
+	if (ptr)
+		pos += p_length;
+	return ptr;
+}
+
 void FileAccessPack::set_endian_swap(bool p_swap) {
 	FileAccess::set_endian_swap(p_swap);
 	f->set_endian_swap(p_swap);
@@ -420,7 +648,7 @@ Error DirAccessPack::change_dir(String p_dir) {
 	PackedData::PackedDir *pd;
 
 	if (absolute)
-		pd = PackedData::get_singleton()->root;
+		pd = PackedData::get_singleton()->_get_root();
 	else
 		pd = current;
 
@@ -496,7 +724,7 @@ String DirAccessPack::get_filesystem_type() const {
 
 DirAccessPack::DirAccessPack() {
 
-	current = PackedData::get_singleton()->root;
+	current = PackedData::get_singleton()->_get_root();
 	cdir = false;
 }
 
@@ -35,8 +35,25 @@
 #include "core/map.h"
 #include "core/os/dir_access.h"
 #include "core/os/file_access.h"
+#include "core/os/mutex.h"
 #include "core/print_string.h"
 
+#define PACK_HEADER_MAGIC 0x43504447
+#define PACK_FORMAT_VERSION 2
+
+// Version 2 packs keep their file table at the end, sorted by the MD5 of the
+// paths, so it can be searched in place instead of being loaded path by path.
+// Each entry is PACK_INDEX_ENTRY_SIZE bytes:
+//   path MD5 (16), offset from the pack header (8), stored size (8),
+//   contents MD5 (16), PackFileFlags (4), offset in the path strings (4)
+#define PACK_INDEX_ENTRY_SIZE 56
+
+enum PackFileFlags {
+	PACK_FILE_COMPRESSED = 1 << 0, // stored as a FileAccessCompressed stream
+};
+
+#define PACK_COMPRESSED_MAGIC "GPCF"
+
 class PackSource;
 
 class PackedData {
@@ -52,6 +69,23 @@ public:
 		uint64_t size;
 		uint8_t md5[16];
 		PackSource *src;
+		bool compressed;
+	};
+
+	// The file table of a mounted version 2 pack.
+	struct PackIndex {
+
+		String pack;
+		uint64_t base; // position of the pack header
+		PackSource *src;
+		Vector<uint8_t> entries;
+		int file_count;
+		uint64_t strings_offset;
+		uint32_t strings_size;
+		bool in_tree; // paths are only added to the directory tree when it's first used
+
+		int find(const uint8_t *p_path_md5) const;
+		void get_file(int p_index, PackedFile *r_file) const;
 	};
 
 private:
@@ -89,20 +123,26 @@ private:
 	};
 
 	Map<PathMD5, PackedFile> files;
+	Vector<PackIndex *> indices; // newer packs last, files in them take precedence over the ones in files
 
 	Vector<PackSource *> sources;
 
 	PackedDir *root;
+	Mutex *tree_mutex;
 	//Map<String,PackedDir*> dirs;
 
 	static PackedData *singleton;
 	bool disabled;
 
 	void _free_packed_dirs(PackedDir *p_dir);
+	void _add_to_tree(const String &p_path);
+	PackedDir *_get_root();
+	bool _find_path(const String &p_path, PackedFile *r_file);
 
 public:
 	void add_pack_source(PackSource *p_source);
-	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src); // for PackSource
+	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, bool p_compressed = false); // for PackSource
+	void add_pack_index(PackIndex *p_index); // for PackSource, takes ownership
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
@@ -127,6 +167,8 @@ public:
 
 class PackedSourcePCK : public PackSource {
 
+	bool _open_index(FileAccess *f, const String &p_path, uint64_t p_base);
+
 public:
 	virtual bool try_open_pack(const String &p_path);
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file);
@@ -155,8 +197,12 @@ public:
 	virtual bool eof_reached() const;
 
 	virtual uint8_t get_8() const;
+	virtual uint16_t get_16() const;
+	virtual uint32_t get_32() const;
+	virtual uint64_t get_64() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+	virtual const uint8_t *map_buffer(int p_length) const;
 
 	virtual void set_endian_swap(bool p_swap);
 
@@ -175,19 +221,18 @@ public:
 
 FileAccess *PackedData::try_open_path(const String &p_path) {
 
-	PathMD5 pmd5(p_path.md5_buffer());
-	Map<PathMD5, PackedFile>::Element *E = files.find(pmd5);
-	if (!E)
+	PackedFile pf;
+	if (!_find_path(p_path, &pf))
 		return NULL; //not found
-	if (E->get().offset == 0)
+	if (pf.offset == 0)
 		return NULL; //was erased
 
-	return E->get().src->get_file(p_path, &E->get());
+	return pf.src->get_file(p_path, &pf);
 }
 
 bool PackedData::has_path(const String &p_path) {
 
-	return files.has(PathMD5(p_path.md5_buffer()));
+	return _find_path(p_path, NULL);
 }
 
 class DirAccessPack : public DirAccess {
@@ -30,8 +30,17 @@
 
 #include "pck_packer.h"
 
+#include "core/io/compression.h"
+#include "core/io/file_access_pack.h"
+#include "core/io/marshalls.h"
 #include "core/os/file_access.h"
 #include "core/version.h"
+#include "thirdparty/misc/md5.h"
+
+// Compressed files are split in blocks of this size, a seek decompresses one block.
+#define COMPRESSION_BLOCK_SIZE 65536
+// FileAccessCompressed stores sizes in 32 bits.
+#define COMPRESSION_MAX_SIZE (1 << 30)
 
 static uint64_t _align(uint64_t p_n, int p_alignment) {
 
@@ -56,12 +65,16 @@ static void _pad(FileAccess *p_file, int p_bytes) {
 void PCKPacker::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("pck_start", "pck_name", "alignment"), &PCKPacker::pck_start);
-	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path"), &PCKPacker::add_file);
+	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path", "compress"), &PCKPacker::add_file, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("flush", "verbose"), &PCKPacker::flush);
 };
 
 Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
 
+	if (file != NULL) {
+		memdelete(file);
+	};
+
 	file = FileAccess::open(p_file, FileAccess::WRITE);
 	if (file == NULL) {
 
@@ -70,11 +83,14 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
 
 	alignment = p_alignment;
 
-	file->store_32(0x43504447); // MAGIC
-	file->store_32(1); // # version
+	file->store_32(PACK_HEADER_MAGIC); // MAGIC
+	file->store_32(PACK_FORMAT_VERSION); // # version
 	file->store_32(VERSION_MAJOR); // # major
 	file->store_32(VERSION_MINOR); // # minor
 	file->store_32(0); // # revision
+	file->store_32(0); // # flags
+	index_ofs_pos = file->get_position();
+	file->store_64(0); // file table offset, written by flush()
 
 	for (int i = 0; i < 16; i++) {
 
@@ -86,27 +102,132 @@ Error PCKPacker::pck_start(const String &p_file, int p_alignment) {
 	return OK;
 };
 
-Error PCKPacker::add_file(const String &p_file, const String &p_src) {
+void PCKPacker::_add_entry(const String &p_file, uint64_t p_offset, uint64_t p_size, const uint8_t *p_md5, uint32_t p_flags) {
+
+	File pf;
+	pf.path = p_file;
+	Vector<uint8_t> path_md5 = p_file.md5_buffer();
+	memcpy(pf.path_md5, path_md5.ptr(), 16);
+	pf.offset = p_offset;
+	pf.size = p_size;
+	memcpy(pf.md5, p_md5, 16);
+	pf.flags = p_flags;
+	pf.order = files.size();
+
+	files.push_back(pf);
+}
+
+// Uses the layout of FileAccessCompressed, which reads these files back.
+Vector<uint8_t> PCKPacker::_compress(const uint8_t *p_data, int p_size) const {
+
+	const Compression::Mode mode = Compression::MODE_ZSTD;
+	int bc = (p_size / COMPRESSION_BLOCK_SIZE) + 1;
+
+	Vector<uint8_t> ret;
+	ret.resize(16 + bc * 4);
+	memcpy(ret.ptrw(), PACK_COMPRESSED_MAGIC, 4);
+	encode_uint32(mode, &ret.ptrw()[4]);
+	encode_uint32(COMPRESSION_BLOCK_SIZE, &ret.ptrw()[8]);
+	encode_uint32(p_size, &ret.ptrw()[12]);
+
+	Vector<uint8_t> cblock;
+	for (int i = 0; i < bc; i++) {
+
+		int bl = i == (bc - 1) ? p_size % COMPRESSION_BLOCK_SIZE : COMPRESSION_BLOCK_SIZE;
+		cblock.resize(Compression::get_max_compressed_buffer_size(bl, mode));
+		int s = Compression::compress(cblock.ptrw(), &p_data[i * COMPRESSION_BLOCK_SIZE], bl, mode);
+		ERR_FAIL_COND_V(s < 0, Vector<uint8_t>());
+
+		int pos = ret.size();
+		ret.resize(pos + s);
+		memcpy(&ret.ptrw()[pos], cblock.ptr(), s);
+		encode_uint32(s, &ret.ptrw()[16 + i * 4]);
+	}
+
+	int pos = ret.size();
+	ret.resize(pos + 4);
+	memcpy(&ret.ptrw()[pos], PACK_COMPRESSED_MAGIC, 4); //magic at the end too
+
+	return ret;
+}
+
+Error PCKPacker::add_file(const String &p_file, const String &p_src, bool p_compress) {
+
+	ERR_FAIL_COND_V(!file, ERR_UNCONFIGURED);
 
 	FileAccess *f = FileAccess::open(p_src, FileAccess::READ);
 	if (!f) {
 		return ERR_FILE_CANT_OPEN;
 	};
 
-	File pf;
-	pf.path = p_file;
-	pf.src_path = p_src;
-	pf.size = f->get_len();
-	pf.offset_offset = 0;
+	uint64_t size = f->get_len();
 
-	files.push_back(pf);
+	if (p_compress && size > 0 && size < COMPRESSION_MAX_SIZE) {
+
+		Vector<uint8_t> data;
+		data.resize(size);
+		f->get_buffer(data.ptrw(), size);
+		memdelete(f);
+
+		return add_file_data(p_file, data, true);
+	}
+
+	// Large files are copied without holding them in memory.
+	_pad(file, _align(file->get_position(), alignment) - file->get_position());
+	uint64_t ofs = file->get_position();
+
+	MD5_CTX ctx;
+	MD5Init(&ctx);
 
-	f->close();
+	const uint32_t buf_max = 65536;
+	uint8_t *buf = memnew_arr(uint8_t, buf_max);
+
+	uint64_t to_write = size;
+	while (to_write > 0) {
+
+		int read = f->get_buffer(buf, MIN(to_write, buf_max));
+		if (read <= 0)
+			break;
+		MD5Update(&ctx, buf, read);
+		file->store_buffer(buf, read);
+		to_write -= read;
+	};
+
+	memdelete_arr(buf);
+	MD5Final(&ctx);
 	memdelete(f);
 
+	_add_entry(p_file, ofs, size - to_write, ctx.digest, 0);
+
 	return OK;
 };
 
+Error PCKPacker::add_file_data(const String &p_file, const Vector<uint8_t> &p_data, bool p_compress) {
+
+	ERR_FAIL_COND_V(!file, ERR_UNCONFIGURED);
+
+	MD5_CTX ctx;
+	MD5Init(&ctx);
+	MD5Update(&ctx, (unsigned char *)p_data.ptr(), p_data.size());
+	MD5Final(&ctx);
+
+	// Only keep the compressed data when it's worth decompressing on every read.
+	Vector<uint8_t> compressed;
+	if (p_compress && p_data.size() > 0 && p_data.size() < COMPRESSION_MAX_SIZE) {
+		compressed = _compress(p_data.ptr(), p_data.size());
+	}
+	bool use_compressed = compressed.size() > 0 && compressed.size() < p_data.size() - p_data.size() / 10;
+	const Vector<uint8_t> &data = use_compressed ? compressed : p_data;
+
+	_pad(file, _align(file->get_position(), alignment) - file->get_position());
+	uint64_t ofs = file->get_position();
+	file->store_buffer(data.ptr(), data.size());
+
+	_add_entry(p_file, ofs, data.size(), ctx.digest, use_compressed ? PACK_FILE_COMPRESSED : 0);
+
+	return OK;
+}
+
 Error PCKPacker::flush(bool p_verbose) {
 
 	if (!file) {
@@ -114,68 +235,58 @@ Error PCKPacker::flush(bool p_verbose) {
 		return ERR_INVALID_PARAMETER;
 	};
 
-	// write the index
-
-	file->store_32(files.size());
+	// Sort the file table so it can be searched, later additions of the same path win.
+	files.sort();
 
+	Vector<File> table;
 	for (int i = 0; i < files.size(); i++) {
 
-		file->store_pascal_string(files[i].path);
-		files.write[i].offset_offset = file->get_position();
-		file->store_64(0); // offset
-		file->store_64(files[i].size); // size
+		if (i + 1 < files.size() && memcmp(files[i].path_md5, files[i + 1].path_md5, 16) == 0)
+			continue;
+		table.push_back(files[i]);
+	}
 
-		// # empty md5
-		file->store_32(0);
-		file->store_32(0);
-		file->store_32(0);
-		file->store_32(0);
-	};
+	uint64_t index_ofs = file->get_position();
 
-	uint64_t ofs = file->get_position();
-	ofs = _align(ofs, alignment);
+	Vector<uint8_t> strings;
+	Vector<uint32_t> string_ofs;
+	for (int i = 0; i < table.size(); i++) {
 
-	_pad(file, ofs - file->get_position());
+		CharString cs = table[i].path.utf8();
+		int pos = strings.size();
+		string_ofs.push_back(pos);
+		strings.resize(pos + cs.length() + 1);
+		memcpy(&strings.ptrw()[pos], cs.get_data(), cs.length() + 1);
+	}
 
-	const uint32_t buf_max = 65536;
-	uint8_t *buf = memnew_arr(uint8_t, buf_max);
+	file->store_32(table.size());
+	file->store_32(strings.size());
 
-	int count = 0;
-	for (int i = 0; i < files.size(); i++) {
+	for (int i = 0; i < table.size(); i++) {
 
-		FileAccess *src = FileAccess::open(files[i].src_path, FileAccess::READ);
-		uint64_t to_write = files[i].size;
-		while (to_write > 0) {
-
-			int read = src->get_buffer(buf, MIN(to_write, buf_max));
-			file->store_buffer(buf, read);
-			to_write -= read;
-		};
-
-		uint64_t pos = file->get_position();
-		file->seek(files[i].offset_offset); // go back to store the file's offset
-		file->store_64(ofs);
-		file->seek(pos);
-
-		ofs = _align(ofs + files[i].size, alignment);
-		_pad(file, ofs - pos);
-
-		src->close();
-		memdelete(src);
-		count += 1;
-		if (p_verbose) {
-			if (count % 100 == 0) {
-				printf("%i/%i (%.2f)\r", count, files.size(), float(count) / files.size() * 100);
-				fflush(stdout);
-			};
-		};
-	};
+		file->store_buffer(table[i].path_md5, 16);
+		file->store_64(table[i].offset);
+		file->store_64(table[i].size);
+		file->store_buffer(table[i].md5, 16);
+		file->store_32(table[i].flags);
+		file->store_32(string_ofs[i]);
+	}
+	file->store_buffer(strings.ptr(), strings.size());
+
+	// Lets the pack be found when it's appended to another file.
+	file->store_64(file->get_position());
+	file->store_32(PACK_HEADER_MAGIC);
 
-	if (p_verbose)
-		printf("\n");
+	file->seek(index_ofs_pos);
+	file->store_64(index_ofs);
+
+	if (p_verbose) {
+		printf("%i files, %.2f MB\n", table.size(), file->get_len() / (1024.0 * 1024.0));
+	}
 
 	file->close();
-	memdelete_arr(buf);
+	memdelete(file);
+	file = NULL;
 
 	return OK;
 };
@@ -183,6 +294,8 @@ Error PCKPacker::flush(bool p_verbose) {
 PCKPacker::PCKPacker() {
 
 	file = NULL;
+	alignment = 0;
+	index_ofs_pos = 0;
 };
 
 PCKPacker::~PCKPacker() {
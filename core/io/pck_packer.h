@@ -41,21 +41,34 @@ class PCKPacker : public Reference {
 
 	FileAccess *file;
 	int alignment;
+	uint64_t index_ofs_pos;
 
 	static void _bind_methods();
 
 	struct File {
 
 		String path;
-		String src_path;
-		int size;
-		uint64_t offset_offset;
+		uint8_t path_md5[16];
+		uint64_t offset;
+		uint64_t size;
+		uint8_t md5[16];
+		uint32_t flags;
+		int order;
+
+		bool operator<(const File &p_file) const {
+			int cmp = memcmp(path_md5, p_file.path_md5, 16);
+			return cmp != 0 ? cmp < 0 : order < p_file.order;
+		}
 	};
 	Vector<File> files;
 
+	void _add_entry(const String &p_file, uint64_t p_offset, uint64_t p_size, const uint8_t *p_md5, uint32_t p_flags);
+	Vector<uint8_t> _compress(const uint8_t *p_data, int p_size) const;
+
 public:
 	Error pck_start(const String &p_file, int p_alignment);
-	Error add_file(const String &p_file, const String &p_src);
+	Error add_file(const String &p_file, const String &p_src, bool p_compress = false);
+	Error add_file_data(const String &p_file, const Vector<uint8_t> &p_data, bool p_compress = false);
 	Error flush(bool p_verbose = false);
 
 	PCKPacker();
@@ -92,6 +92,26 @@ enum {
 
 };
 
+// Strings are stored with their trailing zero. When the file is memory mapped
+// they are decoded in place, otherwise they are read into r_buf first.
+static String _read_utf8(FileAccess *f, int p_len, Vector<char> &r_buf) {
+
+	ERR_FAIL_COND_V(p_len < 0, String());
+
+	String s;
+	const uint8_t *mapped = f->map_buffer(p_len);
+	if (mapped) {
+		s.parse_utf8((const char *)mapped, p_len);
+	} else {
+		if (p_len > r_buf.size()) {
+			r_buf.resize(p_len);
+		}
+		int read = f->get_buffer((uint8_t *)r_buf.ptrw(), p_len);
+		s.parse_utf8(r_buf.ptr(), MAX(read, 0));
+	}
+	return s;
+}
+
 void ResourceInteractiveLoaderBinary::_advance_padding(uint32_t p_len) {
 
 	uint32_t extra = 4 - (p_len % 4);
@@ -106,15 +126,9 @@ StringName ResourceInteractiveLoaderBinary::_get_string() {
 	uint32_t id = f->get_32();
 	if (id & 0x80000000) {
 		uint32_t len = id & 0x7FFFFFFF;
-		if ((int)len > str_buf.size()) {
-			str_buf.resize(len);
-		}
 		if (len == 0)
 			return StringName();
-		f->get_buffer((uint8_t *)&str_buf[0], len);
-		String s;
-		s.parse_utf8(&str_buf[0]);
-		return s;
+		return _read_utf8(f, len, str_buf);
 	}
 
 	return string_map[id];
@@ -794,25 +808,15 @@ static String get_ustring(FileAccess *f) {
 
 	int len = f->get_32();
 	Vector<char> str_buf;
-	str_buf.resize(len);
-	f->get_buffer((uint8_t *)&str_buf[0], len);
-	String s;
-	s.parse_utf8(&str_buf[0]);
-	return s;
+	return _read_utf8(f, len, str_buf);
 }
 
 String ResourceInteractiveLoaderBinary::get_unicode_string() {
 
 	int len = f->get_32();
-	if (len > str_buf.size()) {
-		str_buf.resize(len);
-	}
 	if (len == 0)
 		return String();
-	f->get_buffer((uint8_t *)&str_buf[0], len);
-	String s;
-	s.parse_utf8(&str_buf[0]);
-	return s;
+	return _read_utf8(f, len, str_buf);
 }
 
 void ResourceInteractiveLoaderBinary::get_dependencies(FileAccess *p_f, List<String> *p_dependencies, bool p_add_types) {
@@ -389,6 +389,44 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p
 		if (ResourceCache::lock) {
 			ResourceCache::lock->read_unlock();
 		}
+
+		//if it's being loaded in the background, wait for that instead of loading it twice
+		if (thread_load_mutex) {
+			thread_load_mutex->lock();
+
+			ThreadLoadTask **task_ptr = thread_load_tasks.getptr(local_path);
+			ThreadLoadTask *task = task_ptr ? *task_ptr : NULL;
+
+			// Failed or cancelled ones are loaded again below.
+			if (task && task->state == ThreadLoadTask::STATE_DONE && task->resource.is_null()) {
+				task = NULL;
+			}
+
+			if (task && !(task->state == ThreadLoadTask::STATE_RUNNING && task->thread == Thread::get_caller_id())) {
+
+				// If it didn't start yet it's loaded right here, which adds it again.
+				_remove_from_loading_map(local_path);
+
+				task->users++;
+				bool waited = _wait_thread_load(task);
+				RES res = task->resource;
+				Error err = task->error;
+				task->users--;
+
+				thread_load_mutex->unlock();
+
+				if (!waited) {
+					ERR_EXPLAIN("Resource: '" + local_path + "' is already being loaded. Cyclic reference?");
+					ERR_FAIL_V(RES());
+				}
+
+				if (r_error)
+					*r_error = err;
+				return res;
+			}
+
+			thread_load_mutex->unlock();
+		}
 	}
 
 	bool xl_remapped = false;
@@ -438,6 +476,395 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p
 	return res;
 }
 
+String ResourceLoader::_get_local_path(const String &p_path) {
+
+	if (p_path.is_rel_path())
+		return "res://" + p_path;
+	else
+		return ProjectSettings::get_singleton()->localize_path(p_path);
+}
+
+bool ResourceLoader::_can_load_on_threads() {
+
+	// VisualServer calls made while loading (texture and mesh uploads, RID creation)
+	// are queued to the server thread, and those returning a value block until it
+	// flushes them. Only a separate render thread flushes on its own; in the single
+	// safe mode it's the main thread, which may be the one waiting for the load.
+	return OS::get_singleton()->get_render_thread_mode() == OS::RENDER_SEPARATE_THREAD;
+}
+
+// The functions below expect thread_load_mutex to be locked.
+
+ResourceLoader::ThreadLoadTask *ResourceLoader::_request_thread_load(const String &p_local_path, const String &p_type_hint, bool p_use_pool) {
+
+	int requests = 0;
+
+	ThreadLoadTask **existing = thread_load_tasks.getptr(p_local_path);
+	if (existing) {
+		ThreadLoadTask *previous = *existing;
+		if (previous->state != ThreadLoadTask::STATE_DONE || previous->resource.is_valid()) {
+			return previous;
+		}
+
+		// Failed or cancelled before, try again with a new task.
+		requests = previous->requests;
+		previous->requests = 0;
+		thread_load_tasks.erase(p_local_path);
+		thread_load_detached.push_back(previous);
+	}
+
+	ThreadLoadTask *task = memnew(ThreadLoadTask);
+	task->local_path = p_local_path;
+	task->type_hint = p_type_hint;
+	task->requests = requests;
+	thread_load_tasks[p_local_path] = task;
+
+	RES cached;
+	if (ResourceCache::lock) {
+		ResourceCache::lock->read_lock();
+	}
+	Resource **rptr = ResourceCache::resources.getptr(p_local_path);
+	if (rptr) {
+		cached = RES(*rptr);
+	}
+	if (ResourceCache::lock) {
+		ResourceCache::lock->read_unlock();
+	}
+
+	if (cached.is_valid()) {
+		task->resource = cached;
+		task->state = ThreadLoadTask::STATE_DONE;
+		return task;
+	}
+
+	// Request the dependencies first, so independent ones load in parallel and are
+	// already in the cache when this one needs them. A dependency that is still being
+	// requested further up is a cycle, loading will report it.
+	task->requesting = true;
+
+	List<String> dependencies;
+	get_dependencies(p_local_path, &dependencies, true);
+
+	Vector<WorkerThreadPool::GroupID> dependency_groups;
+	for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+
+		String dependency = E->get();
+		String type_hint;
+		if (dependency.find("::") != -1) {
+			type_hint = dependency.get_slice("::", 1);
+			dependency = dependency.get_slice("::", 0);
+		}
+
+		ThreadLoadTask *dependency_task = _request_thread_load(_get_local_path(dependency), type_hint, p_use_pool);
+		if (dependency_task->requesting || task->dependencies.find(dependency_task) != -1) {
+			continue;
+		}
+
+		dependency_task->users++;
+		task->dependencies.push_back(dependency_task);
+
+		if (dependency_task->group_id != WorkerThreadPool::INVALID_GROUP_ID && dependency_task->state != ThreadLoadTask::STATE_DONE) {
+			dependency_groups.push_back(dependency_task->group_id);
+		}
+	}
+
+	task->requesting = false;
+
+	if (p_use_pool) {
+		// Held by the pool task until its group is waited for. With no worker threads
+		// the task runs right away, the mutex is recursive.
+		task->users++;
+		task->group_id = WorkerThreadPool::get_singleton()->add_task(_thread_load_function, task, dependency_groups.ptr(), dependency_groups.size());
+	}
+
+	return task;
+}
+
+void ResourceLoader::_run_thread_load(ThreadLoadTask *p_task) {
+
+	p_task->state = ThreadLoadTask::STATE_RUNNING;
+	p_task->thread = Thread::get_caller_id();
+
+	thread_load_mutex->unlock();
+
+	Error err = OK;
+	RES res = load(p_task->local_path, p_task->type_hint, false, &err);
+
+	thread_load_mutex->lock();
+
+	p_task->resource = res;
+	p_task->error = res.is_valid() ? OK : (err != OK ? err : FAILED);
+	p_task->state = ThreadLoadTask::STATE_DONE;
+
+	// The resource references what it needs from now on.
+	for (int i = 0; i < p_task->dependencies.size(); i++) {
+		p_task->dependencies[i]->users--;
+	}
+	p_task->dependencies.clear();
+
+	for (int i = 0; i < p_task->waiters; i++) {
+		p_task->semaphore->post();
+	}
+	p_task->waiters = 0;
+}
+
+void ResourceLoader::_thread_load_function(void *p_userdata, uint32_t p_index) {
+
+	ThreadLoadTask *task = (ThreadLoadTask *)p_userdata;
+
+	thread_load_mutex->lock();
+
+	// Another thread may have needed it first and loaded it, or it may be cancelled.
+	if (task->state == ThreadLoadTask::STATE_PENDING) {
+		_run_thread_load(task);
+	}
+
+	thread_load_mutex->unlock();
+}
+
+bool ResourceLoader::_wait_thread_load(ThreadLoadTask *p_task) {
+
+	Thread::ID caller = Thread::get_caller_id();
+
+	while (p_task->state != ThreadLoadTask::STATE_DONE) {
+
+		if (p_task->state == ThreadLoadTask::STATE_PENDING) {
+			// Not started yet, load it here rather than waiting for a worker.
+			_run_thread_load(p_task);
+			break;
+		}
+
+		// Running on another thread. Don't wait if that thread is waiting for us.
+		Thread::ID thread = p_task->thread;
+		while (thread != caller) {
+			ThreadLoadTask **waiting = thread_load_waiting.getptr(thread);
+			if (!waiting)
+				break;
+			thread = (*waiting)->thread;
+		}
+		if (thread == caller) {
+			return false;
+		}
+
+		if (!p_task->semaphore) {
+			p_task->semaphore = Semaphore::create();
+		}
+		p_task->waiters++;
+		p_task->users++;
+		thread_load_waiting[caller] = p_task;
+
+		thread_load_mutex->unlock();
+		p_task->semaphore->wait();
+		thread_load_mutex->lock();
+
+		thread_load_waiting.erase(caller);
+		p_task->users--;
+	}
+
+	return true;
+}
+
+void ResourceLoader::_cancel_thread_load(ThreadLoadTask *p_task) {
+
+	// Only tasks nobody needs anymore, the pool task may still hold a reference.
+	int pool_users = p_task->group_id != WorkerThreadPool::INVALID_GROUP_ID ? 1 : 0;
+	if (p_task->state != ThreadLoadTask::STATE_PENDING || p_task->requests > 0 || p_task->users > pool_users) {
+		return;
+	}
+
+	p_task->state = ThreadLoadTask::STATE_DONE;
+	p_task->error = ERR_SKIP;
+
+	for (int i = 0; i < p_task->dependencies.size(); i++) {
+		p_task->dependencies[i]->users--;
+		_cancel_thread_load(p_task->dependencies[i]);
+	}
+	p_task->dependencies.clear();
+}
+
+ResourceLoader::ThreadLoadTask *ResourceLoader::_find_pending_thread_load(ThreadLoadTask *p_task) {
+
+	for (int i = 0; i < p_task->dependencies.size(); i++) {
+		ThreadLoadTask *pending = _find_pending_thread_load(p_task->dependencies[i]);
+		if (pending) {
+			return pending;
+		}
+	}
+
+	return p_task->state == ThreadLoadTask::STATE_PENDING ? p_task : NULL;
+}
+
+void ResourceLoader::_cleanup_thread_loads() {
+
+	List<String> finished;
+
+	const String *K = NULL;
+	while ((K = thread_load_tasks.next(K))) {
+
+		ThreadLoadTask *task = thread_load_tasks[*K];
+
+		if (task->group_id != WorkerThreadPool::INVALID_GROUP_ID && task->state == ThreadLoadTask::STATE_DONE && WorkerThreadPool::get_singleton()->is_group_task_completed(task->group_id)) {
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(task->group_id);
+			task->group_id = WorkerThreadPool::INVALID_GROUP_ID;
+			task->users--;
+		}
+
+		if (task->state == ThreadLoadTask::STATE_DONE && task->requests == 0 && task->users == 0) {
+			finished.push_back(*K);
+		}
+	}
+
+	for (List<String>::Element *E = finished.front(); E; E = E->next()) {
+
+		ThreadLoadTask *task = thread_load_tasks[E->get()];
+		thread_load_tasks.erase(E->get());
+		_free_thread_load(task);
+	}
+
+	List<ThreadLoadTask *>::Element *E = thread_load_detached.front();
+	while (E) {
+
+		ThreadLoadTask *task = E->get();
+		List<ThreadLoadTask *>::Element *N = E->next();
+
+		if (task->group_id != WorkerThreadPool::INVALID_GROUP_ID && WorkerThreadPool::get_singleton()->is_group_task_completed(task->group_id)) {
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(task->group_id);
+			task->group_id = WorkerThreadPool::INVALID_GROUP_ID;
+			task->users--;
+		}
+
+		if (task->users == 0) {
+			thread_load_detached.erase(E);
+			_free_thread_load(task);
+		}
+
+		E = N;
+	}
+}
+
+void ResourceLoader::_free_thread_load(ThreadLoadTask *p_task) {
+
+	if (p_task->semaphore) {
+		memdelete(p_task->semaphore);
+	}
+	memdelete(p_task);
+}
+
+Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint) {
+
+	ERR_FAIL_COND_V(!thread_load_mutex, ERR_UNAVAILABLE);
+
+	String local_path = _get_local_path(p_path);
+
+	MutexLock lock(thread_load_mutex);
+
+	_cleanup_thread_loads();
+
+	ThreadLoadTask *task = _request_thread_load(local_path, p_type_hint, _can_load_on_threads());
+	task->requests++;
+
+	return OK;
+}
+
+ResourceLoader::ThreadLoadStatus ResourceLoader::load_threaded_get_status(const String &p_path, float *r_progress) {
+
+	if (r_progress)
+		*r_progress = 0;
+
+	if (!thread_load_mutex)
+		return THREAD_LOAD_INVALID_RESOURCE;
+
+	String local_path = _get_local_path(p_path);
+
+	MutexLock lock(thread_load_mutex);
+
+	_cleanup_thread_loads();
+
+	ThreadLoadTask **task_ptr = thread_load_tasks.getptr(local_path);
+	if (!task_ptr || (*task_ptr)->requests == 0) {
+		return THREAD_LOAD_INVALID_RESOURCE;
+	}
+	ThreadLoadTask *task = *task_ptr;
+
+	if (!_can_load_on_threads()) {
+		// Load a step at a time on this thread instead, like ResourceInteractiveLoader.
+		ThreadLoadTask *pending = _find_pending_thread_load(task);
+		if (pending) {
+			_run_thread_load(pending);
+		}
+	}
+
+	if (task->state == ThreadLoadTask::STATE_DONE) {
+		if (r_progress)
+			*r_progress = 1.0;
+		return task->resource.is_valid() ? THREAD_LOAD_LOADED : THREAD_LOAD_FAILED;
+	}
+
+	if (r_progress) {
+		int loaded = 0;
+		for (int i = 0; i < task->dependencies.size(); i++) {
+			if (task->dependencies[i]->state == ThreadLoadTask::STATE_DONE) {
+				loaded++;
+			}
+		}
+		*r_progress = float(loaded) / (task->dependencies.size() + 1);
+	}
+
+	return THREAD_LOAD_IN_PROGRESS;
+}
+
+RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
+
+	if (r_error)
+		*r_error = ERR_INVALID_PARAMETER;
+
+	ERR_FAIL_COND_V(!thread_load_mutex, RES());
+
+	String local_path = _get_local_path(p_path);
+
+	MutexLock lock(thread_load_mutex);
+
+	ThreadLoadTask **task_ptr = thread_load_tasks.getptr(local_path);
+	if (!task_ptr || (*task_ptr)->requests == 0) {
+		ERR_EXPLAIN("Resource: '" + local_path + "' was not requested with load_threaded_request().");
+		ERR_FAIL_V(RES());
+	}
+	ThreadLoadTask *task = *task_ptr;
+
+	if (!_wait_thread_load(task)) {
+		ERR_EXPLAIN("Resource: '" + local_path + "' is already being loaded. Cyclic reference?");
+		ERR_FAIL_V(RES());
+	}
+
+	RES res = task->resource;
+	if (r_error)
+		*r_error = task->error;
+
+	task->requests--;
+	_cleanup_thread_loads();
+
+	return res;
+}
+
+void ResourceLoader::load_threaded_cancel(const String &p_path) {
+
+	if (!thread_load_mutex)
+		return;
+
+	String local_path = _get_local_path(p_path);
+
+	MutexLock lock(thread_load_mutex);
+
+	ThreadLoadTask **task_ptr = thread_load_tasks.getptr(local_path);
+	ERR_FAIL_COND(!task_ptr || (*task_ptr)->requests == 0);
+
+	ThreadLoadTask *task = *task_ptr;
+	task->requests--;
+	_cancel_thread_load(task);
+
+	_cleanup_thread_loads();
+}
+
 bool ResourceLoader::exists(const String &p_path, const String &p_type_hint) {
 
 	String local_path;
@@ -972,13 +1399,67 @@ void ResourceLoader::remove_custom_loaders() {
 Mutex *ResourceLoader::loading_map_mutex = NULL;
 HashMap<ResourceLoader::LoadingMapKey, int, ResourceLoader::LoadingMapKeyHasher> ResourceLoader::loading_map;
 
+Mutex *ResourceLoader::thread_load_mutex = NULL;
+HashMap<String, ResourceLoader::ThreadLoadTask *> ResourceLoader::thread_load_tasks;
+List<ResourceLoader::ThreadLoadTask *> ResourceLoader::thread_load_detached;
+HashMap<Thread::ID, ResourceLoader::ThreadLoadTask *> ResourceLoader::thread_load_waiting;
+
 void ResourceLoader::initialize() {
 #ifndef NO_THREADS
 	loading_map_mutex = Mutex::create();
 #endif
+	thread_load_mutex = Mutex::create();
 }
 
 void ResourceLoader::finalize() {
+
+	if (thread_load_mutex) {
+		thread_load_mutex->lock();
+
+		// Nothing can be requested anymore, drop the requests and let the pool finish.
+		const String *K = NULL;
+		while ((K = thread_load_tasks.next(K))) {
+			thread_load_tasks[*K]->requests = 0;
+		}
+
+		K = NULL;
+		while ((K = thread_load_tasks.next(K))) {
+			ThreadLoadTask *task = thread_load_tasks[*K];
+			_cancel_thread_load(task);
+			if (task->group_id != WorkerThreadPool::INVALID_GROUP_ID) {
+				WorkerThreadPool::GroupID group_id = task->group_id;
+				task->group_id = WorkerThreadPool::INVALID_GROUP_ID;
+				task->users--;
+				thread_load_mutex->unlock();
+				WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+				thread_load_mutex->lock();
+			}
+		}
+
+		for (List<ThreadLoadTask *>::Element *E = thread_load_detached.front(); E; E = E->next()) {
+			ThreadLoadTask *task = E->get();
+			if (task->group_id != WorkerThreadPool::INVALID_GROUP_ID) {
+				WorkerThreadPool::GroupID group_id = task->group_id;
+				task->group_id = WorkerThreadPool::INVALID_GROUP_ID;
+				thread_load_mutex->unlock();
+				WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+				thread_load_mutex->lock();
+			}
+			_free_thread_load(task);
+		}
+		thread_load_detached.clear();
+
+		K = NULL;
+		while ((K = thread_load_tasks.next(K))) {
+			_free_thread_load(thread_load_tasks[*K]);
+		}
+		thread_load_tasks.clear();
+
+		thread_load_mutex->unlock();
+		memdelete(thread_load_mutex);
+		thread_load_mutex = NULL;
+	}
+
 #ifndef NO_THREADS
 	const LoadingMapKey *K = NULL;
 	while ((K = loading_map.next(K))) {
@@ -31,7 +31,9 @@
 #ifndef RESOURCE_LOADER_H
 #define RESOURCE_LOADER_H
 
+#include "core/os/semaphore.h"
 #include "core/os/thread.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/resource.h"
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
@@ -97,6 +99,15 @@ class ResourceLoader {
 		MAX_LOADERS = 64
 	};
 
+public:
+	enum ThreadLoadStatus {
+		THREAD_LOAD_INVALID_RESOURCE,
+		THREAD_LOAD_IN_PROGRESS,
+		THREAD_LOAD_FAILED,
+		THREAD_LOAD_LOADED
+	};
+
+private:
 	static Ref<ResourceFormatLoader> loader[MAX_LOADERS];
 	static int loader_count;
 	static bool timestamp_on_load;
@@ -143,11 +154,71 @@ class ResourceLoader {
 	static void _remove_from_loading_map(const String &p_path);
 	static void _remove_from_loading_map_and_thread(const String &p_path, Thread::ID p_thread);
 
+	//background loads, one task per path, each with tasks for its dependencies
+	struct ThreadLoadTask {
+
+		enum State {
+			STATE_PENDING,
+			STATE_RUNNING,
+			STATE_DONE
+		};
+
+		String local_path;
+		String type_hint;
+		State state;
+		Thread::ID thread; //the one running the load
+		Error error;
+		RES resource;
+		Vector<ThreadLoadTask *> dependencies; //released once loaded
+		bool requesting; //dependencies are being requested
+
+		WorkerThreadPool::GroupID group_id;
+		int requests; //load_threaded_request() calls not yet matched by a get or cancel
+		int users; //dependents, waiting threads and the pool task keep it alive too
+
+		Semaphore *semaphore;
+		int waiters;
+
+		ThreadLoadTask() {
+			state = STATE_PENDING;
+			thread = 0;
+			error = OK;
+			requesting = false;
+			group_id = WorkerThreadPool::INVALID_GROUP_ID;
+			requests = 0;
+			users = 0;
+			semaphore = NULL;
+			waiters = 0;
+		}
+	};
+
+	static Mutex *thread_load_mutex;
+	static HashMap<String, ThreadLoadTask *> thread_load_tasks;
+	static List<ThreadLoadTask *> thread_load_detached; //failed or cancelled, still in use
+	static HashMap<Thread::ID, ThreadLoadTask *> thread_load_waiting;
+
+	static ThreadLoadTask *_request_thread_load(const String &p_local_path, const String &p_type_hint, bool p_use_pool);
+	static void _thread_load_function(void *p_userdata, uint32_t p_index);
+	static void _run_thread_load(ThreadLoadTask *p_task);
+	static bool _wait_thread_load(ThreadLoadTask *p_task);
+	static void _cancel_thread_load(ThreadLoadTask *p_task);
+	static ThreadLoadTask *_find_pending_thread_load(ThreadLoadTask *p_task);
+	static void _cleanup_thread_loads();
+	static void _free_thread_load(ThreadLoadTask *p_task);
+	static bool _can_load_on_threads();
+
+	static String _get_local_path(const String &p_path);
+
 public:
 	static Ref<ResourceInteractiveLoader> load_interactive(const String &p_path, const String &p_type_hint = "", bool p_no_cache = false, Error *r_error = NULL);
 	static RES load(const String &p_path, const String &p_type_hint = "", bool p_no_cache = false, Error *r_error = NULL);
 	static bool exists(const String &p_path, const String &p_type_hint = "");
 
+	static Error load_threaded_request(const String &p_path, const String &p_type_hint = "");
+	static ThreadLoadStatus load_threaded_get_status(const String &p_path, float *r_progress = NULL);
+	static RES load_threaded_get(const String &p_path, Error *r_error = NULL);
+	static void load_threaded_cancel(const String &p_path);
+
 	static void get_recognized_extensions_for_type(const String &p_type, List<String> *p_extensions);
 	static void add_resource_format_loader(Ref<ResourceFormatLoader> p_format_loader, bool p_at_front = false);
 	static void remove_resource_format_loader(Ref<ResourceFormatLoader> p_format_loader);
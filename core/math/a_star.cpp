@@ -36,11 +36,16 @@
 
 int AStar::get_available_point_id() const {
 
-	if (points.empty()) {
+	if (points.get_num_elements() == 0) {
 		return 1;
 	}
 
-	return points.back()->key() + 1;
+	// Ids are handed out in increasing order, so only probe past the last one given.
+	while (points.has(last_free_id)) {
+		last_free_id++;
+	}
+
+	return last_free_id;
 }
 
 void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
@@ -48,81 +53,111 @@ void AStar::add_point(int p_id, const Vector3 &p_pos, real_t p_weight_scale) {
 	ERR_FAIL_COND(p_id < 0);
 	ERR_FAIL_COND(p_weight_scale < 1);
 
-	if (!points.has(p_id)) {
+	Point *found_pt;
+	bool p_exists = points.lookup(p_id, found_pt);
+
+	if (!p_exists) {
 		Point *pt = memnew(Point);
 		pt->id = p_id;
 		pt->pos = p_pos;
 		pt->weight_scale = p_weight_scale;
 		pt->prev_point = NULL;
-		pt->last_pass = 0;
-		points[p_id] = pt;
+		pt->g_score = 0;
+		pt->open_pass = 0;
+		pt->closed_pass = 0;
+		points.set(p_id, pt);
 	} else {
-		points[p_id]->pos = p_pos;
-		points[p_id]->weight_scale = p_weight_scale;
+		found_pt->pos = p_pos;
+		found_pt->weight_scale = p_weight_scale;
 	}
 }
 
 Vector3 AStar::get_point_position(int p_id) const {
 
-	ERR_FAIL_COND_V(!points.has(p_id), Vector3());
+	Point *p;
+	bool p_exists = points.lookup(p_id, p);
+	ERR_FAIL_COND_V(!p_exists, Vector3());
 
-	return points[p_id]->pos;
+	return p->pos;
 }
 
 void AStar::set_point_position(int p_id, const Vector3 &p_pos) {
 
-	ERR_FAIL_COND(!points.has(p_id));
+	Point *p;
+	bool p_exists = points.lookup(p_id, p);
+	ERR_FAIL_COND(!p_exists);
 
-	points[p_id]->pos = p_pos;
+	p->pos = p_pos;
 }
 
 real_t AStar::get_point_weight_scale(int p_id) const {
 
-	ERR_FAIL_COND_V(!points.has(p_id), 0);
+	Point *p;
+	bool p_exists = points.lookup(p_id, p);
+	ERR_FAIL_COND_V(!p_exists, 0);
 
-	return points[p_id]->weight_scale;
+	return p->weight_scale;
 }
 
 void AStar::set_point_weight_scale(int p_id, real_t p_weight_scale) {
 
-	ERR_FAIL_COND(!points.has(p_id));
+	Point *p;
+	bool p_exists = points.lookup(p_id, p);
+	ERR_FAIL_COND(!p_exists);
 	ERR_FAIL_COND(p_weight_scale < 1);
 
-	points[p_id]->weight_scale = p_weight_scale;
+	p->weight_scale = p_weight_scale;
 }
 
 void AStar::remove_point(int p_id) {
 
-	ERR_FAIL_COND(!points.has(p_id));
+	Point *p;
+	bool p_exists = points.lookup(p_id, p);
+	ERR_FAIL_COND(!p_exists);
 
-	Point *p = points[p_id];
+	for (int i = 0; i < p->neighbours.size(); i++) {
 
-	Map<int, Point *>::Element *PE = points.front();
-	while (PE) {
-		for (Set<Point *>::Element *E = PE->get()->neighbours.front(); E; E = E->next()) {
-			Segment s(p_id, E->get()->id);
-			segments.erase(s);
-			E->get()->neighbours.erase(p);
-		}
-		PE = PE->next();
+		Point *n = p->neighbours[i];
+		segments.erase(Segment(p_id, n->id));
+		n->incoming.erase(p);
+	}
+
+	for (int i = 0; i < p->incoming.size(); i++) {
+
+		Point *n = p->incoming[i];
+		segments.erase(Segment(p_id, n->id));
+		n->neighbours.erase(p);
 	}
 
 	memdelete(p);
-	points.erase(p_id);
+	points.remove(p_id);
+
+	if (p_id < last_free_id) {
+		last_free_id = p_id;
+	}
 }
 
 void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 
-	ERR_FAIL_COND(!points.has(p_id));
-	ERR_FAIL_COND(!points.has(p_with_id));
 	ERR_FAIL_COND(p_id == p_with_id);
 
-	Point *a = points[p_id];
-	Point *b = points[p_with_id];
-	a->neighbours.insert(b);
+	Point *a;
+	bool from_exists = points.lookup(p_id, a);
+	ERR_FAIL_COND(!from_exists);
 
-	if (bidirectional)
-		b->neighbours.insert(a);
+	Point *b;
+	bool to_exists = points.lookup(p_with_id, b);
+	ERR_FAIL_COND(!to_exists);
+
+	if (a->neighbours.find(b) == -1) {
+		a->neighbours.push_back(b);
+		b->incoming.push_back(a);
+	}
+
+	if (bidirectional && b->neighbours.find(a) == -1) {
+		b->neighbours.push_back(a);
+		a->incoming.push_back(b);
+	}
 
 	Segment s(p_id, p_with_id);
 	if (s.from == p_id) {
@@ -135,6 +170,7 @@ void AStar::connect_points(int p_id, int p_with_id, bool bidirectional) {
 
 	segments.insert(s);
 }
+
 void AStar::disconnect_points(int p_id, int p_with_id) {
 
 	Segment s(p_id, p_with_id);
@@ -142,10 +178,15 @@ void AStar::disconnect_points(int p_id, int p_with_id) {
 
 	segments.erase(s);
 
-	Point *a = points[p_id];
-	Point *b = points[p_with_id];
+	Point *a;
+	points.lookup(p_id, a);
+	Point *b;
+	points.lookup(p_with_id, b);
+
 	a->neighbours.erase(b);
+	b->incoming.erase(a);
 	b->neighbours.erase(a);
+	a->incoming.erase(b);
 }
 
 bool AStar::has_point(int p_id) const {
@@ -157,8 +198,8 @@ Array AStar::get_points() {
 
 	Array point_list;
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
-		point_list.push_back(E->key());
+	for (OAHashMap<int, Point *>::Iterator it = points.iter(); it.valid; it = points.next_iter(it)) {
+		point_list.push_back(*(it.key));
 	}
 
 	return point_list;
@@ -166,14 +207,18 @@ Array AStar::get_points() {
 
 PoolVector<int> AStar::get_point_connections(int p_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_id), PoolVector<int>());
+	Point *p;
+	bool p_exists = points.lookup(p_id, p);
+	ERR_FAIL_COND_V(!p_exists, PoolVector<int>());
 
 	PoolVector<int> point_list;
+	point_list.resize(p->neighbours.size());
 
-	Point *p = points[p_id];
-
-	for (Set<Point *>::Element *E = p->neighbours.front(); E; E = E->next()) {
-		point_list.push_back(E->get()->id);
+	{
+		PoolVector<int>::Write w = point_list.write();
+		for (int i = 0; i < p->neighbours.size(); i++) {
+			w[i] = p->neighbours[i]->id;
+		}
 	}
 
 	return point_list;
@@ -187,12 +232,14 @@ bool AStar::are_points_connected(int p_id, int p_with_id) const {
 
 void AStar::clear() {
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
-
-		memdelete(E->get());
+	last_free_id = 1;
+	for (OAHashMap<int, Point *>::Iterator it = points.iter(); it.valid; it = points.next_iter(it)) {
+		memdelete(*(it.value));
 	}
 	segments.clear();
 	points.clear();
+	open_list.resize(0);
+	open_count = 0;
 }
 
 int AStar::get_closest_point(const Vector3 &p_point) const {
@@ -200,12 +247,12 @@ int AStar::get_closest_point(const Vector3 &p_point) const {
 	int closest_id = -1;
 	real_t closest_dist = 1e20;
 
-	for (const Map<int, Point *>::Element *E = points.front(); E; E = E->next()) {
+	for (OAHashMap<int, Point *>::Iterator it = points.iter(); it.valid; it = points.next_iter(it)) {
 
-		real_t d = p_point.distance_squared_to(E->get()->pos);
+		real_t d = p_point.distance_squared_to((*it.value)->pos);
 		if (closest_id < 0 || d < closest_dist) {
 			closest_dist = d;
-			closest_id = E->key();
+			closest_id = *(it.key);
 		}
 	}
 
@@ -238,83 +285,79 @@ Vector3 AStar::get_closest_position_in_segment(const Vector3 &p_point) const {
 	return closest_point;
 }
 
-bool AStar::_solve(Point *begin_point, Point *end_point) {
+void AStar::_open_push(Point *p_point, real_t p_f_score) {
 
-	pass++;
+	if (open_count == open_list.size()) {
+		open_list.resize(MAX(open_count * 2, 64));
+	}
 
-	SelfList<Point>::List open_list;
+	OpenPoint op;
+	op.f_score = p_f_score;
+	op.g_score = p_point->g_score;
+	op.point = p_point;
 
-	bool found_route = false;
-
-	for (Set<Point *>::Element *E = begin_point->neighbours.front(); E; E = E->next()) {
+	SortArray<OpenPoint, SortOpenPoints> sorter;
+	sorter.push_heap(0, open_count, 0, op, open_list.ptrw());
+	open_count++;
+}
 
-		Point *n = E->get();
-		n->prev_point = begin_point;
-		n->distance = _compute_cost(begin_point->id, n->id) * n->weight_scale;
-		n->last_pass = pass;
-		open_list.add(&n->list);
-	}
+bool AStar::_solve(Point *begin_point, Point *end_point) {
 
-	while (true) {
+	pass++;
+	open_count = 0;
 
-		if (open_list.first() == NULL) {
-			// No path found
-			break;
-		}
-		// Check open list
+	bool found_route = false;
 
-		SelfList<Point> *least_cost_point = open_list.first();
-		real_t least_cost = Math_INF;
+	begin_point->prev_point = NULL;
+	begin_point->g_score = 0;
+	begin_point->open_pass = pass;
+	_open_push(begin_point, _estimate_cost(begin_point->id, end_point->id));
 
-		// TODO: Cache previous results
-		for (SelfList<Point> *E = open_list.first(); E; E = E->next()) {
+	SortArray<OpenPoint, SortOpenPoints> sorter;
+	OpenPoint *heap = open_list.ptrw();
 
-			Point *p = E->self();
+	while (open_count > 0) {
 
-			real_t cost = p->distance;
-			cost += _estimate_cost(p->id, end_point->id);
+		// Move the best open point to the back and take it off the heap.
+		sorter.pop_heap(0, open_count, heap);
+		open_count--;
+		OpenPoint least = heap[open_count];
+		Point *p = least.point;
 
-			if (cost < least_cost) {
-				least_cost_point = E;
-				least_cost = cost;
-			}
+		// A point is pushed again each time a cheaper route to it is found,
+		// so entries that were superseded or already expanded are skipped here.
+		if (p->closed_pass == pass || least.g_score > p->g_score) {
+			continue;
 		}
 
-		Point *p = least_cost_point->self();
 		if (p == end_point) {
 			found_route = true;
 			break;
 		}
 
-		for (Set<Point *>::Element *E = p->neighbours.front(); E; E = E->next()) {
+		p->closed_pass = pass;
 
-			Point *e = E->get();
+		for (int i = 0; i < p->neighbours.size(); i++) {
 
-			real_t distance = _compute_cost(p->id, e->id) * e->weight_scale + p->distance;
+			Point *e = p->neighbours[i];
 
-			if (e->last_pass == pass) {
-				// Already visited, is this cheaper?
+			if (e->closed_pass == pass) {
+				continue;
+			}
 
-				if (e->distance > distance) {
-					e->prev_point = p;
-					e->distance = distance;
-				}
-			} else {
-				// Add to open neighbours
+			real_t g_score = p->g_score + _compute_cost(p->id, e->id) * e->weight_scale;
 
-				e->prev_point = p;
-				e->distance = distance;
-				e->last_pass = pass; // Mark as used
-				open_list.add(&e->list);
+			if (e->open_pass == pass && g_score >= e->g_score) {
+				// Already reached through a route that is not more expensive.
+				continue;
 			}
-		}
 
-		open_list.remove(least_cost_point);
-	}
-
-	// Clear the openf list
-	while (open_list.first()) {
-		open_list.remove(open_list.first());
+			e->prev_point = p;
+			e->g_score = g_score;
+			e->open_pass = pass;
+			_open_push(e, g_score + _estimate_cost(e->id, end_point->id));
+			heap = open_list.ptrw();
+		}
 	}
 
 	return found_route;
@@ -325,7 +368,15 @@ float AStar::_estimate_cost(int p_from_id, int p_to_id) {
 	if (get_script_instance() && get_script_instance()->has_method(SceneStringNames::get_singleton()->_estimate_cost))
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_estimate_cost, p_from_id, p_to_id);
 
-	return points[p_from_id]->pos.distance_to(points[p_to_id]->pos);
+	Point *from_point;
+	bool from_exists = points.lookup(p_from_id, from_point);
+	ERR_FAIL_COND_V(!from_exists, 0);
+
+	Point *to_point;
+	bool to_exists = points.lookup(p_to_id, to_point);
+	ERR_FAIL_COND_V(!to_exists, 0);
+
+	return from_point->pos.distance_to(to_point->pos);
 }
 
 float AStar::_compute_cost(int p_from_id, int p_to_id) {
@@ -333,18 +384,26 @@ float AStar::_compute_cost(int p_from_id, int p_to_id) {
 	if (get_script_instance() && get_script_instance()->has_method(SceneStringNames::get_singleton()->_compute_cost))
 		return get_script_instance()->call(SceneStringNames::get_singleton()->_compute_cost, p_from_id, p_to_id);
 
-	return points[p_from_id]->pos.distance_to(points[p_to_id]->pos);
+	Point *from_point;
+	bool from_exists = points.lookup(p_from_id, from_point);
+	ERR_FAIL_COND_V(!from_exists, 0);
+
+	Point *to_point;
+	bool to_exists = points.lookup(p_to_id, to_point);
+	ERR_FAIL_COND_V(!to_exists, 0);
+
+	return from_point->pos.distance_to(to_point->pos);
 }
 
 PoolVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_from_id), PoolVector<Vector3>());
-	ERR_FAIL_COND_V(!points.has(p_to_id), PoolVector<Vector3>());
-
-	pass++;
+	Point *a;
+	bool from_exists = points.lookup(p_from_id, a);
+	ERR_FAIL_COND_V(!from_exists, PoolVector<Vector3>());
 
-	Point *a = points[p_from_id];
-	Point *b = points[p_to_id];
+	Point *b;
+	bool to_exists = points.lookup(p_to_id, b);
+	ERR_FAIL_COND_V(!to_exists, PoolVector<Vector3>());
 
 	if (a == b) {
 		PoolVector<Vector3> ret;
@@ -389,13 +448,13 @@ PoolVector<Vector3> AStar::get_point_path(int p_from_id, int p_to_id) {
 
 PoolVector<int> AStar::get_id_path(int p_from_id, int p_to_id) {
 
-	ERR_FAIL_COND_V(!points.has(p_from_id), PoolVector<int>());
-	ERR_FAIL_COND_V(!points.has(p_to_id), PoolVector<int>());
-
-	pass++;
+	Point *a;
+	bool from_exists = points.lookup(p_from_id, a);
+	ERR_FAIL_COND_V(!from_exists, PoolVector<int>());
 
-	Point *a = points[p_from_id];
-	Point *b = points[p_to_id];
+	Point *b;
+	bool to_exists = points.lookup(p_to_id, b);
+	ERR_FAIL_COND_V(!to_exists, PoolVector<int>());
 
 	if (a == b) {
 		PoolVector<int> ret;
@@ -471,6 +530,8 @@ void AStar::_bind_methods() {
 AStar::AStar() {
 
 	pass = 1;
+	last_free_id = 1;
+	open_count = 0;
 }
 
 AStar::~AStar() {
@@ -31,8 +31,8 @@
 #ifndef ASTAR_H
 #define ASTAR_H
 
+#include "core/oa_hash_map.h"
 #include "core/reference.h"
-#include "core/self_list.h"
 
 /**
 	A* pathfinding algorithm
@@ -44,28 +44,49 @@ class AStar : public Reference {
 
 	GDCLASS(AStar, Reference)
 
-	uint64_t pass;
-
 	struct Point {
 
-		SelfList<Point> list;
-
 		int id;
 		Vector3 pos;
 		real_t weight_scale;
-		uint64_t last_pass;
 
-		Set<Point *> neighbours;
+		// Points this one connects to, and points connecting to this one.
+		Vector<Point *> neighbours;
+		Vector<Point *> incoming;
 
-		// Used for pathfinding
+		// Used for pathfinding. A point belongs to the current search only when
+		// its pass matches, so nothing has to be cleared between searches.
 		Point *prev_point;
-		real_t distance;
+		real_t g_score;
+		uint64_t open_pass;
+		uint64_t closed_pass;
+	};
 
-		Point() :
-				list(this) {}
+	struct OpenPoint {
+
+		real_t f_score;
+		real_t g_score;
+		Point *point;
 	};
 
-	Map<int, Point *> points;
+	struct SortOpenPoints {
+
+		// Returns true when A is worse than B, so the heap keeps the best point on top.
+		_FORCE_INLINE_ bool operator()(const OpenPoint &A, const OpenPoint &B) const {
+
+			if (A.f_score > B.f_score)
+				return true;
+			else if (A.f_score < B.f_score)
+				return false;
+			else
+				return A.g_score < B.g_score; // on a tie, prefer the point further from the start
+		}
+	};
+
+	uint64_t pass;
+	mutable int last_free_id;
+
+	OAHashMap<int, Point *> points;
 
 	struct Segment {
 		union {
@@ -93,6 +114,11 @@ class AStar : public Reference {
 
 	Set<Segment> segments;
 
+	// Binary heap of open points, kept between searches to avoid reallocating it.
+	Vector<OpenPoint> open_list;
+	int open_count;
+
+	_FORCE_INLINE_ void _open_push(Point *p_point, real_t p_f_score);
 	bool _solve(Point *begin_point, Point *end_point);
 
 protected:
@@ -0,0 +1,707 @@
+/*************************************************************************/
+/*  bvh.h                                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BVH_H
+#define BVH_H
+
+#include "core/hash_map.h"
+#include "core/math/aabb.h"
+#include "core/math/plane.h"
+#include "core/vector.h"
+
+typedef uint32_t BVHElementID;
+
+/**
+ * Dynamic AABB tree with the same pairing model as Octree<T, true>: elements pair when their
+ * AABBs touch, at least one of them is pairable and either one's type matches the other's mask.
+ *
+ * Pairable and non pairable elements live in separate trees, so moving a non pairable element
+ * only has to look at the (usually much smaller) pairable tree. Leaves keep a fattened AABB;
+ * moves inside it don't touch the tree, small moves out of it refit the parents in place and
+ * only large jumps reinsert the leaf. Culling only reads the trees, so it can run from several
+ * threads at once as long as nothing is moved meanwhile.
+ */
+template <class T>
+class BVH {
+public:
+	typedef void *(*PairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int);
+	typedef void (*UnpairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int, void *);
+
+private:
+	enum {
+		NODE_NULL = -1,
+		STACK_MAX = 128,
+		TREE_NORMAL = 0,
+		TREE_PAIRABLE = 1,
+		TREE_MAX = 2
+	};
+
+	struct Node {
+
+		int parent;
+		int children[2];
+		int height;
+		BVHElementID element; // 0 for internal nodes
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == NODE_NULL; }
+	};
+
+	// Node topology and bounds are kept in separate arrays, culling mostly touches the bounds.
+	struct Tree {
+
+		Vector<AABB> aabbs;
+		Vector<Node> nodes;
+		Vector<int> free_nodes;
+		int root;
+
+		static _FORCE_INLINE_ real_t _get_surface(const AABB &p_aabb) {
+			const Vector3 &s = p_aabb.size;
+			return s.x * s.y + s.y * s.z + s.z * s.x;
+		}
+
+		int alloc_node() {
+
+			int idx;
+			if (free_nodes.size()) {
+				idx = free_nodes[free_nodes.size() - 1];
+				free_nodes.resize(free_nodes.size() - 1);
+			} else {
+				idx = nodes.size();
+				nodes.resize(idx + 1);
+				aabbs.resize(idx + 1);
+			}
+
+			Node &n = nodes.write[idx];
+			n.parent = NODE_NULL;
+			n.children[0] = NODE_NULL;
+			n.children[1] = NODE_NULL;
+			n.height = 0;
+			n.element = 0;
+			return idx;
+		}
+
+		void free_node(int p_node) {
+
+			free_nodes.push_back(p_node);
+		}
+
+		void insert_leaf(int p_leaf) {
+
+			if (root == NODE_NULL) {
+				root = p_leaf;
+				nodes.write[root].parent = NODE_NULL;
+				return;
+			}
+
+			Node *n = nodes.ptrw();
+			const AABB *b = aabbs.ptr();
+			const AABB leaf_aabb = b[p_leaf];
+
+			// descend to the sibling that grows the tree surface the least
+			int index = root;
+			while (!n[index].is_leaf()) {
+
+				real_t surface = _get_surface(b[index]);
+				real_t combined_surface = _get_surface(b[index].merge(leaf_aabb));
+
+				real_t cost = 2.0 * combined_surface;
+				real_t inheritance_cost = 2.0 * (combined_surface - surface);
+
+				real_t child_cost[2];
+				for (int i = 0; i < 2; i++) {
+					int child = n[index].children[i];
+					real_t merged = _get_surface(b[child].merge(leaf_aabb));
+					child_cost[i] = (n[child].is_leaf() ? merged : merged - _get_surface(b[child])) + inheritance_cost;
+				}
+
+				if (cost < child_cost[0] && cost < child_cost[1])
+					break;
+
+				index = child_cost[0] < child_cost[1] ? n[index].children[0] : n[index].children[1];
+			}
+
+			int sibling = index;
+			int new_parent = alloc_node();
+			n = nodes.ptrw();
+
+			int old_parent = n[sibling].parent;
+			n[new_parent].parent = old_parent;
+			n[new_parent].height = n[sibling].height + 1;
+			n[new_parent].children[0] = sibling;
+			n[new_parent].children[1] = p_leaf;
+			aabbs.write[new_parent] = leaf_aabb.merge(aabbs[sibling]);
+			n[sibling].parent = new_parent;
+			n[p_leaf].parent = new_parent;
+
+			if (old_parent != NODE_NULL) {
+				if (n[old_parent].children[0] == sibling) {
+					n[old_parent].children[0] = new_parent;
+				} else {
+					n[old_parent].children[1] = new_parent;
+				}
+			} else {
+				root = new_parent;
+			}
+
+			refit(new_parent);
+		}
+
+		void remove_leaf(int p_leaf) {
+
+			if (p_leaf == root) {
+				root = NODE_NULL;
+				return;
+			}
+
+			Node *n = nodes.ptrw();
+
+			int parent = n[p_leaf].parent;
+			int grand_parent = n[parent].parent;
+			int sibling = n[parent].children[0] == p_leaf ? n[parent].children[1] : n[parent].children[0];
+
+			if (grand_parent != NODE_NULL) {
+				if (n[grand_parent].children[0] == parent) {
+					n[grand_parent].children[0] = sibling;
+				} else {
+					n[grand_parent].children[1] = sibling;
+				}
+				n[sibling].parent = grand_parent;
+				free_node(parent);
+				refit(grand_parent);
+			} else {
+				root = sibling;
+				n[sibling].parent = NODE_NULL;
+				free_node(parent);
+			}
+
+			n[p_leaf].parent = NODE_NULL;
+		}
+
+		// rotates the taller grandchild up when the children heights differ by more than one
+		int balance(int p_node) {
+
+			Node *n = nodes.ptrw();
+			AABB *b = aabbs.ptrw();
+			Node *a = &n[p_node];
+
+			if (a->is_leaf() || a->height < 2)
+				return p_node;
+
+			for (int side = 0; side < 2; side++) {
+
+				int i_up = a->children[side ^ 1];
+				int i_other = a->children[side];
+				Node *up = &n[i_up];
+
+				if (up->height - n[i_other].height <= 1)
+					continue;
+
+				int i_f = up->children[0];
+				int i_g = up->children[1];
+
+				up->children[0] = p_node;
+				up->parent = a->parent;
+				a->parent = i_up;
+
+				if (up->parent != NODE_NULL) {
+					if (n[up->parent].children[0] == p_node) {
+						n[up->parent].children[0] = i_up;
+					} else {
+						n[up->parent].children[1] = i_up;
+					}
+				} else {
+					root = i_up;
+				}
+
+				// the taller grandchild stays with the node moving up, the other one goes down
+				int i_keep = n[i_f].height > n[i_g].height ? i_f : i_g;
+				int i_give = i_keep == i_f ? i_g : i_f;
+
+				up->children[1] = i_keep;
+				a->children[side ^ 1] = i_give;
+				n[i_give].parent = p_node;
+
+				b[p_node] = b[i_other].merge(b[i_give]);
+				b[i_up] = b[p_node].merge(b[i_keep]);
+				a->height = 1 + MAX(n[i_other].height, n[i_give].height);
+				up->height = 1 + MAX(a->height, n[i_keep].height);
+
+				return i_up;
+			}
+
+			return p_node;
+		}
+
+		void refit(int p_node) {
+
+			int index = p_node;
+			while (index != NODE_NULL) {
+
+				index = balance(index);
+
+				Node *n = nodes.ptrw();
+				int c0 = n[index].children[0];
+				int c1 = n[index].children[1];
+
+				n[index].height = 1 + MAX(n[c0].height, n[c1].height);
+				aabbs.write[index] = aabbs[c0].merge(aabbs[c1]);
+
+				index = n[index].parent;
+			}
+		}
+
+		// recomputes bounds up from p_node without restructuring, stops once a node is unchanged
+		void refit_bounds(int p_node) {
+
+			const Node *n = nodes.ptr();
+			AABB *b = aabbs.ptrw();
+
+			for (int i = p_node; i != NODE_NULL; i = n[i].parent) {
+
+				AABB aabb = b[n[i].children[0]].merge(b[n[i].children[1]]);
+				if (aabb == b[i])
+					break;
+				b[i] = aabb;
+			}
+		}
+
+		// p_test(aabb) decides whether to descend, p_leaf(element) returns false to stop
+		template <class Test, class Leaf>
+		void query(const Test &p_test, Leaf &p_leaf) const {
+
+			if (root == NODE_NULL)
+				return;
+
+			const Node *n = nodes.ptr();
+			const AABB *b = aabbs.ptr();
+
+			int stack[STACK_MAX];
+			int stack_size = 0;
+			stack[stack_size++] = root;
+
+			while (stack_size) {
+
+				int index = stack[--stack_size];
+				if (!p_test(b[index]))
+					continue;
+
+				if (n[index].is_leaf()) {
+					if (!p_leaf(n[index].element))
+						return;
+				} else {
+					ERR_FAIL_COND(stack_size + 2 > STACK_MAX);
+					stack[stack_size++] = n[index].children[0];
+					stack[stack_size++] = n[index].children[1];
+				}
+			}
+		}
+
+		Tree() { root = NODE_NULL; }
+	};
+
+	struct Element {
+
+		T *userdata; // NULL while unused
+		int subindex;
+		bool pairable;
+		uint32_t pairable_type;
+		uint32_t pairable_mask;
+		AABB aabb;
+		int tree;
+		int leaf;
+		Vector<BVHElementID> pairs;
+	};
+
+	Tree trees[TREE_MAX];
+
+	Vector<Element> elements;
+	Vector<BVHElementID> free_elements;
+
+	HashMap<uint64_t, void *> pair_map;
+	int element_count;
+
+	PairCallback pair_callback;
+	UnpairCallback unpair_callback;
+	void *pair_callback_userdata;
+	void *unpair_callback_userdata;
+
+	static _FORCE_INLINE_ uint64_t _get_pair_key(BVHElementID p_a, BVHElementID p_b) {
+		return p_a < p_b ? (uint64_t(p_a) << 32) | p_b : (uint64_t(p_b) << 32) | p_a;
+	}
+
+	static _FORCE_INLINE_ AABB _fatten(const AABB &p_aabb) {
+		return p_aabb.grow(p_aabb.get_longest_axis_size() * 0.1);
+	}
+
+	static _FORCE_INLINE_ bool _can_pair(const Element &p_a, const Element &p_b) {
+
+		if (p_a.userdata == p_b.userdata)
+			return false;
+		if (!p_a.pairable && !p_b.pairable)
+			return false;
+		return (p_a.pairable_type & p_b.pairable_mask) || (p_b.pairable_type & p_a.pairable_mask);
+	}
+
+	_FORCE_INLINE_ Element &_get_element(BVHElementID p_id) { return elements.write[p_id - 1]; }
+
+	void _insert(BVHElementID p_id) {
+
+		Element &e = _get_element(p_id);
+		Tree &tree = trees[e.tree];
+		e.leaf = tree.alloc_node();
+		tree.nodes.write[e.leaf].element = p_id;
+		tree.aabbs.write[e.leaf] = _fatten(e.aabb);
+		tree.insert_leaf(e.leaf);
+	}
+
+	void _remove(BVHElementID p_id) {
+
+		Element &e = _get_element(p_id);
+		Tree &tree = trees[e.tree];
+		tree.remove_leaf(e.leaf);
+		tree.free_node(e.leaf);
+		e.leaf = NODE_NULL;
+	}
+
+	void _pair(BVHElementID p_a, BVHElementID p_b) {
+
+		Element &a = _get_element(p_a);
+		Element &b = _get_element(p_b);
+
+		void *ud = NULL;
+		if (pair_callback)
+			ud = pair_callback(pair_callback_userdata, p_a, a.userdata, a.subindex, p_b, b.userdata, b.subindex);
+
+		pair_map.set(_get_pair_key(p_a, p_b), ud);
+		a.pairs.push_back(p_b);
+		b.pairs.push_back(p_a);
+	}
+
+	void _unpair(BVHElementID p_a, BVHElementID p_b) {
+
+		Element &a = _get_element(p_a);
+		Element &b = _get_element(p_b);
+
+		uint64_t key = _get_pair_key(p_a, p_b);
+		void **ud = pair_map.getptr(key);
+		ERR_FAIL_COND(!ud);
+
+		if (unpair_callback)
+			unpair_callback(unpair_callback_userdata, p_a, a.userdata, a.subindex, p_b, b.userdata, b.subindex, *ud);
+
+		pair_map.erase(key);
+
+		// order of pairs doesn't matter, so swap with the last one
+		int idx = a.pairs.find(p_b);
+		a.pairs.write[idx] = a.pairs[a.pairs.size() - 1];
+		a.pairs.resize(a.pairs.size() - 1);
+
+		idx = b.pairs.find(p_a);
+		b.pairs.write[idx] = b.pairs[b.pairs.size() - 1];
+		b.pairs.resize(b.pairs.size() - 1);
+	}
+
+	struct _AABBTest {
+		AABB aabb;
+		_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_inclusive(aabb); }
+	};
+
+	struct _PairLeaf {
+		BVH *bvh;
+		BVHElementID id;
+		_FORCE_INLINE_ bool operator()(BVHElementID p_other) {
+			if (p_other == id)
+				return true;
+			const Element &e = bvh->elements[id - 1];
+			const Element &o = bvh->elements[p_other - 1];
+			if (_can_pair(e, o) && e.aabb.intersects_inclusive(o.aabb) && !bvh->pair_map.has(_get_pair_key(id, p_other))) {
+				bvh->_pair(id, p_other);
+			}
+			return true;
+		}
+	};
+
+	void _check_pairs(BVHElementID p_id) {
+
+		// drop pairs that no longer apply, iterating backwards as _unpair() swaps with the last one
+		for (int i = elements[p_id - 1].pairs.size() - 1; i >= 0; i--) {
+
+			BVHElementID other = elements[p_id - 1].pairs[i];
+			const Element &e = elements[p_id - 1];
+			const Element &o = elements[other - 1];
+			if (!_can_pair(e, o) || !e.aabb.intersects_inclusive(o.aabb)) {
+				_unpair(p_id, other);
+			}
+		}
+
+		_AABBTest test;
+		test.aabb = elements[p_id - 1].aabb;
+		_PairLeaf leaf;
+		leaf.bvh = this;
+		leaf.id = p_id;
+
+		trees[TREE_PAIRABLE].query(test, leaf);
+		if (elements[p_id - 1].pairable) {
+			trees[TREE_NORMAL].query(test, leaf);
+		}
+	}
+
+	template <class Test>
+	struct _CullLeaf {
+		const Element *elements;
+		const Test *test;
+		T **result_array;
+		int *subindex_array;
+		int result_max;
+		int result_count;
+		uint32_t mask;
+
+		_FORCE_INLINE_ bool operator()(BVHElementID p_id) {
+			const Element &e = elements[p_id - 1];
+			if (!(e.pairable_type & mask) || !(*test)(e.aabb))
+				return true;
+			if (subindex_array)
+				subindex_array[result_count] = e.subindex;
+			result_array[result_count++] = e.userdata;
+			return result_count < result_max;
+		}
+	};
+
+	template <class Test>
+	int _cull(const Test &p_test, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+		if (p_result_max <= 0)
+			return 0;
+
+		_CullLeaf<Test> leaf;
+		leaf.elements = elements.ptr();
+		leaf.test = &p_test;
+		leaf.result_array = p_result_array;
+		leaf.subindex_array = p_subindex_array;
+		leaf.result_max = p_result_max;
+		leaf.result_count = 0;
+		leaf.mask = p_mask;
+
+		for (int i = 0; i < TREE_MAX && leaf.result_count < p_result_max; i++) {
+			trees[i].query(p_test, leaf);
+		}
+
+		return leaf.result_count;
+	}
+
+	struct _ConvexTest {
+		const Plane *planes;
+		int plane_count;
+		_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_convex_shape(planes, plane_count); }
+	};
+
+	struct _SegmentTest {
+		Vector3 from;
+		Vector3 to;
+		_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+	};
+
+	struct _PointTest {
+		Vector3 point;
+		_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+	};
+
+public:
+	BVHElementID create(T *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1) {
+
+		ERR_FAIL_COND_V(!p_userdata, 0);
+
+		BVHElementID id;
+		if (free_elements.size()) {
+			id = free_elements[free_elements.size() - 1];
+			free_elements.resize(free_elements.size() - 1);
+		} else {
+			elements.resize(elements.size() + 1);
+			id = elements.size();
+		}
+
+		Element &e = _get_element(id);
+		e.userdata = p_userdata;
+		e.subindex = p_subindex;
+		e.pairable = p_pairable;
+		e.pairable_type = p_pairable_type;
+		e.pairable_mask = p_pairable_mask;
+		e.aabb = p_aabb;
+		e.tree = p_pairable ? TREE_PAIRABLE : TREE_NORMAL;
+		e.pairs.clear();
+
+		_insert(id);
+		_check_pairs(id);
+
+		element_count++;
+		return id;
+	}
+
+	void move(BVHElementID p_id, const AABB &p_aabb) {
+
+		ERR_FAIL_COND(p_id == 0 || p_id > (BVHElementID)elements.size());
+		Element &e = _get_element(p_id);
+		ERR_FAIL_COND(!e.userdata);
+
+		e.aabb = p_aabb;
+
+		Tree &tree = trees[e.tree];
+		const AABB &fat = tree.aabbs[e.leaf];
+
+		if (!fat.encloses(p_aabb)) {
+			if (fat.intersects(p_aabb)) {
+				// small move, refit the leaf and its parents in place
+				// (refitting rather than growing, or parents keep inflating as the element wanders)
+				tree.aabbs.write[e.leaf] = _fatten(p_aabb);
+				tree.refit_bounds(tree.nodes[e.leaf].parent);
+			} else {
+				_remove(p_id);
+				_insert(p_id);
+			}
+		}
+
+		_check_pairs(p_id);
+	}
+
+	void set_pairable(BVHElementID p_id, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t p_pairable_mask = 1) {
+
+		ERR_FAIL_COND(p_id == 0 || p_id > (BVHElementID)elements.size());
+		Element &e = _get_element(p_id);
+		ERR_FAIL_COND(!e.userdata);
+
+		if (p_pairable == e.pairable && e.pairable_type == p_pairable_type && e.pairable_mask == p_pairable_mask)
+			return; // no changes, return
+
+		int tree = p_pairable ? TREE_PAIRABLE : TREE_NORMAL;
+		if (tree != e.tree) {
+			_remove(p_id);
+			_get_element(p_id).tree = tree;
+			_insert(p_id);
+		}
+
+		Element &f = _get_element(p_id);
+		f.pairable = p_pairable;
+		f.pairable_type = p_pairable_type;
+		f.pairable_mask = p_pairable_mask;
+
+		_check_pairs(p_id);
+	}
+
+	void erase(BVHElementID p_id) {
+
+		ERR_FAIL_COND(p_id == 0 || p_id > (BVHElementID)elements.size());
+		ERR_FAIL_COND(!elements[p_id - 1].userdata);
+
+		while (elements[p_id - 1].pairs.size()) {
+			_unpair(p_id, elements[p_id - 1].pairs[0]);
+		}
+
+		_remove(p_id);
+		_get_element(p_id).userdata = NULL;
+		free_elements.push_back(p_id);
+		element_count--;
+	}
+
+	bool is_pairable(BVHElementID p_id) const {
+
+		ERR_FAIL_COND_V(p_id == 0 || p_id > (BVHElementID)elements.size(), false);
+		return elements[p_id - 1].pairable;
+	}
+
+	T *get(BVHElementID p_id) const {
+
+		ERR_FAIL_COND_V(p_id == 0 || p_id > (BVHElementID)elements.size(), NULL);
+		T *userdata = elements[p_id - 1].userdata;
+		ERR_FAIL_COND_V(!userdata, NULL);
+		return userdata;
+	}
+
+	int get_subindex(BVHElementID p_id) const {
+
+		ERR_FAIL_COND_V(p_id == 0 || p_id > (BVHElementID)elements.size(), -1);
+		return elements[p_id - 1].subindex;
+	}
+
+	int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) const {
+
+		_ConvexTest test;
+		test.planes = p_convex.ptr();
+		test.plane_count = p_convex.size();
+		return _cull(test, p_result_array, p_result_max, NULL, p_mask);
+	}
+
+	int cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const {
+
+		_AABBTest test;
+		test.aabb = p_aabb;
+		return _cull(test, p_result_array, p_result_max, p_subindex_array, p_mask);
+	}
+
+	int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const {
+
+		_SegmentTest test;
+		test.from = p_from;
+		test.to = p_to;
+		return _cull(test, p_result_array, p_result_max, p_subindex_array, p_mask);
+	}
+
+	int cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const {
+
+		_PointTest test;
+		test.point = p_point;
+		return _cull(test, p_result_array, p_result_max, p_subindex_array, p_mask);
+	}
+
+	void set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+		pair_callback = p_callback;
+		pair_callback_userdata = p_userdata;
+	}
+
+	void set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+		unpair_callback = p_callback;
+		unpair_callback_userdata = p_userdata;
+	}
+
+	int get_elem_count() const { return element_count; }
+	int get_pair_count() const { return pair_map.size(); }
+
+	BVH() {
+
+		element_count = 0;
+		pair_callback = NULL;
+		unpair_callback = NULL;
+		pair_callback_userdata = NULL;
+		unpair_callback_userdata = NULL;
+	}
+};
+
+#endif // BVH_H
@@ -679,6 +679,7 @@ public:
 	void set_edited(bool p_edited);
 	bool is_edited() const;
 	uint32_t get_edited_version() const; //this function is used to check when something changed beyond a point, it's used mainly for generating previews
+	_FORCE_INLINE_ void _set_edited_flag() { _edited = true; } //what set() does, for callers that bypass it
 #endif
 
 	void set_script_instance(ScriptInstance *p_instance);
@@ -739,6 +740,23 @@ public:
 	virtual ~Object();
 };
 
+#ifdef DEBUG_ENABLED
+// Keeps an object from being freed while one of its methods runs. Used by
+// Object::call(), and by script VMs that dispatch to methods directly.
+struct _ObjectDebugLock {
+
+	Object *obj;
+
+	_ObjectDebugLock(Object *p_obj) {
+		obj = p_obj;
+		obj->_lock_index.ref();
+	}
+	~_ObjectDebugLock() {
+		obj->_lock_index.unref();
+	}
+};
+#endif
+
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
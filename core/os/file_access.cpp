@@ -43,6 +43,7 @@ FileAccess::CreateFunc FileAccess::create_func[ACCESS_MAX] = { 0, 0 };
 FileAccess::FileCloseFailNotify FileAccess::close_fail_notify = NULL;
 
 bool FileAccess::backup_save = false;
+bool FileAccess::memory_map = false;
 
 FileAccess *FileAccess::create(AccessType p_access) {
 
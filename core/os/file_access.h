@@ -63,8 +63,11 @@ protected:
 
 	static FileCloseFailNotify close_fail_notify;
 
+	AccessType get_access_type() const { return _access_type; }
+
 private:
 	static bool backup_save;
+	static bool memory_map;
 
 	AccessType _access_type;
 	static CreateFunc create_func[ACCESS_MAX]; /** default file access creation function for a platform */
@@ -110,6 +113,7 @@ public:
 	virtual real_t get_real() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const; ///< get an array of bytes
+	virtual const uint8_t *map_buffer(int p_length) const { return NULL; } ///< get a pointer to the next p_length bytes and skip them, only when the file is memory mapped (NULL otherwise, use get_buffer)
 	virtual String get_line() const;
 	virtual String get_token() const;
 	virtual Vector<String> get_csv_line(const String &p_delim = ",") const;
@@ -160,6 +164,9 @@ public:
 	static void set_backup_save(bool p_enable) { backup_save = p_enable; };
 	static bool is_backup_save_enabled() { return backup_save; };
 
+	static void set_memory_map_enabled(bool p_enable) { memory_map = p_enable; };
+	static bool is_memory_map_enabled() { return memory_map; };
+
 	static String get_md5(const String &p_file);
 	static String get_sha256(const String &p_file);
 	static String get_multiple_md5(const Vector<String> &p_file);
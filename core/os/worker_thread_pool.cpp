@@ -0,0 +1,403 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "worker_thread_pool.h"
+
+#include "core/os/os.h"
+#include "core/safe_refcount.h"
+
+WorkerThreadPool *WorkerThreadPool::singleton = NULL;
+
+WorkerThreadPool *WorkerThreadPool::get_singleton() {
+
+	return singleton;
+}
+
+void WorkerThreadPool::_thread_function(void *p_user) {
+
+	WorkerThreadPool *pool = (WorkerThreadPool *)p_user;
+
+	while (true) {
+
+		pool->task_available->wait();
+		if (pool->exit_threads)
+			break;
+
+		while (true) {
+
+			Chunk chunk;
+			pool->mutex->lock();
+			bool found = pool->_claim_any_chunk(chunk);
+			pool->mutex->unlock();
+
+			if (!found)
+				break;
+
+			pool->_process_chunk(chunk);
+		}
+	}
+}
+
+// Must be called with the mutex held.
+bool WorkerThreadPool::_claim_chunk(Group *p_group, Chunk &r_chunk) {
+
+	if (p_group->pending_dependencies > 0 || p_group->index >= p_group->elements)
+		return false;
+
+	r_chunk.group = p_group;
+	r_chunk.from = p_group->index;
+	r_chunk.to = MIN(p_group->index + p_group->grain_size, p_group->elements);
+	p_group->index = r_chunk.to;
+
+	if (p_group->index >= p_group->elements) {
+		// Everything in this group was handed out, it's up to the threads processing it now.
+		// It must leave the queue right away, the waiter frees it as soon as the last chunk reports.
+		queue.erase(p_group);
+	}
+
+	return true;
+}
+
+// Must be called with the mutex held.
+bool WorkerThreadPool::_claim_any_chunk(Chunk &r_chunk) {
+
+	if (!queue.front())
+		return false;
+
+	// Groups are only queued once their dependencies are done, and leave it when exhausted.
+	return _claim_chunk(queue.front()->get(), r_chunk);
+}
+
+void WorkerThreadPool::_process_chunk(const Chunk &p_chunk) {
+
+	Group *group = p_chunk.group;
+
+	if (group->template_userdata) {
+		for (uint32_t i = p_chunk.from; i < p_chunk.to; i++) {
+			group->template_userdata->callback_indexed(i);
+		}
+	} else {
+		for (uint32_t i = p_chunk.from; i < p_chunk.to; i++) {
+			group->func(group->userdata, i);
+		}
+	}
+
+	// The group can't be freed before the last chunk reports, so it's safe to touch it here.
+	if (atomic_add(&group->finished, p_chunk.to - p_chunk.from) == group->elements) {
+		mutex->lock();
+		_group_finished(group);
+		mutex->unlock();
+	}
+}
+
+// Must be called with the mutex held.
+void WorkerThreadPool::_enqueue_group(Group *p_group) {
+
+	if (p_group->elements == 0) {
+		_group_finished(p_group);
+		return;
+	}
+
+	queue.push_back(p_group);
+
+	uint32_t chunks = (p_group->elements + p_group->grain_size - 1) / p_group->grain_size;
+	uint32_t wake = MIN(chunks, (uint32_t)threads.size());
+	for (uint32_t i = 0; i < wake; i++) {
+		task_available->post();
+	}
+}
+
+// Must be called with the mutex held.
+void WorkerThreadPool::_group_finished(Group *p_group) {
+
+	p_group->completed = true;
+
+	for (int i = 0; i < p_group->dependents.size(); i++) {
+
+		Group *dependent = p_group->dependents[i];
+		dependent->pending_dependencies--;
+		if (dependent->pending_dependencies == 0) {
+			_enqueue_group(dependent);
+		}
+	}
+	p_group->dependents.clear();
+
+	if (p_group->done_semaphore) {
+		p_group->done_semaphore->post();
+	}
+}
+
+WorkerThreadPool::GroupID WorkerThreadPool::_add_group_task(TaskFunc p_func, void *p_userdata, BaseTemplateUserdata *p_template_userdata, uint32_t p_elements, int p_grain_size, const GroupID *p_dependencies, int p_dependency_count) {
+
+	_ensure_initialized();
+
+	Group *group = memnew(Group);
+	group->func = p_func;
+	group->userdata = p_userdata;
+	group->template_userdata = p_template_userdata;
+	group->elements = p_elements;
+
+	if (p_grain_size > 0) {
+		group->grain_size = p_grain_size;
+	} else {
+		// Aim for a few chunks per thread, so threads that finish early can pick up remaining work.
+		uint32_t slots = (threads.size() + 1) * 4;
+		group->grain_size = MAX(1u, p_elements / slots);
+	}
+
+	if (threads.size() == 0) {
+
+		// No worker threads (NO_THREADS builds or single core configuration), run right away.
+		// Dependencies are always already completed in this mode.
+		if (p_template_userdata) {
+			for (uint32_t i = 0; i < p_elements; i++) {
+				p_template_userdata->callback_indexed(i);
+			}
+		} else {
+			for (uint32_t i = 0; i < p_elements; i++) {
+				p_func(p_userdata, i);
+			}
+		}
+
+		group->index = p_elements;
+		group->finished = p_elements;
+		group->completed = true;
+	}
+
+	mutex->lock();
+
+	group->id = ++last_group_id;
+	if (group->id == INVALID_GROUP_ID) {
+		group->id = ++last_group_id;
+	}
+	groups.set(group->id, group);
+
+	if (!group->completed) {
+
+		for (int i = 0; i < p_dependency_count; i++) {
+
+			Group **dependency = groups.getptr(p_dependencies[i]);
+			// Groups that were already waited for no longer exist, they are completed.
+			if (!dependency || (*dependency)->completed)
+				continue;
+
+			(*dependency)->dependents.push_back(group);
+			group->pending_dependencies++;
+		}
+
+		if (group->pending_dependencies == 0) {
+			_enqueue_group(group);
+		}
+	}
+
+	mutex->unlock();
+
+	return group->id;
+}
+
+WorkerThreadPool::GroupID WorkerThreadPool::add_group_task(TaskFunc p_func, void *p_userdata, uint32_t p_elements, int p_grain_size, const GroupID *p_dependencies, int p_dependency_count) {
+
+	ERR_FAIL_COND_V(!p_func, INVALID_GROUP_ID);
+	return _add_group_task(p_func, p_userdata, NULL, p_elements, p_grain_size, p_dependencies, p_dependency_count);
+}
+
+WorkerThreadPool::GroupID WorkerThreadPool::add_task(TaskFunc p_func, void *p_userdata, const GroupID *p_dependencies, int p_dependency_count) {
+
+	ERR_FAIL_COND_V(!p_func, INVALID_GROUP_ID);
+	return _add_group_task(p_func, p_userdata, NULL, 1, 1, p_dependencies, p_dependency_count);
+}
+
+bool WorkerThreadPool::is_group_task_completed(GroupID p_group) const {
+
+	MutexLock lock(mutex);
+
+	Group *const *group = groups.getptr(p_group);
+	ERR_FAIL_COND_V(!group, false);
+	return (*group)->completed;
+}
+
+void WorkerThreadPool::wait_for_group_task_completion(GroupID p_group) {
+
+	mutex->lock();
+
+	Group **group_ptr = groups.getptr(p_group);
+	if (!group_ptr) {
+		mutex->unlock();
+		ERR_EXPLAIN("Invalid group task ID, or group task already waited for.");
+		ERR_FAIL();
+	}
+
+	Group *group = *group_ptr;
+
+	while (!group->completed) {
+
+		// Help while waiting, starting with our own group.
+		Chunk chunk;
+		if (_claim_chunk(group, chunk) || _claim_any_chunk(chunk)) {
+			mutex->unlock();
+			_process_chunk(chunk);
+			mutex->lock();
+			continue;
+		}
+
+		// Nothing left to do but the remaining chunks are still being processed, sleep until done.
+		if (!group->done_semaphore) {
+			if (semaphore_pool.size()) {
+				group->done_semaphore = semaphore_pool[semaphore_pool.size() - 1];
+				semaphore_pool.resize(semaphore_pool.size() - 1);
+			} else {
+				group->done_semaphore = Semaphore::create();
+			}
+		}
+
+		mutex->unlock();
+		group->done_semaphore->wait();
+		mutex->lock();
+	}
+
+	groups.erase(p_group);
+	if (group->done_semaphore) {
+		semaphore_pool.push_back(group->done_semaphore);
+	}
+
+	mutex->unlock();
+
+	if (group->template_userdata) {
+		memdelete(group->template_userdata);
+	}
+	memdelete(group);
+}
+
+int WorkerThreadPool::get_thread_count() const {
+
+	return threads.size();
+}
+
+void WorkerThreadPool::_ensure_initialized() {
+
+	if (initialized)
+		return;
+
+	MutexLock lock(mutex);
+	if (!initialized) {
+		init();
+	}
+}
+
+void WorkerThreadPool::init(int p_thread_count) {
+
+	ERR_FAIL_COND(threads.size() > 0);
+
+	initialized = true;
+
+#ifndef NO_THREADS
+	if (p_thread_count < 0) {
+		// The thread waiting for the work helps too, so leave one core for it.
+		p_thread_count = MAX(1, OS::get_singleton()->get_processor_count() - 1);
+	}
+
+	if (p_thread_count == 0)
+		return;
+
+	task_available = Semaphore::create();
+	if (!task_available)
+		return; // No semaphores on this platform, run everything inline.
+
+	exit_threads = false;
+	threads.resize(p_thread_count);
+	for (int i = 0; i < threads.size(); i++) {
+		threads.write[i] = Thread::create(_thread_function, this);
+	}
+#endif
+}
+
+void WorkerThreadPool::finish() {
+
+	if (threads.size()) {
+
+		exit_threads = true;
+		for (int i = 0; i < threads.size(); i++) {
+			task_available->post();
+		}
+
+		for (int i = 0; i < threads.size(); i++) {
+			Thread::wait_to_finish(threads[i]);
+			memdelete(threads[i]);
+		}
+		threads.clear();
+	}
+
+	if (task_available) {
+		memdelete(task_available);
+		task_available = NULL;
+	}
+
+	if (groups.size()) {
+		WARN_PRINTS("Group tasks were never waited for: " + itos(groups.size()));
+	}
+
+	const GroupID *k = NULL;
+	while ((k = groups.next(k))) {
+		Group *group = groups[*k];
+		if (group->done_semaphore) {
+			memdelete(group->done_semaphore);
+		}
+		if (group->template_userdata) {
+			memdelete(group->template_userdata);
+		}
+		memdelete(group);
+	}
+	groups.clear();
+	queue.clear();
+
+	for (int i = 0; i < semaphore_pool.size(); i++) {
+		memdelete(semaphore_pool[i]);
+	}
+	semaphore_pool.clear();
+
+	initialized = false;
+}
+
+WorkerThreadPool::WorkerThreadPool() {
+
+	singleton = this;
+	mutex = Mutex::create();
+	task_available = NULL;
+	exit_threads = false;
+	initialized = false;
+	last_group_id = INVALID_GROUP_ID;
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+
+	finish();
+	memdelete(mutex);
+	singleton = NULL;
+}
@@ -0,0 +1,169 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "core/hash_map.h"
+#include "core/list.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/vector.h"
+
+/**
+ * @class WorkerThreadPool
+ * Persistent pool of worker threads, meant to be used every frame by servers
+ * and scene code. Work is submitted as group tasks (parallel-for over a range
+ * of indices, processed in chunks of grain size elements). Groups can depend on
+ * other groups and will only start once those are completed.
+ *
+ * Every group task must be waited for exactly once with
+ * wait_for_group_task_completion(). The waiting thread does not sleep while
+ * there is work it can do, it processes chunks of the group (or of any other
+ * queued group) itself, so waiting from within a task is safe.
+ */
+
+class WorkerThreadPool {
+public:
+	typedef void (*TaskFunc)(void *p_userdata, uint32_t p_index);
+	typedef uint32_t GroupID;
+
+	enum {
+		INVALID_GROUP_ID = 0
+	};
+
+private:
+	struct BaseTemplateUserdata {
+		virtual void callback_indexed(uint32_t p_index) = 0;
+		virtual ~BaseTemplateUserdata() {}
+	};
+
+	template <class C, class M, class U>
+	struct GroupUserData : public BaseTemplateUserdata {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void callback_indexed(uint32_t p_index) {
+			(instance->*method)(p_index, userdata);
+		}
+	};
+
+	struct Group {
+		GroupID id;
+		TaskFunc func;
+		void *userdata;
+		BaseTemplateUserdata *template_userdata;
+
+		uint32_t elements;
+		uint32_t grain_size;
+		uint32_t index; // Next element to hand out, protected by the pool mutex.
+		volatile uint32_t finished; // Elements processed so far.
+
+		uint32_t pending_dependencies;
+		Vector<Group *> dependents;
+
+		bool completed;
+		Semaphore *done_semaphore;
+
+		Group() {
+			id = INVALID_GROUP_ID;
+			func = NULL;
+			userdata = NULL;
+			template_userdata = NULL;
+			elements = 0;
+			grain_size = 1;
+			index = 0;
+			finished = 0;
+			pending_dependencies = 0;
+			completed = false;
+			done_semaphore = NULL;
+		}
+	};
+
+	struct Chunk {
+		Group *group;
+		uint32_t from;
+		uint32_t to;
+	};
+
+	static WorkerThreadPool *singleton;
+
+	Mutex *mutex;
+	Semaphore *task_available;
+	Vector<Thread *> threads;
+	Vector<Semaphore *> semaphore_pool;
+	bool exit_threads;
+	bool initialized;
+
+	List<Group *> queue;
+	HashMap<GroupID, Group *> groups;
+	GroupID last_group_id;
+
+	bool _claim_chunk(Group *p_group, Chunk &r_chunk);
+	bool _claim_any_chunk(Chunk &r_chunk);
+	void _process_chunk(const Chunk &p_chunk);
+	void _enqueue_group(Group *p_group);
+	void _group_finished(Group *p_group);
+	void _ensure_initialized();
+
+	GroupID _add_group_task(TaskFunc p_func, void *p_userdata, BaseTemplateUserdata *p_template_userdata, uint32_t p_elements, int p_grain_size, const GroupID *p_dependencies, int p_dependency_count);
+
+	static void _thread_function(void *p_user);
+
+public:
+	GroupID add_group_task(TaskFunc p_func, void *p_userdata, uint32_t p_elements, int p_grain_size = -1, const GroupID *p_dependencies = NULL, int p_dependency_count = 0);
+	GroupID add_task(TaskFunc p_func, void *p_userdata, const GroupID *p_dependencies = NULL, int p_dependency_count = 0);
+
+	template <class C, class M, class U>
+	GroupID add_template_group_task(C *p_instance, M p_method, U p_userdata, uint32_t p_elements, int p_grain_size = -1, const GroupID *p_dependencies = NULL, int p_dependency_count = 0) {
+
+		GroupUserData<C, M, U> *ud = memnew((GroupUserData<C, M, U>));
+		ud->instance = p_instance;
+		ud->method = p_method;
+		ud->userdata = p_userdata;
+		return _add_group_task(NULL, NULL, ud, p_elements, p_grain_size, p_dependencies, p_dependency_count);
+	}
+
+	bool is_group_task_completed(GroupID p_group) const;
+	void wait_for_group_task_completion(GroupID p_group);
+
+	int get_thread_count() const;
+
+	void init(int p_thread_count = -1);
+	void finish();
+
+	static WorkerThreadPool *get_singleton();
+
+	WorkerThreadPool();
+	~WorkerThreadPool();
+};
+
+#endif // WORKER_THREAD_POOL_H
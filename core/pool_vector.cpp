@@ -37,13 +37,12 @@ uint8_t *MemoryPool::pool_memory = NULL;
 size_t *MemoryPool::pool_size = NULL;
 
 MemoryPool::Alloc *MemoryPool::allocs = NULL;
-MemoryPool::Alloc *MemoryPool::free_list = NULL;
+uint64_t MemoryPool::free_list = 0;
 uint32_t MemoryPool::alloc_count = 0;
 uint32_t MemoryPool::allocs_used = 0;
-Mutex *MemoryPool::alloc_mutex = NULL;
 
-size_t MemoryPool::total_memory = 0;
-size_t MemoryPool::max_memory = 0;
+uint64_t MemoryPool::total_memory = 0;
+uint64_t MemoryPool::max_memory = 0;
 
 void MemoryPool::setup(uint32_t p_max_allocs) {
 
@@ -53,19 +52,70 @@ void MemoryPool::setup(uint32_t p_max_allocs) {
 
 	for (uint32_t i = 0; i < alloc_count - 1; i++) {
 
-		allocs[i].free_list = &allocs[i + 1];
+		allocs[i].next_free = i + 2;
 	}
 
-	free_list = &allocs[0];
-
-	alloc_mutex = Mutex::create();
+	free_list = 1; // allocs[0], nothing changed yet
 }
 
 void MemoryPool::cleanup() {
 
 	memdelete_arr(allocs);
-	memdelete(alloc_mutex);
 
 	ERR_EXPLAINC("There are still MemoryPool allocs in use at exit!");
 	ERR_FAIL_COND(allocs_used > 0);
 }
+
+MemoryPool::Alloc *MemoryPool::take_alloc() {
+
+	uint64_t head = free_list;
+
+	while (true) {
+
+		uint32_t index = head & 0xFFFFFFFF;
+		if (index == 0)
+			return NULL;
+
+		// The alloc may be taken and given back by another thread meanwhile,
+		// in which case the counter changed and the exchange fails.
+		Alloc *alloc = &allocs[index - 1];
+		uint64_t next = (((head >> 32) + 1) << 32) | alloc->next_free;
+
+		uint64_t prev = atomic_compare_exchange(&free_list, head, next);
+		if (prev == head) {
+			atomic_increment(&allocs_used);
+			return alloc;
+		}
+		head = prev;
+	}
+}
+
+void MemoryPool::release_alloc(Alloc *p_alloc) {
+
+	uint32_t index = p_alloc - allocs + 1;
+	uint64_t head = free_list;
+
+	while (true) {
+
+		p_alloc->next_free = head & 0xFFFFFFFF;
+		uint64_t next = (((head >> 32) + 1) << 32) | index;
+
+		uint64_t prev = atomic_compare_exchange(&free_list, head, next);
+		if (prev == head)
+			break;
+		head = prev;
+	}
+
+	atomic_decrement(&allocs_used);
+}
+
+void MemoryPool::add_memory(size_t p_bytes) {
+
+	uint64_t total = atomic_add(&total_memory, (uint64_t)p_bytes);
+	atomic_exchange_if_greater(&max_memory, total);
+}
+
+void MemoryPool::remove_memory(size_t p_bytes) {
+
+	atomic_sub(&total_memory, (uint64_t)p_bytes);
+}
@@ -38,6 +38,32 @@
 #include "core/safe_refcount.h"
 #include "core/ustring.h"
 
+// How the bulk numeric operations compute. Integer elements are 32 bits but
+// scripts use 64 bit integers, so they are widened for the arithmetic and
+// saturated when stored back. Sums wrap around in 64 bits instead of
+// overflowing. Real elements are used as they are.
+template <class T>
+struct PoolVectorNumeric {
+
+	typedef T Wide;
+	typedef T Accum;
+
+	static _FORCE_INLINE_ Wide clamp_scalar(const Wide &p_value) { return p_value; }
+	static _FORCE_INLINE_ T narrow(const Wide &p_value) { return p_value; }
+};
+
+template <>
+struct PoolVectorNumeric<int> {
+
+	typedef int64_t Wide;
+	typedef uint64_t Accum;
+
+	// Past this, any element other than zero saturates, and products of elements
+	// and scalars can't overflow 64 bits.
+	static _FORCE_INLINE_ int64_t clamp_scalar(int64_t p_value) { return CLAMP(p_value, -(int64_t)0xFFFFFFFF, (int64_t)0xFFFFFFFF); }
+	static _FORCE_INLINE_ int narrow(int64_t p_value) { return (int)CLAMP(p_value, -(int64_t)0x80000000, (int64_t)0x7FFFFFFF); }
+};
+
 struct MemoryPool {
 
 	//avoid accessing these directly, must be public for template access
@@ -54,27 +80,35 @@ struct MemoryPool {
 		PoolAllocator::ID pool_id;
 		size_t size;
 
-		Alloc *free_list;
+		uint32_t next_free; // index + 1 of the next free alloc, 0 if last
 
 		Alloc() :
 				lock(0),
 				mem(NULL),
 				pool_id(POOL_ALLOCATOR_INVALID_ID),
 				size(0),
-				free_list(NULL) {
+				next_free(0) {
 		}
 	};
 
 	static Alloc *allocs;
-	static Alloc *free_list;
+	// Lock-free stack of the unused allocs. The low 32 bits are the index + 1
+	// of the top alloc (0 if empty), the high 32 bits count every change to
+	// avoid the ABA problem.
+	static uint64_t free_list;
 	static uint32_t alloc_count;
 	static uint32_t allocs_used;
-	static Mutex *alloc_mutex;
-	static size_t total_memory;
-	static size_t max_memory;
+	static uint64_t total_memory;
+	static uint64_t max_memory;
 
 	static void setup(uint32_t p_max_allocs = (1 << 16));
 	static void cleanup();
+
+	static Alloc *take_alloc(); // NULL if all are in use
+	static void release_alloc(Alloc *p_alloc);
+
+	static void add_memory(size_t p_bytes);
+	static void remove_memory(size_t p_bytes);
 };
 
 /**
@@ -99,20 +133,14 @@ class PoolVector {
 
 		//must allocate something
 
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
+		MemoryPool::Alloc *new_alloc = MemoryPool::take_alloc();
+		if (!new_alloc) {
 			ERR_EXPLAINC("All memory pool allocations are in use, can't COW.");
 			ERR_FAIL();
 		}
 
 		MemoryPool::Alloc *old_alloc = alloc;
-
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
+		alloc = new_alloc;
 
 		//copy the alloc data
 		alloc->size = old_alloc->size;
@@ -121,14 +149,9 @@ class PoolVector {
 		alloc->lock = 0;
 
 #ifdef DEBUG_ENABLED
-		MemoryPool::total_memory += alloc->size;
-		if (MemoryPool::total_memory > MemoryPool::max_memory) {
-			MemoryPool::max_memory = MemoryPool::total_memory;
-		}
+		MemoryPool::add_memory(alloc->size);
 #endif
 
-		MemoryPool::alloc_mutex->unlock();
-
 		if (MemoryPool::memory_pool) {
 
 		} else {
@@ -153,9 +176,7 @@ class PoolVector {
 			//this should never happen but..
 
 #ifdef DEBUG_ENABLED
-			MemoryPool::alloc_mutex->lock();
-			MemoryPool::total_memory -= old_alloc->size;
-			MemoryPool::alloc_mutex->unlock();
+			MemoryPool::remove_memory(old_alloc->size);
 #endif
 
 			{
@@ -179,11 +200,7 @@ class PoolVector {
 				old_alloc->mem = NULL;
 				old_alloc->size = 0;
 
-				MemoryPool::alloc_mutex->lock();
-				old_alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = old_alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
+				MemoryPool::release_alloc(old_alloc);
 			}
 		}
 	}
@@ -232,9 +249,7 @@ class PoolVector {
 		}
 
 #ifdef DEBUG_ENABLED
-		MemoryPool::alloc_mutex->lock();
-		MemoryPool::total_memory -= alloc->size;
-		MemoryPool::alloc_mutex->unlock();
+		MemoryPool::remove_memory(alloc->size);
 #endif
 
 		if (MemoryPool::memory_pool) {
@@ -247,11 +262,7 @@ class PoolVector {
 			alloc->mem = NULL;
 			alloc->size = 0;
 
-			MemoryPool::alloc_mutex->lock();
-			alloc->free_list = MemoryPool::free_list;
-			MemoryPool::free_list = alloc;
-			MemoryPool::allocs_used--;
-			MemoryPool::alloc_mutex->unlock();
+			MemoryPool::release_alloc(alloc);
 		}
 
 		alloc = NULL;
@@ -460,6 +471,16 @@ public:
 
 	void invert();
 
+	// Bulk operations for numeric types, which run over the raw memory so
+	// scripts don't pay a Variant conversion per element.
+	void fill(const T &p_value);
+	void add_scalar(const typename PoolVectorNumeric<T>::Wide &p_value);
+	void multiply_scalar(const typename PoolVectorNumeric<T>::Wide &p_value);
+	void add_array(const PoolVector &p_array);
+	void multiply_array(const PoolVector &p_array);
+	typename PoolVectorNumeric<T>::Wide sum() const;
+	typename PoolVectorNumeric<T>::Wide dot(const PoolVector &p_array) const;
+
 	void operator=(const PoolVector &p_pool_vector) { _reference(p_pool_vector); }
 	PoolVector() { alloc = NULL; }
 	PoolVector(const PoolVector &p_pool_vector) {
@@ -517,24 +538,16 @@ Error PoolVector<T>::resize(int p_size) {
 			return OK; //nothing to do here
 
 		//must allocate something
-		MemoryPool::alloc_mutex->lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex->unlock();
+		alloc = MemoryPool::take_alloc();
+		if (!alloc) {
 			ERR_EXPLAINC("All memory pool allocations are in use.");
 			ERR_FAIL_V(ERR_OUT_OF_MEMORY);
 		}
 
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
-
 		//cleanup the alloc
 		alloc->size = 0;
 		alloc->refcount.init();
 		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		MemoryPool::alloc_mutex->unlock();
 
 	} else {
 
@@ -554,13 +567,11 @@ Error PoolVector<T>::resize(int p_size) {
 	_copy_on_write(); // make it unique
 
 #ifdef DEBUG_ENABLED
-	MemoryPool::alloc_mutex->lock();
-	MemoryPool::total_memory -= alloc->size;
-	MemoryPool::total_memory += new_size;
-	if (MemoryPool::total_memory > MemoryPool::max_memory) {
-		MemoryPool::max_memory = MemoryPool::total_memory;
+	if (new_size > alloc->size) {
+		MemoryPool::add_memory(new_size - alloc->size);
+	} else {
+		MemoryPool::remove_memory(alloc->size - new_size);
 	}
-	MemoryPool::alloc_mutex->unlock();
 #endif
 
 	int cur_elements = alloc->size / sizeof(T);
@@ -610,11 +621,7 @@ Error PoolVector<T>::resize(int p_size) {
 				alloc->mem = NULL;
 				alloc->size = 0;
 
-				MemoryPool::alloc_mutex->lock();
-				alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex->unlock();
+				MemoryPool::release_alloc(alloc);
 
 			} else {
 				alloc->mem = memrealloc(alloc->mem, new_size);
@@ -640,4 +647,152 @@ void PoolVector<T>::invert() {
 	}
 }
 
+template <class T>
+void PoolVector<T>::fill(const T &p_value) {
+
+	int s = size();
+	if (s == 0)
+		return;
+
+	Write w = write();
+	T *ptr = w.ptr();
+	for (int i = 0; i < s; i++)
+		ptr[i] = p_value;
+}
+
+template <class T>
+void PoolVector<T>::add_scalar(const typename PoolVectorNumeric<T>::Wide &p_value) {
+
+	typedef PoolVectorNumeric<T> N;
+	typedef typename N::Wide W;
+
+	int s = size();
+	if (s == 0)
+		return;
+
+	W value = N::clamp_scalar(p_value);
+	Write w = write();
+	T *ptr = w.ptr();
+	for (int i = 0; i < s; i++)
+		ptr[i] = N::narrow(W(ptr[i]) + value);
+}
+
+template <class T>
+void PoolVector<T>::multiply_scalar(const typename PoolVectorNumeric<T>::Wide &p_value) {
+
+	typedef PoolVectorNumeric<T> N;
+	typedef typename N::Wide W;
+
+	int s = size();
+	if (s == 0)
+		return;
+
+	W value = N::clamp_scalar(p_value);
+	Write w = write();
+	T *ptr = w.ptr();
+	for (int i = 0; i < s; i++)
+		ptr[i] = N::narrow(W(ptr[i]) * value);
+}
+
+template <class T>
+void PoolVector<T>::add_array(const PoolVector &p_array) {
+
+	typedef PoolVectorNumeric<T> N;
+	typedef typename N::Wide W;
+
+	int s = size();
+	ERR_FAIL_COND(p_array.size() != s);
+	if (s == 0)
+		return;
+
+	// Keep the operand alive and readable even if it shares our memory.
+	PoolVector<T> operand = p_array;
+	Read r = operand.read();
+	Write w = write();
+	const T *src = r.ptr();
+	T *dst = w.ptr();
+	for (int i = 0; i < s; i++)
+		dst[i] = N::narrow(W(dst[i]) + W(src[i]));
+}
+
+template <class T>
+void PoolVector<T>::multiply_array(const PoolVector &p_array) {
+
+	typedef PoolVectorNumeric<T> N;
+	typedef typename N::Wide W;
+
+	int s = size();
+	ERR_FAIL_COND(p_array.size() != s);
+	if (s == 0)
+		return;
+
+	PoolVector<T> operand = p_array;
+	Read r = operand.read();
+	Write w = write();
+	const T *src = r.ptr();
+	T *dst = w.ptr();
+	for (int i = 0; i < s; i++)
+		dst[i] = N::narrow(W(dst[i]) * W(src[i]));
+}
+
+template <class T>
+typename PoolVectorNumeric<T>::Wide PoolVector<T>::sum() const {
+
+	typedef PoolVectorNumeric<T> N;
+	typedef typename N::Wide W;
+	typedef typename N::Accum A;
+
+	int s = size();
+	if (s == 0)
+		return W();
+
+	Read r = read();
+	const T *ptr = r.ptr();
+
+	// Independent accumulators let the compiler vectorize the loop.
+	A acc[4] = { A(), A(), A(), A() };
+	int i = 0;
+	for (; i + 4 <= s; i += 4) {
+		acc[0] += A(W(ptr[i + 0]));
+		acc[1] += A(W(ptr[i + 1]));
+		acc[2] += A(W(ptr[i + 2]));
+		acc[3] += A(W(ptr[i + 3]));
+	}
+	for (; i < s; i++)
+		acc[0] += A(W(ptr[i]));
+
+	return W((acc[0] + acc[1]) + (acc[2] + acc[3]));
+}
+
+template <class T>
+typename PoolVectorNumeric<T>::Wide PoolVector<T>::dot(const PoolVector &p_array) const {
+
+	typedef PoolVectorNumeric<T> N;
+	typedef typename N::Wide W;
+	typedef typename N::Accum A;
+
+	int s = size();
+	ERR_FAIL_COND_V(p_array.size() != s, W());
+	if (s == 0)
+		return W();
+
+	Read ra = read();
+	Read rb = p_array.read();
+	const T *a = ra.ptr();
+	const T *b = rb.ptr();
+
+	A acc[4] = { A(), A(), A(), A() };
+	int i = 0;
+	for (; i + 4 <= s; i += 4) {
+		acc[0] += A(W(a[i + 0]) * W(b[i + 0]));
+		acc[1] += A(W(a[i + 1]) * W(b[i + 1]));
+		acc[2] += A(W(a[i + 2]) * W(b[i + 2]));
+		acc[3] += A(W(a[i + 3]) * W(b[i + 3]));
+	}
+	for (; i < s; i++)
+		acc[0] += A(W(a[i]) * W(b[i]));
+
+	return W((acc[0] + acc[1]) + (acc[2] + acc[3]));
+}
+
 #endif // POOL_VECTOR_H
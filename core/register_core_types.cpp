@@ -59,6 +59,7 @@
 #include "core/math/triangle_mesh.h"
 #include "core/os/input.h"
 #include "core/os/main_loop.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/packed_data_container.h"
 #include "core/path_remap.h"
 #include "core/project_settings.h"
@@ -81,6 +82,8 @@ static _JSON *_json = NULL;
 
 static IP *ip = NULL;
 
+static WorkerThreadPool *worker_thread_pool = NULL;
+
 static _Geometry *_geometry = NULL;
 
 extern Mutex *_global_mutex;
@@ -101,6 +104,8 @@ void register_core_types() {
 	StringName::setup();
 	ResourceLoader::initialize();
 
+	worker_thread_pool = memnew(WorkerThreadPool);
+
 	register_global_constants();
 	register_variant_methods();
 
@@ -206,6 +211,9 @@ void register_core_settings() {
 	//since in register core types, globals may not e present
 	GLOBAL_DEF_RST("network/limits/packet_peer_stream/max_buffer_po2", (16));
 	ProjectSettings::get_singleton()->set_custom_property_info("network/limits/packet_peer_stream/max_buffer_po2", PropertyInfo(Variant::INT, "network/limits/packet_peer_stream/max_buffer_po2", PROPERTY_HINT_RANGE, "0,64,1,or_greater"));
+
+	GLOBAL_DEF_RST("threading/worker_pool/max_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("threading/worker_pool/max_threads", PropertyInfo(Variant::INT, "threading/worker_pool/max_threads", PROPERTY_HINT_RANGE, "-1,256,1,or_greater"));
 }
 
 void register_core_singletons() {
@@ -272,6 +280,8 @@ void unregister_core_types() {
 
 	ResourceLoader::finalize();
 
+	memdelete(worker_thread_pool);
+
 	ObjectDB::cleanup();
 
 	unregister_variant_methods();
@@ -93,6 +93,16 @@ static _ALWAYS_INLINE_ T atomic_exchange_if_greater(volatile T *pw, volatile V v
 	return *pw;
 }
 
+template <class T, class V>
+static _ALWAYS_INLINE_ T atomic_compare_exchange(volatile T *pw, volatile V expected, volatile V val) {
+
+	T tmp = *pw;
+	if (tmp == expected)
+		*pw = val;
+
+	return tmp;
+}
+
 #elif defined(__GNUC__)
 
 /* Implementation for GCC & Clang */
@@ -148,6 +158,13 @@ static _ALWAYS_INLINE_ T atomic_exchange_if_greater(volatile T *pw, volatile V v
 	}
 }
 
+// Returns the previous value, the exchange happened if it equals expected.
+template <class T, class V>
+static _ALWAYS_INLINE_ T atomic_compare_exchange(volatile T *pw, volatile V expected, volatile V val) {
+
+	return __sync_val_compare_and_swap(pw, (T)expected, (T)val);
+}
+
 #elif defined(_MSC_VER)
 // For MSVC use a separate compilation unit to prevent windows.h from polluting
 // the global namespace.
@@ -157,6 +174,7 @@ uint32_t atomic_increment(volatile uint32_t *pw);
 uint32_t atomic_sub(volatile uint32_t *pw, volatile uint32_t val);
 uint32_t atomic_add(volatile uint32_t *pw, volatile uint32_t val);
 uint32_t atomic_exchange_if_greater(volatile uint32_t *pw, volatile uint32_t val);
+uint32_t atomic_compare_exchange(volatile uint32_t *pw, volatile uint32_t expected, volatile uint32_t val);
 
 uint64_t atomic_conditional_increment(volatile uint64_t *pw);
 uint64_t atomic_decrement(volatile uint64_t *pw);
@@ -164,6 +182,7 @@ uint64_t atomic_increment(volatile uint64_t *pw);
 uint64_t atomic_sub(volatile uint64_t *pw, volatile uint64_t val);
 uint64_t atomic_add(volatile uint64_t *pw, volatile uint64_t val);
 uint64_t atomic_exchange_if_greater(volatile uint64_t *pw, volatile uint64_t val);
+uint64_t atomic_compare_exchange(volatile uint64_t *pw, volatile uint64_t expected, volatile uint64_t val);
 
 #else
 //no threads supported?
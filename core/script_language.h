@@ -300,6 +300,11 @@ public:
 
 	virtual void reload_all_scripts() = 0;
 	virtual void reload_tool_script(const Ref<Script> &p_script, bool p_soft_reload) = 0;
+
+	// Loads the scripts that the given resources need ahead of time, compiling
+	// the ones that don't depend on each other in parallel. The loaded scripts are
+	// added to r_resources, so they stay cached while the caller needs them.
+	virtual void load_dependencies(const Vector<String> &p_paths, List<RES> *r_resources) {}
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const = 0;
@@ -319,6 +324,13 @@ public:
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max) = 0;
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max) = 0;
 
+	// Sampling profiler (--profile-script). Every sample is the script call
+	// stack at that time, as frames separated by ';' from the outermost call in,
+	// which is the "collapsed" format read by flame graph tools.
+	virtual void sampling_start(int p_frequency) {}
+	virtual void sampling_stop() {}
+	virtual void sampling_get_stacks(Map<String, int> *r_stacks) {} // adds the number of samples of each stack
+
 	virtual void *alloc_instance_binding_data(Object *p_object) { return NULL; } //optional, not used by all languages
 	virtual void free_instance_binding_data(void *p_data) {} //optional, not used by all languages
 	virtual void refcount_incremented_instance_binding(Object *p_object) {} //optional, not used by all languages
@@ -47,13 +47,15 @@ StringName _scs_create(const char *p_chr) {
 }
 
 bool StringName::configured = false;
-Mutex *StringName::lock = NULL;
+Mutex *StringName::lock[STRING_TABLE_LOCKS];
 
 void StringName::setup() {
 
-	lock = Mutex::create();
-
 	ERR_FAIL_COND(configured);
+	for (int i = 0; i < STRING_TABLE_LOCKS; i++) {
+
+		lock[i] = Mutex::create();
+	}
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
 
 		_table[i] = NULL;
@@ -63,8 +65,6 @@ void StringName::setup() {
 
 void StringName::cleanup() {
 
-	lock->lock();
-
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
 
@@ -87,9 +87,12 @@ void StringName::cleanup() {
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
-	lock->unlock();
 
-	memdelete(lock);
+	for (int i = 0; i < STRING_TABLE_LOCKS; i++) {
+
+		memdelete(lock[i]);
+		lock[i] = NULL;
+	}
 }
 
 void StringName::unref() {
@@ -98,7 +101,8 @@ void StringName::unref() {
 
 	if (_data && _data->refcount.unref()) {
 
-		lock->lock();
+		Mutex *bucket_lock = lock[_data->idx & STRING_TABLE_LOCK_MASK];
+		bucket_lock->lock();
 
 		if (_data->prev) {
 			_data->prev->next = _data->next;
@@ -113,7 +117,7 @@ void StringName::unref() {
 			_data->next->prev = _data->prev;
 		}
 		memdelete(_data);
-		lock->unlock();
+		bucket_lock->unlock();
 	}
 
 	_data = NULL;
@@ -184,12 +188,13 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *bucket_lock = lock[idx & STRING_TABLE_LOCK_MASK];
+	bucket_lock->lock();
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -203,7 +208,7 @@ StringName::StringName(const char *p_name) {
 	if (_data) {
 		if (_data->refcount.ref()) {
 			// exists
-			lock->unlock();
+			bucket_lock->unlock();
 			return;
 		} else {
 		}
@@ -221,7 +226,7 @@ StringName::StringName(const char *p_name) {
 		_table[idx]->prev = _data;
 	_table[idx] = _data;
 
-	lock->unlock();
+	bucket_lock->unlock();
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -232,12 +237,13 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_static_string.ptr);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *bucket_lock = lock[idx & STRING_TABLE_LOCK_MASK];
+	bucket_lock->lock();
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -251,7 +257,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 	if (_data) {
 		if (_data->refcount.ref()) {
 			// exists
-			lock->unlock();
+			bucket_lock->unlock();
 			return;
 		} else {
 		}
@@ -269,7 +275,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 		_table[idx]->prev = _data;
 	_table[idx] = _data;
 
-	lock->unlock();
+	bucket_lock->unlock();
 }
 
 StringName::StringName(const String &p_name) {
@@ -281,12 +287,13 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
 	uint32_t hash = p_name.hash();
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *bucket_lock = lock[idx & STRING_TABLE_LOCK_MASK];
+	bucket_lock->lock();
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -299,7 +306,7 @@ StringName::StringName(const String &p_name) {
 	if (_data) {
 		if (_data->refcount.ref()) {
 			// exists
-			lock->unlock();
+			bucket_lock->unlock();
 			return;
 		} else {
 		}
@@ -317,7 +324,7 @@ StringName::StringName(const String &p_name) {
 		_table[idx]->prev = _data;
 	_table[idx] = _data;
 
-	lock->unlock();
+	bucket_lock->unlock();
 }
 
 StringName StringName::search(const char *p_name) {
@@ -328,12 +335,13 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *bucket_lock = lock[idx & STRING_TABLE_LOCK_MASK];
+	bucket_lock->lock();
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -345,12 +353,12 @@ StringName StringName::search(const char *p_name) {
 	}
 
 	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+		bucket_lock->unlock();
 
 		return StringName(_data);
 	}
 
-	lock->unlock();
+	bucket_lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -362,12 +370,13 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
 	uint32_t hash = String::hash(p_name);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *bucket_lock = lock[idx & STRING_TABLE_LOCK_MASK];
+	bucket_lock->lock();
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -379,23 +388,24 @@ StringName StringName::search(const CharType *p_name) {
 	}
 
 	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+		bucket_lock->unlock();
 		return StringName(_data);
 	}
 
-	lock->unlock();
+	bucket_lock->unlock();
 	return StringName(); //does not exist
 }
 StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
 	uint32_t hash = p_name.hash();
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	Mutex *bucket_lock = lock[idx & STRING_TABLE_LOCK_MASK];
+	bucket_lock->lock();
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -407,11 +417,11 @@ StringName StringName::search(const String &p_name) {
 	}
 
 	if (_data && _data->refcount.ref()) {
-		lock->unlock();
+		bucket_lock->unlock();
 		return StringName(_data);
 	}
 
-	lock->unlock();
+	bucket_lock->unlock();
 	return StringName(); //does not exist
 }
 
@@ -50,7 +50,13 @@ class StringName {
 
 		STRING_TABLE_BITS = 12,
 		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MASK = STRING_TABLE_LEN - 1,
+
+		// each lock guards the buckets whose index matches it in the low bits,
+		// so threads only contend when they touch the same shard
+		STRING_TABLE_LOCK_BITS = 6,
+		STRING_TABLE_LOCKS = 1 << STRING_TABLE_LOCK_BITS,
+		STRING_TABLE_LOCK_MASK = STRING_TABLE_LOCKS - 1
 	};
 
 	struct _Data {
@@ -85,7 +91,7 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 
-	static Mutex *lock;
+	static Mutex *lock[STRING_TABLE_LOCKS];
 	static void setup();
 	static void cleanup();
 	static bool configured;
@@ -606,6 +606,14 @@ struct _VariantCall {
 	VCALL_LOCALMEM1(PoolIntArray, append);
 	VCALL_LOCALMEM1(PoolIntArray, append_array);
 	VCALL_LOCALMEM0(PoolIntArray, invert);
+	VCALL_LOCALMEM2R(PoolIntArray, subarray);
+	VCALL_LOCALMEM1(PoolIntArray, fill);
+	VCALL_LOCALMEM1(PoolIntArray, add_scalar);
+	VCALL_LOCALMEM1(PoolIntArray, multiply_scalar);
+	VCALL_LOCALMEM1(PoolIntArray, add_array);
+	VCALL_LOCALMEM1(PoolIntArray, multiply_array);
+	VCALL_LOCALMEM0R(PoolIntArray, sum);
+	VCALL_LOCALMEM1R(PoolIntArray, dot);
 
 	VCALL_LOCALMEM0R(PoolRealArray, size);
 	VCALL_LOCALMEM2(PoolRealArray, set);
@@ -617,6 +625,14 @@ struct _VariantCall {
 	VCALL_LOCALMEM1(PoolRealArray, append);
 	VCALL_LOCALMEM1(PoolRealArray, append_array);
 	VCALL_LOCALMEM0(PoolRealArray, invert);
+	VCALL_LOCALMEM2R(PoolRealArray, subarray);
+	VCALL_LOCALMEM1(PoolRealArray, fill);
+	VCALL_LOCALMEM1(PoolRealArray, add_scalar);
+	VCALL_LOCALMEM1(PoolRealArray, multiply_scalar);
+	VCALL_LOCALMEM1(PoolRealArray, add_array);
+	VCALL_LOCALMEM1(PoolRealArray, multiply_array);
+	VCALL_LOCALMEM0R(PoolRealArray, sum);
+	VCALL_LOCALMEM1R(PoolRealArray, dot);
 
 	VCALL_LOCALMEM0R(PoolStringArray, size);
 	VCALL_LOCALMEM2(PoolStringArray, set);
@@ -1739,6 +1755,14 @@ void register_variant_methods() {
 	ADDFUNC2R(POOL_INT_ARRAY, INT, PoolIntArray, insert, INT, "idx", INT, "integer", varray());
 	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, resize, INT, "idx", varray());
 	ADDFUNC0(POOL_INT_ARRAY, NIL, PoolIntArray, invert, varray());
+	ADDFUNC2R(POOL_INT_ARRAY, POOL_INT_ARRAY, PoolIntArray, subarray, INT, "from", INT, "to", varray());
+	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, fill, INT, "integer", varray());
+	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, add_scalar, INT, "integer", varray());
+	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, multiply_scalar, INT, "integer", varray());
+	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, add_array, POOL_INT_ARRAY, "array", varray());
+	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, multiply_array, POOL_INT_ARRAY, "array", varray());
+	ADDFUNC0R(POOL_INT_ARRAY, INT, PoolIntArray, sum, varray());
+	ADDFUNC1R(POOL_INT_ARRAY, INT, PoolIntArray, dot, POOL_INT_ARRAY, "array", varray());
 
 	ADDFUNC0R(POOL_REAL_ARRAY, INT, PoolRealArray, size, varray());
 	ADDFUNC2(POOL_REAL_ARRAY, NIL, PoolRealArray, set, INT, "idx", REAL, "value", varray());
@@ -1749,6 +1773,14 @@ void register_variant_methods() {
 	ADDFUNC2R(POOL_REAL_ARRAY, INT, PoolRealArray, insert, INT, "idx", REAL, "value", varray());
 	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, resize, INT, "idx", varray());
 	ADDFUNC0(POOL_REAL_ARRAY, NIL, PoolRealArray, invert, varray());
+	ADDFUNC2R(POOL_REAL_ARRAY, POOL_REAL_ARRAY, PoolRealArray, subarray, INT, "from", INT, "to", varray());
+	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, fill, REAL, "value", varray());
+	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, add_scalar, REAL, "value", varray());
+	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, multiply_scalar, REAL, "value", varray());
+	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, add_array, POOL_REAL_ARRAY, "array", varray());
+	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, multiply_array, POOL_REAL_ARRAY, "array", varray());
+	ADDFUNC0R(POOL_REAL_ARRAY, REAL, PoolRealArray, sum, varray());
+	ADDFUNC1R(POOL_REAL_ARRAY, REAL, PoolRealArray, dot, POOL_REAL_ARRAY, "array", varray());
 
 	ADDFUNC0R(POOL_STRING_ARRAY, INT, PoolStringArray, size, varray());
 	ADDFUNC2(POOL_STRING_ARRAY, NIL, PoolStringArray, set, INT, "idx", STRING, "string", varray());
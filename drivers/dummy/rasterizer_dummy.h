@@ -237,6 +237,7 @@ public:
 	void texture_set_detect_3d_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata) {}
 	void texture_set_detect_srgb_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata) {}
 	void texture_set_detect_normal_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata) {}
+	void texture_set_stream_callback(RID p_texture, VisualServer::TextureStreamCallback p_callback, void *p_userdata) {}
 
 	void textures_keep_original(bool p_enable) {}
 
@@ -169,6 +169,9 @@ void RasterizerCanvasGLES2::canvas_begin() {
 
 	_set_uniforms();
 	_bind_quad_buffer();
+
+	state.batch_active = false;
+	state.batch_quad_count = 0;
 }
 
 void RasterizerCanvasGLES2::canvas_end() {
@@ -212,6 +215,10 @@ RasterizerStorageGLES2::Texture *RasterizerCanvasGLES2::_bind_canvas_texture(con
 				texture->render_target->used_in_frame = true;
 			}
 
+			if (texture->stream_callback) {
+				texture->stream_callback(texture->stream_ud, MAX(texture->width, texture->height));
+			}
+
 			glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 1);
 			glBindTexture(GL_TEXTURE_2D, texture->tex_id);
 
@@ -330,6 +337,8 @@ void RasterizerCanvasGLES2::_draw_polygon(const int *p_indices, int p_index_coun
 		glDrawElements(GL_TRIANGLES, p_index_count, GL_UNSIGNED_SHORT, 0);
 	}
 
+	storage->info.render.draw_call_count++;
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -369,6 +378,8 @@ void RasterizerCanvasGLES2::_draw_generic(GLuint p_primitive, int p_vertex_count
 
 	glDrawArrays(p_primitive, 0, p_vertex_count);
 
+	storage->info.render.draw_call_count++;
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
@@ -430,6 +441,8 @@ void RasterizerCanvasGLES2::_draw_gui_primitive(int p_points, const Vector2 *p_v
 
 	glDrawArrays(prim[p_points], 0, p_points);
 
+	storage->info.render.draw_call_count++;
+
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
@@ -443,6 +456,149 @@ static const GLenum gl_primitive[] = {
 	GL_TRIANGLE_FAN
 };
 
+bool RasterizerCanvasGLES2::_canvas_item_can_batch(Item *p_item, Light *p_light, int p_z) const {
+
+	Item *material_owner = p_item->material_owner ? p_item->material_owner : p_item;
+
+	if (material_owner->material.is_valid() || p_item->distance_field || p_item->copy_back_buffer || p_item->skeleton.is_valid() || p_item->light_masked)
+		return false;
+
+	// lit items are drawn again for every light, so they keep their own draw calls
+	for (Light *light = p_light; light; light = light->next_ptr) {
+
+		if (p_item->light_mask & light->item_mask && p_z >= light->z_min && p_z <= light->z_max && p_item->global_rect_cache.intersects_transformed(light->xform_cache, light->rect_cache))
+			return false;
+	}
+
+	return true;
+}
+
+bool RasterizerCanvasGLES2::_batch_add_rect(Item::CommandRect *p_rect) {
+
+	if (p_rect->flags & (CANVAS_RECT_TILE | CANVAS_RECT_CLIP_UV))
+		return false;
+
+	if (state.batch_quad_count && (p_rect->texture != state.batch_texture || state.batch_quad_count == data.batch_max_quads)) {
+		_batch_flush();
+	}
+
+	state.batch_texture = p_rect->texture;
+
+	RasterizerStorageGLES2::Texture *texture = storage->texture_owner.getornull(p_rect->texture);
+
+	// same math as the USE_TEXTURE_RECT path of the canvas shader, done on the CPU
+	Rect2 src_rect(0, 0, 1, 1);
+	Rect2 dst_rect = Rect2(p_rect->rect.position, p_rect->rect.size).abs();
+	bool transpose = false;
+
+	if (texture) {
+
+		texture = texture->get_ptr();
+
+		if (p_rect->flags & CANVAS_RECT_REGION) {
+			Size2 texpixel_size(1.0 / texture->width, 1.0 / texture->height);
+			src_rect = Rect2(p_rect->source.position * texpixel_size, p_rect->source.size * texpixel_size);
+		}
+
+		if (p_rect->flags & CANVAS_RECT_FLIP_H) {
+			src_rect.size.x *= -1;
+		}
+
+		if (p_rect->flags & CANVAS_RECT_FLIP_V) {
+			src_rect.size.y *= -1;
+		}
+
+		transpose = p_rect->flags & CANVAS_RECT_TRANSPOSE;
+	}
+
+	static const Vector2 corners[4] = {
+		Vector2(0, 0),
+		Vector2(1, 0),
+		Vector2(1, 1),
+		Vector2(0, 1)
+	};
+
+	Transform2D xform = state.uniforms.modelview_matrix * state.uniforms.extra_matrix;
+	Color color = p_rect->modulate * state.uniforms.final_modulate;
+	BatchVertex *v = &state.batch_vertices.write[state.batch_quad_count * 4];
+
+	for (int i = 0; i < 4; i++) {
+
+		Vector2 uv = transpose ? Vector2(corners[i].y, corners[i].x) : corners[i];
+		uv = src_rect.position + src_rect.size.abs() * uv;
+
+		Vector2 pos = corners[i];
+		if (src_rect.size.x < 0) {
+			pos.x = 1.0 - pos.x;
+		}
+		if (src_rect.size.y < 0) {
+			pos.y = 1.0 - pos.y;
+		}
+		pos = xform.xform(dst_rect.position + dst_rect.size * pos);
+
+		v[i].vertex[0] = pos.x;
+		v[i].vertex[1] = pos.y;
+		v[i].uv[0] = uv.x;
+		v[i].uv[1] = uv.y;
+		v[i].color[0] = color.r;
+		v[i].color[1] = color.g;
+		v[i].color[2] = color.b;
+		v[i].color[3] = color.a;
+	}
+
+	state.batch_quad_count++;
+
+	return true;
+}
+
+void RasterizerCanvasGLES2::_batch_flush() {
+
+	if (!state.batch_quad_count)
+		return;
+
+	state.canvas_shader.set_conditional(CanvasShaderGLES2::USE_TEXTURE_RECT, false);
+	if (state.canvas_shader.bind()) {
+		_set_uniforms();
+	}
+
+	RasterizerStorageGLES2::Texture *texture = _bind_canvas_texture(state.batch_texture, RID());
+
+	state.canvas_shader.set_uniform(CanvasShaderGLES2::COLOR_TEXPIXEL_SIZE, texture ? Vector2(1.0 / texture->width, 1.0 / texture->height) : Vector2());
+
+	// vertices are already in canvas space and carry the item modulate
+	state.canvas_shader.set_uniform(CanvasShaderGLES2::FINAL_MODULATE, Color(1, 1, 1, 1));
+	state.canvas_shader.set_uniform(CanvasShaderGLES2::MODELVIEW_MATRIX, Transform2D());
+	state.canvas_shader.set_uniform(CanvasShaderGLES2::EXTRA_MATRIX, Transform2D());
+
+	glBindBuffer(GL_ARRAY_BUFFER, data.batch_buffer);
+	// orphan the previous contents so the driver does not have to wait for the last batch
+	glBufferData(GL_ARRAY_BUFFER, data.batch_max_quads * 4 * sizeof(BatchVertex), NULL, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, state.batch_quad_count * 4 * sizeof(BatchVertex), state.batch_vertices.ptr());
+
+	glEnableVertexAttribArray(VS::ARRAY_VERTEX);
+	glVertexAttribPointer(VS::ARRAY_VERTEX, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), CAST_INT_TO_UCHAR_PTR(offsetof(BatchVertex, vertex)));
+	glEnableVertexAttribArray(VS::ARRAY_TEX_UV);
+	glVertexAttribPointer(VS::ARRAY_TEX_UV, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), CAST_INT_TO_UCHAR_PTR(offsetof(BatchVertex, uv)));
+	glEnableVertexAttribArray(VS::ARRAY_COLOR);
+	glVertexAttribPointer(VS::ARRAY_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), CAST_INT_TO_UCHAR_PTR(offsetof(BatchVertex, color)));
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.batch_index_buffer);
+	glDrawElements(GL_TRIANGLES, state.batch_quad_count * 6, GL_UNSIGNED_SHORT, 0);
+
+	glDisableVertexAttribArray(VS::ARRAY_TEX_UV);
+	glDisableVertexAttribArray(VS::ARRAY_COLOR);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	storage->info.render.draw_call_count++;
+
+	state.canvas_shader.set_uniform(CanvasShaderGLES2::FINAL_MODULATE, state.uniforms.final_modulate);
+	state.canvas_shader.set_uniform(CanvasShaderGLES2::MODELVIEW_MATRIX, state.uniforms.modelview_matrix);
+	state.canvas_shader.set_uniform(CanvasShaderGLES2::EXTRA_MATRIX, state.uniforms.extra_matrix);
+
+	state.batch_quad_count = 0;
+}
+
 void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip, RasterizerStorageGLES2::Material *p_material) {
 
 	int command_count = p_item->commands.size();
@@ -452,6 +608,13 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 
 		Item::Command *command = commands[i];
 
+		if (command->type == Item::Command::TYPE_RECT && state.batch_active && _batch_add_rect(static_cast<Item::CommandRect *>(command)))
+			continue;
+
+		if (state.batch_quad_count) {
+			_batch_flush();
+		}
+
 		switch (command->type) {
 
 			case Item::Command::TYPE_LINE: {
@@ -629,6 +792,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 						state.canvas_shader.set_uniform(CanvasShaderGLES2::SRC_RECT, Color(0, 0, 1, 1));
 
 						glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+						storage->info.render.draw_call_count++;
 					} else {
 
 						bool untile = false;
@@ -671,6 +835,7 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 						state.canvas_shader.set_uniform(CanvasShaderGLES2::SRC_RECT, Color(src_rect.position.x, src_rect.position.y, src_rect.size.x, src_rect.size.y));
 
 						glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+						storage->info.render.draw_call_count++;
 
 						if (untile) {
 							glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -844,6 +1009,8 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 
 				glDrawElements(GL_TRIANGLES, 18 * 3 - (np->draw_center ? 0 : 6), GL_UNSIGNED_BYTE, NULL);
 
+				storage->info.render.draw_call_count++;
+
 				glBindBuffer(GL_ARRAY_BUFFER, 0);
 				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
@@ -953,6 +1120,8 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 						} else {
 							glDrawArrays(gl_primitive[s->primitive], 0, s->array_len);
 						}
+
+						storage->info.render.draw_call_count++;
 					}
 
 					for (int j = 1; j < VS::ARRAY_MAX - 1; j++) {
@@ -1074,6 +1243,8 @@ void RasterizerCanvasGLES2::_canvas_item_render_commands(Item *p_item, Item *cur
 						} else {
 							glDrawArrays(gl_primitive[s->primitive], 0, s->array_len);
 						}
+
+						storage->info.render.draw_call_count++;
 					}
 				}
 
@@ -1281,6 +1452,13 @@ void RasterizerCanvasGLES2::canvas_render_items(Item *p_item_list, int p_z, cons
 
 		Item *ci = p_item_list;
 
+		bool can_batch = state.use_batching && _canvas_item_can_batch(ci, p_light, p_z);
+
+		if (state.batch_quad_count && (!can_batch || current_clip != ci->final_clip_owner)) {
+			// anything that changes GL state must see the pending batch drawn first
+			_batch_flush();
+		}
+
 		if (current_clip != ci->final_clip_owner) {
 
 			current_clip = ci->final_clip_owner;
@@ -1504,8 +1682,11 @@ void RasterizerCanvasGLES2::canvas_render_items(Item *p_item_list, int p_z, cons
 
 		_set_uniforms();
 
-		if (unshaded || (state.uniforms.final_modulate.a > 0.001 && (!shader_cache || shader_cache->canvas_item.light_mode != RasterizerStorageGLES2::Shader::CanvasItem::LIGHT_MODE_LIGHT_ONLY) && !ci->light_masked))
+		if (unshaded || (state.uniforms.final_modulate.a > 0.001 && (!shader_cache || shader_cache->canvas_item.light_mode != RasterizerStorageGLES2::Shader::CanvasItem::LIGHT_MODE_LIGHT_ONLY) && !ci->light_masked)) {
+			state.batch_active = can_batch;
 			_canvas_item_render_commands(p_item_list, NULL, reclip, material_ptr);
+			state.batch_active = false;
+		}
 
 		rebind_shader = true; // hacked in for now.
 
@@ -1633,6 +1814,8 @@ void RasterizerCanvasGLES2::canvas_render_items(Item *p_item_list, int p_z, cons
 		}
 
 		if (reclip) {
+			_batch_flush();
+
 			glEnable(GL_SCISSOR_TEST);
 			int y = storage->frame.current_rt->height - (current_clip->final_clip_rect.position.y + current_clip->final_clip_rect.size.y);
 			if (storage->frame.current_rt->flags[RasterizerStorage::RENDER_TARGET_VFLIP])
@@ -1643,6 +1826,8 @@ void RasterizerCanvasGLES2::canvas_render_items(Item *p_item_list, int p_z, cons
 		p_item_list = p_item_list->next;
 	}
 
+	_batch_flush();
+
 	if (current_clip) {
 		glDisable(GL_SCISSOR_TEST);
 	}
@@ -1951,6 +2136,42 @@ void RasterizerCanvasGLES2::initialize() {
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
+	// batch buffers
+	{
+		uint32_t batch_size = GLOBAL_DEF("rendering/limits/buffers/canvas_batch_buffer_size_kb", 128);
+		ProjectSettings::get_singleton()->set_custom_property_info("rendering/limits/buffers/canvas_batch_buffer_size_kb", PropertyInfo(Variant::INT, "rendering/limits/buffers/canvas_batch_buffer_size_kb", PROPERTY_HINT_RANGE, "0,256,1,or_greater"));
+		batch_size *= 1024; // kb
+		// quads are indexed with 16 bits
+		data.batch_max_quads = CLAMP(batch_size / (sizeof(BatchVertex) * 4), 1, 16384);
+		state.batch_vertices.resize(data.batch_max_quads * 4);
+		state.batch_quad_count = 0;
+		state.batch_active = false;
+
+		glGenBuffers(1, &data.batch_buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, data.batch_buffer);
+		glBufferData(GL_ARRAY_BUFFER, data.batch_max_quads * 4 * sizeof(BatchVertex), NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		Vector<uint16_t> indices;
+		indices.resize(data.batch_max_quads * 6);
+		{
+			uint16_t *w = indices.ptrw();
+			for (uint32_t i = 0; i < data.batch_max_quads; i++) {
+				w[i * 6 + 0] = i * 4 + 0;
+				w[i * 6 + 1] = i * 4 + 1;
+				w[i * 6 + 2] = i * 4 + 2;
+				w[i * 6 + 3] = i * 4 + 0;
+				w[i * 6 + 4] = i * 4 + 2;
+				w[i * 6 + 5] = i * 4 + 3;
+			}
+		}
+
+		glGenBuffers(1, &data.batch_index_buffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, data.batch_index_buffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.ptr(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
 	// ninepatch buffers
 	{
 		// array buffer
@@ -2027,12 +2248,17 @@ void RasterizerCanvasGLES2::initialize() {
 
 	state.canvas_shader.set_conditional(CanvasShaderGLES2::USE_PIXEL_SNAP, GLOBAL_DEF("rendering/quality/2d/use_pixel_snap", false));
 
+	state.use_batching = GLOBAL_DEF("rendering/quality/2d/use_batching", true);
+
 	state.using_light = NULL;
 	state.using_transparent_rt = false;
 	state.using_skeleton = false;
 }
 
 void RasterizerCanvasGLES2::finalize() {
+
+	glDeleteBuffers(1, &data.batch_buffer);
+	glDeleteBuffers(1, &data.batch_index_buffer);
 }
 
 RasterizerCanvasGLES2::RasterizerCanvasGLES2() {
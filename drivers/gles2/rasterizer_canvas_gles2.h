@@ -58,6 +58,13 @@ public:
 		float time;
 	};
 
+	struct BatchVertex {
+
+		float vertex[2];
+		float uv[2];
+		float color[4];
+	};
+
 	struct Data {
 
 		GLuint canvas_quad_vertices;
@@ -69,6 +76,11 @@ public:
 		GLuint ninepatch_vertices;
 		GLuint ninepatch_elements;
 
+		GLuint batch_buffer;
+		GLuint batch_index_buffer;
+
+		uint32_t batch_max_quads;
+
 	} data;
 
 	struct State {
@@ -95,6 +107,12 @@ public:
 		bool using_shadow;
 		bool using_transparent_rt;
 
+		bool use_batching;
+		bool batch_active;
+		RID batch_texture;
+		Vector<BatchVertex> batch_vertices;
+		uint32_t batch_quad_count;
+
 	} state;
 
 	typedef void Texture;
@@ -118,6 +136,10 @@ public:
 	_FORCE_INLINE_ void _draw_polygon(const int *p_indices, int p_index_count, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor, const float *p_weights = NULL, const int *p_bones = NULL);
 	_FORCE_INLINE_ void _draw_generic(GLuint p_primitive, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor);
 
+	_FORCE_INLINE_ bool _canvas_item_can_batch(Item *p_item, Light *p_light, int p_z) const;
+	_FORCE_INLINE_ bool _batch_add_rect(Item::CommandRect *p_rect);
+	void _batch_flush();
+
 	_FORCE_INLINE_ void _canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip, RasterizerStorageGLES2::Material *p_material);
 	void _copy_screen(const Rect2 &p_rect);
 	_FORCE_INLINE_ void _copy_texscreen(const Rect2 &p_rect);
@@ -215,6 +215,10 @@ public:
 		Vector2 viewport_size;
 
 		Vector2 screen_pixel_size;
+
+		float texture_stream_pixels_per_meter; // zero when sizes are not reported to streamed textures
+		bool texture_stream_orthogonal;
+		int texture_stream_size;
 	} state;
 
 	/* SHADOW ATLAS API */
@@ -647,6 +651,7 @@ public:
 	void _add_geometry_with_material(RasterizerStorageGLES2::Geometry *p_geometry, InstanceBase *p_instance, RasterizerStorageGLES2::GeometryOwner *p_owner, RasterizerStorageGLES2::Material *p_material, bool p_depth_pass, bool p_shadow_pass);
 
 	void _fill_render_list(InstanceBase **p_cull_result, int p_cull_count, bool p_depth_pass, bool p_shadow_pass);
+	void _setup_texture_streaming(const CameraMatrix &p_cam_projection, bool p_cam_ortogonal, int p_viewport_width);
 	void _render_render_list(RenderList::Element **p_elements, int p_element_count,
 			const Transform &p_view_transform,
 			const CameraMatrix &p_projection,
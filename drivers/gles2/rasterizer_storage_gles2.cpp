@@ -1089,6 +1089,20 @@ void RasterizerStorageGLES2::texture_set_detect_normal_callback(RID p_texture, V
 	texture->detect_normal_ud = p_userdata;
 }
 
+void RasterizerStorageGLES2::texture_set_stream_callback(RID p_texture, VisualServer::TextureStreamCallback p_callback, void *p_userdata) {
+	Texture *texture = texture_owner.get(p_texture);
+	ERR_FAIL_COND(!texture);
+
+	if (!texture->stream_callback && p_callback) {
+		texture_stream_count++;
+	} else if (texture->stream_callback && !p_callback) {
+		texture_stream_count--;
+	}
+
+	texture->stream_callback = p_callback;
+	texture->stream_ud = p_userdata;
+}
+
 RID RasterizerStorageGLES2::texture_create_radiance_cubemap(RID p_source, int p_resolution) const {
 
 	return RID();
@@ -5106,6 +5120,8 @@ bool RasterizerStorageGLES2::free(RID p_rid) {
 		// can't free a render target texture
 		ERR_FAIL_COND_V(t->render_target, true);
 
+		if (t->stream_callback)
+			texture_stream_count--;
 		info.texture_mem -= t->total_data_size;
 		texture_owner.free(p_rid);
 		memdelete(t);
@@ -5514,6 +5530,7 @@ void RasterizerStorageGLES2::initialize() {
 	config.support_shadow_cubemaps = config.support_depth_texture && config.support_write_depth && config.support_depth_cubemaps;
 
 	frame.count = 0;
+	texture_stream_count = 0;
 	frame.delta = 0;
 	frame.current_rt = NULL;
 	frame.clear_request = false;
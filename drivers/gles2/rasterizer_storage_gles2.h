@@ -278,6 +278,9 @@ public:
 		VisualServer::TextureDetectCallback detect_normal;
 		void *detect_normal_ud;
 
+		VisualServer::TextureStreamCallback stream_callback;
+		void *stream_ud;
+
 		Texture() :
 				proxy(NULL),
 				flags(0),
@@ -304,7 +307,9 @@ public:
 				detect_srgb(NULL),
 				detect_srgb_ud(NULL),
 				detect_normal(NULL),
-				detect_normal_ud(NULL) {
+				detect_normal_ud(NULL),
+				stream_callback(NULL),
+				stream_ud(NULL) {
 		}
 
 		_ALWAYS_INLINE_ Texture *get_ptr() {
@@ -366,6 +371,9 @@ public:
 	virtual void texture_set_detect_3d_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata);
 	virtual void texture_set_detect_srgb_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata);
 	virtual void texture_set_detect_normal_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata);
+	virtual void texture_set_stream_callback(RID p_texture, VisualServer::TextureStreamCallback p_callback, void *p_userdata);
+
+	int texture_stream_count; // sizes are only reported to streamed textures while there are any
 
 	virtual void texture_set_force_redraw_if_visible(RID p_texture, bool p_enable);
 
@@ -1245,7 +1253,6 @@ public:
 
 		bool clear_request;
 		Color clear_request_color;
-		int canvas_draw_commands;
 		float time[4];
 		float delta;
 		uint64_t count;
@@ -48,6 +48,13 @@ public:
 		uint8_t padding[12];
 	};
 
+	struct BatchVertex {
+
+		float vertex[2];
+		float uv[2];
+		float color[4];
+	};
+
 	RasterizerSceneGLES3 *scene_render;
 
 	struct Data {
@@ -65,6 +72,12 @@ public:
 
 		uint32_t polygon_buffer_size;
 
+		GLuint batch_buffer;
+		GLuint batch_index_buffer;
+		GLuint batch_array;
+
+		uint32_t batch_max_quads;
+
 	} data;
 
 	struct State {
@@ -91,6 +104,12 @@ public:
 		Transform2D skeleton_transform;
 		Transform2D skeleton_transform_inverse;
 
+		bool use_batching;
+		bool batch_active;
+		RID batch_texture;
+		Vector<BatchVertex> batch_vertices;
+		uint32_t batch_quad_count;
+
 	} state;
 
 	RasterizerStorageGLES3 *storage;
@@ -132,6 +151,10 @@ public:
 	_FORCE_INLINE_ void _draw_polygon(const int *p_indices, int p_index_count, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor, const int *p_bones, const float *p_weights);
 	_FORCE_INLINE_ void _draw_generic(GLuint p_primitive, int p_vertex_count, const Vector2 *p_vertices, const Vector2 *p_uvs, const Color *p_colors, bool p_singlecolor);
 
+	_FORCE_INLINE_ bool _canvas_item_can_batch(Item *p_item, Light *p_light, int p_z) const;
+	_FORCE_INLINE_ bool _batch_add_rect(Item::CommandRect *p_rect);
+	void _batch_flush();
+
 	_FORCE_INLINE_ void _canvas_item_render_commands(Item *p_item, Item *current_clip, bool &reclip);
 	_FORCE_INLINE_ void _copy_texscreen(const Rect2 &p_rect);
 
@@ -2327,6 +2327,19 @@ void RasterizerSceneGLES3::_add_geometry(RasterizerStorageGLES3::Geometry *p_geo
 
 void RasterizerSceneGLES3::_add_geometry_with_material(RasterizerStorageGLES3::Geometry *p_geometry, InstanceBase *p_instance, RasterizerStorageGLES3::GeometryOwner *p_owner, RasterizerStorageGLES3::Material *p_material, bool p_depth_pass, bool p_shadow_pass) {
 
+	if (state.texture_stream_size > 0) {
+
+		int tc = p_material->textures.size();
+		for (int i = 0; i < tc; i++) {
+
+			RasterizerStorageGLES3::Texture *t = storage->texture_owner.getornull(p_material->textures[i]);
+			if (t && t->get_ptr()->stream_callback) {
+				t = t->get_ptr();
+				t->stream_callback(t->stream_ud, state.texture_stream_size);
+			}
+		}
+	}
+
 	bool has_base_alpha = (p_material->shader->spatial.uses_alpha && !p_material->shader->spatial.uses_alpha_scissor) || p_material->shader->spatial.uses_screen_texture || p_material->shader->spatial.uses_depth_texture;
 	bool has_blend_alpha = p_material->shader->spatial.blend_mode != RasterizerStorageGLES3::Shader::Spatial::BLEND_MODE_MIX;
 	bool has_alpha = has_base_alpha || has_blend_alpha;
@@ -3176,6 +3189,17 @@ void RasterizerSceneGLES3::_fill_render_list(InstanceBase **p_cull_result, int p
 	for (int i = 0; i < p_cull_count; i++) {
 
 		InstanceBase *inst = p_cull_result[i];
+
+		state.texture_stream_size = 0;
+		if (!p_depth_pass && state.texture_stream_pixels_per_meter > 0) {
+			//rough amount of pixels the instance covers, textures are assumed to span it once
+			float size = inst->transformed_aabb.get_longest_axis_size();
+			float pixels = size * state.texture_stream_pixels_per_meter;
+			if (!state.texture_stream_orthogonal) {
+				pixels /= MAX(inst->depth - size * 0.5, 0.1);
+			}
+			state.texture_stream_size = MAX(int(MIN(pixels, 16384.0f)), 1);
+		}
 		switch (inst->base_type) {
 
 			case VS::INSTANCE_MESH: {
@@ -3253,6 +3277,17 @@ void RasterizerSceneGLES3::_fill_render_list(InstanceBase **p_cull_result, int p
 	}
 }
 
+void RasterizerSceneGLES3::_setup_texture_streaming(const CameraMatrix &p_cam_projection, bool p_cam_ortogonal, int p_viewport_width) {
+
+	state.texture_stream_pixels_per_meter = 0;
+	state.texture_stream_orthogonal = p_cam_ortogonal;
+
+	if (storage->texture_stream_count > 0) {
+		//pixels per meter at a distance of one meter (or at any distance, when orthogonal)
+		state.texture_stream_pixels_per_meter = p_cam_projection.matrix[0][0] * 0.5 * p_viewport_width;
+	}
+}
+
 void RasterizerSceneGLES3::_blur_effect_buffer() {
 
 	//blur diffuse into effect mipmaps using separatable convolution
@@ -4244,6 +4279,7 @@ void RasterizerSceneGLES3::render_scene(const Transform &p_cam_transform, const
 	bool use_mrt = false;
 
 	render_list.clear();
+	_setup_texture_streaming(p_cam_projection, p_cam_ortogonal, p_reflection_probe.is_valid() || !storage->frame.current_rt ? 0 : storage->frame.current_rt->width);
 	_fill_render_list(p_cull_result, p_cull_count, false, false);
 	//
 
@@ -4935,6 +4971,10 @@ void RasterizerSceneGLES3::initialize() {
 
 	render_pass = 0;
 
+	state.texture_stream_pixels_per_meter = 0;
+	state.texture_stream_orthogonal = false;
+	state.texture_stream_size = 0;
+
 	state.scene_shader.init();
 
 	{
@@ -211,6 +211,10 @@ public:
 		bool prepared_depth_texture;
 		bool bound_depth_texture;
 
+		float texture_stream_pixels_per_meter; // zero when sizes are not reported to streamed textures
+		bool texture_stream_orthogonal;
+		int texture_stream_size;
+
 		VS::ViewportDebugDraw debug_draw;
 	} state;
 
@@ -846,6 +850,7 @@ public:
 	void _copy_texture_to_front_buffer(GLuint p_texture); //used for debug
 
 	void _fill_render_list(InstanceBase **p_cull_result, int p_cull_count, bool p_depth_pass, bool p_shadow_pass);
+	void _setup_texture_streaming(const CameraMatrix &p_cam_projection, bool p_cam_ortogonal, int p_viewport_width);
 
 	void _blur_effect_buffer();
 	void _render_mrts(Environment *env, const CameraMatrix &p_cam_projection);
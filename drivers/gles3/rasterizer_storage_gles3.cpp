@@ -1548,6 +1548,20 @@ void RasterizerStorageGLES3::texture_set_detect_normal_callback(RID p_texture, V
 	texture->detect_normal_ud = p_userdata;
 }
 
+void RasterizerStorageGLES3::texture_set_stream_callback(RID p_texture, VisualServer::TextureStreamCallback p_callback, void *p_userdata) {
+	Texture *texture = texture_owner.get(p_texture);
+	ERR_FAIL_COND(!texture);
+
+	if (!texture->stream_callback && p_callback) {
+		texture_stream_count++;
+	} else if (texture->stream_callback && !p_callback) {
+		texture_stream_count--;
+	}
+
+	texture->stream_callback = p_callback;
+	texture->stream_ud = p_userdata;
+}
+
 RID RasterizerStorageGLES3::texture_create_radiance_cubemap(RID p_source, int p_resolution) const {
 
 	Texture *texture = texture_owner.get(p_source);
@@ -7624,6 +7638,8 @@ bool RasterizerStorageGLES3::free(RID p_rid) {
 		// delete the texture
 		Texture *texture = texture_owner.get(p_rid);
 		ERR_FAIL_COND_V(texture->render_target, true); //can't free the render target texture, dude
+		if (texture->stream_callback)
+			texture_stream_count--;
 		info.texture_mem -= texture->total_data_size;
 		texture_owner.free(p_rid);
 		memdelete(texture);
@@ -8142,6 +8158,7 @@ void RasterizerStorageGLES3::initialize() {
 #endif
 
 	frame.count = 0;
+	texture_stream_count = 0;
 	frame.delta = 0;
 	frame.current_rt = NULL;
 	config.keep_original_textures = false;
@@ -287,6 +287,9 @@ public:
 		VisualServer::TextureDetectCallback detect_normal;
 		void *detect_normal_ud;
 
+		VisualServer::TextureStreamCallback stream_callback;
+		void *stream_ud;
+
 		Texture() :
 				proxy(NULL),
 				flags(0),
@@ -311,7 +314,9 @@ public:
 				detect_srgb(NULL),
 				detect_srgb_ud(NULL),
 				detect_normal(NULL),
-				detect_normal_ud(NULL) {
+				detect_normal_ud(NULL),
+				stream_callback(NULL),
+				stream_ud(NULL) {
 		}
 
 		_ALWAYS_INLINE_ Texture *get_ptr() {
@@ -372,6 +377,9 @@ public:
 	virtual void texture_set_detect_3d_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata);
 	virtual void texture_set_detect_srgb_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata);
 	virtual void texture_set_detect_normal_callback(RID p_texture, VisualServer::TextureDetectCallback p_callback, void *p_userdata);
+	virtual void texture_set_stream_callback(RID p_texture, VisualServer::TextureStreamCallback p_callback, void *p_userdata);
+
+	int texture_stream_count; // sizes are only reported to streamed textures while there are any
 
 	virtual void texture_set_proxy(RID p_texture, RID p_proxy);
 	virtual Size2 texture_size_with_proxy(RID p_texture) const;
@@ -1441,7 +1449,6 @@ public:
 
 		bool clear_request;
 		Color clear_request_color;
-		int canvas_draw_commands;
 		float time[4];
 		float delta;
 		uint64_t count;
@@ -32,6 +32,7 @@
 
 #if defined(UNIX_ENABLED) || defined(LIBC_FILEIO_ENABLED)
 
+#include "core/io/marshalls.h"
 #include "core/os/os.h"
 #include "core/print_string.h"
 
@@ -39,6 +40,8 @@
 #include <sys/types.h>
 
 #if defined(UNIX_ENABLED)
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -64,11 +67,49 @@ void FileAccessUnix::check_errors() const {
 	}
 }
 
+bool FileAccessUnix::_map(const String &p_path) {
+
+#ifdef UNIX_ENABLED
+	int fd = ::open(p_path.utf8().get_data(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	void *data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	::close(fd); // the mapping keeps the file referenced
+
+	if (data == MAP_FAILED)
+		return false;
+
+	mapped = (uint8_t *)data;
+	mapped_len = st.st_size;
+	mapped_pos = 0;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void FileAccessUnix::_unmap() {
+
+#ifdef UNIX_ENABLED
+	if (mapped)
+		munmap(mapped, mapped_len);
+#endif
+	mapped = NULL;
+	mapped_len = 0;
+	mapped_pos = 0;
+}
+
 Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
 
 	if (f)
 		fclose(f);
 	f = NULL;
+	_unmap();
 
 	path_src = p_path;
 	path = fix_path(p_path);
@@ -109,6 +150,13 @@ Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
 		path = path + ".tmp";
 	}
 
+	// user:// files are likely to be rewritten while open, mapping them could fault on truncation
+	if (p_mode_flags == READ && is_memory_map_enabled() && get_access_type() != ACCESS_USERDATA && _map(path)) {
+		last_error = OK;
+		flags = p_mode_flags;
+		return OK;
+	}
+
 	f = fopen(path.utf8().get_data(), mode_string);
 
 	if (f == NULL) {
@@ -123,11 +171,15 @@ Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
 
 void FileAccessUnix::close() {
 
-	if (!f)
+	if (!f && !mapped)
 		return;
 
-	fclose(f);
-	f = NULL;
+	if (mapped) {
+		_unmap();
+	} else {
+		fclose(f);
+		f = NULL;
+	}
 
 	if (close_notification_func) {
 		close_notification_func(path, flags);
@@ -147,7 +199,7 @@ void FileAccessUnix::close() {
 
 bool FileAccessUnix::is_open() const {
 
-	return (f != NULL);
+	return (f != NULL || mapped != NULL);
 }
 
 String FileAccessUnix::get_path() const {
@@ -162,6 +214,12 @@ String FileAccessUnix::get_path_absolute() const {
 
 void FileAccessUnix::seek(size_t p_position) {
 
+	if (mapped) {
+		last_error = OK;
+		mapped_pos = p_position;
+		return;
+	}
+
 	ERR_FAIL_COND(!f);
 
 	last_error = OK;
@@ -171,6 +229,12 @@ void FileAccessUnix::seek(size_t p_position) {
 
 void FileAccessUnix::seek_end(int64_t p_position) {
 
+	if (mapped) {
+		ERR_FAIL_COND(int64_t(mapped_len) + p_position < 0);
+		mapped_pos = mapped_len + p_position;
+		return;
+	}
+
 	ERR_FAIL_COND(!f);
 
 	if (fseek(f, p_position, SEEK_END))
@@ -179,6 +243,9 @@ void FileAccessUnix::seek_end(int64_t p_position) {
 
 size_t FileAccessUnix::get_position() const {
 
+	if (mapped)
+		return mapped_pos;
+
 	ERR_FAIL_COND_V(!f, 0);
 
 	long pos = ftell(f);
@@ -191,6 +258,9 @@ size_t FileAccessUnix::get_position() const {
 
 size_t FileAccessUnix::get_len() const {
 
+	if (mapped)
+		return mapped_len;
+
 	ERR_FAIL_COND_V(!f, 0);
 
 	long pos = ftell(f);
@@ -210,6 +280,14 @@ bool FileAccessUnix::eof_reached() const {
 
 uint8_t FileAccessUnix::get_8() const {
 
+	if (mapped) {
+		if (mapped_pos >= mapped_len) {
+			last_error = ERR_FILE_EOF;
+			return 0;
+		}
+		return mapped[mapped_pos++];
+	}
+
 	ERR_FAIL_COND_V(!f, 0);
 	uint8_t b;
 	if (fread(&b, 1, 1, f) == 0) {
@@ -219,14 +297,65 @@ uint8_t FileAccessUnix::get_8() const {
 	return b;
 }
 
+uint16_t FileAccessUnix::get_16() const {
+
+	if (!mapped || mapped_pos + 2 > mapped_len)
+		return FileAccess::get_16();
+
+	uint16_t res = decode_uint16(&mapped[mapped_pos]);
+	mapped_pos += 2;
+	return endian_swap ? BSWAP16(res) : res;
+}
+
+uint32_t FileAccessUnix::get_32() const {
+
+	if (!mapped || mapped_pos + 4 > mapped_len)
+		return FileAccess::get_32();
+
+	uint32_t res = decode_uint32(&mapped[mapped_pos]);
+	mapped_pos += 4;
+	return endian_swap ? BSWAP32(res) : res;
+}
+
+uint64_t FileAccessUnix::get_64() const {
+
+	if (!mapped || mapped_pos + 8 > mapped_len)
+		return FileAccess::get_64();
+
+	uint64_t res = decode_uint64(&mapped[mapped_pos]);
+	mapped_pos += 8;
+	return endian_swap ? BSWAP64(res) : res;
+}
+
 int FileAccessUnix::get_buffer(uint8_t *p_dst, int p_length) const {
 
+	if (mapped) {
+		ERR_FAIL_COND_V(p_length < 0, -1);
+
+		int read = mapped_pos < mapped_len ? MIN(size_t(p_length), mapped_len - mapped_pos) : 0;
+		copymem(p_dst, &mapped[mapped_pos], read);
+		mapped_pos += read;
+		if (read < p_length)
+			last_error = ERR_FILE_EOF;
+		return read;
+	}
+
 	ERR_FAIL_COND_V(!f, -1);
 	int read = fread(p_dst, 1, p_length, f);
 	check_errors();
 	return read;
 };
 
+const uint8_t *FileAccessUnix::map_buffer(int p_length) const {
+
+	if (!mapped || p_length < 0 || mapped_pos > mapped_len || size_t(p_length) > mapped_len - mapped_pos)
+		return NULL;
+
+	const uint8_t *ptr = &mapped[mapped_pos];
+	mapped_pos += p_length;
+	return ptr;
+}
+
 Error FileAccessUnix::get_error() const {
 
 	return last_error;
@@ -312,6 +441,9 @@ CloseNotificationFunc FileAccessUnix::close_notification_func = NULL;
 FileAccessUnix::FileAccessUnix() :
 		f(NULL),
 		flags(0),
+		mapped(NULL),
+		mapped_len(0),
+		mapped_pos(0),
 		last_error(OK) {
 }
 
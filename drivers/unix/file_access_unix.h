@@ -48,6 +48,15 @@ class FileAccessUnix : public FileAccess {
 
 	FILE *f;
 	int flags;
+
+	// read only files are memory mapped when possible, f is NULL then
+	uint8_t *mapped;
+	size_t mapped_len;
+	mutable size_t mapped_pos;
+
+	bool _map(const String &p_path);
+	void _unmap();
+
 	void check_errors() const;
 	mutable Error last_error;
 	String save_path;
@@ -74,7 +83,11 @@ public:
 	virtual bool eof_reached() const; ///< reading passed EOF
 
 	virtual uint8_t get_8() const; ///< get a byte
+	virtual uint16_t get_16() const;
+	virtual uint32_t get_32() const;
+	virtual uint64_t get_64() const;
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+	virtual const uint8_t *map_buffer(int p_length) const;
 
 	virtual Error get_error() const; ///< get last error
 
@@ -31,6 +31,7 @@
 #include "editor_export.h"
 
 #include "core/io/config_file.h"
+#include "core/io/pck_packer.h"
 #include "core/io/resource_loader.h"
 #include "core/io/resource_saver.h"
 #include "core/io/zip_io.h"
@@ -43,18 +44,6 @@
 #include "editor_node.h"
 #include "editor_settings.h"
 #include "scene/resources/resource_format_text.h"
-#include "thirdparty/misc/md5.h"
-
-static int _get_pad(int p_alignment, int p_n) {
-
-	int rest = p_n % p_alignment;
-	int pad = 0;
-	if (rest > 0) {
-		pad = p_alignment - rest;
-	};
-
-	return pad;
-}
 
 #define PCK_PADDING 16
 
@@ -311,33 +300,11 @@ Error EditorExportPlatform::_save_pack_file(void *p_userdata, const String &p_pa
 
 	PackData *pd = (PackData *)p_userdata;
 
-	SavedData sd;
-	sd.path_utf8 = p_path.utf8();
-	sd.ofs = pd->f->get_position();
-	sd.size = p_data.size();
-
-	pd->f->store_buffer(p_data.ptr(), p_data.size());
-	int pad = _get_pad(PCK_PADDING, sd.size);
-	for (int i = 0; i < pad; i++) {
-		pd->f->store_8(0);
-	}
-
-	{
-		MD5_CTX ctx;
-		MD5Init(&ctx);
-		MD5Update(&ctx, (unsigned char *)p_data.ptr(), p_data.size());
-		MD5Final(&ctx);
-		sd.md5.resize(16);
-		for (int i = 0; i < 16; i++) {
-			sd.md5.write[i] = ctx.digest[i];
-		}
-	}
-
-	pd->file_ofs.push_back(sd);
+	Error err = pd->packer->add_file_data(p_path, p_data, pd->compress);
 
 	pd->ep->step(TTR("Storing File:") + " " + p_path, 2 + p_file * 100 / p_total, false);
 
-	return OK;
+	return err;
 }
 
 Error EditorExportPlatform::_save_zip_file(void *p_userdata, const String &p_path, const Vector<uint8_t> &p_data, int p_file, int p_total) {
@@ -886,98 +853,22 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 
 	EditorProgress ep("savepack", TTR("Packing"), 102);
 
-	String tmppath = EditorSettings::get_singleton()->get_cache_dir().plus_file("packtmp");
-	FileAccess *ftmp = FileAccess::open(tmppath, FileAccess::WRITE);
-	ERR_FAIL_COND_V(!ftmp, ERR_CANT_CREATE)
+	Ref<PCKPacker> packer;
+	packer.instance();
+	Error err = packer->pck_start(p_path, PCK_PADDING);
+	ERR_FAIL_COND_V(err != OK, ERR_CANT_CREATE);
 
 	PackData pd;
 	pd.ep = &ep;
-	pd.f = ftmp;
+	pd.packer = packer.ptr();
+	pd.compress = GLOBAL_GET("editor/compress_pck_files_on_export");
 	pd.so_files = p_so_files;
 
-	Error err = export_project_files(p_preset, _save_pack_file, &pd, _add_shared_object);
-
-	memdelete(ftmp); //close tmp file
-
+	err = export_project_files(p_preset, _save_pack_file, &pd, _add_shared_object);
 	if (err)
 		return err;
 
-	pd.file_ofs.sort(); //do sort, so we can do binary search later
-
-	FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE);
-	ERR_FAIL_COND_V(!f, ERR_CANT_CREATE)
-	f->store_32(0x43504447); //GDPK
-	f->store_32(1); //pack version
-	f->store_32(VERSION_MAJOR);
-	f->store_32(VERSION_MINOR);
-	f->store_32(0); //hmph
-	for (int i = 0; i < 16; i++) {
-		//reserved
-		f->store_32(0);
-	}
-
-	f->store_32(pd.file_ofs.size()); //amount of files
-
-	size_t header_size = f->get_position();
-
-	//precalculate header size
-
-	for (int i = 0; i < pd.file_ofs.size(); i++) {
-		header_size += 4; // size of path string (32 bits is enough)
-		uint32_t string_len = pd.file_ofs[i].path_utf8.length();
-		header_size += string_len + _get_pad(4, string_len); ///size of path string
-		header_size += 8; // offset to file _with_ header size included
-		header_size += 8; // size of file
-		header_size += 16; // md5
-	}
-
-	size_t header_padding = _get_pad(PCK_PADDING, header_size);
-
-	for (int i = 0; i < pd.file_ofs.size(); i++) {
-
-		uint32_t string_len = pd.file_ofs[i].path_utf8.length();
-		uint32_t pad = _get_pad(4, string_len);
-		;
-		f->store_32(string_len + pad);
-		f->store_buffer((const uint8_t *)pd.file_ofs[i].path_utf8.get_data(), string_len);
-		for (uint32_t j = 0; j < pad; j++) {
-			f->store_8(0);
-		}
-
-		f->store_64(pd.file_ofs[i].ofs + header_padding + header_size);
-		f->store_64(pd.file_ofs[i].size); // pay attention here, this is where file is
-		f->store_buffer(pd.file_ofs[i].md5.ptr(), 16); //also save md5 for file
-	}
-
-	for (uint32_t j = 0; j < header_padding; j++) {
-		f->store_8(0);
-	}
-
-	//save the rest of the data
-
-	ftmp = FileAccess::open(tmppath, FileAccess::READ);
-	if (!ftmp) {
-		memdelete(f);
-		ERR_FAIL_COND_V(!ftmp, ERR_CANT_CREATE)
-	}
-
-	const int bufsize = 16384;
-	uint8_t buf[bufsize];
-
-	while (true) {
-
-		int got = ftmp->get_buffer(buf, bufsize);
-		if (got <= 0)
-			break;
-		f->store_buffer(buf, got);
-	}
-
-	memdelete(ftmp);
-
-	f->store_32(0x43504447); //GDPK
-	memdelete(f);
-
-	return OK;
+	return packer->flush();
 }
 
 Error EditorExportPlatform::save_zip(const Ref<EditorExportPreset> &p_preset, const String &p_path) {
@@ -1346,6 +1237,8 @@ EditorExport::EditorExport() {
 	save_timer->connect("timeout", this, "_save");
 	block_save = false;
 
+	GLOBAL_DEF("editor/compress_pck_files_on_export", false);
+
 	singleton = this;
 }
 
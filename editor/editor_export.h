@@ -38,6 +38,7 @@
 #include "scene/resources/texture.h"
 
 class FileAccess;
+class PCKPacker;
 class EditorExportPlatform;
 class EditorFileSystemDirectory;
 struct EditorProgress;
@@ -159,22 +160,10 @@ public:
 	typedef Error (*EditorExportSaveSharedObject)(void *p_userdata, const SharedObject &p_so);
 
 private:
-	struct SavedData {
-
-		uint64_t ofs;
-		uint64_t size;
-		Vector<uint8_t> md5;
-		CharString path_utf8;
-
-		bool operator<(const SavedData &p_data) const {
-			return path_utf8 < p_data.path_utf8;
-		}
-	};
-
 	struct PackData {
 
-		FileAccess *f;
-		Vector<SavedData> file_ofs;
+		PCKPacker *packer;
+		bool compress;
 		EditorProgress *ep;
 		Vector<SharedObject> *so_files;
 	};
@@ -41,7 +41,9 @@
 #include "core/io/stream_peer_tcp.h"
 #include "core/message_queue.h"
 #include "core/os/dir_access.h"
+#include "core/os/file_access.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/project_settings.h"
 #include "core/register_core_types.h"
 #include "core/script_debugger_local.h"
@@ -136,6 +138,7 @@ static bool force_lowdpi = false;
 // Debug
 
 static bool use_debug_profiler = false;
+static String profile_script_path;
 #ifdef DEBUG_ENABLED
 static bool debug_collisions = false;
 static bool debug_navigation = false;
@@ -263,6 +266,7 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("  -b, --breakpoints                Breakpoint list as source::line comma-separated pairs, no spaces (use %%20 instead).\n");
 	OS::get_singleton()->print("  --profiling                      Enable profiling in the script debugger.\n");
 	OS::get_singleton()->print("  --remote-debug <address>         Remote debug (<host/IP>:<port> address).\n");
+	OS::get_singleton()->print("  --profile-script <file>          Sample the script call stacks and save them to <file> on exit, in the collapsed format used by flame graph tools.\n");
 #ifdef DEBUG_ENABLED
 	OS::get_singleton()->print("  --debug-collisions               Show collisions shapes when running the scene.\n");
 	OS::get_singleton()->print("  --debug-navigation               Show navigation polygons when running the scene.\n");
@@ -496,6 +500,16 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 		} else if (I->get() == "--profiling") { // enable profiling
 
 			use_debug_profiler = true;
+		} else if (I->get() == "--profile-script") { // sample script call stacks
+
+			if (I->next()) {
+
+				profile_script_path = I->next()->get();
+				N = I->next()->next();
+			} else {
+				OS::get_singleton()->print("Missing profile output file argument, aborting.\n");
+				goto error;
+			}
 		} else if (I->get() == "--video-driver") { // force video driver
 
 			if (I->next()) {
@@ -764,6 +778,11 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 #endif
 	}
 
+	// Settings are loaded now, start the worker threads unless something already needed them.
+	if (!WorkerThreadPool::get_singleton()->get_thread_count()) {
+		WorkerThreadPool::get_singleton()->init(GLOBAL_GET("threading/worker_pool/max_threads"));
+	}
+
 	GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 60);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/multithreaded_server/rid_pool_prealloc", PropertyInfo(Variant::INT, "memory/limits/multithreaded_server/rid_pool_prealloc", PROPERTY_HINT_RANGE, "0,500,1")); // No negative and limit to 500 due to crashes
 	GLOBAL_DEF("network/limits/debugger_stdout/max_chars_per_second", 2048);
@@ -863,6 +882,9 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 		input_map->load_from_globals(); //keys for game
 	}
 
+	// the editor saves over files it may still be reading, so it sticks to buffered reads
+	FileAccess::set_memory_map_enabled(bool(GLOBAL_DEF("application/run/memory_map_files", true)) && !editor && !project_manager);
+
 	if (bool(ProjectSettings::get_singleton()->get("application/run/disable_stdout"))) {
 		quiet_stdout = true;
 	}
@@ -1258,6 +1280,14 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 	if (use_debug_profiler && script_debugger) {
 		script_debugger->profiling_start();
 	}
+
+	int sampling_frequency = GLOBAL_DEF("debug/settings/profiler/sampling_frequency", 1000);
+	ProjectSettings::get_singleton()->set_custom_property_info("debug/settings/profiler/sampling_frequency", PropertyInfo(Variant::INT, "debug/settings/profiler/sampling_frequency", PROPERTY_HINT_RANGE, "1,10000,1"));
+	if (profile_script_path != String()) {
+		for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+			ScriptServer::get_language(i)->sampling_start(sampling_frequency);
+		}
+	}
 	_start_success = true;
 	locale = String();
 
@@ -1289,6 +1319,7 @@ bool Main::start() {
 	String _export_preset;
 	bool export_debug = false;
 	bool check_only = false;
+	List<RES> preloaded_scripts; // Keeps the scripts loaded in parallel until the main scene uses them.
 
 	main_timer_sync.init(OS::get_singleton()->get_ticks_usec());
 
@@ -1529,6 +1560,30 @@ bool Main::start() {
 					}
 				}
 
+				//compile the scripts of the autoloads and the main scene, now that their names can be resolved
+				if (GLOBAL_DEF("application/run/parallel_script_loading", true)) {
+
+					Vector<String> paths;
+					for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+
+						String s = E->get().name;
+						if (!s.begins_with("autoload/"))
+							continue;
+						String path = ProjectSettings::get_singleton()->get(s);
+						if (path.begins_with("*")) {
+							path = path.substr(1, path.length() - 1);
+						}
+						paths.push_back(path);
+					}
+					if (game_path.begins_with("res://")) {
+						paths.push_back(game_path);
+					}
+
+					for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+						ScriptServer::get_language(i)->load_dependencies(paths, &preloaded_scripts);
+					}
+				}
+
 				//second pass, load into global constants
 				List<Node *> to_add;
 				for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
@@ -2008,6 +2063,26 @@ void Main::cleanup() {
 
 	OS::get_singleton()->delete_main_loop();
 
+	if (profile_script_path != String()) {
+
+		Map<String, int> stacks;
+		for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+			ScriptServer::get_language(i)->sampling_stop();
+			ScriptServer::get_language(i)->sampling_get_stacks(&stacks);
+		}
+
+		FileAccess *f = FileAccess::open(profile_script_path, FileAccess::WRITE);
+		if (f) {
+			for (Map<String, int>::Element *E = stacks.front(); E; E = E->next()) {
+				f->store_line(E->key() + " " + itos(E->get()));
+			}
+			memdelete(f);
+		} else {
+			ERR_PRINTS("Can't open script profile file for writing: " + profile_script_path);
+		}
+		profile_script_path = String();
+	}
+
 	OS::get_singleton()->_cmdline.clear();
 	OS::get_singleton()->_execpath = "";
 	OS::get_singleton()->_local_clipboard = "";
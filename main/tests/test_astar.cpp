@@ -87,11 +87,159 @@ bool test_abcx() {
 	return ok;
 }
 
+bool test_remove_point() {
+	AStar a;
+	a.add_point(1, Vector3(0, 0, 0));
+	a.add_point(2, Vector3(1, 0, 0));
+	a.add_point(3, Vector3(2, 0, 0));
+	a.connect_points(1, 2);
+	a.connect_points(3, 2, false);
+	a.remove_point(2);
+
+	bool ok = !a.has_point(2);
+	ok = ok && !a.are_points_connected(1, 2);
+	ok = ok && !a.are_points_connected(2, 3);
+	ok = ok && a.get_point_connections(1).size() == 0;
+	ok = ok && a.get_point_connections(3).size() == 0;
+	ok = ok && a.get_available_point_id() == 2;
+
+	a.add_point(2, Vector3(1, 0, 0));
+	a.connect_points(1, 2);
+	a.connect_points(1, 2);
+	ok = ok && a.get_point_connections(1).size() == 1;
+	ok = ok && a.get_available_point_id() == 4;
+	return ok;
+}
+
+// Plain O(n^2) Dijkstra, used as the reference for the optimal path cost.
+real_t dijkstra_cost(const Vector<Vector3> &p_pos, const Vector<Vector<int> > &p_adj, int p_from, int p_to) {
+	int n = p_pos.size();
+	Vector<real_t> dist;
+	Vector<bool> done;
+	dist.resize(n);
+	done.resize(n);
+	for (int i = 0; i < n; i++) {
+		dist.write[i] = Math_INF;
+		done.write[i] = false;
+	}
+	dist.write[p_from] = 0;
+
+	while (true) {
+		int u = -1;
+		for (int i = 0; i < n; i++) {
+			if (!done[i] && dist[i] < Math_INF && (u < 0 || dist[i] < dist[u])) {
+				u = i;
+			}
+		}
+		if (u < 0 || u == p_to) {
+			break;
+		}
+		done.write[u] = true;
+		for (int i = 0; i < p_adj[u].size(); i++) {
+			int v = p_adj[u][i];
+			real_t d = dist[u] + p_pos[u].distance_to(p_pos[v]);
+			if (d < dist[v]) {
+				dist.write[v] = d;
+			}
+		}
+	}
+	return dist[p_to];
+}
+
+bool test_random_optimal() {
+	const int n = 300;
+	AStar a;
+	Vector<Vector3> pos;
+	Vector<Vector<int> > adj;
+	pos.resize(n);
+	adj.resize(n);
+
+	uint64_t seed = 1234;
+	for (int i = 0; i < n; i++) {
+		pos.write[i] = Vector3((Math::rand_from_seed(&seed) % 10000) / 100.0, (Math::rand_from_seed(&seed) % 10000) / 100.0, 0);
+		a.add_point(i, pos[i]);
+	}
+	for (int i = 0; i < n * 3; i++) {
+		int u = Math::rand_from_seed(&seed) % n;
+		int v = Math::rand_from_seed(&seed) % n;
+		if (u == v || a.are_points_connected(u, v)) {
+			continue;
+		}
+		a.connect_points(u, v);
+		adj.write[u].push_back(v);
+		adj.write[v].push_back(u);
+	}
+
+	bool ok = true;
+	for (int i = 0; i < 50; i++) {
+		int from = Math::rand_from_seed(&seed) % n;
+		int to = Math::rand_from_seed(&seed) % n;
+		if (from == to) {
+			continue;
+		}
+		real_t expected = dijkstra_cost(pos, adj, from, to);
+		PoolVector<int> path = a.get_id_path(from, to);
+		if (expected == Math_INF) {
+			ok = ok && path.size() == 0;
+			continue;
+		}
+		real_t cost = 0;
+		for (int j = 1; j < path.size(); j++) {
+			cost += pos[path[j - 1]].distance_to(pos[path[j]]);
+		}
+		ok = ok && path.size() > 0 && path[0] == from && path[path.size() - 1] == to;
+		ok = ok && Math::abs(cost - expected) < 0.01;
+	}
+	return ok;
+}
+
+bool test_grid_benchmark() {
+	const int side = 400;
+	const int queries = 10;
+	AStar a;
+
+	uint64_t t = OS::get_singleton()->get_ticks_usec();
+	for (int y = 0; y < side; y++) {
+		for (int x = 0; x < side; x++) {
+			int id = y * side + x;
+			a.add_point(id, Vector3(x, y, 0));
+			if (x > 0) {
+				a.connect_points(id, id - 1);
+			}
+			if (y > 0) {
+				a.connect_points(id, id - side);
+			}
+		}
+	}
+	// A wall across most of the grid, so searches have to go around it.
+	for (int x = 0; x < side - 1; x++) {
+		a.set_point_weight_scale((side / 2) * side + x, 1000);
+	}
+	OS::get_singleton()->print("\tbuilt %ix%i grid in %.1f ms\n", side, side, (OS::get_singleton()->get_ticks_usec() - t) / 1000.0);
+
+	bool ok = true;
+	t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < queries; i++) {
+		PoolVector<int> path = a.get_id_path(0, side * side - 1 - i);
+		ok = ok && path.size() > 0 && path[0] == 0 && path[path.size() - 1] == side * side - 1 - i;
+		// The detour through the gap at the end of the wall is the only cheap route.
+		for (int j = 0; j < path.size(); j++) {
+			ok = ok && (path[j] / side != side / 2 || path[j] % side == side - 1);
+		}
+	}
+	OS::get_singleton()->print("\t%i corner to corner queries: %.1f ms\n", queries, (OS::get_singleton()->get_ticks_usec() - t) / 1000.0);
+
+	return ok;
+}
+
 typedef bool (*TestFunc)(void);
 
 TestFunc test_funcs[] = {
 	test_abc,
 	test_abcx,
+	test_remove_point,
+	test_random_optimal,
+	test_grid_benchmark,
 	NULL
 };
 
@@ -0,0 +1,347 @@
+/*************************************************************************/
+/*  test_broad_phase.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_broad_phase.h"
+
+#include "core/math/random_number_generator.h"
+#include "core/os/os.h"
+#include "core/set.h"
+#include "servers/physics/broad_phase_basic.h"
+#include "servers/physics/broad_phase_bvh.h"
+#include "servers/physics/broad_phase_octree.h"
+#include "servers/physics/collision_object_sw.h"
+
+namespace TestBroadPhase {
+
+class TestObject : public CollisionObjectSW {
+public:
+	int index;
+
+	virtual void _shapes_changed() {}
+	virtual void set_space(SpaceSW *p_space) {}
+
+	TestObject() :
+			CollisionObjectSW(TYPE_BODY) { index = 0; }
+};
+
+// Tracks the pairs reported by a broadphase, keyed by object index.
+struct PairTracker {
+
+	Set<uint64_t> pairs;
+	int pair_calls;
+	int unpair_calls;
+
+	static uint64_t key(CollisionObjectSW *p_a, CollisionObjectSW *p_b) {
+		uint64_t a = static_cast<TestObject *>(p_a)->index;
+		uint64_t b = static_cast<TestObject *>(p_b)->index;
+		return a < b ? (a << 32) | b : (b << 32) | a;
+	}
+
+	static void *pair(CollisionObjectSW *p_a, int p_subindex_A, CollisionObjectSW *p_b, int p_subindex_B, void *p_userdata) {
+		PairTracker *self = (PairTracker *)p_userdata;
+		self->pairs.insert(key(p_a, p_b));
+		self->pair_calls++;
+		return NULL;
+	}
+
+	static void unpair(CollisionObjectSW *p_a, int p_subindex_A, CollisionObjectSW *p_b, int p_subindex_B, void *p_data, void *p_userdata) {
+		PairTracker *self = (PairTracker *)p_userdata;
+		self->pairs.erase(key(p_a, p_b));
+		self->unpair_calls++;
+	}
+
+	void attach(BroadPhaseSW *p_broadphase) {
+		p_broadphase->set_pair_callback(pair, this);
+		p_broadphase->set_unpair_callback(unpair, this);
+	}
+
+	PairTracker() {
+		pair_calls = 0;
+		unpair_calls = 0;
+	}
+};
+
+// A set of boxes moving around inside a cube, bouncing off its walls.
+struct Scene {
+
+	Vector<TestObject *> objects;
+	Vector<AABB> aabbs;
+	Vector<Vector3> velocities;
+	real_t extent;
+
+	void create(int p_count, real_t p_extent, uint64_t p_seed) {
+
+		Ref<RandomNumberGenerator> rng;
+		rng.instance();
+		rng->set_seed(p_seed);
+
+		extent = p_extent;
+		objects.resize(p_count);
+		aabbs.resize(p_count);
+		velocities.resize(p_count);
+
+		for (int i = 0; i < p_count; i++) {
+			TestObject *obj = memnew(TestObject);
+			obj->index = i;
+			objects.write[i] = obj;
+
+			Vector3 pos(rng->randf_range(0, extent), rng->randf_range(0, extent), rng->randf_range(0, extent));
+			Vector3 size(rng->randf_range(0.5, 2.0), rng->randf_range(0.5, 2.0), rng->randf_range(0.5, 2.0));
+			aabbs.write[i] = AABB(pos, size);
+			// every fourth object stays put
+			velocities.write[i] = (i % 4 == 0) ? Vector3() : Vector3(rng->randf_range(-0.5, 0.5), rng->randf_range(-0.5, 0.5), rng->randf_range(-0.5, 0.5));
+		}
+	}
+
+	void advance() {
+
+		for (int i = 0; i < aabbs.size(); i++) {
+			AABB &aabb = aabbs.write[i];
+			Vector3 &vel = velocities.write[i];
+			aabb.position += vel;
+			for (int j = 0; j < 3; j++) {
+				if (aabb.position[j] < 0 || aabb.position[j] > extent) {
+					vel[j] = -vel[j];
+				}
+			}
+		}
+	}
+
+	void destroy() {
+
+		for (int i = 0; i < objects.size(); i++) {
+			memdelete(objects[i]);
+		}
+		objects.clear();
+	}
+};
+
+struct Instance {
+
+	BroadPhaseSW *broadphase;
+	PairTracker tracker;
+	Vector<BroadPhaseSW::ID> ids;
+
+	void create(BroadPhaseSW::CreateFunction p_create, const Scene &p_scene) {
+
+		broadphase = p_create();
+		tracker.attach(broadphase);
+		ids.resize(p_scene.objects.size());
+		for (int i = 0; i < p_scene.objects.size(); i++) {
+			ids.write[i] = broadphase->create(p_scene.objects[i]);
+			broadphase->set_static(ids[i], p_scene.velocities[i] == Vector3());
+			broadphase->move(ids[i], p_scene.aabbs[i]);
+		}
+		broadphase->update();
+	}
+
+	void sync(const Scene &p_scene) {
+
+		for (int i = 0; i < ids.size(); i++) {
+			if (ids[i] && p_scene.velocities[i] != Vector3()) {
+				broadphase->move(ids[i], p_scene.aabbs[i]);
+			}
+		}
+		broadphase->update();
+	}
+
+	void destroy() {
+
+		for (int i = 0; i < ids.size(); i++) {
+			if (ids[i]) {
+				broadphase->remove(ids[i]);
+			}
+		}
+		memdelete(broadphase);
+	}
+};
+
+bool test_pairs_match() {
+
+	Scene scene;
+	scene.create(400, 30, 1234);
+
+	Instance basic;
+	Instance bvh;
+	Instance octree;
+	basic.create(BroadPhaseBasic::_create, scene);
+	bvh.create(BroadPhaseBVH::_create, scene);
+	octree.create(BroadPhaseOctree::_create, scene);
+
+	bool ok = basic.tracker.pairs.size() > 0;
+
+	for (int frame = 0; frame < 60 && ok; frame++) {
+
+		scene.advance();
+
+		if (frame == 30) {
+			// removal must unpair right away
+			for (int i = 0; i < scene.objects.size(); i += 7) {
+				basic.broadphase->remove(basic.ids[i]);
+				bvh.broadphase->remove(bvh.ids[i]);
+				octree.broadphase->remove(octree.ids[i]);
+				basic.ids.write[i] = 0;
+				bvh.ids.write[i] = 0;
+				octree.ids.write[i] = 0;
+			}
+		}
+
+		basic.sync(scene);
+		bvh.sync(scene);
+		octree.sync(scene);
+
+		ok = ok && bvh.tracker.pairs.size() == basic.tracker.pairs.size();
+		ok = ok && octree.tracker.pairs.size() == basic.tracker.pairs.size();
+		for (Set<uint64_t>::Element *E = basic.tracker.pairs.front(); E && ok; E = E->next()) {
+			ok = bvh.tracker.pairs.has(E->get());
+		}
+	}
+
+	basic.destroy();
+	bvh.destroy();
+	octree.destroy();
+
+	ok = ok && bvh.tracker.pairs.size() == 0;
+
+	scene.destroy();
+	return ok;
+}
+
+bool test_cull_match() {
+
+	Scene scene;
+	scene.create(400, 30, 4321);
+
+	Instance basic;
+	Instance bvh;
+	basic.create(BroadPhaseBasic::_create, scene);
+	bvh.create(BroadPhaseBVH::_create, scene);
+
+	const int max_results = 512;
+	CollisionObjectSW *results_basic[max_results];
+	CollisionObjectSW *results_bvh[max_results];
+	int indices[max_results];
+
+	bool ok = true;
+	for (int frame = 0; frame < 10 && ok; frame++) {
+
+		scene.advance();
+		basic.sync(scene);
+		bvh.sync(scene);
+
+		AABB query(Vector3(frame * 2, 5, 5), Vector3(10, 10, 10));
+		int count_basic = basic.broadphase->cull_aabb(query, results_basic, max_results, indices);
+		int count_bvh = bvh.broadphase->cull_aabb(query, results_bvh, max_results, indices);
+		ok = ok && count_basic > 0 && count_basic == count_bvh;
+
+		Vector3 from(0, frame * 3, 15);
+		Vector3 to(30, 30 - frame * 3, 15);
+		count_basic = basic.broadphase->cull_segment(from, to, results_basic, max_results, indices);
+		count_bvh = bvh.broadphase->cull_segment(from, to, results_bvh, max_results, indices);
+		ok = ok && count_basic == count_bvh;
+
+		Vector3 point = scene.aabbs[frame].position + scene.aabbs[frame].size * 0.5;
+		count_basic = basic.broadphase->cull_point(point, results_basic, max_results, indices);
+		count_bvh = bvh.broadphase->cull_point(point, results_bvh, max_results, NULL);
+		ok = ok && count_basic > 0 && count_basic == count_bvh;
+	}
+
+	basic.destroy();
+	bvh.destroy();
+	scene.destroy();
+	return ok;
+}
+
+void benchmark(const char *p_name, BroadPhaseSW::CreateFunction p_create, int p_count) {
+
+	Scene scene;
+	// keep the density constant as the count grows
+	scene.create(p_count, Math::pow(p_count * 8.0, 1.0 / 3.0), 5678);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	Instance instance;
+	instance.create(p_create, scene);
+
+	uint64_t built = OS::get_singleton()->get_ticks_usec();
+
+	const int frames = 60;
+	for (int i = 0; i < frames; i++) {
+		scene.advance();
+		instance.sync(scene);
+	}
+
+	uint64_t end = OS::get_singleton()->get_ticks_usec();
+
+	OS::get_singleton()->print("\t%s, %i objects: build %.2f msec, %.3f msec/frame, %i pairs\n", p_name, p_count, (built - from) / 1000.0, (end - built) / 1000.0 / frames, instance.tracker.pairs.size());
+
+	instance.destroy();
+	scene.destroy();
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_pairs_match,
+	test_cull_match,
+	NULL
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	OS::get_singleton()->print("\nMoving objects, 3/4 of them dynamic:\n");
+	const int counts[] = { 1000, 4000, 16000 };
+	for (int i = 0; i < 3; i++) {
+		if (counts[i] <= 1000) {
+			benchmark("Basic", BroadPhaseBasic::_create, counts[i]);
+		}
+		benchmark("Octree", BroadPhaseOctree::_create, counts[i]);
+		benchmark("BVH", BroadPhaseBVH::_create, counts[i]);
+	}
+
+	return NULL;
+}
+
+} // namespace TestBroadPhase
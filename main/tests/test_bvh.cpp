@@ -0,0 +1,352 @@
+/*************************************************************************/
+/*  test_bvh.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_bvh.h"
+
+#include "core/math/bvh.h"
+#include "core/math/camera_matrix.h"
+#include "core/math/octree.h"
+#include "core/math/random_number_generator.h"
+#include "core/os/os.h"
+#include "core/set.h"
+
+namespace TestBVH {
+
+enum {
+	TYPE_GEOMETRY = 1,
+	TYPE_LIGHT = 2
+};
+
+struct Item {
+	int index;
+};
+
+// Tracks the pairs reported by a structure, keyed by item index.
+struct PairTracker {
+
+	Set<uint64_t> pairs;
+
+	static uint64_t key(Item *p_a, Item *p_b) {
+		uint64_t a = p_a->index;
+		uint64_t b = p_b->index;
+		return a < b ? (a << 32) | b : (b << 32) | a;
+	}
+
+	static void *pair(void *p_self, uint32_t, Item *p_a, int, uint32_t, Item *p_b, int) {
+		((PairTracker *)p_self)->pairs.insert(key(p_a, p_b));
+		return NULL;
+	}
+
+	static void unpair(void *p_self, uint32_t, Item *p_a, int, uint32_t, Item *p_b, int, void *) {
+		((PairTracker *)p_self)->pairs.erase(key(p_a, p_b));
+	}
+};
+
+// Geometry moving around inside a cube, with a few lights pairing against it,
+// much like a VisualServer scenario.
+struct Scene {
+
+	Vector<Item> items;
+	Vector<AABB> aabbs;
+	Vector<Vector3> velocities;
+	real_t extent;
+	int light_every;
+
+	void create(int p_count, int p_light_every, uint64_t p_seed) {
+
+		Ref<RandomNumberGenerator> rng;
+		rng.instance();
+		rng->set_seed(p_seed);
+
+		// keep the density constant as the count grows
+		extent = Math::pow(p_count * 16.0, 1.0 / 3.0);
+		light_every = p_light_every;
+
+		items.resize(p_count);
+		aabbs.resize(p_count);
+		velocities.resize(p_count);
+
+		for (int i = 0; i < p_count; i++) {
+			items.write[i].index = i;
+			Vector3 pos(rng->randf_range(0, extent), rng->randf_range(0, extent), rng->randf_range(0, extent));
+			real_t size = is_light(i) ? 6.0 : rng->randf_range(0.5, 2.0);
+			aabbs.write[i] = AABB(pos, Vector3(size, size, size));
+			velocities.write[i] = Vector3(rng->randf_range(-0.2, 0.2), rng->randf_range(-0.2, 0.2), rng->randf_range(-0.2, 0.2));
+		}
+	}
+
+	bool is_light(int p_index) const {
+		return p_index % light_every == 0;
+	}
+
+	void advance() {
+
+		for (int i = 0; i < aabbs.size(); i++) {
+			AABB &aabb = aabbs.write[i];
+			Vector3 &vel = velocities.write[i];
+			aabb.position += vel;
+			for (int j = 0; j < 3; j++) {
+				if (aabb.position[j] < 0 || aabb.position[j] > extent) {
+					vel[j] = -vel[j];
+				}
+			}
+		}
+	}
+
+	Vector<Plane> get_frustum(int p_frame) const {
+
+		CameraMatrix cm;
+		cm.set_perspective(70, 16.0 / 9.0, 0.05, extent * 0.5);
+		Transform xform;
+		xform.origin = Vector3(extent * 0.5, extent * 0.5, extent * 0.5);
+		xform.basis.rotate(Vector3(0, 1, 0), p_frame * 0.1);
+		return cm.get_projection_planes(xform);
+	}
+};
+
+// Runs the same operations on a BVH or an Octree.
+template <class S>
+struct Instance {
+
+	S structure;
+	PairTracker tracker;
+	Vector<uint32_t> ids;
+
+	void create(Scene &p_scene) {
+
+		structure.set_pair_callback(PairTracker::pair, &tracker);
+		structure.set_unpair_callback(PairTracker::unpair, &tracker);
+
+		ids.resize(p_scene.items.size());
+		for (int i = 0; i < ids.size(); i++) {
+			if (p_scene.is_light(i)) {
+				ids.write[i] = structure.create(&p_scene.items.write[i], p_scene.aabbs[i], 0, true, TYPE_LIGHT, TYPE_GEOMETRY);
+			} else {
+				ids.write[i] = structure.create(&p_scene.items.write[i], p_scene.aabbs[i], 0, false, TYPE_GEOMETRY, 0);
+			}
+		}
+	}
+
+	void sync(const Scene &p_scene) {
+
+		for (int i = 0; i < ids.size(); i++) {
+			if (ids[i]) {
+				structure.move(ids[i], p_scene.aabbs[i]);
+			}
+		}
+	}
+
+	void destroy() {
+
+		for (int i = 0; i < ids.size(); i++) {
+			if (ids[i]) {
+				structure.erase(ids[i]);
+			}
+		}
+	}
+};
+
+bool test_pairs_match() {
+
+	Scene scene;
+	scene.create(2000, 20, 1234);
+
+	Instance<BVH<Item> > bvh;
+	Instance<Octree<Item, true> > octree;
+	bvh.create(scene);
+	octree.create(scene);
+
+	bool ok = octree.tracker.pairs.size() > 0;
+
+	for (int frame = 0; frame < 40 && ok; frame++) {
+
+		scene.advance();
+
+		if (frame == 10) {
+			// hide every other light, the way VisualServerScene does
+			for (int i = 0; i < bvh.ids.size(); i += scene.light_every * 2) {
+				bvh.structure.set_pairable(bvh.ids[i], false, TYPE_LIGHT, 0);
+				octree.structure.set_pairable(octree.ids[i], false, TYPE_LIGHT, 0);
+			}
+		}
+
+		if (frame == 20) {
+			for (int i = 0; i < bvh.ids.size(); i += 7) {
+				bvh.structure.erase(bvh.ids[i]);
+				octree.structure.erase(octree.ids[i]);
+				bvh.ids.write[i] = 0;
+				octree.ids.write[i] = 0;
+			}
+		}
+
+		bvh.sync(scene);
+		octree.sync(scene);
+
+		ok = ok && bvh.tracker.pairs.size() == octree.tracker.pairs.size();
+		for (Set<uint64_t>::Element *E = octree.tracker.pairs.front(); E && ok; E = E->next()) {
+			ok = bvh.tracker.pairs.has(E->get());
+		}
+	}
+
+	bvh.destroy();
+	octree.destroy();
+
+	return ok && bvh.tracker.pairs.size() == 0 && bvh.structure.get_elem_count() == 0;
+}
+
+bool test_cull_match() {
+
+	Scene scene;
+	scene.create(2000, 20, 4321);
+
+	Instance<BVH<Item> > bvh;
+	Instance<Octree<Item, true> > octree;
+	bvh.create(scene);
+	octree.create(scene);
+
+	const int max_results = 4096;
+	Item *result_bvh[max_results];
+	Item *result_octree[max_results];
+
+	bool ok = true;
+	for (int frame = 0; frame < 20 && ok; frame++) {
+
+		scene.advance();
+		bvh.sync(scene);
+		octree.sync(scene);
+
+		Vector<Plane> planes = scene.get_frustum(frame);
+		int count_bvh = bvh.structure.cull_convex(planes, result_bvh, max_results);
+		int count_octree = octree.structure.cull_convex(planes, result_octree, max_results);
+		ok = ok && count_octree > 0 && count_bvh == count_octree;
+
+		count_bvh = bvh.structure.cull_convex(planes, result_bvh, max_results, TYPE_LIGHT);
+		count_octree = octree.structure.cull_convex(planes, result_octree, max_results, TYPE_LIGHT);
+		ok = ok && count_bvh == count_octree;
+
+		Set<Item *> seen;
+		for (int i = 0; i < count_octree; i++) {
+			seen.insert(result_octree[i]);
+		}
+		for (int i = 0; i < count_bvh && ok; i++) {
+			ok = seen.has(result_bvh[i]);
+		}
+
+		AABB box(Vector3(frame, frame, frame), Vector3(8, 8, 8));
+		count_bvh = bvh.structure.cull_aabb(box, result_bvh, max_results);
+		count_octree = octree.structure.cull_aabb(box, result_octree, max_results);
+		ok = ok && count_bvh == count_octree;
+
+		Vector3 from(0, frame, scene.extent * 0.5);
+		Vector3 to(scene.extent, scene.extent - frame, scene.extent * 0.5);
+		count_bvh = bvh.structure.cull_segment(from, to, result_bvh, max_results);
+		count_octree = octree.structure.cull_segment(from, to, result_octree, max_results);
+		ok = ok && count_bvh == count_octree;
+	}
+
+	bvh.destroy();
+	octree.destroy();
+	return ok;
+}
+
+template <class S>
+void benchmark(const char *p_name, int p_count) {
+
+	Scene scene;
+	scene.create(p_count, 500, 5678);
+
+	static Item *results[65536];
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+
+	Instance<S> instance;
+	instance.create(scene);
+
+	uint64_t built = OS::get_singleton()->get_ticks_usec();
+
+	const int frames = 30;
+	uint64_t move_time = 0;
+	uint64_t cull_time = 0;
+	int culled = 0;
+
+	for (int i = 0; i < frames; i++) {
+		scene.advance();
+
+		uint64_t t = OS::get_singleton()->get_ticks_usec();
+		instance.sync(scene);
+		move_time += OS::get_singleton()->get_ticks_usec() - t;
+
+		Vector<Plane> planes = scene.get_frustum(i);
+		t = OS::get_singleton()->get_ticks_usec();
+		culled += instance.structure.cull_convex(planes, results, 65536);
+		cull_time += OS::get_singleton()->get_ticks_usec() - t;
+	}
+
+	OS::get_singleton()->print("\t%s, %i instances: build %.2f msec, move %.3f msec/frame, cull %.3f msec/frame (%i visible)\n", p_name, p_count, (built - from) / 1000.0, move_time / 1000.0 / frames, cull_time / 1000.0 / frames, culled / frames);
+
+	instance.destroy();
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_pairs_match,
+	test_cull_match,
+	NULL
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	OS::get_singleton()->print("\nMoving instances, one light every 500:\n");
+	const int counts[] = { 10000, 50000 };
+	for (int i = 0; i < 2; i++) {
+		benchmark<Octree<Item, true> >("Octree", counts[i]);
+		benchmark<BVH<Item> >("BVH", counts[i]);
+	}
+
+	return NULL;
+}
+
+} // namespace TestBVH
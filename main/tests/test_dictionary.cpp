@@ -0,0 +1,394 @@
+/*************************************************************************/
+/*  test_dictionary.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_dictionary.h"
+
+#include "core/dictionary.h"
+#include "core/ordered_hash_map.h"
+#include "core/os/os.h"
+#include "core/variant.h"
+
+namespace TestDictionary {
+
+bool test_insert_lookup() {
+
+	OS::get_singleton()->print("\n\nTest 1: Insert and lookup\n");
+
+	Dictionary d;
+	for (int i = 0; i < 100; i++) {
+		d["key_" + itos(i)] = i;
+		d[i] = -i;
+		if (d.size() != (i + 1) * 2) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < 100; i++) {
+		if (int(d["key_" + itos(i)]) != i || int(d[i]) != -i) {
+			return false;
+		}
+	}
+
+	// Same hash_compare semantics as before, 1 and 1.0 are different keys.
+	d[1.0] = "float";
+	return d.size() == 201 && int(d[1]) == -1 && !d.has("missing") && d.getptr(1000) == NULL;
+}
+
+bool test_order() {
+
+	OS::get_singleton()->print("\n\nTest 2: Insertion order with erasures\n");
+
+	for (int size = 4; size <= 64; size *= 4) {
+
+		Dictionary d;
+		Array expected;
+		for (int i = 0; i < size; i++) {
+			d[i] = i;
+		}
+		for (int i = 0; i < size; i += 3) {
+			d.erase(i);
+		}
+		for (int i = size; i < size * 2; i++) {
+			d[i] = i;
+		}
+		for (int i = 0; i < size * 2; i++) {
+			if (i >= size || i % 3 != 0) {
+				expected.push_back(i);
+			}
+		}
+
+		Array keys = d.keys();
+		if (keys.size() != expected.size() || d.size() != expected.size()) {
+			OS::get_singleton()->print("\tsize %i: wrong size\n", size);
+			return false;
+		}
+
+		const Variant *key = NULL;
+		for (int i = 0; i < expected.size(); i++) {
+			key = d.next(key);
+			if (keys[i] != expected[i] || !key || *key != expected[i] || d.get_key_at_index(i) != expected[i] || d.get_value_at_index(i) != expected[i]) {
+				OS::get_singleton()->print("\tsize %i: wrong order at %i\n", size, i);
+				return false;
+			}
+		}
+		if (d.next(key) != NULL) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool test_erase_reinsert() {
+
+	OS::get_singleton()->print("\n\nTest 3: Erase and insert again\n");
+
+	Dictionary d;
+	for (int round = 0; round < 100; round++) {
+		for (int i = 0; i < 20; i++) {
+			d[i] = round;
+		}
+		for (int i = 0; i < 20; i += 2) {
+			if (!d.erase(i)) {
+				return false;
+			}
+		}
+		if (d.size() != 10 || d.has(0) || !d.has(1) || int(d[1]) != round) {
+			return false;
+		}
+		if (round % 2) {
+			d.clear();
+			if (!d.empty() || d.has(1) || d.next() != NULL) {
+				return false;
+			}
+		}
+	}
+
+	return !d.erase(100);
+}
+
+bool test_duplicate() {
+
+	OS::get_singleton()->print("\n\nTest 4: Duplicate\n");
+
+	for (int size = 3; size <= 300; size *= 10) {
+
+		Dictionary inner;
+		inner["a"] = 1;
+
+		Dictionary d;
+		for (int i = 0; i < size; i++) {
+			d[itos(i)] = inner;
+		}
+		d.erase("0");
+
+		Dictionary shallow = d.duplicate();
+		Dictionary deep = d.duplicate(true);
+
+		if (shallow.size() != size - 1 || deep.size() != size - 1 || shallow.hash() != d.hash()) {
+			return false;
+		}
+		for (int i = 1; i < size; i++) {
+			if (!shallow.has(itos(i)) || !deep.has(itos(i))) {
+				return false;
+			}
+		}
+
+		inner["a"] = 2;
+		if (int(Dictionary(shallow["1"])["a"]) != 2 || int(Dictionary(deep["1"])["a"]) != 1) {
+			return false;
+		}
+
+		// The copies must work as normal dictionaries afterwards.
+		deep["new"] = true;
+		deep.erase("1");
+		if (!deep.has("new") || deep.has("1") || deep.size() != size - 1) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool test_insert_while_iterating() {
+
+	OS::get_singleton()->print("\n\nTest 5: Insert while iterating\n");
+
+	for (int size = 4; size <= 256; size *= 4) {
+
+		Dictionary d;
+		for (int i = 0; i < size; i++) {
+			d[i] = i;
+		}
+		d.erase(0);
+
+		// Keys and values must stay where they are while other keys are inserted.
+		const Variant *value = d.getptr(size - 1);
+		int visited = 0;
+		int inserted = size;
+		for (const Variant *key = d.next(); key; key = d.next(key)) {
+			if (key->get_type() == Variant::INT) {
+				d[String("copy_") + String(*key)] = *key;
+				inserted++;
+			}
+			visited++;
+		}
+
+		if (visited != inserted - 1 || d.size() != inserted - 1 || !value || int(*value) != size - 1 || value != d.getptr(size - 1)) {
+			OS::get_singleton()->print("\tsize %i: visited %i of %i\n", size, visited, d.size());
+			return false;
+		}
+
+		// Assigning from the same dictionary, with holes left by erasing.
+		for (int i = 2; i < size; i += 2) {
+			d.erase(i);
+		}
+		for (int i = 0; i < size * 4; i++) {
+			d[size + i] = d[String("copy_") + itos(size - 1)];
+		}
+		if (int(d[size * 5 - 1]) != size - 1 || value != d.getptr(size - 1)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+typedef OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> VariantMap;
+
+struct BenchmarkTimes {
+
+	uint64_t insert;
+	uint64_t lookup;
+	uint64_t iterate;
+	uint64_t duplicate;
+};
+
+static void _benchmark_dictionary(const Vector<Variant> &p_keys, int p_rounds, BenchmarkTimes &r_times) {
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	Vector<Dictionary> dicts;
+	dicts.resize(p_rounds);
+	for (int i = 0; i < p_rounds; i++) {
+		for (int j = 0; j < p_keys.size(); j++) {
+			dicts.write[i][p_keys[j]] = j;
+		}
+	}
+	r_times.insert = OS::get_singleton()->get_ticks_usec() - from;
+
+	int sum = 0;
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_rounds; i++) {
+		for (int j = 0; j < p_keys.size(); j++) {
+			sum += int(*dicts[i].getptr(p_keys[j]));
+		}
+	}
+	r_times.lookup = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_rounds; i++) {
+		const Dictionary &d = dicts[i];
+		for (const Variant *key = d.next(); key; key = d.next(key)) {
+			sum += int(*d.getptr(*key));
+		}
+	}
+	r_times.iterate = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_rounds; i++) {
+		sum += dicts[i].duplicate().size();
+	}
+	r_times.duplicate = OS::get_singleton()->get_ticks_usec() - from;
+
+	if (sum == 42) {
+		OS::get_singleton()->print("\n"); // keep the compiler from dropping the loops
+	}
+}
+
+// The storage Dictionary used before, the ordered map wrapped the same way.
+static void _benchmark_ordered_hash_map(const Vector<Variant> &p_keys, int p_rounds, BenchmarkTimes &r_times) {
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	VariantMap *maps = memnew_arr(VariantMap, p_rounds);
+	for (int i = 0; i < p_rounds; i++) {
+		for (int j = 0; j < p_keys.size(); j++) {
+			maps[i][p_keys[j]] = j;
+		}
+	}
+	r_times.insert = OS::get_singleton()->get_ticks_usec() - from;
+
+	int sum = 0;
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_rounds; i++) {
+		const VariantMap &map = maps[i];
+		for (int j = 0; j < p_keys.size(); j++) {
+			sum += int(map.find(p_keys[j]).get());
+		}
+	}
+	r_times.lookup = OS::get_singleton()->get_ticks_usec() - from;
+
+	// Dictionary::next() used to look up each key to find the following one.
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_rounds; i++) {
+		VariantMap &map = maps[i];
+		for (VariantMap::Element E = map.front(); E; E = map.find(E.key()).next()) {
+			sum += int(map.find(E.key()).get());
+		}
+	}
+	r_times.iterate = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_rounds; i++) {
+		VariantMap copy;
+		for (VariantMap::Element E = maps[i].front(); E; E = E.next()) {
+			copy[E.key()] = E.value();
+		}
+		sum += copy.size();
+	}
+	r_times.duplicate = OS::get_singleton()->get_ticks_usec() - from;
+
+	memdelete_arr(maps);
+
+	if (sum == 42) {
+		OS::get_singleton()->print("\n");
+	}
+}
+
+static void _print_ratio(const char *p_name, uint64_t p_old, uint64_t p_new) {
+
+	OS::get_singleton()->print("\t\t%-10s ordered map %8.2f ms, dictionary %8.2f ms (%.2fx)\n", p_name, p_old / 1000.0, p_new / 1000.0, double(p_old) / MAX(p_new, 1));
+}
+
+void benchmark() {
+
+	const int sizes[] = { 4, 8, 32, 1024 };
+	const int total_keys = 1 << 19;
+
+	for (int s = 0; s < 4; s++) {
+
+		Vector<Variant> keys;
+		for (int i = 0; i < sizes[s]; i++) {
+			// Mixed keys, as in parsed JSON and RPC arguments.
+			if (i % 2) {
+				keys.push_back("key_" + itos(i));
+			} else {
+				keys.push_back(i);
+			}
+		}
+
+		int rounds = total_keys / sizes[s];
+		BenchmarkTimes before, after;
+		_benchmark_ordered_hash_map(keys, rounds, before);
+		_benchmark_dictionary(keys, rounds, after);
+
+		OS::get_singleton()->print("\t%i keys, %i dictionaries:\n", sizes[s], rounds);
+		_print_ratio("insert", before.insert, after.insert);
+		_print_ratio("lookup", before.lookup, after.lookup);
+		_print_ratio("iterate", before.iterate, after.iterate);
+		_print_ratio("duplicate", before.duplicate, after.duplicate);
+	}
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_insert_lookup,
+	test_order,
+	test_erase_reinsert,
+	test_duplicate,
+	test_insert_while_iterating,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	OS::get_singleton()->print("\nThroughput against the former storage:\n");
+	benchmark();
+
+	return NULL;
+}
+
+} // namespace TestDictionary
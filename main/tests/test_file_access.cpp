@@ -0,0 +1,476 @@
+/*************************************************************************/
+/*  test_file_access.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_file_access.h"
+
+#include "core/io/file_access_pack.h"
+#include "core/io/pck_packer.h"
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+
+namespace TestFileAccess {
+
+static String _temp_path(const String &p_file) {
+
+	return OS::get_singleton()->get_cache_path().plus_file("godot_test_file_access_" + p_file);
+}
+
+static void _remove_temp(const String &p_file) {
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(_temp_path(p_file));
+	memdelete(da);
+}
+
+// Reads a file in every way the loaders do, so mapped and buffered reads can be compared.
+static Vector<uint64_t> _read_sequence(const String &p_path) {
+
+	Vector<uint64_t> log;
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f)
+		return log;
+
+	log.push_back(f->get_len());
+	log.push_back(f->get_8());
+	log.push_back(f->get_16());
+	log.push_back(f->get_32());
+	log.push_back(f->get_64());
+	f->set_endian_swap(true);
+	log.push_back(f->get_32());
+	log.push_back(f->get_64());
+	f->set_endian_swap(false);
+	log.push_back(f->get_position());
+
+	uint8_t buf[64];
+	f->seek(100);
+	log.push_back(f->get_buffer(buf, 64));
+	log.push_back(buf[0] | (buf[63] << 8));
+	log.push_back(f->eof_reached());
+
+	// Short reads at the end of the file.
+	f->seek_end(-10);
+	log.push_back(f->get_position());
+	log.push_back(f->get_buffer(buf, 64));
+	log.push_back(buf[9]);
+	log.push_back(f->eof_reached());
+	log.push_back(f->get_8());
+	log.push_back(f->eof_reached());
+
+	f->seek(f->get_len() - 2);
+	log.push_back(f->get_32());
+	log.push_back(f->eof_reached());
+
+	f->seek(0);
+	log.push_back(f->eof_reached());
+	log.push_back(f->get_32());
+
+	memdelete(f);
+	return log;
+}
+
+bool test_mapped_reads() {
+
+	OS::get_singleton()->print("\n\nTest 1: Mapped and buffered reads match\n");
+
+	String path = _temp_path("data.bin");
+	FileAccess *f = FileAccess::open(path, FileAccess::WRITE);
+	if (!f) {
+		OS::get_singleton()->print("\tcan't write %s\n", path.utf8().get_data());
+		return false;
+	}
+	for (int i = 0; i < 4099; i++) {
+		f->store_8((i * 7) ^ (i >> 8));
+	}
+	memdelete(f);
+
+	bool was_enabled = FileAccess::is_memory_map_enabled();
+	bool ok = true;
+
+	FileAccess::set_memory_map_enabled(false);
+	Vector<uint64_t> buffered = _read_sequence(path);
+	f = FileAccess::open(path, FileAccess::READ);
+	if (f->map_buffer(16)) {
+		OS::get_singleton()->print("\tfile mapped while mapping is disabled\n");
+		ok = false;
+	}
+	memdelete(f);
+
+	FileAccess::set_memory_map_enabled(true);
+	Vector<uint64_t> mapped = _read_sequence(path);
+	f = FileAccess::open(path, FileAccess::READ);
+	f->seek(4090);
+	const uint8_t *ptr = f->map_buffer(8);
+	if (!ptr) {
+		OS::get_singleton()->print("\tmemory mapping is not available, only comparing reads\n");
+	} else if (ptr[0] != uint8_t((4090 * 7) ^ (4090 >> 8)) || f->get_position() != 4098 || f->map_buffer(2)) {
+		OS::get_singleton()->print("\tmap_buffer returned the wrong range\n");
+		ok = false;
+	}
+	memdelete(f);
+
+	FileAccess::set_memory_map_enabled(was_enabled);
+	_remove_temp("data.bin");
+
+	if (buffered.empty() || buffered.size() != mapped.size()) {
+		return false;
+	}
+	for (int i = 0; i < buffered.size(); i++) {
+		if (buffered[i] != mapped[i]) {
+			OS::get_singleton()->print("\tread %i differs: %llu buffered, %llu mapped\n", i, (unsigned long long)buffered[i], (unsigned long long)mapped[i]);
+			ok = false;
+		}
+	}
+
+	return ok;
+}
+
+static Ref<Resource> _make_resource(int p_seed, int p_values, int p_strings) {
+
+	PoolRealArray values;
+	values.resize(p_values);
+	{
+		PoolRealArray::Write w = values.write();
+		for (int i = 0; i < p_values; i++) {
+			w[i] = (i + p_seed) * 0.5;
+		}
+	}
+
+	PoolStringArray strings;
+	Dictionary names;
+	for (int i = 0; i < p_strings; i++) {
+		String s = "string_" + itos(p_seed) + "_" + itos(i);
+		strings.push_back(s);
+		if (i % 8 == 0) {
+			names[s] = i;
+		}
+	}
+
+	Ref<Resource> res;
+	res.instance();
+	res->set_meta("values", values);
+	res->set_meta("strings", strings);
+	res->set_meta("names", names);
+	return res;
+}
+
+// Packs the resources into a pck, whose files show up under res://test_file_access/.
+static Error _make_pack(const String &p_name, int p_count, int p_values, int p_strings) {
+
+	PCKPacker packer;
+	Error err = packer.pck_start(_temp_path(p_name + ".pck"), 16);
+	if (err != OK)
+		return err;
+
+	for (int i = 0; i < p_count; i++) {
+
+		String file = p_name + "_" + itos(i) + ".res";
+		err = ResourceSaver::save(_temp_path(file), _make_resource(i, p_values, p_strings));
+		if (err != OK)
+			return err;
+		packer.add_file("res://test_file_access/" + file, _temp_path(file));
+	}
+	err = packer.flush();
+	if (err != OK)
+		return err;
+
+	for (int i = 0; i < p_count; i++) {
+		_remove_temp(p_name + "_" + itos(i) + ".res");
+	}
+
+	return PackedData::get_singleton()->add_pack(_temp_path(p_name + ".pck"));
+}
+
+bool test_pack_load() {
+
+	OS::get_singleton()->print("\n\nTest 2: Resources load the same from a mapped pack\n");
+
+	if (!PackedData::get_singleton() || PackedData::get_singleton()->is_disabled()) {
+		OS::get_singleton()->print("\tpacks are disabled\n");
+		return true;
+	}
+
+	if (_make_pack("small", 1, 1000, 1000) != OK) {
+		OS::get_singleton()->print("\tcan't create the pack\n");
+		_remove_temp("small.pck");
+		return false;
+	}
+
+	bool was_enabled = FileAccess::is_memory_map_enabled();
+
+	FileAccess::set_memory_map_enabled(false);
+	RES buffered = ResourceLoader::load("res://test_file_access/small_0.res", "", true);
+	FileAccess::set_memory_map_enabled(true);
+	RES mapped = ResourceLoader::load("res://test_file_access/small_0.res", "", true);
+
+	FileAccess::set_memory_map_enabled(was_enabled);
+
+	if (buffered.is_null() || mapped.is_null()) {
+		return false;
+	}
+
+	RES expected = _make_resource(0, 1000, 1000);
+	const char *keys[] = { "values", "strings" };
+	for (int i = 0; i < 2; i++) {
+		Variant v = expected->get_meta(keys[i]);
+		if (buffered->get_meta(keys[i]) != v || mapped->get_meta(keys[i]) != v) {
+			OS::get_singleton()->print("\t%s differs\n", keys[i]);
+			return false;
+		}
+	}
+
+	// Dictionaries compare by reference, so compare their contents.
+	Dictionary names = expected->get_meta("names");
+	Dictionary buffered_names = buffered->get_meta("names");
+	Dictionary mapped_names = mapped->get_meta("names");
+	if (buffered_names.size() != names.size() || mapped_names.size() != names.size()) {
+		OS::get_singleton()->print("\tnames differs\n");
+		return false;
+	}
+	for (int i = 0; i < names.size(); i++) {
+		Variant key = names.get_key_at_index(i);
+		if (buffered_names.get(key, Variant()) != names[key] || mapped_names.get(key, Variant()) != names[key]) {
+			OS::get_singleton()->print("\tnames differs\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static Vector<uint8_t> _make_data(int p_size, int p_seed) {
+
+	Vector<uint8_t> data;
+	data.resize(p_size);
+	for (int i = 0; i < p_size; i++) {
+		data.write[i] = (i / 100 + p_seed) & 0xFF;
+	}
+	return data;
+}
+
+static bool _check_file(const String &p_path, const Vector<uint8_t> &p_data) {
+
+	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+	if (!f) {
+		OS::get_singleton()->print("\tcan't open %s\n", p_path.utf8().get_data());
+		return false;
+	}
+
+	bool ok = f->get_len() == (size_t)p_data.size();
+
+	Vector<uint8_t> data;
+	data.resize(p_data.size() + 1);
+	ok = ok && f->get_buffer(data.ptrw(), data.size()) == p_data.size() && f->eof_reached();
+	ok = ok && memcmp(data.ptr(), p_data.ptr(), p_data.size()) == 0;
+
+	// Random access, across the blocks of compressed files.
+	f->seek(p_data.size() - 10);
+	ok = ok && !f->eof_reached() && f->get_8() == p_data[p_data.size() - 10];
+	f->seek(1);
+	ok = ok && f->get_8() == p_data[1] && f->get_position() == 2;
+
+	memdelete(f);
+
+	if (!ok) {
+		OS::get_singleton()->print("\t%s reads back wrong\n", p_path.utf8().get_data());
+	}
+	return ok;
+}
+
+bool test_pack_index() {
+
+	OS::get_singleton()->print("\n\nTest 3: Packs override each other and store compressed files\n");
+
+	if (!PackedData::get_singleton() || PackedData::get_singleton()->is_disabled()) {
+		OS::get_singleton()->print("\tpacks are disabled\n");
+		return true;
+	}
+
+	Vector<uint8_t> small = _make_data(1000, 1);
+	Vector<uint8_t> blocks = _make_data(65536 * 2, 2); // ends with a whole compression block
+	Vector<uint8_t> large = _make_data(70000, 3);
+
+	PCKPacker packer;
+	packer.pck_start(_temp_path("first.pck"), 16);
+	packer.add_file_data("res://test_file_access/index/a.bin", small);
+	packer.add_file_data("res://test_file_access/index/b.bin", small);
+	packer.flush();
+
+	packer.pck_start(_temp_path("second.pck"), 0);
+	packer.add_file_data("res://test_file_access/index/a.bin", blocks, true);
+	packer.add_file_data("res://test_file_access/index/sub/c.bin", large, true);
+	packer.flush();
+
+	FileAccess *f = FileAccess::open(_temp_path("second.pck"), FileAccess::READ);
+	size_t pack_size = f ? f->get_len() : 0;
+	if (f)
+		memdelete(f);
+
+	bool ok = PackedData::get_singleton()->add_pack(_temp_path("first.pck")) == OK;
+	ok = ok && PackedData::get_singleton()->add_pack(_temp_path("second.pck")) == OK;
+
+	if (pack_size >= (size_t)(blocks.size() + large.size()) / 2) {
+		OS::get_singleton()->print("\tfiles were not compressed\n");
+		ok = false;
+	}
+
+	ok = ok && _check_file("res://test_file_access/index/a.bin", blocks);
+	ok = ok && _check_file("res://test_file_access/index/b.bin", small);
+	ok = ok && _check_file("res://test_file_access/index/sub/c.bin", large);
+	ok = ok && !FileAccess::exists("res://test_file_access/index/d.bin");
+
+	DirAccessPack *da = memnew(DirAccessPack);
+	if (da->change_dir("res://test_file_access/index") != OK || !da->file_exists("a.bin") || !da->file_exists("b.bin") || !da->dir_exists("sub")) {
+		OS::get_singleton()->print("\tdirectory listing is wrong\n");
+		ok = false;
+	}
+	memdelete(da);
+
+	_remove_temp("first.pck");
+	_remove_temp("second.pck");
+
+	return ok;
+}
+
+// Peak resident memory in KB, from /proc on Linux. Returns -1 elsewhere.
+static int64_t _get_peak_rss() {
+
+	FileAccess *f = FileAccess::open("/proc/self/status", FileAccess::READ);
+	if (!f)
+		return -1;
+
+	int64_t peak = -1;
+	while (!f->eof_reached()) {
+		String line = f->get_line();
+		if (line.begins_with("VmHWM:")) {
+			peak = line.substr(6, line.length()).strip_edges().to_int64();
+			break;
+		}
+	}
+	memdelete(f);
+	return peak;
+}
+
+static void _reset_peak_rss() {
+
+	FileAccess *f = FileAccess::open("/proc/self/clear_refs", FileAccess::WRITE);
+	if (f) {
+		f->store_8('5');
+		memdelete(f);
+	}
+}
+
+void benchmark_pack_load() {
+
+	if (!PackedData::get_singleton() || PackedData::get_singleton()->is_disabled())
+		return;
+
+	const int count = 16;
+	if (_make_pack("large", count, 1 << 20, 20000) != OK) {
+		OS::get_singleton()->print("\tcan't create the pack\n");
+		_remove_temp("large.pck");
+		return;
+	}
+
+	FileAccess *f = FileAccess::open(_temp_path("large.pck"), FileAccess::READ);
+	OS::get_singleton()->print("\t%i resources, %.1f MB pack\n", count, f ? f->get_len() / (1024.0 * 1024.0) : 0.0);
+	if (f)
+		memdelete(f);
+
+	bool was_enabled = FileAccess::is_memory_map_enabled();
+
+	for (int pass = 0; pass < 4; pass++) {
+
+		// Alternate, so both modes see a warm page cache.
+		bool map = pass & 1;
+		FileAccess::set_memory_map_enabled(map);
+		_reset_peak_rss();
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		{
+			Vector<RES> loaded;
+			for (int i = 0; i < count; i++) {
+				loaded.push_back(ResourceLoader::load("res://test_file_access/large_" + itos(i) + ".res", "", true));
+			}
+		}
+		uint64_t time = OS::get_singleton()->get_ticks_usec() - from;
+
+		int64_t peak = _get_peak_rss();
+		if (peak >= 0) {
+			OS::get_singleton()->print("\t%s: %.1f ms, peak RSS %.1f MB\n", map ? "mapped" : "buffered", time / 1000.0, peak / 1024.0);
+		} else {
+			OS::get_singleton()->print("\t%s: %.1f ms\n", map ? "mapped" : "buffered", time / 1000.0);
+		}
+	}
+
+	FileAccess::set_memory_map_enabled(was_enabled);
+	_remove_temp("large.pck");
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_mapped_reads,
+	test_pack_load,
+	test_pack_index,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	OS::get_singleton()->print("\nLoading a large pack:\n");
+	benchmark_pack_load();
+
+	// Removed last, the directory tree of the packs is read when first used.
+	_remove_temp("small.pck");
+
+	return NULL;
+}
+
+} // namespace TestFileAccess
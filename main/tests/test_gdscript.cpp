@@ -33,6 +33,7 @@
 #include "core/os/file_access.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 
 #ifdef GDSCRIPT_ENABLED
 
@@ -561,10 +562,15 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 			switch (code[ip]) {
 
-				case GDScriptFunction::OPCODE_OPERATOR: {
+				case GDScriptFunction::OPCODE_OPERATOR:
+				case GDScriptFunction::OPCODE_OPERATOR_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_REAL:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR2:
+				case GDScriptFunction::OPCODE_OPERATOR_VECTOR3: {
 
+					static const char *op_kinds[] = { "op", "op-int", "op-real", "op-vector2", "op-vector3" };
 					int op = code[ip + 1];
-					txt += " op ";
+					txt += " " + String(op_kinds[code[ip] - GDScriptFunction::OPCODE_OPERATOR]) + " ";
 
 					String opname = Variant::get_operator_name(Variant::Operator(op));
 
@@ -587,9 +593,10 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					incr += 4;
 
 				} break;
-				case GDScriptFunction::OPCODE_GET: {
+				case GDScriptFunction::OPCODE_GET:
+				case GDScriptFunction::OPCODE_GET_ARRAY: {
 
-					txt += " get ";
+					txt += code[ip] == GDScriptFunction::OPCODE_GET_ARRAY ? " get-array " : " get ";
 					txt += DADDR(3);
 					txt += "=";
 					txt += DADDR(1);
@@ -607,19 +614,19 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += func.get_global_name(code[ip + 2]);
 					txt += "\"]=";
 					txt += DADDR(3);
-					incr += 4;
+					incr += 5;
 
 				} break;
 				case GDScriptFunction::OPCODE_GET_NAMED: {
 
 					txt += " get_named ";
-					txt += DADDR(3);
+					txt += DADDR(4);
 					txt += "=";
 					txt += DADDR(1);
 					txt += "[\"";
 					txt += func.get_global_name(code[ip + 2]);
 					txt += "\"]";
-					incr += 4;
+					incr += 5;
 
 				} break;
 				case GDScriptFunction::OPCODE_SET_MEMBER: {
@@ -728,6 +735,13 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 				} break;
 
+				case GDScriptFunction::OPCODE_CALL_PTRCALL: {
+
+					txt += " ptrcall ";
+					txt += itos(code[ip + 1]);
+					incr = 2;
+
+				} break;
 				case GDScriptFunction::OPCODE_CALL:
 				case GDScriptFunction::OPCODE_CALL_RETURN: {
 
@@ -740,7 +754,7 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 					int argc = code[ip + 1];
 					if (ret) {
-						txt += DADDR(4 + argc) + "=";
+						txt += DADDR(5 + argc) + "=";
 					}
 
 					txt += DADDR(2) + ".";
@@ -754,7 +768,7 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					}
 					txt += ")";
 
-					incr = 5 + argc;
+					incr = 6 + argc;
 
 				} break;
 				case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
@@ -856,13 +870,15 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					incr = 2;
 
 				} break;
-				case GDScriptFunction::OPCODE_ITERATE_BEGIN: {
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN:
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN_INT: {
 
 					txt += " for-init " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
 					incr += 5;
 
 				} break;
-				case GDScriptFunction::OPCODE_ITERATE: {
+				case GDScriptFunction::OPCODE_ITERATE:
+				case GDScriptFunction::OPCODE_ITERATE_INT: {
 
 					txt += " for-loop " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
 					incr += 5;
@@ -904,10 +920,217 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 	}
 }
 
+// Pairs of functions doing the same work with and without static types. Every
+// bench_* function takes an iteration count; typed/untyped pairs are compared.
+static const char *benchmark_code =
+		"extends Reference\n"
+		"\n"
+		"class Counter:\n"
+		"\textends Reference\n"
+		"\tvar value = 0\n"
+		"\tfunc add(d):\n"
+		"\t\tvalue += d\n"
+		"\n"
+		"func bench_object_access(n):\n"
+		"\tvar c = Counter.new()\n"
+		"\tvar res = Resource.new()\n"
+		"\tfor i in range(n):\n"
+		"\t\tc.add(1)\n"
+		"\t\tc.value = c.value + 1\n"
+		"\t\tres.resource_name = \"r\"\n"
+		"\t\tif res.resource_name == \"r\":\n"
+		"\t\t\tc.value -= 1\n"
+		"\treturn c.value\n"
+		"\n"
+		"func bench_int_untyped(n):\n"
+		"\tvar acc = 0\n"
+		"\tvar i = 0\n"
+		"\twhile i < n:\n"
+		"\t\tacc = (acc + i * 3) % 1000\n"
+		"\t\ti += 1\n"
+		"\treturn acc\n"
+		"\n"
+		"func bench_int_typed(n: int) -> int:\n"
+		"\tvar acc: int = 0\n"
+		"\tvar i: int = 0\n"
+		"\twhile i < n:\n"
+		"\t\tacc = (acc + i * 3) % 1000\n"
+		"\t\ti += 1\n"
+		"\treturn acc\n"
+		"\n"
+		"func bench_float_untyped(n):\n"
+		"\tvar x = 0.0\n"
+		"\tvar v = 1.5\n"
+		"\tfor i in range(n):\n"
+		"\t\tx = x * 0.5 + v * 2.0 - 1.0\n"
+		"\treturn x\n"
+		"\n"
+		"func bench_float_typed(n: int) -> float:\n"
+		"\tvar x: float = 0.0\n"
+		"\tvar v: float = 1.5\n"
+		"\tfor i in range(n):\n"
+		"\t\tx = x * 0.5 + v * 2.0 - 1.0\n"
+		"\treturn x\n"
+		"\n"
+		"func bench_vector2_untyped(n):\n"
+		"\tvar p = Vector2()\n"
+		"\tvar d = Vector2(1, 2)\n"
+		"\tfor i in range(n):\n"
+		"\t\tp = p + d * 0.5 - p * 0.01\n"
+		"\treturn p\n"
+		"\n"
+		"func bench_vector2_typed(n: int) -> Vector2:\n"
+		"\tvar p: Vector2 = Vector2()\n"
+		"\tvar d: Vector2 = Vector2(1, 2)\n"
+		"\tfor i in range(n):\n"
+		"\t\tp = p + d * 0.5 - p * 0.01\n"
+		"\treturn p\n"
+		"\n"
+		"func bench_array_untyped(n):\n"
+		"\tvar arr = []\n"
+		"\tfor i in range(64):\n"
+		"\t\tarr.push_back(i)\n"
+		"\tvar s = 0\n"
+		"\tvar i = 0\n"
+		"\twhile i < n:\n"
+		"\t\ts += arr[i & 63]\n"
+		"\t\ti += 1\n"
+		"\treturn s\n"
+		"\n"
+		"func bench_array_typed(n: int) -> int:\n"
+		"\tvar arr: Array = []\n"
+		"\tfor i in range(64):\n"
+		"\t\tarr.push_back(i)\n"
+		"\tvar s: int = 0\n"
+		"\tvar i: int = 0\n"
+		"\twhile i < n:\n"
+		"\t\ts += arr[i & 63]\n"
+		"\t\ti += 1\n"
+		"\treturn s\n"
+		"\n"
+		"func bench_native_call_untyped(n):\n"
+		"\tvar r = Reference.new()\n"
+		"\tvar s = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tif not r.has_meta(\"x\") and r.is_class(\"Reference\"):\n"
+		"\t\t\ts += 1\n"
+		"\treturn s\n"
+		"\n"
+		"func bench_native_call_typed(n: int):\n"
+		"\tvar r: Reference = Reference.new()\n"
+		"\tvar s = 0\n"
+		"\tfor i in range(n):\n"
+		"\t\tif not r.has_meta(\"x\") and r.is_class(\"Reference\"):\n"
+		"\t\t\ts += 1\n"
+		"\treturn s\n";
+
+static int _get_code_size(const Ref<GDScript> &p_script) {
+
+	int size = 0;
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->get_member_functions().front(); E; E = E->next()) {
+		size += E->get()->get_code_size();
+	}
+	return size;
+}
+
+// Runs the bench_* methods of p_script, returns their rates in million iterations per second.
+static Map<String, double> _run_benchmark(const Ref<GDScript> &p_script, const String &p_label) {
+
+	Reference *instance = memnew(Reference);
+	Ref<Reference> ref = instance; // keeps the instance alive
+	instance->set_script(p_script.get_ref_ptr());
+
+	List<MethodInfo> methods;
+	p_script->get_script_method_list(&methods);
+
+	const int iterations = 1000000;
+	Map<String, double> rates;
+
+	for (List<MethodInfo>::Element *E = methods.front(); E; E = E->next()) {
+
+		String name = E->get().name;
+		if (!name.begins_with("bench_")) {
+			continue;
+		}
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		Variant ret = instance->call(name, iterations);
+		uint64_t usec = MAX(OS::get_singleton()->get_ticks_usec() - from, (uint64_t)1);
+
+		double rate = iterations / double(usec); // million iterations per second
+		rates[name] = rate;
+		String stats;
+#ifdef DEBUG_ENABLED
+		uint64_t hits, misses;
+		p_script->get_member_functions()[name]->get_inline_cache_stats(&hits, &misses);
+		if (hits + misses) {
+			stats = ", inline cache hits " + rtos(100.0 * hits / (hits + misses)) + "%";
+		}
+#endif
+		print_line(p_label + " " + name + ": " + rtos(rate) + " M iterations/s (returned " + String(ret) + stats + ")");
+	}
+
+	return rates;
+}
+
+static void _benchmark(const String &p_code) {
+
+	// Compiled without and with the optimizer, which is a project setting.
+	const String optimize_setting = "debug/gdscript/compiler/optimize";
+	Variant optimize = ProjectSettings::get_singleton()->get(optimize_setting);
+
+	Map<String, double> rates[2];
+	int code_size[2];
+
+	for (int i = 0; i < 2; i++) {
+
+		ProjectSettings::get_singleton()->set(optimize_setting, i == 1);
+
+		Ref<GDScript> script;
+		script.instance();
+		script->set_source_code(p_code);
+		Error err = script->reload();
+		if (err) {
+			print_line("Could not compile the benchmark script.");
+			ProjectSettings::get_singleton()->set(optimize_setting, optimize);
+			return;
+		}
+
+		code_size[i] = _get_code_size(script);
+		rates[i] = _run_benchmark(script, i == 1 ? "optimized" : "unoptimized");
+	}
+
+	ProjectSettings::get_singleton()->set(optimize_setting, optimize);
+
+	print_line("code size: " + itos(code_size[0]) + " words unoptimized, " + itos(code_size[1]) + " optimized (" + rtos(100.0 * code_size[1] / MAX(code_size[0], 1)) + "%)");
+
+	for (Map<String, double>::Element *E = rates[1].front(); E; E = E->next()) {
+
+		if (rates[0].has(E->key())) {
+			print_line(E->key().trim_prefix("bench_") + ": optimized is " + rtos(E->get() / rates[0][E->key()]) + "x unoptimized");
+		}
+
+		if (!E->key().ends_with("_typed")) {
+			continue;
+		}
+
+		String untyped = E->key().trim_suffix("_typed") + "_untyped";
+		if (rates[1].has(untyped)) {
+			print_line(E->key().trim_suffix("_typed").trim_prefix("bench_") + ": typed is " + rtos(E->get() / rates[1][untyped]) + "x untyped");
+		}
+	}
+}
+
 MainLoop *test(TestType p_type) {
 
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
+	if (p_type == TEST_BENCHMARK && (cmdlargs.empty() || !cmdlargs.back()->get().ends_with(".gd"))) {
+		// No script given, use the built in set.
+		_benchmark(benchmark_code);
+		return NULL;
+	}
+
 	if (cmdlargs.empty()) {
 		return NULL;
 	}
@@ -1040,6 +1263,10 @@ MainLoop *test(TestType p_type) {
 			current = current->get_base();
 		}
 
+	} else if (p_type == TEST_BENCHMARK) {
+
+		_benchmark(code);
+
 	} else if (p_type == TEST_BYTECODE) {
 
 		Vector<uint8_t> buf2 = GDScriptTokenizerBuffer::parse_code_string(code);
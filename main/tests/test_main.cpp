@@ -34,24 +34,36 @@
 #ifdef DEBUG_ENABLED
 
 #include "test_astar.h"
+#include "test_broad_phase.h"
+#include "test_bvh.h"
+#include "test_dictionary.h"
+#include "test_file_access.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
 #include "test_math.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
+#include "test_packed_scene.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
+#include "test_pool_vector.h"
 #include "test_render.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_string_name.h"
+#include "test_worker_thread_pool.h"
 
 const char **tests_get_names() {
 
 	static const char *test_names[] = {
 		"string",
+		"string_name",
 		"math",
 		"physics",
 		"physics_2d",
+		"physics_2d_stress",
+		"broad_phase",
+		"bvh",
 		"render",
 		"oa_hash_map",
 		"gui",
@@ -60,8 +72,14 @@ const char **tests_get_names() {
 		"gd_parser",
 		"gd_compiler",
 		"gd_bytecode",
+		"gd_benchmark",
 		"ordered_hash_map",
 		"astar",
+		"worker_thread_pool",
+		"dictionary",
+		"pool_vector",
+		"file_access",
+		"packed_scene",
 		NULL
 	};
 
@@ -75,6 +93,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestString::test();
 	}
 
+	if (p_test == "string_name") {
+
+		return TestStringName::test();
+	}
+
 	if (p_test == "math") {
 
 		return TestMath::test();
@@ -90,6 +113,21 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "physics_2d_stress") {
+
+		return TestPhysics2D::test_stress();
+	}
+
+	if (p_test == "broad_phase") {
+
+		return TestBroadPhase::test();
+	}
+
+	if (p_test == "bvh") {
+
+		return TestBVH::test();
+	}
+
 	if (p_test == "render") {
 
 		return TestRender::test();
@@ -132,6 +170,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_benchmark") {
+
+		return TestGDScript::test(TestGDScript::TEST_BENCHMARK);
+	}
+
 	if (p_test == "ordered_hash_map") {
 
 		return TestOrderedHashMap::test();
@@ -142,6 +185,31 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "worker_thread_pool") {
+
+		return TestWorkerThreadPool::test();
+	}
+
+	if (p_test == "dictionary") {
+
+		return TestDictionary::test();
+	}
+
+	if (p_test == "pool_vector") {
+
+		return TestPoolVector::test();
+	}
+
+	if (p_test == "file_access") {
+
+		return TestFileAccess::test();
+	}
+
+	if (p_test == "packed_scene") {
+
+		return TestPackedScene::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return NULL;
 }
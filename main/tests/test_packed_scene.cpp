@@ -0,0 +1,302 @@
+/*************************************************************************/
+/*  test_packed_scene.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_packed_scene.h"
+
+#include "core/os/os.h"
+#include "scene/main/node.h"
+#include "scene/main/timer.h"
+#include "scene/resources/packed_scene.h"
+
+namespace TestPackedScene {
+
+static Node *_make_timer(const String &p_name, float p_wait_time) {
+
+	Timer *timer = memnew(Timer);
+	timer->set_name(p_name);
+	timer->set_wait_time(p_wait_time);
+	timer->set_one_shot(true);
+	timer->add_to_group("timers", true);
+	return timer;
+}
+
+static Ref<PackedScene> _pack(Node *p_root) {
+
+	Ref<PackedScene> scene;
+	scene.instance();
+	Error err = scene->pack(p_root);
+	memdelete(p_root);
+	return err == OK ? scene : Ref<PackedScene>();
+}
+
+// A Node root with a Timer wired to it, and an instanced sub-scene holding two timers.
+static Ref<PackedScene> _make_scene(const String &p_sub_path) {
+
+	Node *sub_root = memnew(Node);
+	sub_root->set_name("Sub");
+	for (int i = 0; i < 2; i++) {
+		Node *timer = _make_timer("SubTimer" + itos(i), i + 1);
+		sub_root->add_child(timer);
+		timer->set_owner(sub_root);
+	}
+
+	Ref<PackedScene> sub = _pack(sub_root);
+	if (sub.is_null())
+		return sub;
+	sub->set_path(p_sub_path); //lets the main scene find it in the cache
+
+	Node *root = memnew(Node);
+	root->set_name("Root");
+
+	Node *timer = _make_timer("Timer", 0.5);
+	root->add_child(timer);
+	timer->set_owner(root);
+	timer->connect("timeout", root, "queue_free", Vector<Variant>(), Object::CONNECT_PERSIST);
+
+	Node *instanced = sub->instance();
+	root->add_child(instanced);
+	instanced->set_owner(root);
+	instanced->get_child(1)->set("wait_time", 3.0); //overridden from the main scene
+
+	Ref<PackedScene> scene = _pack(root);
+	if (scene.is_valid()) {
+		scene->set_meta("sub", sub); //keep it in the cache
+	}
+	return scene;
+}
+
+static bool _compare(Node *p_a, Node *p_b) {
+
+	if (!p_a || !p_b)
+		return false;
+
+	if (p_a->get_name() != p_b->get_name() || p_a->get_class() != p_b->get_class() || p_a->get_filename() != p_b->get_filename())
+		return false;
+
+	if ((p_a->get_owner() == NULL) != (p_b->get_owner() == NULL) || p_a->is_in_group("timers") != p_b->is_in_group("timers"))
+		return false;
+
+	Timer *ta = Object::cast_to<Timer>(p_a);
+	Timer *tb = Object::cast_to<Timer>(p_b);
+	if (ta) {
+		if (ta->get_wait_time() != tb->get_wait_time() || ta->is_one_shot() != tb->is_one_shot())
+			return false;
+
+		List<Object::Connection> ca, cb;
+		ta->get_signal_connection_list("timeout", &ca);
+		tb->get_signal_connection_list("timeout", &cb);
+		if (ca.size() != cb.size())
+			return false;
+	}
+
+	if (p_a->get_child_count() != p_b->get_child_count())
+		return false;
+
+	for (int i = 0; i < p_a->get_child_count(); i++) {
+		if (!_compare(p_a->get_child(i), p_b->get_child(i)))
+			return false;
+	}
+
+	return true;
+}
+
+bool test_poll() {
+
+	OS::get_singleton()->print("\n\nTest 1: Polling builds the same tree as instance()\n");
+
+	Ref<PackedScene> scene = _make_scene("res://test_packed_scene_poll.tscn");
+	if (scene.is_null())
+		return false;
+
+	Ref<SceneInteractiveInstancer> ii = scene->instance_interactive();
+	if (ii.is_null())
+		return false;
+
+	int polls = 0;
+	Error err = OK;
+	while (err == OK) {
+		if (ii->get_node())
+			return false; //not handed out before it's done
+		err = ii->poll();
+		polls++;
+	}
+
+	// Nested sub-scenes take several polls for a single stage.
+	if (err != ERR_FILE_EOF || ii->get_stage() != ii->get_stage_count() || polls <= ii->get_stage_count())
+		return false;
+
+	Node *polled = ii->get_node();
+	Node *instanced = scene->instance();
+	bool same = _compare(polled, instanced) && polled->get_filename() == scene->get_path();
+
+	memdelete(polled);
+	memdelete(instanced);
+	return same && ii->poll() == ERR_FILE_EOF;
+}
+
+bool test_wait() {
+
+	OS::get_singleton()->print("\n\nTest 2: Waiting builds the same tree as instance()\n");
+
+	Ref<PackedScene> scene = _make_scene("res://test_packed_scene_wait.tscn");
+	if (scene.is_null())
+		return false;
+
+	Ref<SceneInteractiveInstancer> ii = scene->instance_interactive();
+	ii->poll();
+	if (ii->wait() != ERR_FILE_EOF)
+		return false;
+
+	Node *waited = ii->get_node();
+	Node *instanced = scene->instance();
+	bool same = _compare(waited, instanced);
+
+	memdelete(waited);
+	memdelete(instanced);
+	return same;
+}
+
+bool test_abandon() {
+
+	OS::get_singleton()->print("\n\nTest 3: Abandoning an unfinished instance\n");
+
+	Ref<PackedScene> scene = _make_scene("res://test_packed_scene_abandon.tscn");
+	if (scene.is_null())
+		return false;
+
+	// Stop inside the sub-scene, its nodes are freed with the instancer.
+	for (int stop = 1; stop < 6; stop++) {
+		Ref<SceneInteractiveInstancer> ii = scene->instance_interactive();
+		for (int i = 0; i < stop; i++) {
+			if (ii->poll() != OK)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// Renames the type of the root node to one that doesn't exist.
+static void _break_root(Ref<PackedScene> p_scene) {
+
+	Dictionary bundled = p_scene->get("_bundled");
+	PoolVector<String> names = bundled["names"];
+	for (int i = 0; i < names.size(); i++) {
+		if (names[i] == "Timer") {
+			names.set(i, "TestPackedSceneMissingType");
+		}
+	}
+	bundled["names"] = names;
+	p_scene->set("_bundled", bundled);
+}
+
+bool test_invalid_root() {
+
+	OS::get_singleton()->print("\n\nTest 4: Root node that can't be created\n");
+
+	Node *root = _make_timer("Broken", 1);
+	Node *child = memnew(Node);
+	child->set_name("Child");
+	root->add_child(child);
+	child->set_owner(root);
+
+	Ref<PackedScene> scene = _pack(root);
+	if (scene.is_null())
+		return false;
+	_break_root(scene);
+
+	if (scene->instance())
+		return false;
+
+	Ref<SceneInteractiveInstancer> ii = scene->instance_interactive();
+	return ii->wait() == ERR_CANT_CREATE && ii->get_node() == NULL && ii->poll() == ERR_CANT_CREATE;
+}
+
+bool test_invalid_sub_scene() {
+
+	OS::get_singleton()->print("\n\nTest 5: Sub-scene root that can't be created\n");
+
+	Node *sub_root = _make_timer("Sub", 1);
+	Ref<PackedScene> sub = _pack(sub_root);
+	if (sub.is_null())
+		return false;
+	sub->set_path("res://test_packed_scene_broken_sub.tscn");
+
+	Node *root = memnew(Node);
+	root->set_name("Root");
+	Node *instanced = sub->instance();
+	root->add_child(instanced);
+	instanced->set_owner(root);
+
+	Ref<PackedScene> scene = _pack(root);
+	if (scene.is_null())
+		return false;
+	_break_root(sub);
+
+	if (scene->instance())
+		return false;
+
+	Ref<SceneInteractiveInstancer> ii = scene->instance_interactive();
+	return ii->wait() == ERR_CANT_CREATE && ii->get_node() == NULL;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_poll,
+	test_wait,
+	test_abandon,
+	test_invalid_root,
+	test_invalid_sub_scene,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+
+} // namespace TestPackedScene
@@ -426,10 +426,114 @@ public:
 	TestPhysics2DMainLoop() {}
 };
 
+// Headless stress scene: piles of boxes far enough apart to form separate islands.
+class TestPhysics2DStressMainLoop : public MainLoop {
+
+	GDCLASS(TestPhysics2DStressMainLoop, MainLoop);
+
+	enum {
+		PILE_HEIGHT = 10,
+		STEPS = 120
+	};
+
+	RID box_shape;
+	RID ground_shape;
+
+	void _run(int p_body_count) {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+
+		RID space = ps->space_create();
+		ps->space_set_active(space, true);
+		ps->area_set_param(space, Physics2DServer::AREA_PARAM_GRAVITY_VECTOR, Vector2(0, 1));
+		ps->area_set_param(space, Physics2DServer::AREA_PARAM_GRAVITY, 98);
+
+		RID ground = ps->body_create();
+		ps->body_set_mode(ground, Physics2DServer::BODY_MODE_STATIC);
+		ps->body_set_space(ground, space);
+		ps->body_add_shape(ground, ground_shape);
+
+		Vector<RID> bodies;
+		for (int i = 0; i < p_body_count; i++) {
+
+			int pile = i / PILE_HEIGHT;
+			int level = i % PILE_HEIGHT;
+
+			RID body = ps->body_create();
+			ps->body_add_shape(body, box_shape);
+			ps->body_set_space(body, space);
+			ps->body_set_state(body, Physics2DServer::BODY_STATE_TRANSFORM, Transform2D(0, Point2(pile * 40, -8 - level * 17)));
+			bodies.push_back(body);
+		}
+
+		const real_t step = 1.0 / 60.0;
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < STEPS; i++) {
+			ps->sync();
+			ps->flush_queries();
+			ps->end_sync();
+			ps->step(step);
+		}
+		ps->sync();
+		ps->end_sync();
+		uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - from;
+
+		print_line(vformat("%d bodies, %d islands: %s steps/s", p_body_count, ps->get_process_info(Physics2DServer::INFO_ISLAND_COUNT), rtos(STEPS * 1000000.0 / MAX(elapsed, (uint64_t)1))));
+
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->free(bodies[i]);
+		}
+		ps->free(ground);
+		ps->free(space);
+	}
+
+public:
+	virtual void init() {
+
+		Physics2DServer *ps = Physics2DServer::get_singleton();
+		ps->set_active(true);
+
+		box_shape = ps->rectangle_shape_create();
+		ps->shape_set_data(box_shape, Vector2(8, 8));
+
+		Array plane;
+		plane.push_back(Vector2(0, -1));
+		plane.push_back(0);
+		ground_shape = ps->line_shape_create();
+		ps->shape_set_data(ground_shape, plane);
+
+		const int counts[] = { 1000, 2000, 5000, 10000, 20000 };
+		for (int i = 0; i < 5; i++) {
+			_run(counts[i]);
+		}
+
+		ps->free(box_shape);
+		ps->free(ground_shape);
+	}
+
+	virtual bool iteration(float p_time) {
+
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+
+		return true;
+	}
+
+	TestPhysics2DStressMainLoop() {}
+};
+
 namespace TestPhysics2D {
 
 MainLoop *test() {
 
 	return memnew(TestPhysics2DMainLoop);
 }
+
+MainLoop *test_stress() {
+
+	return memnew(TestPhysics2DStressMainLoop);
+}
 } // namespace TestPhysics2D
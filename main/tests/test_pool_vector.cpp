@@ -0,0 +1,306 @@
+/*************************************************************************/
+/*  test_pool_vector.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_pool_vector.h"
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/pool_vector.h"
+#include "core/variant.h"
+
+namespace TestPoolVector {
+
+bool test_alloc_release() {
+
+	OS::get_singleton()->print("\n\nTest 1: Allocation and release\n");
+
+	uint32_t used = MemoryPool::allocs_used;
+
+	{
+		Vector<PoolVector<int> > vectors;
+		vectors.resize(1000);
+		for (int i = 0; i < vectors.size(); i++) {
+			vectors.write[i].resize(i % 7 + 1);
+			vectors.write[i].set(0, i);
+		}
+		if (MemoryPool::allocs_used != used + 1000) {
+			return false;
+		}
+
+		// Copies share the allocation until written to.
+		PoolVector<int> copy = vectors[10];
+		if (MemoryPool::allocs_used != used + 1000) {
+			return false;
+		}
+		copy.set(0, -1);
+		if (MemoryPool::allocs_used != used + 1001 || vectors[10][0] != 10 || copy[0] != -1) {
+			return false;
+		}
+
+		vectors.write[20].resize(0);
+		if (MemoryPool::allocs_used != used + 1000) {
+			return false;
+		}
+	}
+
+	return MemoryPool::allocs_used == used;
+}
+
+struct ThreadData {
+
+	int iterations;
+	bool failed;
+	Thread *thread;
+};
+
+static void _alloc_vectors(void *p_userdata) {
+
+	ThreadData *td = (ThreadData *)p_userdata;
+
+	PoolVector<int> kept[8];
+	for (int i = 0; i < td->iterations; i++) {
+
+		PoolVector<int> v;
+		v.resize(16 + (i & 15));
+		{
+			PoolVector<int>::Write w = v.write();
+			w[0] = i;
+		}
+
+		// Copy on write takes a second allocation, which is then released.
+		PoolVector<int> copy = v;
+		copy.set(1, i);
+
+		// Keep some alive for a while, so allocations and releases interleave.
+		kept[i & 7] = copy;
+
+		if (v[0] != i || copy[0] != i || copy[1] != i) {
+			td->failed = true;
+		}
+	}
+}
+
+static void _run_threads(ThreadData *p_data, int p_count) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_data[i].thread = Thread::create(_alloc_vectors, &p_data[i]);
+	}
+	for (int i = 0; i < p_count; i++) {
+		Thread::wait_to_finish(p_data[i].thread);
+		memdelete(p_data[i].thread);
+	}
+}
+
+bool test_threaded_alloc() {
+
+	OS::get_singleton()->print("\n\nTest 2: Allocation from several threads\n");
+
+	uint32_t used = MemoryPool::allocs_used;
+#ifdef DEBUG_ENABLED
+	uint64_t memory = MemoryPool::total_memory;
+#endif
+
+	const int thread_count = 8;
+	ThreadData data[thread_count];
+	for (int i = 0; i < thread_count; i++) {
+		data[i].iterations = 20000;
+		data[i].failed = false;
+	}
+
+	_run_threads(data, thread_count);
+
+	for (int i = 0; i < thread_count; i++) {
+		if (data[i].failed) {
+			OS::get_singleton()->print("\tthread %i read back wrong data\n", i);
+			return false;
+		}
+	}
+
+	if (MemoryPool::allocs_used != used) {
+		OS::get_singleton()->print("\t%i allocations leaked\n", int(MemoryPool::allocs_used - used));
+		return false;
+	}
+
+#ifdef DEBUG_ENABLED
+	if (MemoryPool::total_memory != memory) {
+		OS::get_singleton()->print("\tmemory usage is off by %i bytes\n", int(MemoryPool::total_memory - memory));
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+void benchmark_alloc() {
+
+	const int iterations = 200000;
+	int max_threads = MAX(OS::get_singleton()->get_processor_count(), 4);
+
+	for (int threads = 1; threads <= max_threads; threads *= 2) {
+
+		ThreadData *data = memnew_arr(ThreadData, threads);
+		for (int i = 0; i < threads; i++) {
+			data[i].iterations = iterations;
+			data[i].failed = false;
+		}
+
+		uint64_t from = OS::get_singleton()->get_ticks_usec();
+		_run_threads(data, threads);
+		uint64_t time = OS::get_singleton()->get_ticks_usec() - from;
+
+		memdelete_arr(data);
+
+		// Every iteration allocates and releases two vectors.
+		double ops = double(threads) * iterations * 2;
+		OS::get_singleton()->print("\t%i threads: %.2f M allocations/s\n", threads, ops / MAX(time, 1));
+	}
+}
+
+bool test_int_numeric() {
+
+	OS::get_singleton()->print("\n\nTest 3: Integer sum, dot and arithmetic\n");
+
+	PoolVector<int> a;
+	PoolVector<int> b;
+	for (int i = 0; i < 1001; i++) {
+		a.push_back(i - 500);
+		b.push_back(i % 7);
+	}
+
+	int64_t sum = 0;
+	int64_t dot = 0;
+	for (int i = 0; i < a.size(); i++) {
+		sum += a[i];
+		dot += int64_t(a[i]) * b[i];
+	}
+	if (a.sum() != sum || a.dot(b) != dot) {
+		return false;
+	}
+
+	// Sums past 32 bits must reach scripts as they are, not truncated.
+	PoolVector<int> big;
+	big.resize(5);
+	big.fill(0x7FFFFFFF);
+	int64_t expected = int64_t(0x7FFFFFFF) * 5;
+	Variant big_v = big;
+	Variant::CallError ce;
+	if (big.sum() != expected || int64_t(big_v.call("sum", NULL, 0, ce)) != expected || big.dot(big) != int64_t(0x7FFFFFFF) * 0x7FFFFFFF * 5) {
+		OS::get_singleton()->print("\tsum above 2^31 is wrong\n");
+		return false;
+	}
+
+	// Element results saturate to 32 bits instead of overflowing.
+	big.add_scalar(10);
+	PoolVector<int> neg = big;
+	neg.multiply_scalar(-1);
+	PoolVector<int> huge = big;
+	huge.multiply_scalar(int64_t(1) << 40);
+	PoolVector<int> product = big;
+	product.multiply_array(neg);
+	if (big[0] != 0x7FFFFFFF || neg[0] != -0x7FFFFFFF || huge[0] != 0x7FFFFFFF || product[0] != -0x7FFFFFFF - 1) {
+		OS::get_singleton()->print("\telements did not saturate\n");
+		return false;
+	}
+
+	// Sizes that don't match are an error, and leave the array alone.
+	PoolVector<int> short_array;
+	short_array.push_back(1);
+	OS::get_singleton()->print("\ttwo errors about the array size are expected:\n");
+	if (a.dot(short_array) != 0) {
+		return false;
+	}
+	a.add_array(short_array);
+	return a[0] == -500;
+}
+
+bool test_real_numeric() {
+
+	OS::get_singleton()->print("\n\nTest 4: Real sum, dot and arithmetic\n");
+
+	PoolVector<real_t> a;
+	PoolVector<real_t> b;
+	for (int i = 0; i < 1001; i++) {
+		a.push_back(i * 0.5);
+		b.push_back(2.0);
+	}
+
+	// All the values are exact in floating point.
+	if (a.sum() != 250250.0 || a.dot(b) != 500500.0) {
+		return false;
+	}
+
+	a.add_scalar(1.0);
+	a.multiply_scalar(0.5);
+	a.multiply_array(b);
+	a.add_array(b);
+	if (a[0] != 3.0 || a[10] != 8.0) {
+		return false;
+	}
+
+	PoolVector<real_t> empty;
+	OS::get_singleton()->print("\tan error about the array size is expected:\n");
+	return empty.sum() == 0.0 && a.dot(empty) == 0.0;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_alloc_release,
+	test_threaded_alloc,
+	test_int_numeric,
+	test_real_numeric,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	OS::get_singleton()->print("\nAllocation throughput:\n");
+	benchmark_alloc();
+
+	return NULL;
+}
+
+} // namespace TestPoolVector
@@ -0,0 +1,257 @@
+/*************************************************************************/
+/*  test_string_name.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_string_name.h"
+
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string_name.h"
+
+namespace TestStringName {
+
+bool test_interning() {
+
+	OS::get_singleton()->print("\n\nTest 1: Interning\n");
+
+	StringName a("test_string_name_interning");
+	StringName b(String("test_string_name_interning"));
+	StringName c = _scs_create("test_string_name_interning");
+
+	if (a != b || a != c) {
+		return false;
+	}
+
+	if (StringName::search("test_string_name_interning") != a) {
+		return false;
+	}
+
+	return a == "test_string_name_interning" && String(a) == "test_string_name_interning";
+}
+
+bool test_release() {
+
+	OS::get_singleton()->print("\n\nTest 2: Release of unused names\n");
+
+	{
+		StringName a("test_string_name_release");
+		if (StringName::search("test_string_name_release") != a) {
+			return false;
+		}
+	}
+
+	return StringName::search("test_string_name_release") == StringName();
+}
+
+struct ThreadData {
+
+	const Vector<String> *names;
+	Vector<StringName> interned;
+	int iterations;
+	Mutex *global_lock;
+	Thread *thread;
+};
+
+static void _intern_names(void *p_userdata) {
+
+	ThreadData *td = (ThreadData *)p_userdata;
+	const Vector<String> &names = *td->names;
+
+	td->interned.resize(names.size());
+	for (int i = 0; i < td->iterations; i++) {
+		for (int j = 0; j < names.size(); j++) {
+			// drop the previous reference first, so some names get freed and inserted again
+			td->interned.write[j] = StringName();
+			td->interned.write[j] = StringName(names[j]);
+		}
+	}
+}
+
+static void _run_threads(ThreadData *p_data, int p_count, void (*p_func)(void *)) {
+
+	for (int i = 0; i < p_count; i++) {
+		p_data[i].thread = Thread::create(p_func, &p_data[i]);
+	}
+	for (int i = 0; i < p_count; i++) {
+		Thread::wait_to_finish(p_data[i].thread);
+		memdelete(p_data[i].thread);
+	}
+}
+
+bool test_threaded_interning() {
+
+	OS::get_singleton()->print("\n\nTest 3: Interning from several threads\n");
+
+	Vector<String> names;
+	for (int i = 0; i < 2000; i++) {
+		names.push_back("test_string_name_threaded_" + itos(i));
+	}
+
+	const int thread_count = 8;
+	ThreadData data[thread_count];
+	for (int i = 0; i < thread_count; i++) {
+		data[i].names = &names;
+		data[i].iterations = 20;
+		data[i].global_lock = NULL;
+	}
+
+	_run_threads(data, thread_count, _intern_names);
+
+	// every thread must have ended up with the very same entry for each name
+	for (int i = 0; i < names.size(); i++) {
+		StringName expected = StringName::search(names[i]);
+		if (expected == StringName() || expected != names[i]) {
+			OS::get_singleton()->print("\tname %i was not interned\n", i);
+			return false;
+		}
+		for (int j = 0; j < thread_count; j++) {
+			if (data[j].interned[i] != expected) {
+				OS::get_singleton()->print("\tname %i has more than one entry\n", i);
+				return false;
+			}
+		}
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		data[i].interned.clear();
+	}
+
+	for (int i = 0; i < names.size(); i++) {
+		if (StringName::search(names[i]) != StringName()) {
+			OS::get_singleton()->print("\tname %i was not released\n", i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Emulates the former table wide mutex by serializing every construction and release.
+static void _intern_names_global_lock(void *p_userdata) {
+
+	ThreadData *td = (ThreadData *)p_userdata;
+	const Vector<String> &names = *td->names;
+
+	td->interned.resize(names.size());
+	for (int i = 0; i < td->iterations; i++) {
+		for (int j = 0; j < names.size(); j++) {
+			td->global_lock->lock();
+			td->interned.write[j] = StringName();
+			td->global_lock->unlock();
+
+			td->global_lock->lock();
+			td->interned.write[j] = StringName(names[j]);
+			td->global_lock->unlock();
+		}
+	}
+}
+
+static uint64_t _benchmark_threads(const Vector<String> &p_names, int p_threads, int p_iterations, Mutex *p_global_lock) {
+
+	ThreadData *data = memnew_arr(ThreadData, p_threads);
+	for (int i = 0; i < p_threads; i++) {
+		data[i].names = &p_names;
+		data[i].iterations = p_iterations;
+		data[i].global_lock = p_global_lock;
+	}
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	_run_threads(data, p_threads, p_global_lock ? _intern_names_global_lock : _intern_names);
+	uint64_t time = OS::get_singleton()->get_ticks_usec() - from;
+
+	memdelete_arr(data);
+
+	return time;
+}
+
+void benchmark_interning() {
+
+	Vector<String> names;
+	for (int i = 0; i < 1024; i++) {
+		names.push_back("bench_string_name_" + itos(i));
+	}
+
+	// keep half of the names alive, so both the lookup and the insert/remove paths are exercised
+	Vector<StringName> kept;
+	for (int i = 0; i < names.size(); i += 2) {
+		kept.push_back(names[i]);
+	}
+
+	Mutex *global_lock = Mutex::create();
+	const int iterations = 200;
+	int max_threads = MAX(OS::get_singleton()->get_processor_count(), 4);
+
+	for (int threads = 1; threads <= max_threads; threads *= 2) {
+
+		double ops = double(threads) * iterations * names.size() * 2;
+
+		uint64_t global_time = _benchmark_threads(names, threads, iterations, global_lock);
+		uint64_t sharded_time = _benchmark_threads(names, threads, iterations, NULL);
+
+		OS::get_singleton()->print("\t%i threads: global mutex %.2f Mops/s, sharded table %.2f Mops/s\n", threads, ops / MAX(global_time, 1), ops / MAX(sharded_time, 1));
+	}
+
+	memdelete(global_lock);
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_interning,
+	test_release,
+	test_threaded_interning,
+	NULL
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	OS::get_singleton()->print("\nInterning throughput:\n");
+	benchmark_interning();
+
+	return NULL;
+}
+
+} // namespace TestStringName
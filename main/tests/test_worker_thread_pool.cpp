@@ -0,0 +1,243 @@
+/*************************************************************************/
+/*  test_worker_thread_pool.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_worker_thread_pool.h"
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/os/threaded_array_processor.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/safe_refcount.h"
+
+namespace TestWorkerThreadPool {
+
+struct ArrayData {
+	Vector<uint32_t> values;
+	volatile uint32_t counter;
+
+	void square(uint32_t p_index, uint32_t p_offset) {
+		values.write[p_index] = p_index * p_index + p_offset;
+	}
+
+	void touch(uint32_t p_index, void *p_unused) {
+		atomic_increment(&counter);
+	}
+};
+
+static void _add_one(void *p_userdata, uint32_t p_index) {
+
+	uint32_t *values = (uint32_t *)p_userdata;
+	values[p_index]++;
+}
+
+static void _double(void *p_userdata, uint32_t p_index) {
+
+	uint32_t *values = (uint32_t *)p_userdata;
+	values[p_index] *= 2;
+}
+
+bool test_group_task() {
+
+	ArrayData data;
+	data.values.resize(10000);
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	WorkerThreadPool::GroupID group = pool->add_template_group_task(&data, &ArrayData::square, 7u, data.values.size(), 16);
+	pool->wait_for_group_task_completion(group);
+
+	for (int i = 0; i < data.values.size(); i++) {
+		if (data.values[i] != uint32_t(i * i + 7))
+			return false;
+	}
+	return true;
+}
+
+bool test_dependencies() {
+
+	const int count = 4096;
+	Vector<uint32_t> values;
+	values.resize(count);
+	for (int i = 0; i < count; i++) {
+		values.write[i] = i;
+	}
+
+	// (i + 1) * 2 only holds if the second group waits for the first one.
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	WorkerThreadPool::GroupID first = pool->add_group_task(_add_one, values.ptrw(), count, 1);
+	WorkerThreadPool::GroupID second = pool->add_group_task(_double, values.ptrw(), count, 1, &first, 1);
+	pool->wait_for_group_task_completion(second);
+	pool->wait_for_group_task_completion(first);
+
+	for (int i = 0; i < count; i++) {
+		if (values[i] != uint32_t((i + 1) * 2))
+			return false;
+	}
+	return true;
+}
+
+bool test_thread_process_array() {
+
+	ArrayData data;
+	data.counter = 0;
+	thread_process_array(12345, &data, &ArrayData::touch, (void *)NULL);
+	return data.counter == 12345;
+}
+
+// The way thread_process_array used to work, spawning and joining threads on every call.
+template <class C, class U>
+struct SpawnData {
+	uint32_t elements;
+	volatile uint32_t index;
+	C *instance;
+	void (C::*method)(uint32_t, U);
+	U userdata;
+};
+
+template <class C, class U>
+static void _spawn_thread_func(void *p_userdata) {
+
+	SpawnData<C, U> &data = *(SpawnData<C, U> *)p_userdata;
+	while (true) {
+		uint32_t index = atomic_increment(&data.index) - 1;
+		if (index >= data.elements)
+			break;
+		(data.instance->*data.method)(index, data.userdata);
+	}
+}
+
+static void _spawn_process_array(uint32_t p_elements, ArrayData *p_instance) {
+
+	SpawnData<ArrayData, void *> data;
+	data.elements = p_elements;
+	data.index = 0;
+	data.instance = p_instance;
+	data.method = &ArrayData::touch;
+	data.userdata = NULL;
+
+	Vector<Thread *> threads;
+	threads.resize(OS::get_singleton()->get_processor_count());
+	for (int i = 0; i < threads.size(); i++) {
+		threads.write[i] = Thread::create(_spawn_thread_func<ArrayData, void *>, &data);
+	}
+	for (int i = 0; i < threads.size(); i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+}
+
+void benchmark_dispatch(uint32_t p_elements, int p_iterations) {
+
+	ArrayData data;
+	data.counter = 0;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_iterations; i++) {
+		_spawn_process_array(p_elements, &data);
+	}
+	uint64_t spawn_time = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_iterations; i++) {
+		thread_process_array(p_elements, &data, &ArrayData::touch, (void *)NULL);
+	}
+	uint64_t pool_time = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("\t%u elements x %i: spawned threads %.2f usec/call, worker pool %.2f usec/call\n", p_elements, p_iterations, double(spawn_time) / p_iterations, double(pool_time) / p_iterations);
+}
+
+bool test_many_groups() {
+
+	// Short groups back to back, so exhausted groups get waited for (and freed)
+	// while the workers are still looking for more work.
+	const int rounds = 2000;
+	const int count = 8;
+	Vector<uint32_t> values;
+	values.resize(count * rounds);
+	for (int i = 0; i < values.size(); i++) {
+		values.write[i] = i;
+	}
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	for (int i = 0; i < rounds; i++) {
+		WorkerThreadPool::GroupID group = pool->add_group_task(_add_one, values.ptrw() + i * count, count, 1);
+		pool->wait_for_group_task_completion(group);
+	}
+
+	for (int i = 0; i < values.size(); i++) {
+		if (values[i] != uint32_t(i + 1))
+			return false;
+	}
+
+	ArrayData data;
+	data.counter = 0;
+	for (int i = 0; i < rounds; i++) {
+		thread_process_array(count, &data, &ArrayData::touch, (void *)NULL);
+	}
+	return data.counter == uint32_t(rounds * count);
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+	test_group_task,
+	test_dependencies,
+	test_thread_process_array,
+	test_many_groups,
+	NULL
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	OS::get_singleton()->print("Worker threads: %i\n", WorkerThreadPool::get_singleton()->get_thread_count());
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+	OS::get_singleton()->print("\n");
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	OS::get_singleton()->print("\nDispatch overhead:\n");
+	benchmark_dispatch(64, 1000);
+	benchmark_dispatch(4096, 1000);
+	benchmark_dispatch(1 << 22, 10);
+
+	return NULL;
+}
+
+} // namespace TestWorkerThreadPool
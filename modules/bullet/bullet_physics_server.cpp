@@ -677,6 +677,17 @@ void BulletPhysicsServer::body_set_state(RID p_body, BodyState p_state, const Va
 	body->set_state(p_state, p_variant);
 }
 
+void BulletPhysicsServer::bodies_set_state(const Vector<RID> &p_bodies, BodyState p_state, const Array &p_values) {
+	ERR_FAIL_COND(p_values.size() != p_bodies.size());
+
+	for (int i = 0; i < p_bodies.size(); i++) {
+		RigidBodyBullet *body = rigid_body_owner.get(p_bodies[i]);
+		ERR_CONTINUE(!body);
+
+		body->set_state(p_state, p_values[i]);
+	}
+}
+
 Variant BulletPhysicsServer::body_get_state(RID p_body, BodyState p_state) const {
 	RigidBodyBullet *body = rigid_body_owner.get(p_body);
 	ERR_FAIL_COND_V(!body, Variant());
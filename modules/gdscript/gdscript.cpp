@@ -33,9 +33,13 @@
 #include "core/engine.h"
 #include "core/global_constants.h"
 #include "core/io/file_access_encrypted.h"
+#include "core/io/resource_loader.h"
 #include "core/os/file_access.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/project_settings.h"
+#include "core/safe_refcount.h"
+#include "gdscript_bytecode.h"
 #include "gdscript_compiler.h"
 
 ///////////////////////////
@@ -769,6 +773,24 @@ Error GDScript::load_byte_code(const String &p_path) {
 	ERR_FAIL_COND_V(bytecode.size() == 0, ERR_PARSE_ERROR);
 	path = p_path;
 
+	if (GDScriptBytecode::is_compiled(bytecode)) {
+
+		if (GDScriptBytecode::load(this, bytecode) == OK) {
+
+			valid = true;
+
+			for (Map<StringName, Ref<GDScript> >::Element *E = subclasses.front(); E; E = E->next()) {
+
+				_set_subclass_path(E->get(), path);
+			}
+
+			return OK;
+		}
+
+		bytecode = GDScriptBytecode::get_tokens(bytecode);
+		ERR_FAIL_COND_V(bytecode.size() == 0, ERR_FILE_CORRUPT);
+	}
+
 	String basedir = path;
 
 	if (basedir == "")
@@ -924,6 +946,7 @@ GDScript::GDScript() :
 }
 
 GDScript::~GDScript() {
+	GDScriptFunction::invalidate_inline_caches(); // the address may be reused by another script
 	for (Map<StringName, GDScriptFunction *>::Element *E = member_functions.front(); E; E = E->next()) {
 		memdelete(E->get());
 	}
@@ -1528,6 +1551,103 @@ int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_
 	return current;
 }
 
+void GDScriptLanguage::_sampling_thread_func(void *p_userdata) {
+
+	GDScriptLanguage *language = (GDScriptLanguage *)p_userdata;
+
+	while (!language->sampling_exit) {
+
+		OS::get_singleton()->delay_usec(language->sampling_interval);
+
+		// Only the call stack of the main thread is tracked, and it can only be
+		// read safely from that thread, so just count the tick here.
+		if (language->_debug_call_stack_pos > 0)
+			atomic_increment(&language->sampling_ticks);
+	}
+}
+
+void GDScriptLanguage::_take_sample() {
+
+	if (Thread::get_main_id() != Thread::get_caller_id())
+		return;
+
+	uint32_t ticks = sampling_ticks;
+	atomic_sub(&sampling_ticks, ticks);
+
+	int depth = MIN(_debug_call_stack_pos, _debug_max_call_stack);
+	if (depth == 0 || ticks == 0)
+		return;
+
+	String stack;
+	for (int i = 0; i < depth; i++) {
+
+		const CallLevel &cl = _call_stack[i];
+		if (i > 0)
+			stack += ";";
+		stack += String(cl.function->get_source()) + ":" + String(cl.function->get_name()) + ":" + itos(*cl.line);
+	}
+
+	Map<String, int>::Element *E = sampled_stacks.find(stack);
+	if (E) {
+		E->get() += ticks;
+	} else {
+		sampled_stacks.insert(stack, ticks);
+	}
+}
+
+void GDScriptLanguage::sampling_start(int p_frequency) {
+
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND(p_frequency <= 0);
+
+	if (sampling)
+		sampling_stop();
+
+	if (!_call_stack) {
+		_debug_max_call_stack = GLOBAL_GET("debug/settings/gdscript/max_call_stack");
+		_call_stack = memnew_arr(CallLevel, _debug_max_call_stack + 1);
+	}
+
+	sampled_stacks.clear();
+	sampling_ticks = 0;
+	sampling_interval = MAX(1000000 / p_frequency, 1);
+	sampling_exit = false;
+	sampling = true;
+	sampling_thread = Thread::create(_sampling_thread_func, this);
+#else
+	WARN_PRINT("Script sampling is only available in debug builds.");
+#endif
+}
+
+void GDScriptLanguage::sampling_stop() {
+
+	if (!sampling)
+		return;
+
+	sampling_exit = true;
+	if (sampling_thread) {
+		Thread::wait_to_finish(sampling_thread);
+		memdelete(sampling_thread);
+		sampling_thread = NULL;
+	}
+	sampling = false;
+}
+
+void GDScriptLanguage::sampling_get_stacks(Map<String, int> *r_stacks) {
+
+	ERR_FAIL_COND(!r_stacks);
+
+	for (Map<String, int>::Element *E = sampled_stacks.front(); E; E = E->next()) {
+
+		Map<String, int>::Element *F = r_stacks->find(E->key());
+		if (F) {
+			F->get() += E->get();
+		} else {
+			r_stacks->insert(E->key(), E->get());
+		}
+	}
+}
+
 struct GDScriptDepSort {
 
 	//must support sorting so inheritance works properly (parent must be reloaded first)
@@ -1719,10 +1839,274 @@ void GDScriptLanguage::reload_tool_script(const Ref<Script> &p_script, bool p_so
 #endif
 }
 
+bool GDScriptLanguage::_get_compile_dependencies(const String &p_path, const Map<StringName, String> &p_autoloads, List<String> *r_paths) {
+
+	String path = ResourceLoader::path_remap(p_path);
+
+	GDScriptTokenizerText tt;
+	GDScriptTokenizerBuffer tb;
+	GDScriptTokenizer *tokenizer;
+
+	if (path.get_extension() == "gd") {
+
+		FileAccessRef file = FileAccess::open(path, FileAccess::READ);
+		if (!file)
+			return false;
+
+		tt.set_code(file->get_as_utf8_string());
+		tokenizer = &tt;
+
+	} else if (path.get_extension() == "gdc") {
+
+		Vector<uint8_t> buffer = FileAccess::get_file_as_array(path);
+		if (GDScriptBytecode::is_compiled(buffer))
+			buffer = GDScriptBytecode::get_tokens(buffer);
+		if (buffer.empty() || tb.set_code_buffer(buffer) != OK)
+			return false;
+		tokenizer = &tb;
+
+	} else {
+		return false; // Encrypted, it's only read when loading.
+	}
+
+	// Everything the parser or compiler loads: the base script, preloads, and
+	// scripts used through global class names or autoload names.
+	String base_dir = p_path.get_base_dir();
+
+	while (tokenizer->get_token() != GDScriptTokenizer::TK_EOF && tokenizer->get_token() != GDScriptTokenizer::TK_ERROR) {
+
+		String dependency;
+
+		switch (tokenizer->get_token()) {
+			case GDScriptTokenizer::TK_PR_EXTENDS: {
+
+				if (tokenizer->get_token(1) == GDScriptTokenizer::TK_CONSTANT && tokenizer->get_token_constant(1).get_type() == Variant::STRING) {
+					dependency = tokenizer->get_token_constant(1);
+				}
+			} break;
+			case GDScriptTokenizer::TK_PR_PRELOAD: {
+
+				if (tokenizer->get_token(1) == GDScriptTokenizer::TK_PARENTHESIS_OPEN && tokenizer->get_token(2) == GDScriptTokenizer::TK_CONSTANT && tokenizer->get_token_constant(2).get_type() == Variant::STRING) {
+					dependency = tokenizer->get_token_constant(2);
+				}
+			} break;
+			case GDScriptTokenizer::TK_IDENTIFIER: {
+
+				StringName identifier = tokenizer->get_token_identifier();
+				if (ScriptServer::is_global_class(identifier)) {
+					r_paths->push_back(ScriptServer::get_global_class_path(identifier));
+				} else if (p_autoloads.has(identifier)) {
+					r_paths->push_back(p_autoloads[identifier]);
+				}
+			} break;
+			default: {
+			}
+		}
+
+		if (dependency != String()) {
+			if (dependency.is_rel_path()) {
+				dependency = base_dir.plus_file(dependency).simplify_path();
+			}
+			r_paths->push_back(dependency);
+		}
+
+		tokenizer->advance();
+	}
+
+	return true;
+}
+
+struct GDScriptDependencyScript {
+
+	String path;
+	Vector<int> dependents;
+	int pending;
+	bool serial;
+	RES resource;
+
+	GDScriptDependencyScript() {
+		pending = 0;
+		serial = false;
+	}
+};
+
+struct GDScriptDependencyBatch {
+
+	GDScriptDependencyScript *scripts;
+	const int *indices;
+};
+
+static void _load_dependency_script(void *p_userdata, uint32_t p_index) {
+
+	GDScriptDependencyBatch *batch = (GDScriptDependencyBatch *)p_userdata;
+	GDScriptDependencyScript &script = batch->scripts[batch->indices[p_index]];
+	script.resource = ResourceLoader::load(script.path);
+}
+
+void GDScriptLanguage::load_dependencies(const Vector<String> &p_paths, List<RES> *r_resources) {
+
+	Map<StringName, String> autoloads;
+	{
+		List<PropertyInfo> props;
+		ProjectSettings::get_singleton()->get_property_list(&props);
+		for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+
+			if (!E->get().name.begins_with("autoload/"))
+				continue;
+			String path = ProjectSettings::get_singleton()->get(E->get().name);
+			if (path.begins_with("*")) {
+				path = path.substr(1, path.length() - 1);
+			}
+			autoloads[E->get().name.get_slicec('/', 1)] = path;
+		}
+	}
+
+	// Find the scripts that aren't loaded yet and what each one loads while
+	// compiling. Other resources are only followed to find more scripts.
+	Vector<GDScriptDependencyScript> scripts;
+	Map<String, int> script_indices;
+	List<Pair<int, String> > script_dependencies;
+
+	Set<String> visited;
+	List<String> to_visit;
+	for (int i = 0; i < p_paths.size(); i++) {
+		to_visit.push_back(p_paths[i]);
+	}
+
+	while (to_visit.size()) {
+
+		String path = to_visit.front()->get();
+		to_visit.pop_front();
+
+		if (visited.has(path) || ResourceCache::has(path))
+			continue;
+		visited.insert(path);
+
+		String extension = path.get_extension();
+		if (extension == "gd" || extension == "gdc" || extension == "gde") {
+
+			GDScriptDependencyScript script;
+			script.path = path;
+
+			List<String> dependencies;
+			if (!_get_compile_dependencies(path, autoloads, &dependencies)) {
+				script.serial = true;
+			}
+
+			for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+				if (E->get() != path) {
+					script_dependencies.push_back(Pair<int, String>(scripts.size(), E->get()));
+					to_visit.push_back(E->get());
+				}
+			}
+
+			script_indices[path] = scripts.size();
+			scripts.push_back(script);
+
+		} else {
+
+			List<String> dependencies;
+			ResourceLoader::get_dependencies(path, &dependencies);
+			for (List<String>::Element *E = dependencies.front(); E; E = E->next()) {
+				to_visit.push_back(E->get().get_slice("::", 0));
+			}
+		}
+	}
+
+	if (scripts.empty())
+		return;
+
+	// Loading any other resource while compiling could load scripts that
+	// another thread is compiling, so those scripts (and the ones that depend on
+	// them) are loaded on this thread once the rest is done.
+	for (List<Pair<int, String> >::Element *E = script_dependencies.front(); E; E = E->next()) {
+
+		int script = E->get().first;
+		Map<String, int>::Element *D = script_indices.find(E->get().second);
+
+		if (D) {
+			scripts.write[D->get()].dependents.push_back(script);
+			scripts.write[script].pending++;
+		} else if (!ResourceCache::has(E->get().second)) {
+			scripts.write[script].serial = true;
+		}
+	}
+
+	List<int> serial;
+	for (int i = 0; i < scripts.size(); i++) {
+		if (scripts[i].serial) {
+			serial.push_back(i);
+		}
+	}
+	while (serial.size()) {
+
+		const GDScriptDependencyScript &script = scripts[serial.front()->get()];
+		serial.pop_front();
+
+		for (int i = 0; i < script.dependents.size(); i++) {
+			if (!scripts[script.dependents[i]].serial) {
+				scripts.write[script.dependents[i]].serial = true;
+				serial.push_back(script.dependents[i]);
+			}
+		}
+	}
+
+	// Compile in waves, each one with the scripts whose dependencies are done.
+	Vector<int> wave;
+	for (int i = 0; i < scripts.size(); i++) {
+		if (!scripts[i].serial && scripts[i].pending == 0) {
+			wave.push_back(i);
+		}
+	}
+
+	int parallel = 0;
+	while (wave.size()) {
+
+		GDScriptDependencyBatch batch;
+		batch.scripts = scripts.ptrw();
+		batch.indices = wave.ptr();
+
+		WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_group_task(_load_dependency_script, &batch, wave.size(), 1);
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+		parallel += wave.size();
+
+		Vector<int> next;
+		for (int i = 0; i < wave.size(); i++) {
+
+			const GDScriptDependencyScript &script = scripts[wave[i]];
+			for (int j = 0; j < script.dependents.size(); j++) {
+
+				GDScriptDependencyScript &dependent = scripts.write[script.dependents[j]];
+				dependent.pending--;
+				if (dependent.pending == 0 && !dependent.serial) {
+					next.push_back(script.dependents[j]);
+				}
+			}
+		}
+		wave = next;
+	}
+
+	// The rest, including cyclic dependencies, loads the usual way. Scripts that
+	// failed aren't cached, so their errors show up again when they are used.
+	for (int i = 0; i < scripts.size(); i++) {
+
+		if (scripts[i].resource.is_null() && (scripts[i].serial || scripts[i].pending > 0)) {
+			scripts.write[i].resource = ResourceLoader::load(scripts[i].path);
+		}
+		if (scripts[i].resource.is_valid()) {
+			r_resources->push_back(scripts[i].resource);
+		}
+	}
+
+	print_verbose("GDScript: Loaded " + itos(scripts.size()) + " scripts ahead of time, " + itos(parallel) + " of them in parallel.");
+}
+
 void GDScriptLanguage::frame() {
 
 	calls = 0;
 
+	GDScriptFunction::free_retired_inline_cache_entries();
+
 #ifdef DEBUG_ENABLED
 	if (profiling) {
 		if (lock) {
@@ -2111,6 +2495,12 @@ GDScriptLanguage::GDScriptLanguage() {
 	profiling = false;
 	script_frame_time = 0;
 
+	sampling = false;
+	sampling_exit = false;
+	sampling_ticks = 0;
+	sampling_interval = 1000;
+	sampling_thread = NULL;
+
 	_debug_call_stack_pos = 0;
 	int dmcs = GLOBAL_DEF("debug/settings/gdscript/max_call_stack", 1024);
 	ProjectSettings::get_singleton()->set_custom_property_info("debug/settings/gdscript/max_call_stack", PropertyInfo(Variant::INT, "debug/settings/gdscript/max_call_stack", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater")); //minimum is 1024
@@ -2126,6 +2516,8 @@ GDScriptLanguage::GDScriptLanguage() {
 		_call_stack = NULL;
 	}
 
+	GLOBAL_DEF("debug/gdscript/compiler/optimize", true);
+
 #ifdef DEBUG_ENABLED
 	GLOBAL_DEF("debug/gdscript/warnings/enable", true);
 	GLOBAL_DEF("debug/gdscript/warnings/treat_warnings_as_errors", false);
@@ -2139,6 +2531,9 @@ GDScriptLanguage::GDScriptLanguage() {
 
 GDScriptLanguage::~GDScriptLanguage() {
 
+	sampling_stop();
+	GDScriptFunction::free_retired_inline_cache_entries(true);
+
 	if (lock) {
 		memdelete(lock);
 		lock = NULL;
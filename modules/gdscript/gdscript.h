@@ -70,6 +70,7 @@ class GDScript : public Script {
 	friend class GDScriptInstance;
 	friend class GDScriptFunction;
 	friend class GDScriptCompiler;
+	friend class GDScriptBytecode;
 	friend class GDScriptFunctions;
 	friend class GDScriptLanguage;
 
@@ -351,24 +352,48 @@ class GDScriptLanguage : public ScriptLanguage {
 	bool profiling;
 	uint64_t script_frame_time;
 
+	// Sampling profiler. A thread counts ticks while the main thread runs
+	// scripts; the next line executed records the call stack for them.
+	bool sampling;
+	volatile bool sampling_exit;
+	uint32_t sampling_ticks;
+	int sampling_interval;
+	Thread *sampling_thread;
+	Map<String, int> sampled_stacks;
+
+	static void _sampling_thread_func(void *p_userdata);
+	void _take_sample();
+
+	static bool _get_compile_dependencies(const String &p_path, const Map<StringName, String> &p_autoloads, List<String> *r_paths);
+
 public:
 	int calls;
 
 	bool debug_break(const String &p_error, bool p_allow_continue = true);
 	bool debug_break_parse(const String &p_file, int p_line, const String &p_error);
 
+	// The call stack is kept while debugging or sampling.
+	_FORCE_INLINE_ bool is_tracking_call_stack() const { return ScriptDebugger::get_singleton() || sampling; }
+
 	_FORCE_INLINE_ void enter_function(GDScriptInstance *p_instance, GDScriptFunction *p_function, Variant *p_stack, int *p_ip, int *p_line) {
 
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return; //no support for other threads than main for now
 
-		if (ScriptDebugger::get_singleton()->get_lines_left() > 0 && ScriptDebugger::get_singleton()->get_depth() >= 0)
-			ScriptDebugger::get_singleton()->set_depth(ScriptDebugger::get_singleton()->get_depth() + 1);
+		ScriptDebugger *debugger = ScriptDebugger::get_singleton();
+
+		if (debugger && debugger->get_lines_left() > 0 && debugger->get_depth() >= 0)
+			debugger->set_depth(debugger->get_depth() + 1);
 
 		if (_debug_call_stack_pos >= _debug_max_call_stack) {
+			if (!debugger) {
+				// Only sampling, the deeper calls are left out of the samples.
+				_debug_call_stack_pos++;
+				return;
+			}
 			//stack overflow
 			_debug_error = "Stack Overflow (Stack Size: " + itos(_debug_max_call_stack) + ")";
-			ScriptDebugger::get_singleton()->debug(this);
+			debugger->debug(this);
 			return;
 		}
 
@@ -385,13 +410,17 @@ public:
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return; //no support for other threads than main for now
 
-		if (ScriptDebugger::get_singleton()->get_lines_left() > 0 && ScriptDebugger::get_singleton()->get_depth() >= 0)
-			ScriptDebugger::get_singleton()->set_depth(ScriptDebugger::get_singleton()->get_depth() - 1);
+		ScriptDebugger *debugger = ScriptDebugger::get_singleton();
+
+		if (debugger && debugger->get_lines_left() > 0 && debugger->get_depth() >= 0)
+			debugger->set_depth(debugger->get_depth() - 1);
 
 		if (_debug_call_stack_pos == 0) {
 
 			_debug_error = "Stack Underflow (Engine Bug)";
-			ScriptDebugger::get_singleton()->debug(this);
+			if (debugger) {
+				debugger->debug(this);
+			}
 			return;
 		}
 
@@ -402,13 +431,15 @@ public:
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return Vector<StackInfo>();
 
+		int depth = MIN(_debug_call_stack_pos, _debug_max_call_stack);
+
 		Vector<StackInfo> csi;
-		csi.resize(_debug_call_stack_pos);
-		for (int i = 0; i < _debug_call_stack_pos; i++) {
-			csi.write[_debug_call_stack_pos - i - 1].line = _call_stack[i].line ? *_call_stack[i].line : 0;
+		csi.resize(depth);
+		for (int i = 0; i < depth; i++) {
+			csi.write[depth - i - 1].line = _call_stack[i].line ? *_call_stack[i].line : 0;
 			if (_call_stack[i].function)
-				csi.write[_debug_call_stack_pos - i - 1].func = _call_stack[i].function->get_name();
-			csi.write[_debug_call_stack_pos - i - 1].file = _call_stack[i].function->get_script()->get_path();
+				csi.write[depth - i - 1].func = _call_stack[i].function->get_name();
+			csi.write[depth - i - 1].file = _call_stack[i].function->get_script()->get_path();
 		}
 		return csi;
 	}
@@ -479,6 +510,7 @@ public:
 
 	virtual void reload_all_scripts();
 	virtual void reload_tool_script(const Ref<Script> &p_script, bool p_soft_reload);
+	virtual void load_dependencies(const Vector<String> &p_paths, List<RES> *r_resources);
 
 	virtual void frame();
 
@@ -491,6 +523,16 @@ public:
 	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr, int p_info_max);
 	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr, int p_info_max);
 
+	virtual void sampling_start(int p_frequency);
+	virtual void sampling_stop();
+	virtual void sampling_get_stacks(Map<String, int> *r_stacks);
+
+	_FORCE_INLINE_ void sampling_poll() {
+		if (unlikely(sampling_ticks)) {
+			_take_sample();
+		}
+	}
+
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
@@ -0,0 +1,1100 @@
+/*************************************************************************/
+/*  gdscript_bytecode.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_bytecode.h"
+
+#include "core/io/marshalls.h"
+#include "core/version.h"
+#include "gdscript_compiler.h"
+#include "gdscript_parser.h"
+#include "gdscript_tokenizer.h"
+
+// Bump when the layout below or the meaning of the stored code changes. The
+// opcode count and engine version are checked as well, so most VM changes
+// invalidate old files on their own.
+#define COMPILED_FORMAT_VERSION 1
+#define COMPILED_HEADER_SIZE 12
+
+// Keeps corrupted files from nesting inner classes without bound.
+#define MAX_CLASS_DEPTH 64
+
+enum {
+	OBJECT_NULL,
+	OBJECT_NATIVE_CLASS,
+	OBJECT_RESOURCE,
+};
+
+enum {
+	VALUE_PLAIN,
+	VALUE_OBJECT,
+	VALUE_ARRAY,
+	VALUE_DICTIONARY,
+};
+
+class GDScriptBytecode::Writer {
+public:
+	Vector<uint8_t> data;
+
+	void put_u8(uint8_t p_value) {
+		data.push_back(p_value);
+	}
+
+	void put_u32(uint32_t p_value) {
+		int ofs = data.size();
+		data.resize(ofs + 4);
+		encode_uint32(p_value, &data.write[ofs]);
+	}
+
+	void put_buffer(const uint8_t *p_buffer, int p_size) {
+		put_u32(p_size);
+		int ofs = data.size();
+		data.resize(ofs + p_size);
+		for (int i = 0; i < p_size; i++) {
+			data.write[ofs + i] = p_buffer[i];
+		}
+	}
+
+	void put_string(const String &p_string) {
+		CharString cs = p_string.utf8();
+		put_buffer((const uint8_t *)cs.get_data(), cs.length());
+	}
+
+	bool put_value(const Variant &p_value) {
+		int len;
+		if (encode_variant(p_value, NULL, len) != OK)
+			return false;
+		put_u32(len);
+		int ofs = data.size();
+		data.resize(ofs + len);
+		return encode_variant(p_value, &data.write[ofs], len) == OK;
+	}
+};
+
+// Every read checks the remaining size; after a failed one the reader only
+// returns empty values, so callers check `error` once per block.
+class GDScriptBytecode::Reader {
+
+	const uint8_t *data;
+	int size;
+	int pos;
+
+public:
+	bool error;
+
+	uint8_t get_u8() {
+		if (error || pos + 1 > size) {
+			error = true;
+			return 0;
+		}
+		return data[pos++];
+	}
+
+	uint32_t get_u32() {
+		if (error || pos + 4 > size) {
+			error = true;
+			return 0;
+		}
+		uint32_t v = decode_uint32(&data[pos]);
+		pos += 4;
+		return v;
+	}
+
+	// A count of items taking at least one byte each, so a corrupted count
+	// can't make the caller allocate more than the buffer could hold.
+	int get_count() {
+		uint32_t count = get_u32();
+		if (error || count > uint32_t(size - pos)) {
+			error = true;
+			return 0;
+		}
+		return count;
+	}
+
+	const uint8_t *get_buffer(int &r_size) {
+		r_size = get_count();
+		if (error)
+			return NULL;
+		const uint8_t *buffer = &data[pos];
+		pos += r_size;
+		return buffer;
+	}
+
+	String get_string() {
+		int len;
+		const uint8_t *buffer = get_buffer(len);
+		String s;
+		if (buffer) {
+			s.parse_utf8((const char *)buffer, len);
+		}
+		return s;
+	}
+
+	Variant get_value() {
+		int len;
+		const uint8_t *buffer = get_buffer(len);
+		Variant v;
+		if (buffer && decode_variant(v, buffer, len) != OK) {
+			error = true;
+		}
+		return v;
+	}
+
+	Reader(const uint8_t *p_data, int p_size) {
+		data = p_data;
+		size = p_size;
+		pos = 0;
+		error = false;
+	}
+};
+
+struct GDScriptBytecode::Context {
+
+	GDScript *root; // outermost class of the script being written or read
+	String path; // its resource path
+	Vector<StringName> global_names; // by index in the global array, for writing
+};
+
+// Positions of the operands of p_code that are addresses (see
+// GDScriptFunction::Address). Fails on code it doesn't understand.
+bool GDScriptBytecode::_get_address_positions(const Vector<int> &p_code, Vector<int> &r_positions) {
+
+	GDScriptFunction::InstructionInfo info;
+	int ip = 0;
+
+	while (ip < p_code.size()) {
+
+		if (!GDScriptFunction::get_instruction_info(p_code.ptr(), p_code.size(), ip, info))
+			return false;
+
+		for (int i = 0; i < info.addresses.size(); i++) {
+			r_positions.push_back(ip + info.addresses[i]);
+		}
+
+		ip += info.length;
+	}
+
+	return true;
+}
+
+/* WRITING */
+
+bool GDScriptBytecode::_write_object(Writer &w, Context &c, const Object *p_object) {
+
+	if (!p_object) {
+		w.put_u8(OBJECT_NULL);
+		return true;
+	}
+
+	const GDScriptNativeClass *native = Object::cast_to<GDScriptNativeClass>(p_object);
+	if (native) {
+		// Stored by global name, which drops the underscore of classes like _File.
+		String name = native->get_name();
+		if (name.begins_with("_"))
+			name = name.substr(1, name.length());
+		if (!GDScriptLanguage::get_singleton()->get_global_map().has(name))
+			return false;
+		w.put_u8(OBJECT_NATIVE_CLASS);
+		w.put_string(name);
+		return true;
+	}
+
+	const Resource *res = Object::cast_to<Resource>(p_object);
+	if (!res)
+		return false;
+
+	// Inner classes are found from the file that declares them.
+	Vector<String> inner_path;
+	const GDScript *script = Object::cast_to<GDScript>(res);
+	while (script && script->_owner) {
+		const GDScript *owner = script->_owner;
+		const Map<StringName, Ref<GDScript> >::Element *E = owner->subclasses.front();
+		while (E && E->get().ptr() != script) {
+			E = E->next();
+		}
+		if (!E)
+			return false;
+		inner_path.push_back(E->key());
+		script = owner;
+	}
+	if (script) {
+		res = script;
+	}
+
+	String path;
+	if (res != c.root && res->get_path() != c.path) {
+		path = res->get_path();
+		if (!path.is_resource_file())
+			return false; // built-in resource, can't be loaded on its own
+	}
+
+	w.put_u8(OBJECT_RESOURCE);
+	w.put_string(path);
+	w.put_u32(inner_path.size());
+	for (int i = inner_path.size() - 1; i >= 0; i--) {
+		w.put_string(inner_path[i]);
+	}
+	return true;
+}
+
+bool GDScriptBytecode::_write_variant(Writer &w, Context &c, const Variant &p_value) {
+
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			w.put_u8(VALUE_OBJECT);
+			return _write_object(w, c, p_value);
+		} break;
+		case Variant::ARRAY: {
+			Array array = p_value;
+			w.put_u8(VALUE_ARRAY);
+			w.put_u32(array.size());
+			for (int i = 0; i < array.size(); i++) {
+				if (!_write_variant(w, c, array[i]))
+					return false;
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary dict = p_value;
+			w.put_u8(VALUE_DICTIONARY);
+			w.put_u32(dict.size());
+			const Variant *K = NULL;
+			while ((K = dict.next(K))) {
+				if (!_write_variant(w, c, *K) || !_write_variant(w, c, dict[*K]))
+					return false;
+			}
+		} break;
+		case Variant::_RID: {
+			return false; // only valid in this process
+		} break;
+		default: {
+			w.put_u8(VALUE_PLAIN);
+			return w.put_value(p_value);
+		}
+	}
+
+	return true;
+}
+
+bool GDScriptBytecode::_write_data_type(Writer &w, Context &c, const GDScriptDataType &p_type) {
+
+	w.put_u8(p_type.has_type);
+	w.put_u8(p_type.kind);
+	w.put_u32(p_type.builtin_type);
+	w.put_string(p_type.native_type);
+	return _write_object(w, c, p_type.script_type.ptr());
+}
+
+bool GDScriptBytecode::_write_function(Writer &w, Context &c, const GDScriptFunction *p_function) {
+
+	w.put_string(p_function->name);
+	w.put_u8(p_function->_static);
+	w.put_u32(p_function->rpc_mode);
+	w.put_u32(p_function->_argument_count);
+
+	w.put_u32(p_function->argument_types.size());
+	for (int i = 0; i < p_function->argument_types.size(); i++) {
+		if (!_write_data_type(w, c, p_function->argument_types[i]))
+			return false;
+	}
+	if (!_write_data_type(w, c, p_function->return_type))
+		return false;
+
+#ifdef TOOLS_ENABLED
+	w.put_u32(p_function->arg_names.size());
+	for (int i = 0; i < p_function->arg_names.size(); i++) {
+		w.put_string(p_function->arg_names[i]);
+	}
+#else
+	w.put_u32(0);
+#endif
+
+	w.put_u32(p_function->constants.size());
+	for (int i = 0; i < p_function->constants.size(); i++) {
+		if (!_write_variant(w, c, p_function->constants[i]))
+			return false;
+	}
+
+	w.put_u32(p_function->global_names.size());
+	for (int i = 0; i < p_function->global_names.size(); i++) {
+		w.put_string(p_function->global_names[i]);
+	}
+
+	// Indices in the global array depend on the classes and singletons of the
+	// running engine, so the code refers to a table of names instead.
+	Vector<int> code = p_function->code;
+	Vector<int> positions;
+	if (!_get_address_positions(code, positions))
+		return false;
+
+	Vector<StringName> globals;
+	for (int i = 0; i < positions.size(); i++) {
+
+		int address = code[positions[i]];
+		int index = address & GDScriptFunction::ADDR_MASK;
+		StringName name;
+
+		switch ((address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) {
+			case GDScriptFunction::ADDR_TYPE_GLOBAL: {
+				if (index >= c.global_names.size())
+					return false;
+				name = c.global_names[index];
+			} break;
+#ifdef TOOLS_ENABLED
+			case GDScriptFunction::ADDR_TYPE_NAMED_GLOBAL: {
+				if (index >= p_function->named_globals.size())
+					return false;
+				name = p_function->named_globals[index];
+			} break;
+#endif
+			default: {
+				continue;
+			}
+		}
+
+		int global = globals.find(name);
+		if (global == -1) {
+			global = globals.size();
+			globals.push_back(name);
+		}
+		code.write[positions[i]] = global | (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS);
+	}
+
+	w.put_u32(globals.size());
+	for (int i = 0; i < globals.size(); i++) {
+		w.put_string(globals[i]);
+	}
+
+	w.put_u32(p_function->ptrcall_methods.size());
+	for (int i = 0; i < p_function->ptrcall_methods.size(); i++) {
+
+		const GDScriptFunction::PtrCallMethod &pcm = p_function->ptrcall_methods[i];
+
+		StringName class_name;
+		List<StringName> classes;
+		ClassDB::get_class_list(&classes);
+		for (List<StringName>::Element *E = classes.front(); E; E = E->next()) {
+			if (ClassDB::get_class_ptr(E->get()) == pcm.class_ptr) {
+				class_name = E->get();
+				break;
+			}
+		}
+		if (class_name == StringName())
+			return false;
+
+		w.put_string(class_name);
+		w.put_string(pcm.method->get_name());
+	}
+
+	w.put_u32(p_function->_inline_cache_count);
+
+	w.put_u32(p_function->default_arguments.size());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		w.put_u32(p_function->default_arguments[i]);
+	}
+
+	w.put_u32(p_function->_stack_size);
+	w.put_u32(p_function->_call_size);
+	w.put_u32(p_function->_initial_line);
+
+	w.put_u32(code.size());
+	for (int i = 0; i < code.size(); i++) {
+		w.put_u32(code[i]);
+	}
+
+	w.put_u32(p_function->stack_debug.size());
+	for (const List<GDScriptFunction::StackDebug>::Element *E = p_function->stack_debug.front(); E; E = E->next()) {
+		w.put_u32(E->get().line);
+		w.put_u32(E->get().pos);
+		w.put_u8(E->get().added);
+		w.put_string(E->get().identifier);
+	}
+
+	return true;
+}
+
+bool GDScriptBytecode::_write_class(Writer &w, Context &c, const GDScript *p_class) {
+
+	w.put_string(p_class->name);
+	w.put_u8(p_class->tool);
+	if (!_write_object(w, c, p_class->native.ptr()))
+		return false;
+	if (!_write_object(w, c, p_class->base.ptr()))
+		return false;
+
+	w.put_u32(p_class->member_indices.size());
+	for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_class->member_indices.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_u32(E->get().index);
+		w.put_string(E->get().setter);
+		w.put_string(E->get().getter);
+		w.put_u32(E->get().rpc_mode);
+		if (!_write_data_type(w, c, E->get().data_type))
+			return false;
+	}
+
+	w.put_u32(p_class->members.size());
+	for (const Set<StringName>::Element *E = p_class->members.front(); E; E = E->next()) {
+		w.put_string(E->get());
+	}
+
+	w.put_u32(p_class->member_info.size());
+	for (const Map<StringName, PropertyInfo>::Element *E = p_class->member_info.front(); E; E = E->next()) {
+		const PropertyInfo &pi = E->get();
+		w.put_string(E->key());
+		w.put_u32(pi.type);
+		w.put_string(pi.name);
+		w.put_string(pi.class_name);
+		w.put_u32(pi.hint);
+		w.put_string(pi.hint_string);
+		w.put_u32(pi.usage);
+	}
+
+	w.put_u32(p_class->constants.size());
+	for (const Map<StringName, Variant>::Element *E = p_class->constants.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		if (!_write_variant(w, c, E->get()))
+			return false;
+	}
+
+	w.put_u32(p_class->_signals.size());
+	for (const Map<StringName, Vector<StringName> >::Element *E = p_class->_signals.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		w.put_u32(E->get().size());
+		for (int i = 0; i < E->get().size(); i++) {
+			w.put_string(E->get()[i]);
+		}
+	}
+
+	String initializer;
+	w.put_u32(p_class->member_functions.size());
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_class->member_functions.front(); E; E = E->next()) {
+		if (!_write_function(w, c, E->get()))
+			return false;
+		if (E->get() == p_class->initializer) {
+			initializer = E->key();
+		}
+	}
+	w.put_string(initializer);
+
+	w.put_u32(p_class->subclasses.size());
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_class->subclasses.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		if (!_write_class(w, c, E->get().ptr()))
+			return false;
+	}
+
+	return true;
+}
+
+void GDScriptBytecode::_write_class_tree(Writer &w, const GDScript *p_class) {
+
+	w.put_u32(p_class->subclasses.size());
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_class->subclasses.front(); E; E = E->next()) {
+		w.put_string(E->key());
+		_write_class_tree(w, E->get().ptr());
+	}
+}
+
+/* READING */
+
+bool GDScriptBytecode::_read_object(Reader &r, Context &c, Variant &r_object) {
+
+	switch (r.get_u8()) {
+		case OBJECT_NULL: {
+			r_object = Variant();
+		} break;
+		case OBJECT_NATIVE_CLASS: {
+			String name = r.get_string();
+			const Map<StringName, int>::Element *E = GDScriptLanguage::get_singleton()->get_global_map().find(name);
+			if (!E)
+				return false;
+			const Variant &native = GDScriptLanguage::get_singleton()->get_global_array()[E->get()];
+			if (!Object::cast_to<GDScriptNativeClass>(native))
+				return false;
+			r_object = native;
+		} break;
+		case OBJECT_RESOURCE: {
+			String path = r.get_string();
+			int inner_count = r.get_count();
+			if (r.error)
+				return false;
+
+			RES res;
+			if (path.empty() || path == c.path) {
+				res = Ref<GDScript>(c.root);
+			} else {
+				res = ResourceLoader::load(path);
+				if (res.is_null())
+					return false;
+			}
+
+			for (int i = 0; i < inner_count; i++) {
+				StringName name = r.get_string();
+				GDScript *script = Object::cast_to<GDScript>(res.ptr());
+				if (!script || !script->subclasses.has(name))
+					return false;
+				res = script->subclasses[name];
+			}
+			r_object = res;
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return !r.error;
+}
+
+bool GDScriptBytecode::_read_variant(Reader &r, Context &c, Variant &r_value) {
+
+	switch (r.get_u8()) {
+		case VALUE_PLAIN: {
+			r_value = r.get_value();
+		} break;
+		case VALUE_OBJECT: {
+			return _read_object(r, c, r_value);
+		} break;
+		case VALUE_ARRAY: {
+			Array array;
+			int size = r.get_count();
+			array.resize(size);
+			for (int i = 0; i < size; i++) {
+				if (!_read_variant(r, c, array[i]))
+					return false;
+			}
+			r_value = array;
+		} break;
+		case VALUE_DICTIONARY: {
+			Dictionary dict;
+			int size = r.get_count();
+			for (int i = 0; i < size; i++) {
+				Variant key, value;
+				if (!_read_variant(r, c, key) || !_read_variant(r, c, value))
+					return false;
+				dict[key] = value;
+			}
+			r_value = dict;
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	return !r.error;
+}
+
+bool GDScriptBytecode::_read_data_type(Reader &r, Context &c, GDScriptDataType &r_type) {
+
+	r_type.has_type = r.get_u8();
+	int kind = r.get_u8();
+	int builtin_type = r.get_u32();
+	r_type.native_type = r.get_string();
+
+	switch (kind) {
+		case GDScriptDataType::UNINITIALIZED: r_type.kind = GDScriptDataType::UNINITIALIZED; break;
+		case GDScriptDataType::BUILTIN: r_type.kind = GDScriptDataType::BUILTIN; break;
+		case GDScriptDataType::NATIVE: r_type.kind = GDScriptDataType::NATIVE; break;
+		case GDScriptDataType::SCRIPT: r_type.kind = GDScriptDataType::SCRIPT; break;
+		case GDScriptDataType::GDSCRIPT: r_type.kind = GDScriptDataType::GDSCRIPT; break;
+		default: return false;
+	}
+	if (builtin_type >= Variant::VARIANT_MAX)
+		return false;
+	r_type.builtin_type = Variant::Type(builtin_type);
+
+	Variant script;
+	if (!_read_object(r, c, script))
+		return false;
+	r_type.script_type = script;
+	if (script.get_type() != Variant::NIL && r_type.script_type.is_null())
+		return false; // not a script
+
+	return true;
+}
+
+bool GDScriptBytecode::_read_function(Reader &r, Context &c, GDScript *p_class, GDScriptFunction *p_function) {
+
+	p_function->name = r.get_string();
+	p_function->_static = r.get_u8();
+	p_function->rpc_mode = MultiplayerAPI::RPCMode(r.get_u32());
+	p_function->_argument_count = r.get_u32();
+
+	int argument_type_count = r.get_count();
+	p_function->argument_types.resize(argument_type_count);
+	for (int i = 0; i < argument_type_count; i++) {
+		if (!_read_data_type(r, c, p_function->argument_types.write[i]))
+			return false;
+	}
+	if (!_read_data_type(r, c, p_function->return_type))
+		return false;
+
+	int arg_name_count = r.get_count();
+	for (int i = 0; i < arg_name_count; i++) {
+		StringName arg_name = r.get_string();
+#ifdef TOOLS_ENABLED
+		p_function->arg_names.push_back(arg_name);
+#endif
+	}
+
+	int constant_count = r.get_count();
+	p_function->constants.resize(constant_count);
+	for (int i = 0; i < constant_count; i++) {
+		if (!_read_variant(r, c, p_function->constants.write[i]))
+			return false;
+	}
+
+	int global_name_count = r.get_count();
+	p_function->global_names.resize(global_name_count);
+	for (int i = 0; i < global_name_count; i++) {
+		p_function->global_names.write[i] = r.get_string();
+	}
+
+	int global_count = r.get_count();
+	Vector<StringName> globals;
+	globals.resize(global_count);
+	for (int i = 0; i < global_count; i++) {
+		globals.write[i] = r.get_string();
+	}
+
+	int ptrcall_count = r.get_count();
+	p_function->ptrcall_methods.resize(ptrcall_count);
+	for (int i = 0; i < ptrcall_count; i++) {
+		StringName class_name = r.get_string();
+		StringName method_name = r.get_string();
+		if (!ClassDB::class_exists(class_name))
+			return false;
+		GDScriptFunction::PtrCallMethod &pcm = p_function->ptrcall_methods.write[i];
+		pcm.method = ClassDB::get_method(class_name, method_name);
+		pcm.class_ptr = ClassDB::get_class_ptr(class_name);
+		if (!pcm.method || !pcm.class_ptr)
+			return false;
+	}
+
+	int inline_cache_count = r.get_count();
+
+	int default_argument_count = r.get_count();
+	p_function->default_arguments.resize(default_argument_count);
+	for (int i = 0; i < default_argument_count; i++) {
+		p_function->default_arguments.write[i] = r.get_u32();
+	}
+
+	p_function->_stack_size = r.get_u32();
+	p_function->_call_size = r.get_u32();
+	p_function->_initial_line = r.get_u32();
+
+	int code_size = r.get_count();
+	p_function->code.resize(code_size);
+	for (int i = 0; i < code_size; i++) {
+		p_function->code.write[i] = r.get_u32();
+	}
+
+	int stack_debug_count = r.get_count();
+	for (int i = 0; i < stack_debug_count; i++) {
+		GDScriptFunction::StackDebug sd;
+		sd.line = r.get_u32();
+		sd.pos = r.get_u32();
+		sd.added = r.get_u8();
+		sd.identifier = r.get_string();
+		p_function->stack_debug.push_back(sd);
+	}
+
+	if (r.error || p_function->_stack_size < 0 || p_function->_call_size < 0)
+		return false;
+
+	// Check the addresses, and point globals at the running engine's.
+	Vector<int> positions;
+	if (!_get_address_positions(p_function->code, positions))
+		return false;
+
+	const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+	int member_count = p_class->member_indices.size();
+
+	for (int i = 0; i < positions.size(); i++) {
+
+		int &address = p_function->code.write[positions[i]];
+		int type = (address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS;
+		int index = address & GDScriptFunction::ADDR_MASK;
+
+		switch (type) {
+			case GDScriptFunction::ADDR_TYPE_SELF:
+			case GDScriptFunction::ADDR_TYPE_CLASS:
+			case GDScriptFunction::ADDR_TYPE_NIL: {
+			} break;
+			case GDScriptFunction::ADDR_TYPE_MEMBER: {
+				if (index >= member_count)
+					return false;
+			} break;
+			case GDScriptFunction::ADDR_TYPE_CLASS_CONSTANT: {
+				if (index >= global_name_count)
+					return false;
+			} break;
+			case GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT: {
+				if (index >= constant_count)
+					return false;
+			} break;
+			case GDScriptFunction::ADDR_TYPE_STACK:
+			case GDScriptFunction::ADDR_TYPE_STACK_VARIABLE: {
+				if (index >= p_function->_stack_size)
+					return false;
+			} break;
+			case GDScriptFunction::ADDR_TYPE_GLOBAL: {
+				if (index >= global_count)
+					return false;
+
+				const Map<StringName, int>::Element *E = global_map.find(globals[index]);
+				if (E) {
+					address = E->get() | (GDScriptFunction::ADDR_TYPE_GLOBAL << GDScriptFunction::ADDR_BITS);
+					break;
+				}
+#ifdef TOOLS_ENABLED
+				// Autoloads are only named globals in the editor.
+				if (GDScriptLanguage::get_singleton()->get_named_globals_map().has(globals[index])) {
+					int named = p_function->named_globals.find(globals[index]);
+					if (named == -1) {
+						named = p_function->named_globals.size();
+						p_function->named_globals.push_back(globals[index]);
+					}
+					address = named | (GDScriptFunction::ADDR_TYPE_NAMED_GLOBAL << GDScriptFunction::ADDR_BITS);
+					break;
+				}
+#endif
+				return false;
+			} break;
+			default: {
+				return false;
+			}
+		}
+	}
+
+	for (int i = 0; i < default_argument_count; i++) {
+		if (p_function->default_arguments[i] < 0 || p_function->default_arguments[i] >= code_size)
+			return false;
+	}
+
+	// What GDScriptCompiler::_parse_function() sets up after generating code.
+	p_function->_constants_ptr = constant_count ? p_function->constants.ptrw() : NULL;
+	p_function->_constant_count = constant_count;
+	p_function->_global_names_ptr = global_name_count ? p_function->global_names.ptr() : NULL;
+	p_function->_global_names_count = global_name_count;
+	p_function->_ptrcall_methods_ptr = ptrcall_count ? p_function->ptrcall_methods.ptr() : NULL;
+	p_function->_ptrcall_methods_count = ptrcall_count;
+	p_function->_set_inline_cache_count(inline_cache_count);
+#ifdef TOOLS_ENABLED
+	p_function->_named_globals_ptr = p_function->named_globals.size() ? p_function->named_globals.ptr() : NULL;
+	p_function->_named_globals_count = p_function->named_globals.size();
+#endif
+	p_function->_code_ptr = code_size ? p_function->code.ptr() : NULL;
+	p_function->_code_size = code_size;
+	p_function->_default_arg_ptr = default_argument_count ? p_function->default_arguments.ptr() : NULL;
+	p_function->_default_arg_count = default_argument_count ? default_argument_count - 1 : 0;
+
+	p_function->_script = p_class;
+	p_function->source = c.path;
+
+#ifdef DEBUG_ENABLED
+	if (ScriptDebugger::get_singleton()) {
+		String signature = c.path + "::" + itos(p_function->_initial_line);
+		if (p_class->name != String()) {
+			signature += "::" + p_class->name + "." + String(p_function->name);
+		} else {
+			signature += "::" + String(p_function->name);
+		}
+		p_function->profile.signature = signature;
+	}
+
+	p_function->func_cname = (c.path + " - " + String(p_function->name)).utf8();
+	p_function->_func_cname = p_function->func_cname.get_data();
+#endif
+
+	return true;
+}
+
+bool GDScriptBytecode::_read_class(Reader &r, Context &c, GDScript *p_class) {
+
+	for (Map<StringName, GDScriptFunction *>::Element *E = p_class->member_functions.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+	p_class->member_functions.clear();
+	p_class->member_indices.clear();
+	p_class->members.clear();
+	p_class->member_info.clear();
+	p_class->constants.clear();
+	p_class->_signals.clear();
+	p_class->initializer = NULL;
+
+	p_class->name = r.get_string();
+	p_class->tool = r.get_u8();
+
+	Variant native;
+	if (!_read_object(r, c, native))
+		return false;
+	p_class->native = native;
+	if (native.get_type() != Variant::NIL && p_class->native.is_null())
+		return false;
+
+	Variant base;
+	if (!_read_object(r, c, base))
+		return false;
+	p_class->base = base;
+	p_class->_base = p_class->base.ptr();
+	if (base.get_type() != Variant::NIL && p_class->base.is_null())
+		return false;
+
+	int member_index_count = r.get_count();
+	for (int i = 0; i < member_index_count; i++) {
+		StringName name = r.get_string();
+		GDScript::MemberInfo minfo;
+		minfo.index = r.get_u32();
+		minfo.setter = r.get_string();
+		minfo.getter = r.get_string();
+		minfo.rpc_mode = MultiplayerAPI::RPCMode(r.get_u32());
+		if (!_read_data_type(r, c, minfo.data_type))
+			return false;
+		if (minfo.index < 0 || minfo.index >= member_index_count)
+			return false;
+		p_class->member_indices[name] = minfo;
+	}
+
+	int member_count = r.get_count();
+	for (int i = 0; i < member_count; i++) {
+		p_class->members.insert(r.get_string());
+	}
+
+	int member_info_count = r.get_count();
+	for (int i = 0; i < member_info_count; i++) {
+		StringName name = r.get_string();
+		PropertyInfo pi;
+		pi.type = Variant::Type(r.get_u32());
+		pi.name = r.get_string();
+		pi.class_name = r.get_string();
+		pi.hint = PropertyHint(r.get_u32());
+		pi.hint_string = r.get_string();
+		pi.usage = r.get_u32();
+		if (pi.type >= Variant::VARIANT_MAX)
+			return false;
+		p_class->member_info[name] = pi;
+	}
+
+	int constant_count = r.get_count();
+	for (int i = 0; i < constant_count; i++) {
+		StringName name = r.get_string();
+		Variant value;
+		if (!_read_variant(r, c, value))
+			return false;
+		p_class->constants[name] = value;
+	}
+
+	int signal_count = r.get_count();
+	for (int i = 0; i < signal_count; i++) {
+		StringName name = r.get_string();
+		Vector<StringName> arguments;
+		arguments.resize(r.get_count());
+		for (int j = 0; j < arguments.size(); j++) {
+			arguments.write[j] = r.get_string();
+		}
+		p_class->_signals[name] = arguments;
+	}
+
+	if (r.error)
+		return false;
+
+	int function_count = r.get_count();
+	for (int i = 0; i < function_count; i++) {
+		GDScriptFunction *function = memnew(GDScriptFunction);
+		bool ok = _read_function(r, c, p_class, function);
+		if (!ok || p_class->member_functions.has(function->name)) {
+			memdelete(function);
+			return false;
+		}
+		p_class->member_functions[function->name] = function;
+	}
+
+	StringName initializer = r.get_string();
+	if (initializer != StringName()) {
+		if (!p_class->member_functions.has(initializer))
+			return false;
+		p_class->initializer = p_class->member_functions[initializer];
+	}
+
+	int subclass_count = r.get_count();
+	if (r.error || subclass_count != p_class->subclasses.size())
+		return false;
+	for (int i = 0; i < subclass_count; i++) {
+		StringName name = r.get_string();
+		if (!p_class->subclasses.has(name))
+			return false;
+		if (!_read_class(r, c, p_class->subclasses[name].ptr()))
+			return false;
+	}
+
+	p_class->valid = true;
+	return !r.error;
+}
+
+bool GDScriptBytecode::_read_class_tree(Reader &r, GDScript *p_class, int p_depth) {
+
+	if (p_depth > MAX_CLASS_DEPTH)
+		return false;
+
+	p_class->subclasses.clear();
+
+	int subclass_count = r.get_count();
+	for (int i = 0; i < subclass_count; i++) {
+		StringName name = r.get_string();
+		if (r.error || p_class->subclasses.has(name))
+			return false;
+
+		Ref<GDScript> subclass;
+		subclass.instance();
+		subclass->_owner = p_class;
+		p_class->subclasses.insert(name, subclass);
+
+		if (!_read_class_tree(r, subclass.ptr(), p_depth + 1))
+			return false;
+	}
+
+	return !r.error;
+}
+
+/* FILES */
+
+bool GDScriptBytecode::is_compiled(const Vector<uint8_t> &p_buffer) {
+
+	return p_buffer.size() >= COMPILED_HEADER_SIZE && p_buffer[0] == 'G' && p_buffer[1] == 'D' && p_buffer[2] == 'S' && p_buffer[3] == 'B';
+}
+
+Vector<uint8_t> GDScriptBytecode::get_tokens(const Vector<uint8_t> &p_buffer) {
+
+	ERR_FAIL_COND_V(!is_compiled(p_buffer), Vector<uint8_t>());
+
+	Reader r(&p_buffer[COMPILED_HEADER_SIZE], p_buffer.size() - COMPILED_HEADER_SIZE);
+	r.get_string(); // engine version
+
+	int size;
+	const uint8_t *tokens = r.get_buffer(size);
+	ERR_FAIL_COND_V(r.error, Vector<uint8_t>());
+
+	Vector<uint8_t> ret;
+	ret.resize(size);
+	for (int i = 0; i < size; i++) {
+		ret.write[i] = tokens[i];
+	}
+	return ret;
+}
+
+Error GDScriptBytecode::load(GDScript *p_script, const Vector<uint8_t> &p_buffer) {
+
+	ERR_FAIL_COND_V(!is_compiled(p_buffer), ERR_INVALID_DATA);
+
+	uint32_t format_version = decode_uint32(&p_buffer[4]);
+	uint32_t opcode_count = decode_uint32(&p_buffer[8]);
+
+	Reader r(&p_buffer[COMPILED_HEADER_SIZE], p_buffer.size() - COMPILED_HEADER_SIZE);
+	String engine_version = r.get_string();
+
+	if (format_version != COMPILED_FORMAT_VERSION || opcode_count != GDScriptFunction::OPCODE_END + 1 || engine_version != VERSION_FULL_CONFIG) {
+		print_verbose("GDScript: " + p_script->get_path() + " was compiled by another engine version, compiling it again.");
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	int size;
+	r.get_buffer(size); // tokens
+	const uint8_t *classes = r.get_buffer(size);
+	if (r.error || size == 0)
+		return ERR_FILE_CORRUPT;
+
+	Context c;
+	c.root = p_script;
+	c.path = p_script->get_path();
+
+	Reader cr(classes, size);
+	p_script->_owner = NULL;
+	if (!_read_class_tree(cr, p_script, 0) || !_read_class(cr, c, p_script)) {
+		print_verbose("GDScript: The compiled code of " + p_script->get_path() + " doesn't match this engine, compiling it again.");
+		return ERR_INVALID_DATA;
+	}
+
+	return OK;
+}
+
+Vector<uint8_t> GDScriptBytecode::_compile_classes(const String &p_source, const String &p_path, bool p_debug) {
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_script_path(p_path);
+
+	GDScriptParser parser;
+	if (parser.parse(p_source, p_path.get_base_dir(), false, p_path) != OK)
+		return Vector<uint8_t>();
+
+	GDScriptCompiler compiler;
+	compiler.set_debug_code(p_debug);
+	if (compiler.compile(&parser, script.ptr()) != OK)
+		return Vector<uint8_t>();
+
+	Context c;
+	c.root = script.ptr();
+	c.path = p_path;
+
+	const Map<StringName, int> &global_map = GDScriptLanguage::get_singleton()->get_global_map();
+	c.global_names.resize(GDScriptLanguage::get_singleton()->get_global_array_size());
+	for (const Map<StringName, int>::Element *E = global_map.front(); E; E = E->next()) {
+		c.global_names.write[E->get()] = E->key();
+	}
+
+	Writer w;
+	_write_class_tree(w, script.ptr());
+	if (!_write_class(w, c, script.ptr()))
+		return Vector<uint8_t>();
+
+	return w.data;
+}
+
+Vector<uint8_t> GDScriptBytecode::compile(const String &p_source, const String &p_path, bool p_debug) {
+
+	Vector<uint8_t> tokens = GDScriptTokenizerBuffer::parse_code_string(p_source);
+	if (tokens.empty())
+		return tokens;
+
+	Vector<uint8_t> classes = _compile_classes(p_source, p_path, p_debug);
+	if (classes.empty())
+		return tokens; // still loads, just not any faster
+
+	Writer w;
+	w.put_u8('G');
+	w.put_u8('D');
+	w.put_u8('S');
+	w.put_u8('B');
+	w.put_u32(COMPILED_FORMAT_VERSION);
+	w.put_u32(GDScriptFunction::OPCODE_END + 1);
+	w.put_string(VERSION_FULL_CONFIG);
+	w.put_buffer(tokens.ptr(), tokens.size());
+	w.put_buffer(classes.ptr(), classes.size());
+	return w.data;
+}
@@ -0,0 +1,83 @@
+/*************************************************************************/
+/*  gdscript_bytecode.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_BYTECODE_H
+#define GDSCRIPT_BYTECODE_H
+
+#include "gdscript.h"
+
+// Compiled scripts for exported projects (.gdc/.gde files).
+//
+// A compiled file holds the token stream of GDScriptTokenizerBuffer, followed
+// by the classes and functions produced by GDScriptCompiler, so loading it
+// skips parsing and compiling. The compiled part is only used by the engine
+// version and bytecode format that wrote it, and only when everything it
+// refers to (global names, native methods, other resources) can be found;
+// otherwise the token stream is compiled as usual.
+
+class GDScriptBytecode {
+
+	class Writer;
+	class Reader;
+
+	struct Context;
+
+	static bool _get_address_positions(const Vector<int> &p_code, Vector<int> &r_positions);
+
+	static bool _write_object(Writer &w, Context &c, const Object *p_object);
+	static bool _write_variant(Writer &w, Context &c, const Variant &p_value);
+	static bool _write_data_type(Writer &w, Context &c, const GDScriptDataType &p_type);
+	static bool _write_function(Writer &w, Context &c, const GDScriptFunction *p_function);
+	static bool _write_class(Writer &w, Context &c, const GDScript *p_class);
+	static void _write_class_tree(Writer &w, const GDScript *p_class);
+
+	static bool _read_object(Reader &r, Context &c, Variant &r_object);
+	static bool _read_variant(Reader &r, Context &c, Variant &r_value);
+	static bool _read_data_type(Reader &r, Context &c, GDScriptDataType &r_type);
+	static bool _read_function(Reader &r, Context &c, GDScript *p_class, GDScriptFunction *p_function);
+	static bool _read_class(Reader &r, Context &c, GDScript *p_class);
+	static bool _read_class_tree(Reader &r, GDScript *p_class, int p_depth);
+
+	static Vector<uint8_t> _compile_classes(const String &p_source, const String &p_path, bool p_debug);
+
+public:
+	static bool is_compiled(const Vector<uint8_t> &p_buffer);
+	static Vector<uint8_t> get_tokens(const Vector<uint8_t> &p_buffer);
+
+	// Fills p_script (which must not have instances) from a compiled buffer.
+	// On failure the caller compiles the tokens from get_tokens() instead.
+	static Error load(GDScript *p_script, const Vector<uint8_t> &p_buffer);
+
+	// Builds the contents of an exported script file. Falls back to the
+	// tokens alone when the script doesn't compile or can't be stored.
+	static Vector<uint8_t> compile(const String &p_source, const String &p_path, bool p_debug);
+};
+
+#endif // GDSCRIPT_BYTECODE_H
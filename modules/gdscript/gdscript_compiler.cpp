@@ -30,6 +30,7 @@
 
 #include "gdscript_compiler.h"
 
+#include "core/project_settings.h"
 #include "gdscript.h"
 
 bool GDScriptCompiler::_is_class_member_property(CodeGen &codegen, const StringName &p_name) {
@@ -74,6 +75,47 @@ void GDScriptCompiler::_set_error(const String &p_error, const GDScriptParser::N
 	}
 }
 
+static bool _is_builtin(const GDScriptParser::DataType &p_type, Variant::Type p_builtin) {
+
+	return p_type.has_type && !p_type.is_meta_type && p_type.kind == GDScriptParser::DataType::BUILTIN && p_type.builtin_type == p_builtin;
+}
+
+GDScriptFunction::Opcode GDScriptCompiler::_get_operator_opcode(Variant::Operator p_op, const GDScriptParser::DataType &p_a, const GDScriptParser::DataType &p_b) const {
+
+	// The typed opcodes check the operand types again at runtime, so a wrong guess
+	// here is only slower, never incorrect.
+
+	if (p_op == Variant::OP_NOT || p_op == Variant::OP_IN) {
+		return GDScriptFunction::OPCODE_OPERATOR;
+	}
+
+	bool a_int = _is_builtin(p_a, Variant::INT);
+	bool b_int = _is_builtin(p_b, Variant::INT);
+	bool a_num = a_int || _is_builtin(p_a, Variant::REAL);
+	bool b_num = b_int || _is_builtin(p_b, Variant::REAL);
+
+	if (a_int && b_int) {
+		return GDScriptFunction::OPCODE_OPERATOR_INT;
+	}
+	if (a_num && b_num) {
+		return GDScriptFunction::OPCODE_OPERATOR_REAL;
+	}
+	if (_is_builtin(p_a, Variant::VECTOR2) && (b_num || _is_builtin(p_b, Variant::VECTOR2))) {
+		return GDScriptFunction::OPCODE_OPERATOR_VECTOR2;
+	}
+	if (_is_builtin(p_a, Variant::VECTOR3) && (b_num || _is_builtin(p_b, Variant::VECTOR3))) {
+		return GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+	}
+	if (a_num && _is_builtin(p_b, Variant::VECTOR2)) {
+		return GDScriptFunction::OPCODE_OPERATOR_VECTOR2;
+	}
+	if (a_num && _is_builtin(p_b, Variant::VECTOR3)) {
+		return GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+	}
+
+	return GDScriptFunction::OPCODE_OPERATOR;
+}
+
 bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level) {
 
 	ERR_FAIL_COND_V(on->arguments.size() != 1, false);
@@ -82,7 +124,9 @@ bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptPa
 	if (src_address_a < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	GDScriptParser::DataType type_a = on->arguments[0]->get_datatype();
+
+	codegen.opcodes.push_back(_get_operator_opcode(op, type_a, type_a)); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
@@ -104,13 +148,72 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 	if (src_address_b < 0)
 		return false;
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	codegen.opcodes.push_back(_get_operator_opcode(op, on->arguments[0]->get_datatype(), on->arguments[1]->get_datatype())); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
 	return true;
 }
 
+#ifdef GDSCRIPT_PTRCALL_ENABLED
+int GDScriptCompiler::_get_ptrcall_method(CodeGen &codegen, const GDScriptParser::OperatorNode *on) {
+
+	// Resolves the MethodBind of a call whose base has a statically known native
+	// class. Returns its index in the function's ptrcall table, or -1. The VM
+	// still checks the object and argument types and falls back to a regular
+	// call when they don't match.
+
+	const GDScriptParser::Node *base = on->arguments[0];
+	StringName native;
+
+	if (base->type == GDScriptParser::Node::TYPE_SELF) {
+		if ((codegen.function_node && codegen.function_node->_static) || codegen.script->native.is_null())
+			return -1;
+		native = codegen.script->native->get_name();
+	} else {
+		GDScriptParser::DataType base_type = base->get_datatype();
+		if (!base_type.has_type || base_type.is_meta_type || base_type.kind != GDScriptParser::DataType::NATIVE)
+			return -1;
+		native = base_type.native_type;
+	}
+
+	const StringName &method_name = static_cast<const GDScriptParser::IdentifierNode *>(on->arguments[1])->name;
+	int argc = on->arguments.size() - 2;
+
+	MethodBind *mb = ClassDB::get_method(native, method_name);
+	if (!mb || mb->is_vararg() || mb->get_argument_count() != argc)
+		return -1;
+
+	// Objects are passed as raw pointers, which the VM can't produce safely.
+	if (mb->has_return() && mb->get_argument_type(-1) == Variant::OBJECT)
+		return -1;
+
+	for (int i = 0; i < argc; i++) {
+		Variant::Type arg_type = mb->get_argument_type(i);
+		if (arg_type == Variant::OBJECT)
+			return -1;
+
+		GDScriptParser::DataType type = on->arguments[i + 2]->get_datatype();
+		if (arg_type != Variant::NIL && type.has_type && !_is_builtin(type, arg_type))
+			return -1; // would always need a conversion
+	}
+
+	// A derived class binding the same name would take over in a regular call.
+	List<StringName> inheriters;
+	ClassDB::get_inheriters_from_class(native, &inheriters);
+	for (List<StringName>::Element *E = inheriters.front(); E; E = E->next()) {
+		if (ClassDB::has_method(E->get(), method_name, true))
+			return -1;
+	}
+
+	void *class_ptr = ClassDB::get_class_ptr(native);
+	if (!class_ptr)
+		return -1;
+
+	return codegen.get_ptrcall_method_pos(mb, class_ptr);
+}
+#endif
+
 GDScriptDataType GDScriptCompiler::_gdtype_from_datatype(const GDScriptParser::DataType &p_datatype) const {
 	if (!p_datatype.has_type) {
 		return GDScriptDataType();
@@ -656,11 +759,19 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							arguments.push_back(ret);
 						}
 
+#ifdef GDSCRIPT_PTRCALL_ENABLED
+						int ptrcall_method = _get_ptrcall_method(codegen, on);
+						if (ptrcall_method >= 0) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_CALL_PTRCALL); // try the native method directly
+							codegen.opcodes.push_back(ptrcall_method);
+						}
+#endif
 						codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
 						codegen.opcodes.push_back(on->arguments.size() - 2);
 						codegen.alloc_call(on->arguments.size() - 2);
 						for (int i = 0; i < arguments.size(); i++)
 							codegen.opcodes.push_back(arguments[i]);
+						codegen.opcodes.push_back(codegen.alloc_inline_cache(on->arguments[0]->get_datatype()));
 					}
 				} break;
 				case GDScriptParser::OperatorNode::OP_YIELD: {
@@ -747,9 +858,18 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						}
 					}
 
-					codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
+					if (named) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_NAMED); // perform operator
+					} else if (_is_builtin(on->arguments[0]->get_datatype(), Variant::ARRAY) && _is_builtin(on->arguments[1]->get_datatype(), Variant::INT)) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_ARRAY);
+					} else {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET);
+					}
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+					if (named) {
+						codegen.opcodes.push_back(codegen.alloc_inline_cache(on->arguments[0]->get_datatype()));
+					}
 
 				} break;
 				case GDScriptParser::OperatorNode::OP_AND: {
@@ -1049,9 +1169,14 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							if (key_idx < 0) //error
 								return key_idx;
 
+							const GDScriptParser::DataType &base_type = E->get()->arguments[0]->get_datatype();
+
 							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET);
 							codegen.opcodes.push_back(prev_pos);
 							codegen.opcodes.push_back(key_idx);
+							if (named) {
+								codegen.opcodes.push_back(codegen.alloc_inline_cache(base_type));
+							}
 							slevel++;
 							codegen.alloc_stack(slevel);
 							int dst_pos = (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS) | slevel;
@@ -1060,6 +1185,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 
 							//add in reverse order, since it will be reverted
 
+							if (named) {
+								setchain.push_back(codegen.alloc_inline_cache(base_type));
+							}
 							setchain.push_back(dst_pos);
 							setchain.push_back(key_idx);
 							setchain.push_back(prev_pos);
@@ -1099,6 +1227,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						codegen.opcodes.push_back(prev_pos);
 						codegen.opcodes.push_back(set_index);
 						codegen.opcodes.push_back(set_value);
+						if (named) {
+							codegen.opcodes.push_back(codegen.alloc_inline_cache(op->arguments[0]->get_datatype()));
+						}
 
 						for (int i = 0; i < setchain.size(); i++) {
 
@@ -1276,6 +1407,8 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 		switch (s->type) {
 			case GDScriptParser::Node::TYPE_NEWLINE: {
 #ifdef DEBUG_ENABLED
+				if (!debug_code)
+					break;
 				const GDScriptParser::NewLineNode *nl = static_cast<const GDScriptParser::NewLineNode *>(s);
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_LINE);
 				codegen.opcodes.push_back(nl->line);
@@ -1415,8 +1548,17 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(ret2);
 
+						// range() with a single argument is turned into an int by the parser
+						bool int_range = _is_builtin(cf->arguments[1]->get_datatype(), Variant::INT);
+						if (cf->arguments[1]->type == GDScriptParser::Node::TYPE_OPERATOR) {
+							const GDScriptParser::OperatorNode *on = static_cast<const GDScriptParser::OperatorNode *>(cf->arguments[1]);
+							if (on->op == GDScriptParser::OperatorNode::OP_CALL && on->arguments[0]->type == GDScriptParser::Node::TYPE_TYPE) {
+								int_range = static_cast<const GDScriptParser::TypeNode *>(on->arguments[0])->vtype == Variant::INT;
+							}
+						}
+
 						//begin loop
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_BEGIN);
+						codegen.opcodes.push_back(int_range ? GDScriptFunction::OPCODE_ITERATE_BEGIN_INT : GDScriptFunction::OPCODE_ITERATE_BEGIN);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(codegen.opcodes.size() + 4);
@@ -1429,7 +1571,7 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(0); //skip code for next
 						//next loop
 						int continue_pos = codegen.opcodes.size();
-						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE);
+						codegen.opcodes.push_back(int_range ? GDScriptFunction::OPCODE_ITERATE_INT : GDScriptFunction::OPCODE_ITERATE);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(break_pos);
@@ -1516,6 +1658,8 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 			} break;
 			case GDScriptParser::Node::TYPE_ASSERT: {
 #ifdef DEBUG_ENABLED
+				if (!debug_code)
+					break;
 				// try subblocks
 
 				const GDScriptParser::AssertNode *as = static_cast<const GDScriptParser::AssertNode *>(s);
@@ -1531,7 +1675,8 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 			case GDScriptParser::Node::TYPE_BREAKPOINT: {
 #ifdef DEBUG_ENABLED
 				// try subblocks
-				codegen.opcodes.push_back(GDScriptFunction::OPCODE_BREAKPOINT);
+				if (debug_code)
+					codegen.opcodes.push_back(GDScriptFunction::OPCODE_BREAKPOINT);
 #endif
 			} break;
 			case GDScriptParser::Node::TYPE_LOCAL_VAR: {
@@ -1562,6 +1707,352 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 	return OK;
 }
 
+static _FORCE_INLINE_ bool _is_operator_opcode(int p_opcode) {
+
+	return p_opcode >= GDScriptFunction::OPCODE_OPERATOR && p_opcode <= GDScriptFunction::OPCODE_OPERATOR_VECTOR3;
+}
+
+static _FORCE_INLINE_ bool _is_address_of_type(int p_address, int p_type) {
+
+	return ((p_address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) == p_type;
+}
+
+// Values that a folded instruction can leave in a constant. Arrays, dictionaries
+// and objects are shared, so the function would see its own changes to them.
+static bool _is_foldable_constant(const Variant &p_value) {
+
+	switch (p_value.get_type()) {
+		case Variant::OBJECT:
+		case Variant::ARRAY:
+		case Variant::DICTIONARY: return false;
+		default: return true;
+	}
+}
+
+struct GDScriptCompiler::OptimizerInstruction {
+	Vector<int> code;
+	GDScriptFunction::InstructionInfo info;
+	int target; // index of the instruction jumped to, if info.jump != -1
+	bool removed;
+};
+
+// Index of the first instruction at or after p_index that is still there.
+int GDScriptCompiler::_next_live(const OptimizerInstruction *p_insts, int p_count, int p_index) {
+
+	while (p_index < p_count && p_insts[p_index].removed) {
+		p_index++;
+	}
+	return p_index;
+}
+
+// Runs on the finished code of a function, before it's stored:
+// - operators and deterministic built-in calls on constants are folded,
+// - conditional jumps on constants become jumps or go away,
+// - jumps to jumps go straight to the final target,
+// - unreachable code and jumps to the next instruction are removed,
+// - a result computed into a temporary and then assigned to a variable is
+//   stored to the variable directly.
+// Leaves the code untouched if it can't decode it.
+void GDScriptCompiler::_optimize_code(CodeGen &codegen, Vector<int> &r_defarg_addr) {
+
+	const int code_size = codegen.opcodes.size();
+	const int *code = codegen.opcodes.ptr();
+
+	Vector<OptimizerInstruction> instructions;
+	Vector<int> index_of; // instruction starting at each code position, or -1
+	index_of.resize(code_size + 1);
+	for (int i = 0; i <= code_size; i++) {
+		index_of.write[i] = -1;
+	}
+
+	int ip = 0;
+	while (ip < code_size) {
+
+		OptimizerInstruction inst;
+		if (!GDScriptFunction::get_instruction_info(code, code_size, ip, inst.info)) {
+			ERR_PRINT("Compiler bug: can't decode code to optimize.");
+			return;
+		}
+		inst.code.resize(inst.info.length);
+		for (int i = 0; i < inst.info.length; i++) {
+			inst.code.write[i] = code[ip + i];
+		}
+		inst.target = -1;
+		inst.removed = false;
+
+		index_of.write[ip] = instructions.size();
+		instructions.push_back(inst);
+		ip += inst.info.length;
+	}
+
+	const int count = instructions.size();
+	index_of.write[code_size] = count;
+	OptimizerInstruction *insts = instructions.ptrw();
+
+	for (int i = 0; i < count; i++) {
+		if (insts[i].info.jump == -1)
+			continue;
+		int to = insts[i].code[insts[i].info.jump];
+		if (to < 0 || to > code_size || index_of[to] == -1) {
+			ERR_PRINT("Compiler bug: jump to the middle of an instruction.");
+			return;
+		}
+		insts[i].target = index_of[to];
+	}
+
+	Vector<int> entries; // where calls can start, by number of default arguments used
+	entries.push_back(0);
+	for (int i = 0; i < r_defarg_addr.size(); i++) {
+		int to = r_defarg_addr[i];
+		ERR_FAIL_COND(to < 0 || to > code_size || index_of[to] == -1);
+		entries.push_back(index_of[to]);
+	}
+
+	Vector<Variant> constants;
+	constants.resize(codegen.constant_map.size());
+	const Variant *K = NULL;
+	while ((K = codegen.constant_map.next(K))) {
+		constants.write[codegen.constant_map[*K]] = *K;
+	}
+
+	/* Fold constants */
+
+	const int local_constant = GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT << GDScriptFunction::ADDR_BITS;
+
+	for (int i = 0; i < count; i++) {
+
+		Vector<int> &c = insts[i].code;
+		int opcode = c[0];
+		bool folded = false;
+		Variant result;
+
+		if (_is_operator_opcode(opcode)) {
+
+			if (_is_address_of_type(c[2], GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT) && _is_address_of_type(c[3], GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT)) {
+
+				const Variant &a = constants[c[2] & GDScriptFunction::ADDR_MASK];
+				const Variant &b = constants[c[3] & GDScriptFunction::ADDR_MASK];
+				if (a.get_type() != Variant::OBJECT && b.get_type() != Variant::OBJECT) {
+					bool valid;
+					Variant::evaluate(Variant::Operator(c[1]), a, b, result, valid);
+					folded = valid; // errors are left to be reported when running
+				}
+			}
+
+		} else if (opcode == GDScriptFunction::OPCODE_CALL_BUILT_IN) {
+
+			GDScriptFunctions::Function func = GDScriptFunctions::Function(c[1]);
+			int argc = c[2];
+			bool constant_args = GDScriptFunctions::is_deterministic(func);
+			for (int j = 0; j < argc && constant_args; j++) {
+				constant_args = _is_address_of_type(c[3 + j], GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT);
+			}
+
+			if (constant_args) {
+				Vector<const Variant *> args;
+				for (int j = 0; j < argc; j++) {
+					args.push_back(&constants[c[3 + j] & GDScriptFunction::ADDR_MASK]);
+				}
+				Variant::CallError err;
+				GDScriptFunctions::call(func, argc ? args.ptrw() : NULL, argc, result, err);
+				folded = err.error == Variant::CallError::CALL_OK;
+			}
+
+		} else if (opcode == GDScriptFunction::OPCODE_JUMP_IF || opcode == GDScriptFunction::OPCODE_JUMP_IF_NOT) {
+
+			if (_is_address_of_type(c[1], GDScriptFunction::ADDR_TYPE_LOCAL_CONSTANT)) {
+
+				bool condition = constants[c[1] & GDScriptFunction::ADDR_MASK].booleanize();
+				if (condition == (opcode == GDScriptFunction::OPCODE_JUMP_IF)) {
+					int to = c[2];
+					c.resize(2);
+					c.write[0] = GDScriptFunction::OPCODE_JUMP;
+					c.write[1] = to;
+					GDScriptFunction::get_instruction_info(c.ptr(), c.size(), 0, insts[i].info);
+				} else {
+					insts[i].removed = true;
+				}
+			}
+		}
+
+		if (folded && _is_foldable_constant(result)) {
+
+			int dst = c[insts[i].info.dst];
+			int pos = codegen.get_constant_pos(result);
+			if (pos == constants.size()) {
+				constants.push_back(result);
+			}
+
+			c.resize(3);
+			c.write[0] = GDScriptFunction::OPCODE_ASSIGN;
+			c.write[1] = dst;
+			c.write[2] = pos | local_constant;
+			GDScriptFunction::get_instruction_info(c.ptr(), c.size(), 0, insts[i].info);
+		}
+	}
+
+	/* Thread jumps */
+
+	for (int i = 0; i < count; i++) {
+
+		if (insts[i].removed || insts[i].info.jump == -1)
+			continue;
+
+		int to = _next_live(insts, count, insts[i].target);
+		for (int hops = 0; to < count && insts[to].code[0] == GDScriptFunction::OPCODE_JUMP && hops < count; hops++) {
+			to = _next_live(insts, count, insts[to].target);
+		}
+		insts[i].target = to;
+	}
+
+	/* Remove unreachable code */
+
+	Vector<bool> reachable;
+	reachable.resize(count + 1);
+	for (int i = 0; i <= count; i++) {
+		reachable.write[i] = false;
+	}
+
+	Vector<int> pending;
+	for (int i = 0; i < entries.size(); i++) {
+		pending.push_back(entries[i]);
+	}
+
+	while (pending.size()) {
+
+		int i = pending[pending.size() - 1];
+		pending.resize(pending.size() - 1);
+
+		if (i >= count || reachable[i])
+			continue;
+		reachable.write[i] = true;
+
+		int opcode = insts[i].code[0];
+		if (insts[i].removed || (opcode != GDScriptFunction::OPCODE_JUMP && opcode != GDScriptFunction::OPCODE_RETURN && opcode != GDScriptFunction::OPCODE_END)) {
+			pending.push_back(i + 1);
+		}
+		if (!insts[i].removed && insts[i].info.jump != -1) {
+			pending.push_back(insts[i].target);
+		}
+	}
+
+	for (int i = 0; i < count - 1; i++) { // the final OPCODE_END stays
+		if (!reachable[i]) {
+			insts[i].removed = true;
+		}
+	}
+
+	/* Remove jumps to the next instruction */
+
+	for (int i = count - 1; i >= 0; i--) {
+		if (!insts[i].removed && insts[i].code[0] == GDScriptFunction::OPCODE_JUMP && _next_live(insts, count, i + 1) == _next_live(insts, count, insts[i].target)) {
+			insts[i].removed = true;
+		}
+	}
+
+	/* Store results to their destination directly */
+
+	Vector<bool> is_target;
+	is_target.resize(count + 1);
+	for (int i = 0; i <= count; i++) {
+		is_target.write[i] = false;
+	}
+	for (int i = 0; i < count; i++) {
+		if (!insts[i].removed && insts[i].info.jump != -1) {
+			is_target.write[_next_live(insts, count, insts[i].target)] = true;
+		}
+	}
+	for (int i = 0; i < entries.size(); i++) {
+		is_target.write[_next_live(insts, count, entries[i])] = true;
+	}
+
+	int previous = -1;
+	for (int i = 0; i < count; i++) {
+
+		if (insts[i].removed)
+			continue;
+
+		const Vector<int> &c = insts[i].code;
+
+		if (c[0] == GDScriptFunction::OPCODE_ASSIGN) {
+
+			int dst = c[1];
+			int src = c[2];
+
+			if (dst == src) {
+				insts[i].removed = true; // assigns a value to itself
+				continue;
+			}
+
+			// Temporaries only live while the expression that creates them is
+			// evaluated, so nothing reads src after it's assigned.
+			if (previous != -1 && !is_target[i] && _is_address_of_type(src, GDScriptFunction::ADDR_TYPE_STACK)) {
+
+				OptimizerInstruction &producer = insts[previous];
+				if (producer.info.dst != -1 && producer.code[producer.info.dst] == src) {
+
+					// Operators and assignments compute their result before storing
+					// it. Other instructions may store it while their inputs are
+					// still needed, so they can't write over one of them.
+					bool aliased = false;
+					if (!_is_operator_opcode(producer.code[0]) && producer.code[0] != GDScriptFunction::OPCODE_ASSIGN) {
+						for (int j = 0; j < producer.info.addresses.size(); j++) {
+							if (producer.code[producer.info.addresses[j]] == dst) {
+								aliased = true;
+								break;
+							}
+						}
+					}
+
+					if (!aliased) {
+						producer.code.write[producer.info.dst] = dst;
+						insts[i].removed = true;
+						continue;
+					}
+				}
+			}
+		}
+
+		previous = i;
+	}
+
+	/* Put the code back together */
+
+	Vector<int> new_pos;
+	new_pos.resize(count + 1);
+	int size = 0;
+	for (int i = 0; i < count; i++) {
+		new_pos.write[i] = size;
+		if (!insts[i].removed) {
+			size += insts[i].code.size();
+		}
+	}
+	new_pos.write[count] = size;
+
+	Vector<int> optimized;
+	optimized.resize(size);
+	int *w = optimized.ptrw();
+	for (int i = 0; i < count; i++) {
+
+		if (insts[i].removed)
+			continue;
+
+		int pos = new_pos[i];
+		for (int j = 0; j < insts[i].code.size(); j++) {
+			w[pos + j] = insts[i].code[j];
+		}
+		if (insts[i].info.jump != -1) {
+			w[pos + insts[i].info.jump] = new_pos[insts[i].target];
+		}
+	}
+
+	for (int i = 0; i < r_defarg_addr.size(); i++) {
+		r_defarg_addr.write[i] = new_pos[entries[i + 1]];
+	}
+
+	codegen.opcodes = optimized;
+}
+
 Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser::ClassNode *p_class, const GDScriptParser::FunctionNode *p_func, bool p_for_ready) {
 
 	Vector<int> bytecode;
@@ -1571,9 +2062,10 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	codegen.script = p_script;
 	codegen.function_node = p_func;
 	codegen.stack_max = 0;
+	codegen.inline_cache_count = 0;
 	codegen.current_line = 0;
 	codegen.call_max = 0;
-	codegen.debug_stack = ScriptDebugger::get_singleton() != NULL;
+	codegen.debug_stack = debug_stack;
 	Vector<StringName> argnames;
 
 	int stack_level = 0;
@@ -1660,6 +2152,10 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 
 	codegen.opcodes.push_back(GDScriptFunction::OPCODE_END);
 
+	if (optimize) {
+		_optimize_code(codegen, defarg_addr);
+	}
+
 	/*
 	if (String(p_func->name)=="") { //initializer func
 		gdfunc = &p_script->initializer;
@@ -1720,6 +2216,13 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		gdfunc->_global_names_count = 0;
 	}
 
+	//native methods called through ptrcall
+	gdfunc->ptrcall_methods = codegen.ptrcall_methods;
+	gdfunc->_ptrcall_methods_ptr = gdfunc->ptrcall_methods.size() ? gdfunc->ptrcall_methods.ptr() : NULL;
+	gdfunc->_ptrcall_methods_count = gdfunc->ptrcall_methods.size();
+
+	gdfunc->_set_inline_cache_count(codegen.inline_cache_count);
+
 #ifdef TOOLS_ENABLED
 	// Named globals
 	if (codegen.named_globals.size()) {
@@ -1835,6 +2338,7 @@ Error GDScriptCompiler::_parse_class_level(GDScript *p_script, const GDScriptPar
 	p_script->_base = NULL;
 	p_script->members.clear();
 	p_script->constants.clear();
+	GDScriptFunction::invalidate_inline_caches(); // may refer to the old members and functions
 	for (Map<StringName, GDScriptFunction *>::Element *E = p_script->member_functions.front(); E; E = E->next()) {
 		memdelete(E->get());
 	}
@@ -2160,5 +2664,20 @@ int GDScriptCompiler::get_error_column() const {
 	return err_column;
 }
 
+void GDScriptCompiler::set_debug_code(bool p_enable) {
+
+	debug_code = p_enable;
+	debug_stack = p_enable;
+}
+
+void GDScriptCompiler::set_optimize(bool p_enable) {
+
+	optimize = p_enable;
+}
+
 GDScriptCompiler::GDScriptCompiler() {
+
+	debug_code = true;
+	debug_stack = ScriptDebugger::get_singleton() != NULL;
+	optimize = GLOBAL_GET("debug/gdscript/compiler/optimize");
 }
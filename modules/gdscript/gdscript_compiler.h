@@ -113,6 +113,30 @@ class GDScriptCompiler {
 			return ret;
 		}
 
+		Vector<GDScriptFunction::PtrCallMethod> ptrcall_methods;
+
+		int get_ptrcall_method_pos(MethodBind *p_method, void *p_class_ptr) {
+			for (int i = 0; i < ptrcall_methods.size(); i++) {
+				if (ptrcall_methods[i].method == p_method && ptrcall_methods[i].class_ptr == p_class_ptr)
+					return i;
+			}
+			GDScriptFunction::PtrCallMethod pcm;
+			pcm.method = p_method;
+			pcm.class_ptr = p_class_ptr;
+			ptrcall_methods.push_back(pcm);
+			return ptrcall_methods.size() - 1;
+		}
+
+		int inline_cache_count;
+
+		// Slot of a new inline cache for a named get/set or call on a base of
+		// the given type, or -1 when the base can't be an object.
+		int alloc_inline_cache(const GDScriptParser::DataType &p_base_type) {
+			if (p_base_type.has_type && !p_base_type.is_meta_type && p_base_type.kind == GDScriptParser::DataType::BUILTIN && p_base_type.builtin_type != Variant::OBJECT)
+				return -1;
+			return inline_cache_count++;
+		}
+
 		int get_constant_pos(const Variant &p_constant) {
 			if (constant_map.has(p_constant))
 				return constant_map[p_constant];
@@ -139,14 +163,21 @@ class GDScriptCompiler {
 
 	void _set_error(const String &p_error, const GDScriptParser::Node *p_node);
 
+	GDScriptFunction::Opcode _get_operator_opcode(Variant::Operator p_op, const GDScriptParser::DataType &p_a, const GDScriptParser::DataType &p_b) const;
 	bool _create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level);
 	bool _create_binary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level, bool p_initializer = false);
+#ifdef GDSCRIPT_PTRCALL_ENABLED
+	int _get_ptrcall_method(CodeGen &codegen, const GDScriptParser::OperatorNode *on);
+#endif
 
 	GDScriptDataType _gdtype_from_datatype(const GDScriptParser::DataType &p_datatype) const;
 
 	int _parse_assign_right_expression(CodeGen &codegen, const GDScriptParser::OperatorNode *p_expression, int p_stack_level);
 	int _parse_expression(CodeGen &codegen, const GDScriptParser::Node *p_expression, int p_stack_level, bool p_root = false, bool p_initializer = false);
 	Error _parse_block(CodeGen &codegen, const GDScriptParser::BlockNode *p_block, int p_stack_level = 0, int p_break_addr = -1, int p_continue_addr = -1);
+	struct OptimizerInstruction;
+	static int _next_live(const OptimizerInstruction *p_insts, int p_count, int p_index);
+	void _optimize_code(CodeGen &codegen, Vector<int> &r_defarg_addr);
 	Error _parse_function(GDScript *p_script, const GDScriptParser::ClassNode *p_class, const GDScriptParser::FunctionNode *p_func, bool p_for_ready = false);
 	Error _parse_class_level(GDScript *p_script, const GDScriptParser::ClassNode *p_class, bool p_keep_state);
 	Error _parse_class_blocks(GDScript *p_script, const GDScriptParser::ClassNode *p_class, bool p_keep_state);
@@ -155,10 +186,22 @@ class GDScriptCompiler {
 	int err_column;
 	StringName source;
 	String error;
+	bool debug_code;
+	bool debug_stack;
+	bool optimize;
 
 public:
 	Error compile(const GDScriptParser *p_parser, GDScript *p_script, bool p_keep_state = false);
 
+	// Whether to emit line, assert and breakpoint instructions and local variable
+	// info. Defaults to what this build and process use; exporting a project
+	// sets it for the target instead.
+	void set_debug_code(bool p_enable);
+
+	// Whether to run the optimization pass over each compiled function. Defaults
+	// to the "debug/gdscript/compiler/optimize" project setting.
+	void set_optimize(bool p_enable);
+
 	String get_error() const;
 	int get_error_line() const;
 	int get_error_column() const;
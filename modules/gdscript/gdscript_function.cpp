@@ -30,7 +30,9 @@
 
 #include "gdscript_function.h"
 
+#include "core/core_string_names.h"
 #include "core/os/os.h"
+#include "core/variant_internal.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
 
@@ -183,14 +185,294 @@ static String _get_var_type(const Variant *p_type) {
 }
 #endif
 
+// The object held by p_base if named access on it may go through an inline
+// cache, NULL if it has to take the regular path (which reports errors).
+static _FORCE_INLINE_ Object *_get_cacheable_object(const Variant *p_base) {
+
+	if (p_base->get_type() != Variant::OBJECT)
+		return NULL;
+
+	Object *obj = VariantInternal::get_object(p_base);
+#ifdef DEBUG_ENABLED
+	if (obj && ScriptDebugger::get_singleton() && !p_base->is_ref() && !ObjectDB::instance_validate(obj))
+		return NULL;
+#endif
+	return obj;
+}
+
+uint32_t GDScriptFunction::inline_cache_epoch = 0;
+Vector<GDScriptFunction::InlineCacheEntry *> GDScriptFunction::inline_cache_retired[2];
+
+void GDScriptFunction::invalidate_inline_caches() {
+
+	atomic_increment(&inline_cache_epoch);
+}
+
+void GDScriptFunction::free_retired_inline_cache_entries(bool p_all) {
+
+	Mutex *lock = GDScriptLanguage::get_singleton() ? GDScriptLanguage::get_singleton()->lock : NULL;
+	if (lock)
+		lock->lock();
+
+	// Another thread may have been reading an entry when it was replaced, but
+	// not for a whole frame.
+	for (int i = 0; i < inline_cache_retired[1].size(); i++) {
+		memdelete(inline_cache_retired[1][i]);
+	}
+	inline_cache_retired[1] = inline_cache_retired[0];
+	inline_cache_retired[0].clear();
+
+	if (p_all) {
+		for (int i = 0; i < inline_cache_retired[1].size(); i++) {
+			memdelete(inline_cache_retired[1][i]);
+		}
+		inline_cache_retired[1].clear();
+	}
+
+	if (lock)
+		lock->unlock();
+}
+
+// The resolvers mirror Object::get(), Object::set() and Object::call(), and
+// only accept cases where the result depends on nothing but the class and
+// script of the object.
+
+bool GDScriptFunction::_resolve_inline_get(const StringName &p_class, GDScript *p_script, const StringName &p_name, InlineCacheEntry &r_entry) {
+
+	if (p_script) {
+		const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.find(p_name);
+		if (E) {
+			if (E->get().getter)
+				return false;
+			r_entry.kind = InlineCacheEntry::SCRIPT_MEMBER;
+			r_entry.index = E->get().index;
+			return true;
+		}
+
+		for (GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+			if (sptr->constants.has(p_name) || sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._get))
+				return false;
+		}
+	}
+
+	bool is_constant = false;
+	ClassDB::get_integer_constant(p_class, p_name, &is_constant);
+	if (is_constant)
+		return false;
+
+	const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(p_class, p_name);
+	if (!psg || !psg->getter)
+		return false;
+
+	MethodBind *getter;
+	if (psg->index >= 0) {
+		// Called by name, which a script could override.
+		if (p_script)
+			return false;
+		getter = ClassDB::get_method(p_class, psg->getter);
+	} else {
+		getter = psg->_getptr;
+	}
+
+	if (!getter)
+		return false;
+
+	r_entry.kind = InlineCacheEntry::NATIVE_PROPERTY;
+	r_entry.method = getter;
+	r_entry.index = psg->index;
+	return true;
+}
+
+bool GDScriptFunction::_resolve_inline_set(const StringName &p_class, GDScript *p_script, const StringName &p_name, InlineCacheEntry &r_entry) {
+
+	if (p_script) {
+		const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.find(p_name);
+		if (E) {
+			if (E->get().setter)
+				return false;
+			r_entry.kind = InlineCacheEntry::SCRIPT_MEMBER;
+			r_entry.index = E->get().index;
+			r_entry.member_type = &E->get().data_type;
+			return true;
+		}
+
+		for (GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+			if (sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._set))
+				return false;
+		}
+	}
+
+	const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(p_class, p_name);
+	if (!psg || !psg->setter || !psg->_setptr)
+		return false;
+
+	r_entry.kind = InlineCacheEntry::NATIVE_PROPERTY;
+	r_entry.method = psg->_setptr;
+	r_entry.index = psg->index;
+	return true;
+}
+
+bool GDScriptFunction::_resolve_inline_call(const StringName &p_class, GDScript *p_script, const StringName &p_name, InlineCacheEntry &r_entry) {
+
+	if (p_name == CoreStringNames::get_singleton()->_free)
+		return false;
+
+	// Scripts (static functions) override Object::call() itself.
+	if (ClassDB::is_parent_class(p_class, "Script"))
+		return false;
+
+	for (GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+		Map<StringName, GDScriptFunction *>::Element *E = sptr->member_functions.find(p_name);
+		if (E) {
+			r_entry.kind = InlineCacheEntry::SCRIPT_FUNCTION;
+			r_entry.function = E->get();
+			return true;
+		}
+	}
+
+	MethodBind *method = ClassDB::get_method(p_class, p_name);
+	if (!method)
+		return false;
+
+	r_entry.kind = InlineCacheEntry::NATIVE_METHOD;
+	r_entry.method = method;
+	return true;
+}
+
+const GDScriptFunction::InlineCacheEntry *GDScriptFunction::_get_inline_cache_entry(int p_cache, int p_opcode, Object *p_object, const StringName &p_name, ScriptInstance *&r_instance) {
+
+	InlineCache &cache = _inline_caches_ptr[p_cache];
+
+	ScriptInstance *si = p_object->get_script_instance();
+	GDScript *script = NULL;
+	if (si) {
+		if (si->is_placeholder() || si->get_language() != GDScriptLanguage::get_singleton())
+			return NULL;
+		script = static_cast<GDScriptInstance *>(si)->script.ptr();
+	}
+	r_instance = si;
+
+	const StringName *class_name = &p_object->get_class_name();
+	uint32_t epoch = inline_cache_epoch;
+
+	for (int i = 0; i < InlineCache::MAX_ENTRIES; i++) {
+		const InlineCacheEntry *e = cache.entries[i];
+		if (e && e->class_name == class_name && e->script == script && e->epoch == epoch) {
+#ifdef DEBUG_ENABLED
+			if (e->kind == InlineCacheEntry::GENERIC) {
+				atomic_increment(&cache.misses);
+			} else {
+				atomic_increment(&cache.hits);
+			}
+#endif
+			return e->kind == InlineCacheEntry::GENERIC ? NULL : e;
+		}
+		if (!e)
+			break;
+	}
+
+#ifdef DEBUG_ENABLED
+	atomic_increment(&cache.misses);
+#endif
+	if (cache.megamorphic)
+		return NULL;
+
+	InlineCacheEntry entry;
+	entry.class_name = class_name;
+	entry.script = script;
+	entry.epoch = epoch;
+	entry.index = -1;
+	entry.member_type = NULL;
+	entry.function = NULL;
+	entry.method = NULL;
+
+	bool resolved;
+	switch (p_opcode) {
+		case OPCODE_GET_NAMED: resolved = _resolve_inline_get(*class_name, script, p_name, entry); break;
+		case OPCODE_SET_NAMED: resolved = _resolve_inline_set(*class_name, script, p_name, entry); break;
+		default: resolved = _resolve_inline_call(*class_name, script, p_name, entry); break;
+	}
+
+	if (!resolved) {
+		entry.kind = InlineCacheEntry::GENERIC;
+	}
+
+	Mutex *lock = GDScriptLanguage::get_singleton()->lock;
+	if (lock)
+		lock->lock();
+
+	// Reuse a slot that is empty or outdated; if all of them are in use, the
+	// instruction sees too many different objects to be worth caching.
+	int slot = -1;
+	for (int i = 0; i < InlineCache::MAX_ENTRIES; i++) {
+		if (!cache.entries[i] || cache.entries[i]->epoch != epoch) {
+			slot = i;
+			break;
+		}
+	}
+
+	InlineCacheEntry *e = NULL;
+	if (slot == -1) {
+		cache.megamorphic = true;
+	} else {
+		e = memnew(InlineCacheEntry(entry));
+		if (cache.entries[slot]) {
+			inline_cache_retired[0].push_back(cache.entries[slot]); // may still be in use elsewhere
+		}
+		// Also a full barrier, so the entry is complete before it is published.
+		atomic_increment(&inline_cache_fills);
+		cache.entries[slot] = e;
+	}
+
+	if (lock)
+		lock->unlock();
+
+	return resolved ? e : NULL;
+}
+
+void GDScriptFunction::_set_inline_cache_count(int p_count) {
+
+	inline_caches.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		InlineCache &cache = inline_caches.write[i];
+		for (int j = 0; j < InlineCache::MAX_ENTRIES; j++) {
+			cache.entries[j] = NULL;
+		}
+		cache.megamorphic = false;
+#ifdef DEBUG_ENABLED
+		cache.hits = 0;
+		cache.misses = 0;
+#endif
+	}
+	_inline_caches_ptr = inline_caches.size() ? inline_caches.ptrw() : NULL;
+	_inline_cache_count = inline_caches.size();
+}
+
+#ifdef DEBUG_ENABLED
+void GDScriptFunction::get_inline_cache_stats(uint64_t *r_hits, uint64_t *r_misses) const {
+
+	*r_hits = 0;
+	*r_misses = 0;
+	for (int i = 0; i < _inline_cache_count; i++) {
+		*r_hits += _inline_caches_ptr[i].hits;
+		*r_misses += _inline_caches_ptr[i].misses;
+	}
+}
+#endif
+
 #if defined(__GNUC__)
 #define OPCODES_TABLE                         \
 	static const void *switch_table_ops[] = { \
 		&&OPCODE_OPERATOR,                    \
+		&&OPCODE_OPERATOR_INT,                \
+		&&OPCODE_OPERATOR_REAL,               \
+		&&OPCODE_OPERATOR_VECTOR2,            \
+		&&OPCODE_OPERATOR_VECTOR3,            \
 		&&OPCODE_EXTENDS_TEST,                \
 		&&OPCODE_IS_BUILTIN,                  \
 		&&OPCODE_SET,                         \
 		&&OPCODE_GET,                         \
+		&&OPCODE_GET_ARRAY,                   \
 		&&OPCODE_SET_NAMED,                   \
 		&&OPCODE_GET_NAMED,                   \
 		&&OPCODE_SET_MEMBER,                  \
@@ -207,6 +489,7 @@ static String _get_var_type(const Variant *p_type) {
 		&&OPCODE_CONSTRUCT,                   \
 		&&OPCODE_CONSTRUCT_ARRAY,             \
 		&&OPCODE_CONSTRUCT_DICTIONARY,        \
+		&&OPCODE_CALL_PTRCALL,                \
 		&&OPCODE_CALL,                        \
 		&&OPCODE_CALL_RETURN,                 \
 		&&OPCODE_CALL_BUILT_IN,               \
@@ -222,6 +505,8 @@ static String _get_var_type(const Variant *p_type) {
 		&&OPCODE_RETURN,                      \
 		&&OPCODE_ITERATE_BEGIN,               \
 		&&OPCODE_ITERATE,                     \
+		&&OPCODE_ITERATE_BEGIN_INT,           \
+		&&OPCODE_ITERATE_INT,                 \
 		&&OPCODE_ASSERT,                      \
 		&&OPCODE_BREAKPOINT,                  \
 		&&OPCODE_LINE,                        \
@@ -383,7 +668,8 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #ifdef DEBUG_ENABLED
 
-	if (ScriptDebugger::get_singleton())
+	bool track_call_stack = GDScriptLanguage::get_singleton()->is_tracking_call_stack();
+	if (track_call_stack)
 		GDScriptLanguage::get_singleton()->enter_function(p_instance, this, stack, &ip, &line);
 
 #define GD_ERR_BREAK(m_cond)                                                                                           \
@@ -437,6 +723,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		OPCODE_SWITCH(_code_ptr[ip]) {
 
 			OPCODE(OPCODE_OPERATOR) {
+			operator_generic:
 
 				CHECK_SPACE(5);
 
@@ -473,6 +760,173 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			// The typed operator opcodes are emitted when the compiler knows the operand
+			// types. They still check them, and anything they don't handle (including
+			// errors such as division by zero) goes through the generic operator.
+
+			OPCODE(OPCODE_OPERATOR_INT) {
+
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+
+				if (likely(a->get_type() == Variant::INT && b->get_type() == Variant::INT)) {
+
+					int64_t va = *VariantInternal::get_int(a);
+					int64_t vb = *VariantInternal::get_int(b);
+					GET_VARIANT_PTR(dst, 4);
+
+					bool handled = true;
+					switch (_code_ptr[ip + 1]) {
+						case Variant::OP_EQUAL: VariantInternal::set_bool(dst, va == vb); break;
+						case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(dst, va != vb); break;
+						case Variant::OP_LESS: VariantInternal::set_bool(dst, va < vb); break;
+						case Variant::OP_LESS_EQUAL: VariantInternal::set_bool(dst, va <= vb); break;
+						case Variant::OP_GREATER: VariantInternal::set_bool(dst, va > vb); break;
+						case Variant::OP_GREATER_EQUAL: VariantInternal::set_bool(dst, va >= vb); break;
+						case Variant::OP_ADD: VariantInternal::set_int(dst, va + vb); break;
+						case Variant::OP_SUBTRACT: VariantInternal::set_int(dst, va - vb); break;
+						case Variant::OP_MULTIPLY: VariantInternal::set_int(dst, va * vb); break;
+						case Variant::OP_NEGATE: VariantInternal::set_int(dst, -va); break;
+						case Variant::OP_POSITIVE: VariantInternal::set_int(dst, va); break;
+						case Variant::OP_DIVIDE: {
+							if (vb == 0) {
+								handled = false;
+							} else {
+								VariantInternal::set_int(dst, va / vb);
+							}
+						} break;
+						case Variant::OP_MODULE: {
+							if (vb == 0) {
+								handled = false;
+							} else {
+								VariantInternal::set_int(dst, va % vb);
+							}
+						} break;
+						case Variant::OP_SHIFT_LEFT: VariantInternal::set_int(dst, va << vb); break;
+						case Variant::OP_SHIFT_RIGHT: VariantInternal::set_int(dst, va >> vb); break;
+						case Variant::OP_BIT_AND: VariantInternal::set_int(dst, va & vb); break;
+						case Variant::OP_BIT_OR: VariantInternal::set_int(dst, va | vb); break;
+						case Variant::OP_BIT_XOR: VariantInternal::set_int(dst, va ^ vb); break;
+						case Variant::OP_BIT_NEGATE: VariantInternal::set_int(dst, ~va); break;
+						default: handled = false;
+					}
+
+					if (likely(handled)) {
+						ip += 5;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				goto operator_generic;
+			}
+
+			OPCODE(OPCODE_OPERATOR_REAL) {
+
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(a, 2);
+				GET_VARIANT_PTR(b, 3);
+
+				// int/float mixes promote to float, but int with int must stay int.
+				Variant::Type ta = a->get_type();
+				Variant::Type tb = b->get_type();
+				if (likely((ta == Variant::REAL || ta == Variant::INT) && (tb == Variant::REAL || tb == Variant::INT) && (ta == Variant::REAL || tb == Variant::REAL))) {
+
+					double va = VariantInternal::get_number(a);
+					double vb = VariantInternal::get_number(b);
+					GET_VARIANT_PTR(dst, 4);
+
+					bool handled = true;
+					switch (_code_ptr[ip + 1]) {
+						case Variant::OP_EQUAL: VariantInternal::set_bool(dst, va == vb); break;
+						case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(dst, va != vb); break;
+						case Variant::OP_LESS: VariantInternal::set_bool(dst, va < vb); break;
+						case Variant::OP_LESS_EQUAL: VariantInternal::set_bool(dst, va <= vb); break;
+						case Variant::OP_GREATER: VariantInternal::set_bool(dst, va > vb); break;
+						case Variant::OP_GREATER_EQUAL: VariantInternal::set_bool(dst, va >= vb); break;
+						case Variant::OP_ADD: VariantInternal::set_real(dst, va + vb); break;
+						case Variant::OP_SUBTRACT: VariantInternal::set_real(dst, va - vb); break;
+						case Variant::OP_MULTIPLY: VariantInternal::set_real(dst, va * vb); break;
+						case Variant::OP_NEGATE: VariantInternal::set_real(dst, -va); break;
+						case Variant::OP_POSITIVE: VariantInternal::set_real(dst, va); break;
+						case Variant::OP_DIVIDE: {
+							if (vb == 0) {
+								handled = false;
+							} else {
+								VariantInternal::set_real(dst, va / vb);
+							}
+						} break;
+						default: handled = false;
+					}
+
+					if (likely(handled)) {
+						ip += 5;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				goto operator_generic;
+			}
+
+#define OPCODE_OPERATOR_VECTOR(m_opcode, m_vtype, m_type, m_get, m_set)                                                         \
+	OPCODE(m_opcode) {                                                                                                          \
+                                                                                                                                \
+		CHECK_SPACE(5);                                                                                                         \
+                                                                                                                                \
+		GET_VARIANT_PTR(a, 2);                                                                                                  \
+		GET_VARIANT_PTR(b, 3);                                                                                                  \
+                                                                                                                                \
+		Variant::Type ta = a->get_type();                                                                                       \
+		Variant::Type tb = b->get_type();                                                                                       \
+		bool handled = false;                                                                                                   \
+                                                                                                                                \
+		if (ta == m_vtype && tb == m_vtype) {                                                                                   \
+			const m_type &va = *VariantInternal::m_get(a);                                                                      \
+			const m_type &vb = *VariantInternal::m_get(b);                                                                      \
+			GET_VARIANT_PTR(dst, 4);                                                                                            \
+			handled = true;                                                                                                     \
+			switch (_code_ptr[ip + 1]) {                                                                                        \
+				case Variant::OP_EQUAL: VariantInternal::set_bool(dst, va == vb); break;                                        \
+				case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(dst, va != vb); break;                                    \
+				case Variant::OP_ADD: VariantInternal::m_set(dst, va + vb); break;                                              \
+				case Variant::OP_SUBTRACT: VariantInternal::m_set(dst, va - vb); break;                                         \
+				case Variant::OP_MULTIPLY: VariantInternal::m_set(dst, va * vb); break;                                         \
+				case Variant::OP_DIVIDE: VariantInternal::m_set(dst, va / vb); break;                                           \
+				case Variant::OP_NEGATE: VariantInternal::m_set(dst, -va); break;                                               \
+				case Variant::OP_POSITIVE: VariantInternal::m_set(dst, va); break;                                              \
+				default: handled = false;                                                                                       \
+			}                                                                                                                   \
+		} else if (ta == m_vtype && (tb == Variant::REAL || tb == Variant::INT)) {                                              \
+			m_type va = *VariantInternal::m_get(a);                                                                             \
+			real_t vb = VariantInternal::get_number(b);                                                                         \
+			GET_VARIANT_PTR(dst, 4);                                                                                            \
+			handled = true;                                                                                                     \
+			switch (_code_ptr[ip + 1]) {                                                                                        \
+				case Variant::OP_MULTIPLY: VariantInternal::m_set(dst, va * vb); break;                                         \
+				case Variant::OP_DIVIDE: VariantInternal::m_set(dst, va / vb); break;                                           \
+				default: handled = false;                                                                                       \
+			}                                                                                                                   \
+		} else if ((ta == Variant::REAL || ta == Variant::INT) && tb == m_vtype && _code_ptr[ip + 1] == Variant::OP_MULTIPLY) { \
+			real_t va = VariantInternal::get_number(a);                                                                         \
+			m_type vb = *VariantInternal::m_get(b);                                                                             \
+			GET_VARIANT_PTR(dst, 4);                                                                                            \
+			VariantInternal::m_set(dst, vb * va);                                                                               \
+			handled = true;                                                                                                     \
+		}                                                                                                                       \
+                                                                                                                                \
+		if (likely(handled)) {                                                                                                  \
+			ip += 5;                                                                                                            \
+			DISPATCH_OPCODE;                                                                                                    \
+		}                                                                                                                       \
+                                                                                                                                \
+		goto operator_generic;                                                                                                  \
+	}
+
+			OPCODE_OPERATOR_VECTOR(OPCODE_OPERATOR_VECTOR2, Variant::VECTOR2, Vector2, get_vector2, set_vector2)
+			OPCODE_OPERATOR_VECTOR(OPCODE_OPERATOR_VECTOR3, Variant::VECTOR3, Vector3, get_vector3, set_vector3)
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 
 				CHECK_SPACE(4);
@@ -579,6 +1033,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET) {
+			get_generic:
 
 				CHECK_SPACE(3);
 
@@ -611,10 +1066,42 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
-			OPCODE(OPCODE_SET_NAMED) {
+			OPCODE(OPCODE_GET_ARRAY) {
 
 				CHECK_SPACE(3);
 
+				GET_VARIANT_PTR(src, 1);
+				GET_VARIANT_PTR(index, 2);
+
+				if (likely(src->get_type() == Variant::ARRAY && index->get_type() == Variant::INT)) {
+
+					const Array *array = VariantInternal::get_array(src);
+					int idx = *VariantInternal::get_int(index);
+					if (idx < 0) {
+						idx += array->size();
+					}
+
+					if (likely(idx >= 0 && idx < array->size())) {
+						GET_VARIANT_PTR(dst, 3);
+						if (unlikely(dst == src)) {
+							// Assigning would release the array the element lives in.
+							Variant ret = array->get(idx);
+							*dst = ret;
+						} else {
+							*dst = array->get(idx);
+						}
+						ip += 4;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				goto get_generic; // out of bounds errors are reported there
+			}
+
+			OPCODE(OPCODE_SET_NAMED) {
+
+				CHECK_SPACE(5);
+
 				GET_VARIANT_PTR(dst, 1);
 				GET_VARIANT_PTR(value, 3);
 
@@ -623,8 +1110,42 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(cache_idx >= _inline_cache_count);
+
+				const InlineCacheEntry *ice = NULL;
+				ScriptInstance *ice_instance = NULL;
+				Object *ice_object = cache_idx >= 0 ? _get_cacheable_object(dst) : NULL;
+				if (ice_object) {
+					ice = _get_inline_cache_entry(cache_idx, OPCODE_SET_NAMED, ice_object, *index, ice_instance);
+					if (ice && ice->kind == InlineCacheEntry::SCRIPT_MEMBER && !ice->member_type->is_type(*value)) {
+						ice = NULL; // let the regular path report the type mismatch
+					}
+				}
+
 				bool valid;
-				dst->set_named(*index, *value, &valid);
+				if (ice) {
+#ifdef TOOLS_ENABLED
+					ice_object->_set_edited_flag();
+#endif
+					if (ice->kind == InlineCacheEntry::SCRIPT_MEMBER) {
+						static_cast<GDScriptInstance *>(ice_instance)->members.write[ice->index] = *value;
+						valid = true;
+					} else {
+						Variant::CallError ce;
+						if (ice->index >= 0) {
+							Variant prop_index = ice->index;
+							const Variant *args[2] = { &prop_index, value };
+							ice->method->call(ice_object, args, 2, ce);
+						} else {
+							const Variant *args[1] = { value };
+							ice->method->call(ice_object, args, 1, ce);
+						}
+						valid = ce.error == Variant::CallError::CALL_OK;
+					}
+				} else {
+					dst->set_named(*index, *value, &valid);
+				}
 
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -633,22 +1154,49 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET_NAMED) {
 
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 
 				GET_VARIANT_PTR(src, 1);
-				GET_VARIANT_PTR(dst, 3);
+				GET_VARIANT_PTR(dst, 4);
 
 				int indexname = _code_ptr[ip + 2];
 
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				int cache_idx = _code_ptr[ip + 3];
+				GD_ERR_BREAK(cache_idx >= _inline_cache_count);
+
+				Object *ice_object = cache_idx >= 0 ? _get_cacheable_object(src) : NULL;
+				if (ice_object) {
+					ScriptInstance *ice_instance;
+					const InlineCacheEntry *ice = _get_inline_cache_entry(cache_idx, OPCODE_GET_NAMED, ice_object, *index, ice_instance);
+					if (ice) {
+						if (ice->kind == InlineCacheEntry::SCRIPT_MEMBER) {
+							// src may be dst, and hold the last reference to the object.
+							Variant member = static_cast<GDScriptInstance *>(ice_instance)->members[ice->index];
+							*dst = member;
+						} else {
+							Variant::CallError ce;
+							if (ice->index >= 0) {
+								Variant prop_index = ice->index;
+								const Variant *args[1] = { &prop_index };
+								*dst = ice->method->call(ice_object, args, 1, ce);
+							} else {
+								*dst = ice->method->call(ice_object, NULL, 0, ce);
+							}
+						}
+						ip += 5;
+						DISPATCH_OPCODE;
+					}
+				}
+
 				bool valid;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
@@ -668,7 +1216,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1034,6 +1582,110 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_CALL_PTRCALL) {
+
+				CHECK_SPACE(6);
+#ifdef GDSCRIPT_PTRCALL_ENABLED
+				int pc_idx = _code_ptr[ip + 1];
+				GD_ERR_BREAK(pc_idx < 0 || pc_idx >= _ptrcall_methods_count);
+				const PtrCallMethod &pcm = _ptrcall_methods_ptr[pc_idx];
+				MethodBind *mb = pcm.method;
+#endif
+				// Skip to the regular call that follows; the fast path below
+				// consumes it, otherwise it runs as usual.
+				ip += 2;
+#ifdef GDSCRIPT_PTRCALL_ENABLED
+				int argc = _code_ptr[ip + 1];
+				GD_ERR_BREAK(argc != mb->get_argument_count());
+				CHECK_SPACE(argc + 6);
+
+				GET_VARIANT_PTR(base, 2);
+				Object *obj = _get_cacheable_object(base);
+				if (!obj || !obj->is_class_ptr(pcm.class_ptr)) {
+					DISPATCH_OPCODE;
+				}
+
+				if (obj->get_script_instance()) {
+					int nameg = _code_ptr[ip + 3];
+					GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
+					if (obj->get_script_instance()->has_method(_global_names_ptr[nameg])) {
+						DISPATCH_OPCODE; // overridden by a script
+					}
+				}
+
+				GET_VARIANT_PTR(dst, 5 + argc); // after the inline cache
+				const void **ptrargs = (const void **)call_args;
+				bool args_match = true;
+				bool dst_is_arg = false;
+
+				for (int i = 0; i < argc; i++) {
+					GET_VARIANT_PTR(v, 4 + i);
+					Variant::Type arg_type = mb->get_argument_type(i);
+					if (arg_type == Variant::NIL) {
+						ptrargs[i] = v; // takes a Variant
+					} else if (v->get_type() == arg_type) {
+						ptrargs[i] = VariantInternal::get_opaque_pointer(v);
+					} else {
+						args_match = false;
+					}
+					dst_is_arg = dst_is_arg || v == dst;
+				}
+
+				if (!args_match) {
+					DISPATCH_OPCODE; // needs conversion, let the regular call do it
+				}
+
+#ifdef DEBUG_ENABLED
+				uint64_t call_time = 0;
+
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					call_time = OS::get_singleton()->get_ticks_usec();
+				}
+#endif
+				bool call_ret = _code_ptr[ip] == OPCODE_CALL_RETURN;
+
+				if (!mb->has_return()) {
+					mb->ptrcall(obj, ptrargs, NULL);
+					if (call_ret) {
+						*dst = Variant();
+					}
+				} else {
+					Variant::Type ret_type = mb->get_argument_type(-1);
+					// The result can't be written into dst while an argument
+					// still points at it.
+					Variant tmp;
+					Variant *ret = dst;
+					if (!call_ret || dst_is_arg || (ret_type != Variant::NIL && dst->get_type() != ret_type)) {
+						Variant::CallError ce;
+						if (ret_type != Variant::NIL) {
+							tmp = Variant::construct(ret_type, NULL, 0, ce);
+						}
+						ret = &tmp;
+					}
+
+					if (ret_type == Variant::NIL) {
+						mb->ptrcall(obj, ptrargs, ret);
+					} else {
+						if (ret_type == Variant::INT) {
+							*VariantInternal::get_int(ret) = 0; // enums only write 32 bits
+						}
+						mb->ptrcall(obj, ptrargs, VariantInternal::get_opaque_pointer(ret));
+					}
+
+					if (call_ret && ret != dst) {
+						*dst = *ret;
+					}
+				}
+#ifdef DEBUG_ENABLED
+				if (GDScriptLanguage::get_singleton()->profiling) {
+					function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+				}
+#endif
+				ip += argc + 6;
+#endif
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
 
@@ -1049,7 +1701,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 				GD_ERR_BREAK(argc < 0);
 				ip += 4;
-				CHECK_SPACE(argc + 1);
+				CHECK_SPACE(argc + 2);
 				Variant **argptrs = call_args;
 
 				for (int i = 0; i < argc; i++) {
@@ -1057,6 +1709,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					argptrs[i] = v;
 				}
 
+				int cache_idx = _code_ptr[ip + argc];
+				GD_ERR_BREAK(cache_idx >= _inline_cache_count);
+
 #ifdef DEBUG_ENABLED
 				uint64_t call_time = 0;
 
@@ -1065,10 +1720,33 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 
 #endif
+				const InlineCacheEntry *ice = NULL;
+				ScriptInstance *ice_instance = NULL;
+				Object *ice_object = cache_idx >= 0 ? _get_cacheable_object(base) : NULL;
+				if (ice_object) {
+					ice = _get_inline_cache_entry(cache_idx, OPCODE_CALL, ice_object, *methodname, ice_instance);
+				}
+
 				Variant::CallError err;
-				if (call_ret) {
+				if (ice) {
+					// What Object::call() would end up doing.
+#ifdef DEBUG_ENABLED
+					_ObjectDebugLock debug_lock(ice_object);
+#endif
+					err.error = Variant::CallError::CALL_OK;
+					Variant r;
+					if (ice->kind == InlineCacheEntry::SCRIPT_FUNCTION) {
+						r = ice->function->call(static_cast<GDScriptInstance *>(ice_instance), (const Variant **)argptrs, argc, err);
+					} else {
+						r = ice->method->call(ice_object, (const Variant **)argptrs, argc, err);
+					}
+					if (call_ret && err.error == Variant::CallError::CALL_OK) {
+						GET_VARIANT_PTR(ret, argc + 1);
+						*ret = r;
+					}
+				} else if (call_ret) {
 
-					GET_VARIANT_PTR(ret, argc);
+					GET_VARIANT_PTR(ret, argc + 1);
 					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
 				} else {
 
@@ -1111,7 +1789,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 
 				//_call_func(NULL,base,*methodname,ip,argc,p_instance,stack);
-				ip += argc + 1;
+				ip += argc + 2;
 			}
 			DISPATCH_OPCODE;
 
@@ -1395,12 +2073,14 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GET_VARIANT_PTR(r, 1);
 				retvalue = *r;
 #ifdef DEBUG_ENABLED
+				GDScriptLanguage::get_singleton()->sampling_poll(); // before leaving the last line
 				exit_ok = true;
 #endif
 				OPCODE_BREAK;
 			}
 
 			OPCODE(OPCODE_ITERATE_BEGIN) {
+			iterate_begin_generic:
 
 				CHECK_SPACE(8); //space for this a regular iterate
 
@@ -1434,6 +2114,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_ITERATE) {
+			iterate_generic:
 
 				CHECK_SPACE(4);
 
@@ -1466,6 +2147,57 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_ITERATE_BEGIN_INT) {
+
+				CHECK_SPACE(8);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+
+				if (unlikely(container->get_type() != Variant::INT)) {
+					goto iterate_begin_generic;
+				}
+
+				if (*VariantInternal::get_int(container) <= 0) {
+					int jumpto = _code_ptr[ip + 3];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					GET_VARIANT_PTR(iterator, 4);
+
+					VariantInternal::set_int(counter, 0);
+					VariantInternal::set_int(iterator, 0);
+					ip += 5; //skip regular iterate which is always next
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_ITERATE_INT) {
+
+				CHECK_SPACE(4);
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+
+				if (unlikely(container->get_type() != Variant::INT || counter->get_type() != Variant::INT)) {
+					goto iterate_generic;
+				}
+
+				int64_t idx = *VariantInternal::get_int(counter) + 1;
+				if (idx >= *VariantInternal::get_int(container)) {
+					int jumpto = _code_ptr[ip + 3];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				} else {
+					GET_VARIANT_PTR(iterator, 4);
+
+					*VariantInternal::get_int(counter) = idx;
+					VariantInternal::set_int(iterator, idx);
+					ip += 5; //loop again
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_ASSERT) {
 				CHECK_SPACE(2);
 
@@ -1497,6 +2229,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_LINE) {
 				CHECK_SPACE(2);
 
+#ifdef DEBUG_ENABLED
+				// ticks that came in so far belong to the line that just ran
+				GDScriptLanguage::get_singleton()->sampling_poll();
+#endif
+
 				line = _code_ptr[ip + 1];
 				ip += 2;
 
@@ -1526,6 +2263,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 			OPCODE(OPCODE_END) {
 #ifdef DEBUG_ENABLED
+				GDScriptLanguage::get_singleton()->sampling_poll(); // before leaving the last line
 				exit_ok = true;
 #endif
 				OPCODE_BREAK;
@@ -1583,7 +2321,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		GDScriptLanguage::get_singleton()->script_frame_time += time_taken - function_call_time;
 	}
 
-	if (ScriptDebugger::get_singleton())
+	if (track_call_stack)
 		GDScriptLanguage::get_singleton()->exit_function();
 #endif
 
@@ -1664,6 +2402,216 @@ struct _GDFKCS {
 	}
 };
 
+bool GDScriptFunction::get_instruction_info(const int *p_code, int p_size, int p_ip, InstructionInfo &r_info) {
+
+	ERR_FAIL_INDEX_V(p_ip, p_size, false);
+
+	const int *code = &p_code[p_ip];
+	int remaining = p_size - p_ip;
+
+	r_info.length = 0;
+	r_info.jump = -1;
+	r_info.dst = -1;
+	r_info.addresses.clear();
+
+	int argc = 0;
+
+	switch (code[0]) {
+		case OPCODE_OPERATOR:
+		case OPCODE_OPERATOR_INT:
+		case OPCODE_OPERATOR_REAL:
+		case OPCODE_OPERATOR_VECTOR2:
+		case OPCODE_OPERATOR_VECTOR3: {
+			// [op, operator, a, b, dst]
+			r_info.length = 5;
+			r_info.dst = 4;
+			r_info.addresses.push_back(2);
+			r_info.addresses.push_back(3);
+		} break;
+		case OPCODE_EXTENDS_TEST:
+		case OPCODE_GET:
+		case OPCODE_GET_ARRAY:
+		case OPCODE_CAST_TO_NATIVE:
+		case OPCODE_CAST_TO_SCRIPT: {
+			// [op, a, b, dst]
+			r_info.length = 4;
+			r_info.dst = 3;
+			r_info.addresses.push_back(1);
+			r_info.addresses.push_back(2);
+		} break;
+		case OPCODE_SET: {
+			// [op, dst, index, value], dst is modified in place
+			r_info.length = 4;
+			r_info.addresses.push_back(1);
+			r_info.addresses.push_back(2);
+			r_info.addresses.push_back(3);
+		} break;
+		case OPCODE_ASSIGN_TYPED_NATIVE:
+		case OPCODE_ASSIGN_TYPED_SCRIPT: {
+			// [op, type, dst, src]
+			r_info.length = 4;
+			r_info.dst = 2;
+			r_info.addresses.push_back(1);
+			r_info.addresses.push_back(3);
+		} break;
+		case OPCODE_IS_BUILTIN: {
+			// [op, value, type, dst]
+			r_info.length = 4;
+			r_info.dst = 3;
+			r_info.addresses.push_back(1);
+		} break;
+		case OPCODE_ASSIGN_TYPED_BUILTIN: {
+			// [op, type, dst, src]
+			r_info.length = 4;
+			r_info.dst = 2;
+			r_info.addresses.push_back(3);
+		} break;
+		case OPCODE_CAST_TO_BUILTIN: {
+			// [op, type, src, dst]
+			r_info.length = 4;
+			r_info.dst = 3;
+			r_info.addresses.push_back(2);
+		} break;
+		case OPCODE_SET_NAMED: {
+			// [op, dst, name, value, inline cache], dst is modified in place
+			r_info.length = 5;
+			r_info.addresses.push_back(1);
+			r_info.addresses.push_back(3);
+		} break;
+		case OPCODE_GET_NAMED: {
+			// [op, src, name, inline cache, dst]
+			r_info.length = 5;
+			r_info.dst = 4;
+			r_info.addresses.push_back(1);
+		} break;
+		case OPCODE_SET_MEMBER: {
+			// [op, name, src]
+			r_info.length = 3;
+			r_info.addresses.push_back(2);
+		} break;
+		case OPCODE_GET_MEMBER: {
+			// [op, name, dst]
+			r_info.length = 3;
+			r_info.dst = 2;
+		} break;
+		case OPCODE_ASSIGN: {
+			// [op, dst, src]
+			r_info.length = 3;
+			r_info.dst = 1;
+			r_info.addresses.push_back(2);
+		} break;
+		case OPCODE_ASSIGN_TRUE:
+		case OPCODE_ASSIGN_FALSE:
+		case OPCODE_YIELD_RESUME: {
+			// [op, dst]
+			r_info.length = 2;
+			r_info.dst = 1;
+		} break;
+		case OPCODE_RETURN:
+		case OPCODE_ASSERT: {
+			// [op, value]
+			r_info.length = 2;
+			r_info.addresses.push_back(1);
+		} break;
+		case OPCODE_CONSTRUCT:
+		case OPCODE_CALL_BUILT_IN:
+		case OPCODE_CALL_SELF_BASE: {
+			// [op, type/function/name, argc, args..., dst]
+			if (remaining < 3)
+				return false;
+			argc = code[2];
+			r_info.length = 4 + argc;
+			r_info.dst = 3 + argc;
+			for (int i = 0; i < argc; i++) {
+				r_info.addresses.push_back(3 + i);
+			}
+		} break;
+		case OPCODE_CONSTRUCT_ARRAY:
+		case OPCODE_CONSTRUCT_DICTIONARY: {
+			// [op, argc, args..., dst], dictionaries take a key and a value per argument
+			if (remaining < 2)
+				return false;
+			argc = code[1];
+			if (code[0] == OPCODE_CONSTRUCT_DICTIONARY) {
+				argc *= 2;
+			}
+			r_info.length = 3 + argc;
+			r_info.dst = 2 + argc;
+			for (int i = 0; i < argc; i++) {
+				r_info.addresses.push_back(2 + i);
+			}
+		} break;
+		case OPCODE_CALL_PTRCALL:
+		case OPCODE_LINE: {
+			r_info.length = 2;
+		} break;
+		case OPCODE_CALL:
+		case OPCODE_CALL_RETURN: {
+			// [op, argc, base, name, args..., inline cache, dst], dst is unused without a return
+			if (remaining < 2)
+				return false;
+			argc = code[1];
+			r_info.length = 6 + argc;
+			r_info.addresses.push_back(2);
+			for (int i = 0; i < argc; i++) {
+				r_info.addresses.push_back(4 + i);
+			}
+			if (code[0] == OPCODE_CALL_RETURN) {
+				r_info.dst = 5 + argc;
+			} else {
+				r_info.addresses.push_back(5 + argc);
+			}
+		} break;
+		case OPCODE_YIELD:
+		case OPCODE_JUMP_TO_DEF_ARGUMENT:
+		case OPCODE_BREAKPOINT:
+		case OPCODE_END: {
+			r_info.length = 1;
+		} break;
+		case OPCODE_YIELD_SIGNAL: {
+			// [op, object, signal]
+			r_info.length = 3;
+			r_info.addresses.push_back(1);
+			r_info.addresses.push_back(2);
+		} break;
+		case OPCODE_JUMP: {
+			// [op, target]
+			r_info.length = 2;
+			r_info.jump = 1;
+		} break;
+		case OPCODE_JUMP_IF:
+		case OPCODE_JUMP_IF_NOT: {
+			// [op, condition, target]
+			r_info.length = 3;
+			r_info.jump = 2;
+			r_info.addresses.push_back(1);
+		} break;
+		case OPCODE_ITERATE_BEGIN:
+		case OPCODE_ITERATE:
+		case OPCODE_ITERATE_BEGIN_INT:
+		case OPCODE_ITERATE_INT: {
+			// [op, counter, container, exit target, iterator]
+			r_info.length = 5;
+			r_info.jump = 3;
+			r_info.addresses.push_back(1);
+			r_info.addresses.push_back(2);
+			r_info.addresses.push_back(4);
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	if (argc < 0 || r_info.length > remaining)
+		return false;
+
+	if (r_info.dst != -1) {
+		r_info.addresses.push_back(r_info.dst);
+	}
+
+	return true;
+}
+
 void GDScriptFunction::debug_get_stack_member_state(int p_line, List<Pair<StringName, int> > *r_stackvars) const {
 
 	int oc = 0;
@@ -1721,6 +2669,11 @@ GDScriptFunction::GDScriptFunction() :
 
 	_stack_size = 0;
 	_call_size = 0;
+	_ptrcall_methods_ptr = NULL;
+	_ptrcall_methods_count = 0;
+	_inline_caches_ptr = NULL;
+	_inline_cache_count = 0;
+	inline_cache_fills = 0;
 	rpc_mode = MultiplayerAPI::RPC_MODE_DISABLED;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -1749,6 +2702,15 @@ GDScriptFunction::GDScriptFunction() :
 }
 
 GDScriptFunction::~GDScriptFunction() {
+
+	for (int i = 0; i < inline_caches.size(); i++) {
+		for (int j = 0; j < InlineCache::MAX_ENTRIES; j++) {
+			if (inline_caches[i].entries[j]) {
+				memdelete(inline_caches[i].entries[j]);
+			}
+		}
+	}
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->lock) {
 		GDScriptLanguage::get_singleton()->lock->lock();
@@ -42,6 +42,12 @@
 class GDScriptInstance;
 class GDScript;
 
+#if defined(PTRCALL_ENABLED) && defined(DEBUG_METHODS_ENABLED)
+// Calling native methods through ptrcall needs their argument types, which
+// MethodBind only keeps when DEBUG_METHODS_ENABLED is set.
+#define GDSCRIPT_PTRCALL_ENABLED
+#endif
+
 struct GDScriptDataType {
 	bool has_type;
 	enum {
@@ -148,10 +154,15 @@ class GDScriptFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_INT, // same layout as OPCODE_OPERATOR, emitted when operand types are known
+		OPCODE_OPERATOR_REAL,
+		OPCODE_OPERATOR_VECTOR2,
+		OPCODE_OPERATOR_VECTOR3,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET,
 		OPCODE_GET,
+		OPCODE_GET_ARRAY, // same layout as OPCODE_GET, for Array bases indexed by int
 		OPCODE_SET_NAMED,
 		OPCODE_GET_NAMED,
 		OPCODE_SET_MEMBER,
@@ -168,6 +179,7 @@ public:
 		OPCODE_CONSTRUCT, //only for basic types!!
 		OPCODE_CONSTRUCT_ARRAY,
 		OPCODE_CONSTRUCT_DICTIONARY,
+		OPCODE_CALL_PTRCALL, // prefix of OPCODE_CALL/OPCODE_CALL_RETURN, for native methods resolved at compile time
 		OPCODE_CALL,
 		OPCODE_CALL_RETURN,
 		OPCODE_CALL_BUILT_IN,
@@ -183,6 +195,8 @@ public:
 		OPCODE_RETURN,
 		OPCODE_ITERATE_BEGIN,
 		OPCODE_ITERATE,
+		OPCODE_ITERATE_BEGIN_INT, // same layout as OPCODE_ITERATE_BEGIN/OPCODE_ITERATE, for range() loops
+		OPCODE_ITERATE_INT,
 		OPCODE_ASSERT,
 		OPCODE_BREAKPOINT,
 		OPCODE_LINE,
@@ -205,6 +219,50 @@ public:
 		ADDR_TYPE_NIL = 9
 	};
 
+	struct PtrCallMethod {
+
+		MethodBind *method;
+		void *class_ptr; // native class the method was resolved on
+	};
+
+	// Per-instruction cache for OPCODE_GET_NAMED, OPCODE_SET_NAMED and
+	// OPCODE_CALL/OPCODE_CALL_RETURN on objects, keyed on the object's class and
+	// script. Entries are never modified once published, so the VM reads them
+	// without locking. Outdated ones are replaced and freed a frame later.
+	struct InlineCacheEntry {
+
+		enum Kind {
+			SCRIPT_MEMBER,
+			SCRIPT_FUNCTION,
+			NATIVE_PROPERTY,
+			NATIVE_METHOD,
+			GENERIC, // can't be cached, remembered so it's not resolved again
+		};
+
+		const StringName *class_name;
+		GDScript *script; // NULL for objects without a script instance
+		uint32_t epoch;
+		Kind kind;
+		int index; // member index, or argument of an indexed property (-1 if none)
+		const GDScriptDataType *member_type;
+		GDScriptFunction *function;
+		MethodBind *method;
+	};
+
+	struct InlineCache {
+
+		enum {
+			MAX_ENTRIES = 4
+		};
+
+		InlineCacheEntry *entries[MAX_ENTRIES];
+		bool megamorphic; // saw more shapes than it can hold, no longer filled
+#ifdef DEBUG_ENABLED
+		volatile uint32_t hits;
+		volatile uint32_t misses;
+#endif
+	};
+
 	struct StackDebug {
 
 		int line;
@@ -215,6 +273,7 @@ public:
 
 private:
 	friend class GDScriptCompiler;
+	friend class GDScriptBytecode;
 
 	StringName source;
 
@@ -223,6 +282,10 @@ private:
 	int _constant_count;
 	const StringName *_global_names_ptr;
 	int _global_names_count;
+	const PtrCallMethod *_ptrcall_methods_ptr;
+	int _ptrcall_methods_count;
+	InlineCache *_inline_caches_ptr;
+	int _inline_cache_count;
 #ifdef TOOLS_ENABLED
 	const StringName *_named_globals_ptr;
 	int _named_globals_count;
@@ -243,6 +306,9 @@ private:
 	StringName name;
 	Vector<Variant> constants;
 	Vector<StringName> global_names;
+	Vector<PtrCallMethod> ptrcall_methods;
+	Vector<InlineCache> inline_caches;
+	uint32_t inline_cache_fills;
 #ifdef TOOLS_ENABLED
 	Vector<StringName> named_globals;
 #endif
@@ -260,6 +326,15 @@ private:
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const;
 
+	static uint32_t inline_cache_epoch;
+	static Vector<InlineCacheEntry *> inline_cache_retired[2];
+
+	static bool _resolve_inline_get(const StringName &p_class, GDScript *p_script, const StringName &p_name, InlineCacheEntry &r_entry);
+	static bool _resolve_inline_set(const StringName &p_class, GDScript *p_script, const StringName &p_name, InlineCacheEntry &r_entry);
+	static bool _resolve_inline_call(const StringName &p_class, GDScript *p_script, const StringName &p_name, InlineCacheEntry &r_entry);
+	const InlineCacheEntry *_get_inline_cache_entry(int p_cache, int p_opcode, Object *p_object, const StringName &p_name, ScriptInstance *&r_instance);
+	void _set_inline_cache_count(int p_count);
+
 	friend class GDScriptLanguage;
 
 	SelfList<GDScriptFunction> function_list;
@@ -315,6 +390,18 @@ public:
 
 	void debug_get_stack_member_state(int p_line, List<Pair<StringName, int> > *r_stackvars) const;
 
+	// Operands of one instruction, as offsets from its opcode. Used by the
+	// passes that rewrite or store compiled code.
+	struct InstructionInfo {
+		int length;
+		int jump; // operand holding a code position to jump to, or -1
+		int dst; // address the result is stored to without being read first, or -1
+		Vector<int> addresses; // all operands holding addresses, dst included
+	};
+
+	// Returns false on unknown opcodes or truncated code.
+	static bool get_instruction_info(const int *p_code, int p_size, int p_ip, InstructionInfo &r_info);
+
 	_FORCE_INLINE_ bool is_empty() const { return _code_size == 0; }
 
 	int get_argument_count() const { return _argument_count; }
@@ -334,6 +421,14 @@ public:
 	Variant call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError &r_err, CallState *p_state = NULL);
 
 	_FORCE_INLINE_ MultiplayerAPI::RPCMode get_rpc_mode() const { return rpc_mode; }
+
+	// Makes every inline cache miss once; call when script members or functions change.
+	static void invalidate_inline_caches();
+	// Frees the entries replaced before the previous call (or all of them), call once per frame.
+	static void free_retired_inline_cache_entries(bool p_all = false);
+#ifdef DEBUG_ENABLED
+	void get_inline_cache_stats(uint64_t *r_hits, uint64_t *r_misses) const;
+#endif
 	GDScriptFunction();
 	~GDScriptFunction();
 };
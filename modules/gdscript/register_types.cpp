@@ -35,6 +35,7 @@
 #include "core/os/file_access.h"
 #include "editor/gdscript_highlighter.h"
 #include "gdscript.h"
+#include "gdscript_bytecode.h"
 #include "gdscript_tokenizer.h"
 
 GDScriptLanguage *script_language_gd = NULL;
@@ -51,7 +52,14 @@ class EditorExportGDScript : public EditorExportPlugin {
 
 	GDCLASS(EditorExportGDScript, EditorExportPlugin);
 
+	bool debug;
+
 public:
+	virtual void _export_begin(const Set<String> &p_features, bool p_debug, const String &p_path, int p_flags) {
+
+		debug = p_debug;
+	}
+
 	virtual void _export_file(const String &p_path, const String &p_type, const Set<String> &p_features) {
 
 		int script_mode = EditorExportPreset::MODE_SCRIPT_COMPILED;
@@ -73,7 +81,7 @@ public:
 
 		String txt;
 		txt.parse_utf8((const char *)file.ptr(), file.size());
-		file = GDScriptTokenizerBuffer::parse_code_string(txt);
+		file = GDScriptBytecode::compile(txt, p_path, debug);
 
 		if (!file.empty()) {
 
@@ -123,6 +131,10 @@ public:
 			}
 		}
 	}
+
+	EditorExportGDScript() {
+		debug = false;
+	}
 };
 
 static void _editor_init() {
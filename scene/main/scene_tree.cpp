@@ -44,6 +44,7 @@
 #include "scene/resources/material.h"
 #include "scene/resources/mesh.h"
 #include "scene/resources/packed_scene.h"
+#include "scene/resources/texture.h"
 #include "scene/scene_string_names.h"
 #include "servers/physics_2d_server.h"
 #include "servers/physics_server.h"
@@ -565,6 +566,8 @@ bool SceneTree::idle(float p_time) {
 
 	_call_idle_callbacks();
 
+	StreamTexture::update_streaming();
+
 #ifdef TOOLS_ENABLED
 
 	if (Engine::get_singleton()->is_editor_hint()) {
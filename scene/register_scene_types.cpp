@@ -653,6 +653,7 @@ void register_scene_types() {
 	ClassDB::register_class<DynamicFont>();
 
 	DynamicFont::initialize_dynamic_fonts();
+	StreamTexture::initialize_streaming();
 
 	ClassDB::register_virtual_class<StyleBox>();
 	ClassDB::register_class<StyleBoxEmpty>();
@@ -698,6 +699,7 @@ void register_scene_types() {
 
 	ClassDB::register_virtual_class<SceneState>();
 	ClassDB::register_class<PackedScene>();
+	ClassDB::register_virtual_class<SceneInteractiveInstancer>();
 
 	ClassDB::register_class<SceneTree>();
 	ClassDB::register_virtual_class<SceneTreeTimer>(); //sorry, you can't create it
@@ -763,6 +765,7 @@ void unregister_scene_types() {
 	resource_loader_stream_texture.unref();
 
 	DynamicFont::finish_dynamic_fonts();
+	StreamTexture::finish_streaming();
 
 	ResourceSaver::remove_resource_format_saver(resource_saver_text);
 	resource_saver_text.unref();
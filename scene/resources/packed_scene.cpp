@@ -33,6 +33,7 @@
 #include "core/core_string_names.h"
 #include "core/engine.h"
 #include "core/io/resource_loader.h"
+#include "core/os/os.h"
 #include "core/project_settings.h"
 #include "scene/2d/node_2d.h"
 #include "scene/3d/spatial.h"
@@ -46,23 +47,51 @@ bool SceneState::can_instance() const {
 	return nodes.size() > 0;
 }
 
-Node *SceneState::instance(GenEditState p_edit_state) const {
+#define NODE_FROM_ID(p_name, p_id)                              \
+	Node *p_name;                                               \
+	if (p_id & FLAG_ID_IS_PATH) {                               \
+		NodePath np = node_paths[p_id & FLAG_MASK];             \
+		p_name = r_state.ret_nodes[0]->get_node_or_null(np);    \
+	} else {                                                    \
+		ERR_FAIL_INDEX_V(p_id &FLAG_MASK, nodes.size(), false); \
+		p_name = r_state.ret_nodes[p_id & FLAG_MASK];           \
+	}
+
+void SceneState::_instance_begin(InstanceState &r_state, GenEditState p_edit_state) const {
+
+	r_state.edit_state = p_edit_state;
+	r_state.gen_node_path_cache = p_edit_state != GEN_EDIT_STATE_DISABLED && node_path_cache.empty();
+	r_state.ret_nodes.resize(nodes.size());
+	for (int i = 0; i < r_state.ret_nodes.size(); i++) {
+		r_state.ret_nodes.write[i] = NULL;
+	}
+}
 
-	// nodes where instancing failed (because something is missing)
-	List<Node *> stray_instances;
+Ref<PackedScene> SceneState::_get_node_scene(int p_idx) const {
 
-#define NODE_FROM_ID(p_name, p_id)                   \
-	Node *p_name;                                    \
-	if (p_id & FLAG_ID_IS_PATH) {                    \
-		NodePath np = node_paths[p_id & FLAG_MASK];  \
-		p_name = ret_nodes[0]->get_node_or_null(np); \
-	} else {                                         \
-		ERR_FAIL_INDEX_V(p_id &FLAG_MASK, nc, NULL); \
-		p_name = ret_nodes[p_id & FLAG_MASK];        \
+	if (p_idx == 0 && base_scene_idx >= 0) {
+		return variants[base_scene_idx];
+	}
+
+	const NodeData &n = nodes[p_idx];
+	if (n.instance < 0) {
+		return Ref<PackedScene>();
+	}
+
+	if (n.instance & FLAG_INSTANCE_IS_PLACEHOLDER) {
+		if (!disable_placeholders) {
+			return Ref<PackedScene>();
+		}
+		return ResourceLoader::load(variants[n.instance & FLAG_MASK], "PackedScene");
 	}
 
+	return variants[n.instance & FLAG_MASK];
+}
+
+bool SceneState::_instance_node(InstanceState &r_state, int p_idx, Node *p_instanced) const {
+
 	int nc = nodes.size();
-	ERR_FAIL_COND_V(nc == 0, NULL);
+	ERR_FAIL_INDEX_V(p_idx, nc, false);
 
 	const StringName *snames = NULL;
 	int sname_count = names.size();
@@ -74,236 +103,246 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 	if (prop_count)
 		props = &variants[0];
 
-	//Vector<Variant> properties;
-
-	const NodeData *nd = &nodes[0];
-
-	Node **ret_nodes = (Node **)alloca(sizeof(Node *) * nc);
+	GenEditState edit_state = r_state.edit_state;
+	Node **ret_nodes = r_state.ret_nodes.ptrw();
 
-	bool gen_node_path_cache = p_edit_state != GEN_EDIT_STATE_DISABLED && node_path_cache.empty();
+	int i = p_idx;
+	const NodeData &n = nodes[i];
 
-	Map<Ref<Resource>, Ref<Resource> > resources_local_to_scene;
+	Node *parent = NULL;
 
-	for (int i = 0; i < nc; i++) {
+	if (i > 0) {
 
-		const NodeData &n = nd[i];
-
-		Node *parent = NULL;
-
-		if (i > 0) {
-
-			ERR_EXPLAIN(vformat("Invalid scene: node %s does not specify its parent node.", snames[n.name]))
-			ERR_FAIL_COND_V(n.parent == -1, NULL)
-			NODE_FROM_ID(nparent, n.parent);
+		ERR_EXPLAIN(vformat("Invalid scene: node %s does not specify its parent node.", snames[n.name]))
+		ERR_FAIL_COND_V(n.parent == -1, false)
+		NODE_FROM_ID(nparent, n.parent);
 #ifdef DEBUG_ENABLED
-			if (!nparent && (n.parent & FLAG_ID_IS_PATH)) {
+		if (!nparent && (n.parent & FLAG_ID_IS_PATH)) {
 
-				WARN_PRINT(String("Parent path '" + String(node_paths[n.parent & FLAG_MASK]) + "' for node '" + String(snames[n.name]) + "' has vanished when instancing: '" + get_path() + "'.").ascii().get_data());
-			}
-#endif
-			parent = nparent;
+			WARN_PRINT(String("Parent path '" + String(node_paths[n.parent & FLAG_MASK]) + "' for node '" + String(snames[n.name]) + "' has vanished when instancing: '" + get_path() + "'.").ascii().get_data());
 		}
+#endif
+		parent = nparent;
+	}
 
-		Node *node = NULL;
+	Node *node = NULL;
 
-		if (i == 0 && base_scene_idx >= 0) {
-			//scene inheritance on root node
-			Ref<PackedScene> sdata = props[base_scene_idx];
-			ERR_FAIL_COND_V(!sdata.is_valid(), NULL);
-			node = sdata->instance(p_edit_state == GEN_EDIT_STATE_DISABLED ? PackedScene::GEN_EDIT_STATE_DISABLED : PackedScene::GEN_EDIT_STATE_INSTANCE); //only main gets main edit state
-			ERR_FAIL_COND_V(!node, NULL);
-			if (p_edit_state != GEN_EDIT_STATE_DISABLED) {
-				node->set_scene_inherited_state(sdata->get_state());
-			}
+	if (i == 0 && base_scene_idx >= 0) {
+		//scene inheritance on root node
+		Ref<PackedScene> sdata = props[base_scene_idx];
+		ERR_FAIL_COND_V(!sdata.is_valid(), false);
+		node = p_instanced ? p_instanced : sdata->instance(edit_state == GEN_EDIT_STATE_DISABLED ? PackedScene::GEN_EDIT_STATE_DISABLED : PackedScene::GEN_EDIT_STATE_INSTANCE); //only main gets main edit state
+		ERR_FAIL_COND_V(!node, false);
+		if (edit_state != GEN_EDIT_STATE_DISABLED) {
+			node->set_scene_inherited_state(sdata->get_state());
+		}
 
-		} else if (n.instance >= 0) {
-			//instance a scene into this node
-			if (n.instance & FLAG_INSTANCE_IS_PLACEHOLDER) {
+	} else if (n.instance >= 0) {
+		//instance a scene into this node
+		if (n.instance & FLAG_INSTANCE_IS_PLACEHOLDER) {
 
-				String path = props[n.instance & FLAG_MASK];
-				if (disable_placeholders) {
+			String path = props[n.instance & FLAG_MASK];
+			if (p_instanced) {
+				node = p_instanced;
+			} else if (disable_placeholders) {
 
-					Ref<PackedScene> sdata = ResourceLoader::load(path, "PackedScene");
-					ERR_FAIL_COND_V(!sdata.is_valid(), NULL);
-					node = sdata->instance(p_edit_state == GEN_EDIT_STATE_DISABLED ? PackedScene::GEN_EDIT_STATE_DISABLED : PackedScene::GEN_EDIT_STATE_INSTANCE);
-					ERR_FAIL_COND_V(!node, NULL);
-				} else {
-					InstancePlaceholder *ip = memnew(InstancePlaceholder);
-					ip->set_instance_path(path);
-					node = ip;
-				}
-				node->set_scene_instance_load_placeholder(true);
+				Ref<PackedScene> sdata = ResourceLoader::load(path, "PackedScene");
+				ERR_FAIL_COND_V(!sdata.is_valid(), false);
+				node = sdata->instance(edit_state == GEN_EDIT_STATE_DISABLED ? PackedScene::GEN_EDIT_STATE_DISABLED : PackedScene::GEN_EDIT_STATE_INSTANCE);
+				ERR_FAIL_COND_V(!node, false);
 			} else {
-				Ref<PackedScene> sdata = props[n.instance & FLAG_MASK];
-				ERR_FAIL_COND_V(!sdata.is_valid(), NULL);
-				node = sdata->instance(p_edit_state == GEN_EDIT_STATE_DISABLED ? PackedScene::GEN_EDIT_STATE_DISABLED : PackedScene::GEN_EDIT_STATE_INSTANCE);
-				ERR_FAIL_COND_V(!node, NULL);
+				InstancePlaceholder *ip = memnew(InstancePlaceholder);
+				ip->set_instance_path(path);
+				node = ip;
 			}
+			node->set_scene_instance_load_placeholder(true);
+		} else if (p_instanced) {
+			node = p_instanced;
+		} else {
+			Ref<PackedScene> sdata = props[n.instance & FLAG_MASK];
+			ERR_FAIL_COND_V(!sdata.is_valid(), false);
+			node = sdata->instance(edit_state == GEN_EDIT_STATE_DISABLED ? PackedScene::GEN_EDIT_STATE_DISABLED : PackedScene::GEN_EDIT_STATE_INSTANCE);
+			ERR_FAIL_COND_V(!node, false);
+		}
 
-		} else if (n.type == TYPE_INSTANCED) {
-			//get the node from somewhere, it likely already exists from another instance
-			if (parent) {
-				node = parent->_get_child_by_name(snames[n.name]);
+	} else if (n.type == TYPE_INSTANCED) {
+		//get the node from somewhere, it likely already exists from another instance
+		if (parent) {
+			node = parent->_get_child_by_name(snames[n.name]);
 #ifdef DEBUG_ENABLED
-				if (!node) {
-					WARN_PRINT(String("Node '" + String(ret_nodes[0]->get_path_to(parent)) + "/" + String(snames[n.name]) + "' was modified from inside an instance, but it has vanished.").ascii().get_data());
-				}
+			if (!node) {
+				WARN_PRINT(String("Node '" + String(ret_nodes[0]->get_path_to(parent)) + "/" + String(snames[n.name]) + "' was modified from inside an instance, but it has vanished.").ascii().get_data());
+			}
 #endif
+		}
+	} else if (ClassDB::is_class_enabled(snames[n.type])) {
+		//node belongs to this scene and must be created
+		Object *obj = ClassDB::instance(snames[n.type]);
+		if (!Object::cast_to<Node>(obj)) {
+			if (obj) {
+				memdelete(obj);
+				obj = NULL;
 			}
-		} else if (ClassDB::is_class_enabled(snames[n.type])) {
-			//node belongs to this scene and must be created
-			Object *obj = ClassDB::instance(snames[n.type]);
-			if (!Object::cast_to<Node>(obj)) {
-				if (obj) {
-					memdelete(obj);
-					obj = NULL;
-				}
-				WARN_PRINT(String("Warning node of type " + snames[n.type].operator String() + " does not exist.").ascii().get_data());
-				if (n.parent >= 0 && n.parent < nc && ret_nodes[n.parent]) {
-					if (Object::cast_to<Spatial>(ret_nodes[n.parent])) {
-						obj = memnew(Spatial);
-					} else if (Object::cast_to<Control>(ret_nodes[n.parent])) {
-						obj = memnew(Control);
-					} else if (Object::cast_to<Node2D>(ret_nodes[n.parent])) {
-						obj = memnew(Node2D);
-					}
+			WARN_PRINT(String("Warning node of type " + snames[n.type].operator String() + " does not exist.").ascii().get_data());
+			if (n.parent >= 0 && n.parent < nc && ret_nodes[n.parent]) {
+				if (Object::cast_to<Spatial>(ret_nodes[n.parent])) {
+					obj = memnew(Spatial);
+				} else if (Object::cast_to<Control>(ret_nodes[n.parent])) {
+					obj = memnew(Control);
+				} else if (Object::cast_to<Node2D>(ret_nodes[n.parent])) {
+					obj = memnew(Node2D);
 				}
+			}
 
-				if (!obj) {
-					obj = memnew(Node);
-				}
+			if (!obj) {
+				obj = memnew(Node);
 			}
+		}
 
-			node = Object::cast_to<Node>(obj);
+		node = Object::cast_to<Node>(obj);
 
-		} else {
-			//print_line("Class is disabled for: " + itos(n.type));
-			//print_line("name: " + String(snames[n.type]));
-		}
+	} else {
+		//print_line("Class is disabled for: " + itos(n.type));
+		//print_line("name: " + String(snames[n.type]));
+	}
 
-		if (node) {
-			// may not have found the node (part of instanced scene and removed)
-			// if found all is good, otherwise ignore
+	if (i == 0 && !node) {
+		ERR_EXPLAIN(vformat("Invalid scene: root node %s could not be created.", snames[n.name]));
+		ERR_FAIL_V(false);
+	}
 
-			//properties
-			int nprop_count = n.properties.size();
-			if (nprop_count) {
+	if (node) {
+		// may not have found the node (part of instanced scene and removed)
+		// if found all is good, otherwise ignore
 
-				const NodeData::Property *nprops = &n.properties[0];
+		//properties
+		int nprop_count = n.properties.size();
+		if (nprop_count) {
 
-				for (int j = 0; j < nprop_count; j++) {
+			const NodeData::Property *nprops = &n.properties[0];
 
-					bool valid;
-					ERR_FAIL_INDEX_V(nprops[j].name, sname_count, NULL);
-					ERR_FAIL_INDEX_V(nprops[j].value, prop_count, NULL);
+			for (int j = 0; j < nprop_count; j++) {
 
-					if (snames[nprops[j].name] == CoreStringNames::get_singleton()->_script) {
-						//work around to avoid old script variables from disappearing, should be the proper fix to:
-						//https://github.com/godotengine/godot/issues/2958
+				bool valid;
+				ERR_FAIL_INDEX_V(nprops[j].name, sname_count, false);
+				ERR_FAIL_INDEX_V(nprops[j].value, prop_count, false);
 
-						//store old state
-						List<Pair<StringName, Variant> > old_state;
-						if (node->get_script_instance()) {
-							node->get_script_instance()->get_property_state(old_state);
-						}
+				if (snames[nprops[j].name] == CoreStringNames::get_singleton()->_script) {
+					//work around to avoid old script variables from disappearing, should be the proper fix to:
+					//https://github.com/godotengine/godot/issues/2958
 
-						node->set(snames[nprops[j].name], props[nprops[j].value], &valid);
+					//store old state
+					List<Pair<StringName, Variant> > old_state;
+					if (node->get_script_instance()) {
+						node->get_script_instance()->get_property_state(old_state);
+					}
 
-						//restore old state for new script, if exists
-						for (List<Pair<StringName, Variant> >::Element *E = old_state.front(); E; E = E->next()) {
-							node->set(E->get().first, E->get().second);
-						}
-					} else {
+					node->set(snames[nprops[j].name], props[nprops[j].value], &valid);
 
-						Variant value = props[nprops[j].value];
+					//restore old state for new script, if exists
+					for (List<Pair<StringName, Variant> >::Element *E = old_state.front(); E; E = E->next()) {
+						node->set(E->get().first, E->get().second);
+					}
+				} else {
 
-						if (value.get_type() == Variant::OBJECT) {
-							//handle resources that are local to scene by duplicating them if needed
-							Ref<Resource> res = value;
-							if (res.is_valid()) {
-								if (res->is_local_to_scene()) {
+					Variant value = props[nprops[j].value];
 
-									Map<Ref<Resource>, Ref<Resource> >::Element *E = resources_local_to_scene.find(res);
+					if (value.get_type() == Variant::OBJECT) {
+						//handle resources that are local to scene by duplicating them if needed
+						Ref<Resource> res = value;
+						if (res.is_valid()) {
+							if (res->is_local_to_scene()) {
 
-									if (E) {
-										value = E->get();
-									} else {
+								Map<Ref<Resource>, Ref<Resource> >::Element *E = r_state.resources_local_to_scene.find(res);
 
-										Node *base = i == 0 ? node : ret_nodes[0];
-
-										if (p_edit_state == GEN_EDIT_STATE_MAIN) {
-											//for the main scene, use the resource as is
-											res->configure_for_local_scene(base, resources_local_to_scene);
-											resources_local_to_scene[res] = res;
-
-										} else {
-											//for instances, a copy must be made
-											Node *base2 = i == 0 ? node : ret_nodes[0];
-											Ref<Resource> local_dupe = res->duplicate_for_local_scene(base2, resources_local_to_scene);
-											resources_local_to_scene[res] = local_dupe;
-											res = local_dupe;
-											value = local_dupe;
-										}
+								if (E) {
+									value = E->get();
+								} else {
+
+									Node *base = i == 0 ? node : ret_nodes[0];
+
+									if (edit_state == GEN_EDIT_STATE_MAIN) {
+										//for the main scene, use the resource as is
+										res->configure_for_local_scene(base, r_state.resources_local_to_scene);
+										r_state.resources_local_to_scene[res] = res;
+
+									} else {
+										//for instances, a copy must be made
+										Node *base2 = i == 0 ? node : ret_nodes[0];
+										Ref<Resource> local_dupe = res->duplicate_for_local_scene(base2, r_state.resources_local_to_scene);
+										r_state.resources_local_to_scene[res] = local_dupe;
+										res = local_dupe;
+										value = local_dupe;
 									}
-									//must make a copy, because this res is local to scene
 								}
+								//must make a copy, because this res is local to scene
 							}
-						} else if (p_edit_state == GEN_EDIT_STATE_INSTANCE) {
-							value = value.duplicate(true); // Duplicate arrays and dictionaries for the editor
 						}
-						node->set(snames[nprops[j].name], value, &valid);
+					} else if (edit_state == GEN_EDIT_STATE_INSTANCE) {
+						value = value.duplicate(true); // Duplicate arrays and dictionaries for the editor
 					}
+					node->set(snames[nprops[j].name], value, &valid);
 				}
 			}
+		}
 
-			//name
+		//name
 
-			//groups
-			for (int j = 0; j < n.groups.size(); j++) {
+		//groups
+		for (int j = 0; j < n.groups.size(); j++) {
 
-				ERR_FAIL_INDEX_V(n.groups[j], sname_count, NULL);
-				node->add_to_group(snames[n.groups[j]], true);
-			}
+			ERR_FAIL_INDEX_V(n.groups[j], sname_count, false);
+			node->add_to_group(snames[n.groups[j]], true);
+		}
 
-			if (n.instance >= 0 || n.type != TYPE_INSTANCED || i == 0) {
-				//if node was not part of instance, must set its name, parenthood and ownership
-				if (i > 0) {
-					if (parent) {
-						parent->_add_child_nocheck(node, snames[n.name]);
-						if (n.index >= 0 && n.index < parent->get_child_count() - 1)
-							parent->move_child(node, n.index);
-					} else {
-						//it may be possible that an instanced scene has changed
-						//and the node has nowhere to go anymore
-						stray_instances.push_back(node); //can't be added, go to stray list
-					}
+		if (n.instance >= 0 || n.type != TYPE_INSTANCED || i == 0) {
+			//if node was not part of instance, must set its name, parenthood and ownership
+			if (i > 0) {
+				if (parent) {
+					parent->_add_child_nocheck(node, snames[n.name]);
+					if (n.index >= 0 && n.index < parent->get_child_count() - 1)
+						parent->move_child(node, n.index);
 				} else {
-					if (Engine::get_singleton()->is_editor_hint()) {
-						//validate name if using editor, to avoid broken
-						node->set_name(snames[n.name]);
-					} else {
-						node->_set_name_nocheck(snames[n.name]);
-					}
+					//it may be possible that an instanced scene has changed
+					//and the node has nowhere to go anymore
+					r_state.stray_instances.push_back(node); //can't be added, go to stray list
+				}
+			} else {
+				if (Engine::get_singleton()->is_editor_hint()) {
+					//validate name if using editor, to avoid broken
+					node->set_name(snames[n.name]);
+				} else {
+					node->_set_name_nocheck(snames[n.name]);
 				}
 			}
+		}
 
-			if (n.owner >= 0) {
+		if (n.owner >= 0) {
 
-				NODE_FROM_ID(owner, n.owner);
-				if (owner)
-					node->_set_owner_nocheck(owner);
-			}
+			NODE_FROM_ID(owner, n.owner);
+			if (owner)
+				node->_set_owner_nocheck(owner);
 		}
+	}
 
-		ret_nodes[i] = node;
+	ret_nodes[i] = node;
 
-		if (node && gen_node_path_cache && ret_nodes[0]) {
-			NodePath n2 = ret_nodes[0]->get_path_to(node);
-			node_path_cache[n2] = i;
-		}
+	if (node && r_state.gen_node_path_cache && ret_nodes[0]) {
+		NodePath n2 = ret_nodes[0]->get_path_to(node);
+		node_path_cache[n2] = i;
 	}
 
-	for (Map<Ref<Resource>, Ref<Resource> >::Element *E = resources_local_to_scene.front(); E; E = E->next()) {
+	return true;
+}
+
+bool SceneState::_instance_end(InstanceState &r_state) const {
+
+	ERR_FAIL_COND_V(r_state.ret_nodes.size() == 0 || !r_state.ret_nodes[0], false);
+
+	const StringName *snames = names.ptr();
+	const Variant *props = variants.ptr();
+
+	for (Map<Ref<Resource>, Ref<Resource> >::Element *E = r_state.resources_local_to_scene.front(); E; E = E->next()) {
 
 		E->get()->setup_local_to_scene();
 	}
@@ -316,8 +355,6 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 	for (int i = 0; i < cc; i++) {
 
 		const ConnectionData &c = cdata[i];
-		//ERR_FAIL_INDEX_V( c.from, nc, NULL );
-		//ERR_FAIL_INDEX_V( c.to, nc, NULL );
 
 		NODE_FROM_ID(cfrom, c.from);
 		NODE_FROM_ID(cto, c.to);
@@ -335,22 +372,59 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 		cfrom->connect(snames[c.signal], cto, snames[c.method], binds, CONNECT_PERSIST | c.flags);
 	}
 
-	//Node *s = ret_nodes[0];
-
 	//remove nodes that could not be added, likely as a result that
-	while (stray_instances.size()) {
-		memdelete(stray_instances.front()->get());
-		stray_instances.pop_front();
+	while (r_state.stray_instances.size()) {
+		memdelete(r_state.stray_instances.front()->get());
+		r_state.stray_instances.pop_front();
 	}
 
+	Node *root = r_state.ret_nodes[0];
 	for (int i = 0; i < editable_instances.size(); i++) {
-		Node *ei = ret_nodes[0]->get_node_or_null(editable_instances[i]);
+		Node *ei = root->get_node_or_null(editable_instances[i]);
 		if (ei) {
-			ret_nodes[0]->set_editable_instance(ei, true);
+			root->set_editable_instance(ei, true);
 		}
 	}
 
-	return ret_nodes[0];
+	return true;
+}
+
+#undef NODE_FROM_ID
+
+void SceneState::_instance_abort(InstanceState &r_state) const {
+
+	while (r_state.stray_instances.size()) {
+		memdelete(r_state.stray_instances.front()->get());
+		r_state.stray_instances.pop_front();
+	}
+
+	if (r_state.ret_nodes.size() && r_state.ret_nodes[0]) {
+		memdelete(r_state.ret_nodes[0]);
+	}
+	r_state.ret_nodes.clear();
+	r_state.resources_local_to_scene.clear();
+}
+
+Node *SceneState::instance(GenEditState p_edit_state) const {
+
+	ERR_FAIL_COND_V(nodes.size() == 0, NULL);
+
+	InstanceState state;
+	_instance_begin(state, p_edit_state);
+
+	for (int i = 0; i < nodes.size(); i++) {
+		if (!_instance_node(state, i, NULL)) {
+			_instance_abort(state);
+			return NULL;
+		}
+	}
+
+	if (!_instance_end(state)) {
+		_instance_abort(state);
+		return NULL;
+	}
+
+	return state.ret_nodes[0];
 }
 
 static int _nm_get_string(const String &p_string, Map<StringName, int> &name_map) {
@@ -1700,16 +1774,39 @@ Node *PackedScene::instance(GenEditState p_edit_state) const {
 	if (!s)
 		return NULL;
 
+	_instance_finished(s, p_edit_state);
+
+	return s;
+}
+
+void PackedScene::_instance_finished(Node *p_node, int p_edit_state) const {
+
 	if (p_edit_state != GEN_EDIT_STATE_DISABLED) {
-		s->set_scene_instance_state(state);
+		p_node->set_scene_instance_state(state);
 	}
 
 	if (get_path() != "" && get_path().find("::") == -1)
-		s->set_filename(get_path());
+		p_node->set_filename(get_path());
 
-	s->notification(Node::NOTIFICATION_INSTANCED);
+	p_node->notification(Node::NOTIFICATION_INSTANCED);
+}
 
-	return s;
+Ref<SceneInteractiveInstancer> PackedScene::instance_interactive(GenEditState p_edit_state) {
+
+#ifndef TOOLS_ENABLED
+	if (p_edit_state != GEN_EDIT_STATE_DISABLED) {
+		ERR_EXPLAIN("Edit state is only for editors, does not work without tools compiled");
+		ERR_FAIL_COND_V(p_edit_state != GEN_EDIT_STATE_DISABLED, Ref<SceneInteractiveInstancer>());
+	}
+#endif
+
+	ERR_FAIL_COND_V(!state->can_instance(), Ref<SceneInteractiveInstancer>());
+
+	Ref<SceneInteractiveInstancer> ii;
+	ii.instance();
+	ii->_start(Ref<PackedScene>(this), p_edit_state);
+
+	return ii;
 }
 
 void PackedScene::replace_state(Ref<SceneState> p_by) {
@@ -1745,6 +1842,7 @@ void PackedScene::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("pack", "path"), &PackedScene::pack);
 	ClassDB::bind_method(D_METHOD("instance", "edit_state"), &PackedScene::instance, DEFVAL(GEN_EDIT_STATE_DISABLED));
+	ClassDB::bind_method(D_METHOD("instance_interactive", "edit_state"), &PackedScene::instance_interactive, DEFVAL(GEN_EDIT_STATE_DISABLED));
 	ClassDB::bind_method(D_METHOD("can_instance"), &PackedScene::can_instance);
 	ClassDB::bind_method(D_METHOD("_set_bundled_scene"), &PackedScene::_set_bundled_scene);
 	ClassDB::bind_method(D_METHOD("_get_bundled_scene"), &PackedScene::_get_bundled_scene);
@@ -1761,3 +1859,148 @@ PackedScene::PackedScene() {
 
 	state = Ref<SceneState>(memnew(SceneState));
 }
+
+////////////////
+
+void SceneInteractiveInstancer::_start(const Ref<PackedScene> &p_scene, PackedScene::GenEditState p_edit_state) {
+
+	scene = p_scene;
+	state = p_scene->state;
+	edit_state = p_edit_state;
+	state->_instance_begin(instance_state, (SceneState::GenEditState)p_edit_state);
+}
+
+Node *SceneInteractiveInstancer::get_node() const {
+
+	return node;
+}
+
+Error SceneInteractiveInstancer::poll() {
+
+	if (error != OK)
+		return error;
+
+	int node_count = state->nodes.size();
+
+	if (stage < node_count) {
+
+		if (sub_instancer.is_null()) {
+			Ref<PackedScene> sdata = state->_get_node_scene(stage);
+			if (sdata.is_valid() && sdata->can_instance()) {
+				sub_instancer = sdata->instance_interactive(edit_state == PackedScene::GEN_EDIT_STATE_DISABLED ? PackedScene::GEN_EDIT_STATE_DISABLED : PackedScene::GEN_EDIT_STATE_INSTANCE);
+			}
+		}
+
+		Node *instanced = NULL;
+
+		if (sub_instancer.is_valid()) {
+
+			Error err = sub_instancer->poll();
+			if (err == OK)
+				return OK;
+
+			instanced = sub_instancer->get_node();
+			sub_instancer.unref();
+
+			if (err == ERR_FILE_EOF && !instanced) {
+				err = ERR_CANT_CREATE;
+			}
+
+			if (err != ERR_FILE_EOF) {
+				error = err;
+				state->_instance_abort(instance_state);
+				return error;
+			}
+		}
+
+		if (!state->_instance_node(instance_state, stage, instanced)) {
+
+			// the sub-scene may have been left out of the tree before the failure
+			if (instanced && !instanced->get_parent() && !instance_state.stray_instances.find(instanced)) {
+				memdelete(instanced);
+			}
+
+			error = ERR_CANT_CREATE;
+			state->_instance_abort(instance_state);
+			return error;
+		}
+
+		stage++;
+		return OK;
+	}
+
+	if (!state->_instance_end(instance_state)) {
+		error = ERR_CANT_CREATE;
+		state->_instance_abort(instance_state);
+		return error;
+	}
+
+	node = instance_state.ret_nodes[0];
+	instance_state.ret_nodes.clear();
+	instance_state.resources_local_to_scene.clear();
+
+	scene->_instance_finished(node, edit_state);
+
+	stage++;
+	error = ERR_FILE_EOF;
+	return error;
+}
+
+Error SceneInteractiveInstancer::poll_usec(int p_usec) {
+
+	uint64_t until = OS::get_singleton()->get_ticks_usec() + p_usec;
+
+	Error err = poll();
+	while (err == OK && OS::get_singleton()->get_ticks_usec() < until) {
+		err = poll();
+	}
+
+	return err;
+}
+
+Error SceneInteractiveInstancer::wait() {
+
+	Error err = poll();
+	while (err == OK) {
+		err = poll();
+	}
+
+	return err;
+}
+
+int SceneInteractiveInstancer::get_stage() const {
+
+	return stage;
+}
+
+int SceneInteractiveInstancer::get_stage_count() const {
+
+	return state->nodes.size() + 1;
+}
+
+void SceneInteractiveInstancer::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("get_node"), &SceneInteractiveInstancer::get_node);
+	ClassDB::bind_method(D_METHOD("poll"), &SceneInteractiveInstancer::poll);
+	ClassDB::bind_method(D_METHOD("poll_usec", "usec"), &SceneInteractiveInstancer::poll_usec);
+	ClassDB::bind_method(D_METHOD("wait"), &SceneInteractiveInstancer::wait);
+	ClassDB::bind_method(D_METHOD("get_stage"), &SceneInteractiveInstancer::get_stage);
+	ClassDB::bind_method(D_METHOD("get_stage_count"), &SceneInteractiveInstancer::get_stage_count);
+}
+
+SceneInteractiveInstancer::SceneInteractiveInstancer() {
+
+	edit_state = PackedScene::GEN_EDIT_STATE_DISABLED;
+	stage = 0;
+	error = OK;
+	node = NULL;
+}
+
+SceneInteractiveInstancer::~SceneInteractiveInstancer() {
+
+	// nodes of an unfinished instance are not reachable from anywhere else
+	sub_instancer.unref();
+	if (state.is_valid()) {
+		state->_instance_abort(instance_state);
+	}
+}
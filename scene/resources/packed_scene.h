@@ -34,6 +34,8 @@
 #include "core/resource.h"
 #include "scene/main/node.h"
 
+class SceneInteractiveInstancer;
+
 class SceneState : public Reference {
 
 	GDCLASS(SceneState, Reference);
@@ -124,6 +126,26 @@ public:
 		GEN_EDIT_STATE_MAIN,
 	};
 
+private:
+	friend class SceneInteractiveInstancer;
+
+	//nodes are created one at a time, so instancing can be spread over several calls
+	struct InstanceState {
+
+		GenEditState edit_state;
+		bool gen_node_path_cache;
+		Vector<Node *> ret_nodes;
+		List<Node *> stray_instances; // nodes where instancing failed (because something is missing)
+		Map<Ref<Resource>, Ref<Resource> > resources_local_to_scene;
+	};
+
+	void _instance_begin(InstanceState &r_state, GenEditState p_edit_state) const;
+	Ref<PackedScene> _get_node_scene(int p_idx) const;
+	bool _instance_node(InstanceState &r_state, int p_idx, Node *p_instanced) const;
+	bool _instance_end(InstanceState &r_state) const;
+	void _instance_abort(InstanceState &r_state) const;
+
+public:
 	static void set_disable_placeholders(bool p_disable);
 
 	int find_node_by_path(const NodePath &p_node) const;
@@ -204,6 +226,9 @@ class PackedScene : public Resource {
 	void _set_bundled_scene(const Dictionary &p_scene);
 	Dictionary _get_bundled_scene() const;
 
+	friend class SceneInteractiveInstancer;
+	void _instance_finished(Node *p_node, int p_edit_state) const;
+
 protected:
 	virtual bool editor_can_reload_from_file() { return false; } // this is handled by editor better
 	static void _bind_methods();
@@ -221,6 +246,7 @@ public:
 
 	bool can_instance() const;
 	Node *instance(GenEditState p_edit_state = GEN_EDIT_STATE_DISABLED) const;
+	Ref<SceneInteractiveInstancer> instance_interactive(GenEditState p_edit_state = GEN_EDIT_STATE_DISABLED);
 
 	void recreate_state();
 	void replace_state(Ref<SceneState> p_by);
@@ -237,4 +263,38 @@ public:
 
 VARIANT_ENUM_CAST(PackedScene::GenEditState)
 
+class SceneInteractiveInstancer : public Reference {
+
+	GDCLASS(SceneInteractiveInstancer, Reference);
+	friend class PackedScene;
+
+	Ref<PackedScene> scene;
+	Ref<SceneState> state;
+	PackedScene::GenEditState edit_state;
+	SceneState::InstanceState instance_state;
+
+	//sub-scenes are instanced interactively too, so big instances don't stall a single poll
+	Ref<SceneInteractiveInstancer> sub_instancer;
+
+	int stage;
+	Error error;
+	Node *node;
+
+	void _start(const Ref<PackedScene> &p_scene, PackedScene::GenEditState p_edit_state);
+
+protected:
+	static void _bind_methods();
+
+public:
+	Node *get_node() const;
+	Error poll();
+	Error poll_usec(int p_usec);
+	Error wait();
+	int get_stage() const;
+	int get_stage_count() const;
+
+	SceneInteractiveInstancer();
+	~SceneInteractiveInstancer();
+};
+
 #endif // SCENE_PRELOADER_H
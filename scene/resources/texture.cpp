@@ -31,9 +31,11 @@
 #include "texture.h"
 
 #include "core/core_string_names.h"
+#include "core/engine.h"
 #include "core/io/image_loader.h"
 #include "core/method_bind_ext.gen.inc"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 #include "scene/resources/bit_map.h"
 
 Size2 Texture::get_size() const {
@@ -474,6 +476,15 @@ StreamTexture::TextureFormatRequestCallback StreamTexture::request_3d_callback =
 StreamTexture::TextureFormatRequestCallback StreamTexture::request_srgb_callback = NULL;
 StreamTexture::TextureFormatRequestCallback StreamTexture::request_normal_callback = NULL;
 
+Mutex *StreamTexture::stream_mutex = NULL;
+SelfList<StreamTexture>::List *StreamTexture::stream_textures = NULL;
+StreamTexture::StreamRequest *StreamTexture::stream_retired_requests = NULL;
+bool StreamTexture::streaming_enabled = false;
+uint64_t StreamTexture::stream_memory_budget = 0;
+int StreamTexture::stream_initial_size = 0;
+int StreamTexture::stream_evict_frames = 0;
+int StreamTexture::stream_max_uploads = 0;
+
 uint32_t StreamTexture::get_flags() const {
 
 	return flags;
@@ -483,20 +494,16 @@ Image::Format StreamTexture::get_format() const {
 	return format;
 }
 
-Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, Ref<Image> &image, int p_size_limit) {
-
-	alpha_cache.unref();
-
-	ERR_FAIL_COND_V(image.is_null(), ERR_INVALID_PARAMETER);
+FileAccess *StreamTexture::_open_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, uint32_t &df) {
 
 	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
-	ERR_FAIL_COND_V(!f, ERR_CANT_OPEN);
+	ERR_FAIL_COND_V(!f, NULL);
 
 	uint8_t header[4];
 	f->get_buffer(header, 4);
 	if (header[0] != 'G' || header[1] != 'D' || header[2] != 'S' || header[3] != 'T') {
 		memdelete(f);
-		ERR_FAIL_COND_V(header[0] != 'G' || header[1] != 'D' || header[2] != 'S' || header[3] != 'T', ERR_FILE_CORRUPT);
+		ERR_FAIL_COND_V(header[0] != 'G' || header[1] != 'D' || header[2] != 'S' || header[3] != 'T', NULL);
 	}
 
 	tw = f->get_16();
@@ -505,7 +512,20 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_
 	th_custom = f->get_16();
 
 	flags = f->get_32(); //texture flags!
-	uint32_t df = f->get_32(); //data format
+	df = f->get_32(); //data format
+
+	return f;
+}
+
+Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, Ref<Image> &image, int p_size_limit) {
+
+	alpha_cache.unref();
+
+	ERR_FAIL_COND_V(image.is_null(), ERR_INVALID_PARAMETER);
+
+	uint32_t df;
+	FileAccess *f = _open_data(p_path, tw, th, tw_custom, th_custom, flags, df);
+	ERR_FAIL_COND_V(!f, ERR_CANT_OPEN);
 
 	/*
 	print_line("width: " + itos(tw));
@@ -539,6 +559,12 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_
 		VS::get_singleton()->texture_set_detect_normal_callback(texture, NULL, NULL);
 	}
 #endif
+
+	return _load_image(f, df, tw, th, image, p_size_limit);
+}
+
+Error StreamTexture::_load_image(FileAccess *f, uint32_t df, int tw, int th, Ref<Image> &image, int p_size_limit) {
+
 	if (!(df & FORMAT_BIT_STREAM)) {
 		p_size_limit = 0;
 	}
@@ -557,7 +583,6 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_
 		while (mipmaps > 1 && p_size_limit > 0 && (sw > p_size_limit || sh > p_size_limit)) {
 
 			f->seek(f->get_position() + size);
-			mipmaps = f->get_32();
 			size = f->get_32();
 
 			sw = MAX(sw >> 1, 1);
@@ -670,7 +695,7 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_
 			}
 
 			if (idx > 0) {
-				ofs = Image::get_image_data_size(tw, th, format, idx - 1);
+				ofs = Image::get_image_mipmap_offset(tw, th, format, idx);
 			}
 
 			if (total_size - ofs <= 0) {
@@ -710,10 +735,20 @@ Error StreamTexture::_load_data(const String &p_path, int &tw, int &th, int &tw_
 
 Error StreamTexture::load(const String &p_path) {
 
+	//a mipmap may still be loading from the previous file
+	if (stream_mutex)
+		stream_mutex->lock();
+
+	_stream_finish_task();
+	stream_image.unref();
+
+	if (stream_mutex)
+		stream_mutex->unlock();
+
 	int lw, lh, lwc, lhc, lflags;
 	Ref<Image> image;
 	image.instance();
-	Error err = _load_data(p_path, lw, lh, lwc, lhc, lflags, image);
+	Error err = _load_data(p_path, lw, lh, lwc, lhc, lflags, image, streaming_enabled ? stream_initial_size : 0);
 	if (err)
 		return err;
 
@@ -723,9 +758,17 @@ Error StreamTexture::load(const String &p_path) {
 	}
 	VS::get_singleton()->texture_allocate(texture, image->get_width(), image->get_height(), 0, image->get_format(), VS::TEXTURE_TYPE_2D, lflags);
 	VS::get_singleton()->texture_set_data(texture, image);
+
+	//streamable textures only load up to the initial size, find out which mipmap that was
+	int level = 0;
+	while (MAX(lw >> level, 1) > image->get_width() || MAX(lh >> level, 1) > image->get_height()) {
+		level++;
+	}
+
 	if (lwc || lhc) {
 		VS::get_singleton()->texture_set_size_override(texture, lwc, lhc, 0);
-	} else {
+	} else if (level > 0) {
+		VS::get_singleton()->texture_set_size_override(texture, lw, lh, 0);
 	}
 
 	w = lwc ? lwc : lw;
@@ -734,9 +777,299 @@ Error StreamTexture::load(const String &p_path) {
 	path_to_file = p_path;
 	format = image->get_format();
 
+	stream_width = lw;
+	stream_height = lh;
+	_stream_setup(level, image->get_data().size());
+
 	_change_notify();
 	return OK;
 }
+
+int StreamTexture::_get_stream_level_memory(int p_level) const {
+
+	return Image::get_image_data_size(MAX(stream_width >> p_level, 1), MAX(stream_height >> p_level, 1), format, true);
+}
+
+int StreamTexture::_get_stream_level_for_size(int p_size) const {
+
+	int level = stream_base_level;
+	while (level > 0 && MAX(stream_width >> level, stream_height >> level) < p_size) {
+		level--;
+	}
+	return level;
+}
+
+void StreamTexture::_stream_setup(int p_level, int p_memory) {
+
+	if (stream_mutex)
+		stream_mutex->lock();
+
+	stream_level = p_level;
+	stream_base_level = p_level;
+	stream_memory = p_memory;
+
+	if (stream_textures && p_level > 0) {
+		if (!stream_request) {
+			stream_request = memnew(StreamRequest);
+		}
+		stream_request->size = 0;
+		stream_request->frame = Engine::get_singleton()->get_frames_drawn();
+
+		if (!stream_list.in_list()) {
+			stream_textures->add(&stream_list);
+		}
+		VS::get_singleton()->texture_set_stream_callback(texture, _stream_requested, stream_request);
+	} else {
+		if (stream_list.in_list()) {
+			stream_textures->remove(&stream_list);
+		}
+		VS::get_singleton()->texture_set_stream_callback(texture, NULL, NULL);
+	}
+
+	if (stream_mutex)
+		stream_mutex->unlock();
+}
+
+void StreamTexture::_stream_finish_task() {
+
+	if (stream_task == WorkerThreadPool::INVALID_GROUP_ID)
+		return;
+
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(stream_task);
+	stream_task = WorkerThreadPool::INVALID_GROUP_ID;
+}
+
+void StreamTexture::_stream_upload() {
+
+	Ref<Image> image = stream_image;
+	stream_image.unref();
+
+	ERR_FAIL_COND(image.is_null());
+
+	VS::get_singleton()->texture_allocate(texture, image->get_width(), image->get_height(), 0, image->get_format(), VS::TEXTURE_TYPE_2D, flags);
+	VS::get_singleton()->texture_set_data(texture, image);
+	VS::get_singleton()->texture_set_size_override(texture, w, h, 0);
+
+	stream_level = stream_load_level;
+	stream_memory = image->get_data().size();
+}
+
+void StreamTexture::_stream_requested(void *p_ud, int p_size) {
+
+	//called from the rendering thread, keep the biggest size it was drawn at during the frame
+	StreamRequest *request = (StreamRequest *)p_ud;
+	uint64_t frame = Engine::get_singleton()->get_frames_drawn();
+
+	if (request->frame != frame) {
+		request->frame = frame;
+		request->size = p_size;
+	} else if (p_size > request->size) {
+		request->size = p_size;
+	}
+}
+
+void StreamTexture::_stream_load_task(void *p_ud, uint32_t p_index) {
+
+	StreamTexture *st = (StreamTexture *)p_ud;
+
+	int tw, th, tw_custom, th_custom, tflags;
+	uint32_t df;
+	FileAccess *f = _open_data(st->path_to_file, tw, th, tw_custom, th_custom, tflags, df);
+	if (!f)
+		return;
+
+	Ref<Image> image;
+	image.instance();
+	int size_limit = MAX(MAX(tw >> st->stream_load_level, th >> st->stream_load_level), 1);
+	if (_load_image(f, df, tw, th, image, size_limit) == OK) {
+		st->stream_image = image;
+	}
+}
+
+struct _StreamTextureLevel {
+
+	StreamTexture *texture;
+	int level;
+	uint64_t unused_frames;
+	int memory;
+
+	bool operator<(const _StreamTextureLevel &p_other) const {
+		//least recently drawn first, then biggest first
+		if (unused_frames != p_other.unused_frames)
+			return unused_frames > p_other.unused_frames;
+		return memory > p_other.memory;
+	}
+};
+
+void StreamTexture::update_streaming() {
+
+	if (!streaming_enabled || !stream_textures)
+		return;
+
+	if (stream_mutex)
+		stream_mutex->lock();
+
+	uint64_t frame = Engine::get_singleton()->get_frames_drawn();
+	int pending = 0;
+	int uploads = 0;
+
+	_free_retired_requests(frame);
+
+	//upload the mipmaps that finished loading
+
+	SelfList<StreamTexture> *E = stream_textures->first();
+	while (E) {
+
+		StreamTexture *st = E->self();
+		E = E->next();
+
+		if (st->stream_task == WorkerThreadPool::INVALID_GROUP_ID)
+			continue;
+
+		if (uploads >= stream_max_uploads || !WorkerThreadPool::get_singleton()->is_group_task_completed(st->stream_task)) {
+			pending++;
+			continue;
+		}
+
+		st->_stream_finish_task();
+		if (st->stream_image.is_null()) {
+			//file went away or got corrupted, keep what is loaded and stop streaming it
+			ERR_PRINTS("Failed streaming mipmaps of texture: " + st->path_to_file);
+			stream_textures->remove(&st->stream_list);
+			VS::get_singleton()->texture_set_stream_callback(st->texture, NULL, NULL);
+			continue;
+		}
+
+		st->_stream_upload();
+		uploads++;
+	}
+
+	//find out which mipmap each texture should have, never dropping detail while still in use
+
+	Vector<_StreamTextureLevel> levels;
+	uint64_t total_memory = 0;
+
+	for (E = stream_textures->first(); E; E = E->next()) {
+
+		StreamTexture *st = E->self();
+
+		_StreamTextureLevel l;
+		l.texture = st;
+		l.unused_frames = frame > st->stream_request->frame ? frame - st->stream_request->frame : 0;
+
+		int current = st->stream_task != WorkerThreadPool::INVALID_GROUP_ID ? st->stream_load_level : st->stream_level;
+		if (l.unused_frames > (uint64_t)stream_evict_frames) {
+			l.level = st->stream_base_level;
+		} else {
+			l.level = MIN(st->_get_stream_level_for_size(st->stream_request->size), current);
+		}
+		l.memory = st->_get_stream_level_memory(l.level);
+		total_memory += l.memory;
+
+		levels.push_back(l);
+	}
+
+	//over budget, evict a mipmap at a time from the least recently drawn and biggest textures
+
+	if (total_memory > stream_memory_budget) {
+
+		levels.sort();
+
+		bool evicted = true;
+		while (evicted && total_memory > stream_memory_budget) {
+
+			evicted = false;
+			for (int i = 0; i < levels.size() && total_memory > stream_memory_budget; i++) {
+
+				_StreamTextureLevel &l = levels.write[i];
+				if (l.level >= l.texture->stream_base_level)
+					continue;
+
+				total_memory -= l.memory;
+				l.level++;
+				l.memory = l.texture->_get_stream_level_memory(l.level);
+				total_memory += l.memory;
+				evicted = true;
+			}
+		}
+	}
+
+	//load the mipmaps that changed in the background, they are uploaded once ready
+
+	for (int i = 0; i < levels.size() && pending < stream_max_uploads; i++) {
+
+		StreamTexture *st = levels[i].texture;
+		if (st->stream_task != WorkerThreadPool::INVALID_GROUP_ID || levels[i].level == st->stream_level)
+			continue;
+
+		st->stream_load_level = levels[i].level;
+		st->stream_task = WorkerThreadPool::get_singleton()->add_task(_stream_load_task, st);
+		pending++;
+	}
+
+	if (stream_mutex)
+		stream_mutex->unlock();
+}
+
+void StreamTexture::initialize_streaming() {
+
+	streaming_enabled = GLOBAL_DEF("rendering/texture_streaming/enabled", true);
+	stream_memory_budget = uint64_t(GLOBAL_DEF("rendering/texture_streaming/memory_budget_mb", 256)) * 1024 * 1024;
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/memory_budget_mb", PropertyInfo(Variant::INT, "rendering/texture_streaming/memory_budget_mb", PROPERTY_HINT_RANGE, "1,8192,1,or_greater"));
+	stream_initial_size = GLOBAL_DEF("rendering/texture_streaming/initial_size", 128);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/initial_size", PropertyInfo(Variant::INT, "rendering/texture_streaming/initial_size", PROPERTY_HINT_RANGE, "1,4096,1"));
+	stream_evict_frames = GLOBAL_DEF("rendering/texture_streaming/evict_unused_after_frames", 300);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/evict_unused_after_frames", PropertyInfo(Variant::INT, "rendering/texture_streaming/evict_unused_after_frames", PROPERTY_HINT_RANGE, "1,3600,1,or_greater"));
+	stream_max_uploads = GLOBAL_DEF("rendering/texture_streaming/max_uploads_per_frame", 4);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/texture_streaming/max_uploads_per_frame", PropertyInfo(Variant::INT, "rendering/texture_streaming/max_uploads_per_frame", PROPERTY_HINT_RANGE, "1,64,1"));
+
+	//the editor needs the full textures, for import previews and such
+	if (Engine::get_singleton()->is_editor_hint()) {
+		streaming_enabled = false;
+	}
+
+	stream_initial_size = MAX(stream_initial_size, 1);
+	stream_max_uploads = MAX(stream_max_uploads, 1);
+
+	stream_textures = memnew(SelfList<StreamTexture>::List());
+	stream_mutex = Mutex::create();
+}
+
+void StreamTexture::_free_retired_requests(uint64_t p_frame) {
+
+	//the main loop syncs with the rendering thread before drawing each frame, so once
+	//frames_drawn moved twice since retiring, the draw that could report to it is done
+	StreamRequest **prev = &stream_retired_requests;
+	while (*prev) {
+		StreamRequest *request = *prev;
+		if (p_frame >= request->retired_frame + 2) {
+			*prev = request->next_retired;
+			memdelete(request);
+		} else {
+			prev = &request->next_retired;
+		}
+	}
+}
+
+void StreamTexture::finish_streaming() {
+
+	while (stream_textures->first()) {
+		StreamTexture *st = stream_textures->first()->self();
+		st->_stream_finish_task();
+		st->stream_image.unref();
+		stream_textures->remove(&st->stream_list);
+	}
+	while (stream_retired_requests) {
+		StreamRequest *request = stream_retired_requests;
+		stream_retired_requests = request->next_retired;
+		memdelete(request);
+	}
+
+	memdelete(stream_mutex);
+	stream_mutex = NULL;
+	memdelete(stream_textures);
+	stream_textures = NULL;
+}
 String StreamTexture::get_load_path() const {
 
 	return path_to_file;
@@ -856,18 +1189,51 @@ void StreamTexture::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::STRING, "load_path", PROPERTY_HINT_FILE, "*.stex"), "load", "get_load_path");
 }
 
-StreamTexture::StreamTexture() {
+StreamTexture::StreamTexture() :
+		stream_list(this) {
 
 	format = Image::FORMAT_MAX;
 	flags = 0;
 	w = 0;
 	h = 0;
 
+	stream_width = 0;
+	stream_height = 0;
+	stream_level = 0;
+	stream_base_level = 0;
+	stream_memory = 0;
+	stream_load_level = 0;
+	stream_task = WorkerThreadPool::INVALID_GROUP_ID;
+	stream_request = NULL;
+
 	texture = VS::get_singleton()->texture_create();
 }
 
 StreamTexture::~StreamTexture() {
 
+	if (stream_mutex)
+		stream_mutex->lock();
+
+	_stream_finish_task();
+	if (stream_list.in_list()) {
+		stream_textures->remove(&stream_list);
+	}
+
+	if (stream_request) {
+		VS::get_singleton()->texture_set_stream_callback(texture, NULL, NULL);
+		if (stream_mutex) {
+			//a frame being drawn may still report to it, free it later without waiting
+			stream_request->retired_frame = Engine::get_singleton()->get_frames_drawn();
+			stream_request->next_retired = stream_retired_requests;
+			stream_retired_requests = stream_request;
+		} else {
+			memdelete(stream_request);
+		}
+	}
+
+	if (stream_mutex)
+		stream_mutex->unlock();
+
 	VS::get_singleton()->free(texture);
 }
 
@@ -33,9 +33,11 @@
 
 #include "core/io/resource_loader.h"
 #include "core/math/rect2.h"
+#include "core/os/file_access.h"
 #include "core/os/mutex.h"
 #include "core/os/rw_lock.h"
 #include "core/os/thread_safe.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/resource.h"
 #include "scene/resources/curve.h"
 #include "scene/resources/gradient.h"
@@ -187,6 +189,8 @@ public:
 	};
 
 private:
+	static FileAccess *_open_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, uint32_t &df);
+	static Error _load_image(FileAccess *f, uint32_t df, int tw, int th, Ref<Image> &image, int p_size_limit);
 	Error _load_data(const String &p_path, int &tw, int &th, int &tw_custom, int &th_custom, int &flags, Ref<Image> &image, int p_size_limit = 0);
 	String path_to_file;
 	RID texture;
@@ -201,6 +205,46 @@ private:
 	static void _requested_srgb(void *p_ud);
 	static void _requested_normal(void *p_ud);
 
+	//mipmap streaming, textures imported as streamable start with their small mipmaps
+	//and load bigger ones as they are drawn bigger on screen, within a memory budget
+	SelfList<StreamTexture> stream_list;
+	int stream_width, stream_height; // size of the full image in the file
+	int stream_level; // biggest mipmap loaded, zero when fully loaded
+	int stream_base_level; // mipmap loaded initially, and when evicted
+	int stream_memory;
+	int stream_load_level;
+	Ref<Image> stream_image;
+	WorkerThreadPool::GroupID stream_task;
+
+	//written from the render thread, which may still do so for a frame or two after
+	//the texture is gone, so it's kept apart and freed once those frames are drawn
+	struct StreamRequest {
+		volatile int size; // size in pixels the texture was drawn at, during frame
+		volatile uint64_t frame;
+		uint64_t retired_frame;
+		StreamRequest *next_retired;
+	};
+	StreamRequest *stream_request;
+
+	int _get_stream_level_memory(int p_level) const;
+	int _get_stream_level_for_size(int p_size) const;
+	void _stream_setup(int p_level, int p_memory);
+	void _stream_finish_task();
+	void _stream_upload();
+
+	static void _stream_requested(void *p_ud, int p_size);
+	static void _stream_load_task(void *p_ud, uint32_t p_index);
+	static void _free_retired_requests(uint64_t p_frame);
+
+	static Mutex *stream_mutex;
+	static SelfList<StreamTexture>::List *stream_textures;
+	static StreamRequest *stream_retired_requests;
+	static bool streaming_enabled;
+	static uint64_t stream_memory_budget;
+	static int stream_initial_size;
+	static int stream_evict_frames;
+	static int stream_max_uploads;
+
 protected:
 	static void _bind_methods();
 	void _validate_property(PropertyInfo &property) const;
@@ -233,6 +277,10 @@ public:
 
 	virtual Ref<Image> get_data() const;
 
+	static void initialize_streaming();
+	static void finish_streaming();
+	static void update_streaming();
+
 	StreamTexture();
 	~StreamTexture();
 };
@@ -30,6 +30,7 @@
 
 #include "area_pair_sw.h"
 #include "collision_solver_sw.h"
+#include "space_sw.h"
 
 bool AreaPairSW::setup(real_t p_step) {
 
@@ -43,6 +44,9 @@ bool AreaPairSW::setup(real_t p_step) {
 
 	if (result != colliding) {
 
+		// Areas are shared between islands, which may be set up in parallel.
+		MutexLock lock(area->get_space()->get_island_mutex());
+
 		if (result) {
 
 			if (area->get_space_override_mode() != PhysicsServer::AREA_SPACE_OVERRIDE_DISABLED)
@@ -106,6 +110,8 @@ bool Area2PairSW::setup(real_t p_step) {
 
 	if (result != colliding) {
 
+		MutexLock lock(area_a->get_space()->get_island_mutex());
+
 		if (result) {
 
 			if (area_b->has_area_monitor_callback() && area_a->is_monitorable())
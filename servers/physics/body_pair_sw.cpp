@@ -311,13 +311,16 @@ bool BodyPairSW::setup(real_t p_step) {
 
 		// contact query reporting...
 
+		// Static and kinematic bodies don't belong to a single island, other islands may be reporting to them at the same time.
 		if (A->can_report_contacts()) {
 			Vector3 crA = A->get_angular_velocity().cross(c.rA) + A->get_linear_velocity();
+			MutexLock lock(A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC ? space->get_island_mutex() : NULL);
 			A->add_contact(global_A, -c.normal, depth, shape_A, global_B, shape_B, B->get_instance_id(), B->get_self(), crA);
 		}
 
 		if (B->can_report_contacts()) {
 			Vector3 crB = B->get_angular_velocity().cross(c.rB) + B->get_linear_velocity();
+			MutexLock lock(B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC ? space->get_island_mutex() : NULL);
 			B->add_contact(global_B, c.normal, depth, shape_B, global_A, shape_A, A->get_instance_id(), A->get_self(), crB);
 		}
 
@@ -560,22 +560,26 @@ void BodySW::integrate_forces(real_t p_step) {
 	biased_angular_velocity = Vector3();
 	biased_linear_velocity = Vector3();
 
-	if (do_motion) { //shapes temporarily extend for raycast
-		_update_shapes_with_motion(motion);
-	}
+	integrate_motion = motion;
+	integrate_motion_pending = do_motion;
 
 	def_area = NULL; // clear the area, so it is set in the next frame
 	contact_count = 0;
 }
 
+void BodySW::post_integrate_forces() {
+
+	if (integrate_motion_pending) { //shapes temporarily extend for raycast
+		_update_shapes_with_motion(integrate_motion);
+		integrate_motion_pending = false;
+	}
+}
+
 void BodySW::integrate_velocities(real_t p_step) {
 
 	if (mode == PhysicsServer::BODY_MODE_STATIC)
 		return;
 
-	if (fi_callback)
-		get_space()->body_add_to_state_query_list(&direct_state_query_list);
-
 	//apply axis lock linear
 	for (int i = 0; i < 3; i++) {
 		if (is_axis_locked((PhysicsServer::BodyAxis)(1 << i))) {
@@ -597,7 +601,7 @@ void BodySW::integrate_velocities(real_t p_step) {
 		_set_transform(new_transform, false);
 		_set_inv_transform(new_transform.affine_inverse());
 		if (contacts.size() == 0 && linear_velocity == Vector3() && angular_velocity == Vector3())
-			set_active(false); //stopped moving, deactivate
+			integrate_deactivate_pending = true; //stopped moving, deactivate
 
 		return;
 	}
@@ -625,8 +629,9 @@ void BodySW::integrate_velocities(real_t p_step) {
 
 	transform.origin += total_linear_velocity * p_step;
 
-	_set_transform(transform);
+	_set_transform(transform, false);
 	_set_inv_transform(get_transform().inverse());
+	integrate_shapes_pending = true;
 
 	_update_transform_dependant();
 
@@ -636,6 +641,25 @@ void BodySW::integrate_velocities(real_t p_step) {
 	*/
 }
 
+void BodySW::post_integrate_velocities() {
+
+	if (mode == PhysicsServer::BODY_MODE_STATIC)
+		return;
+
+	if (fi_callback)
+		get_space()->body_add_to_state_query_list(&direct_state_query_list);
+
+	if (integrate_shapes_pending) {
+		_update_shapes();
+		integrate_shapes_pending = false;
+	}
+
+	if (integrate_deactivate_pending) {
+		set_active(false);
+		integrate_deactivate_pending = false;
+	}
+}
+
 /*
 void BodySW::simulate_motion(const Transform& p_xform,real_t p_step) {
 
@@ -791,6 +815,9 @@ BodySW::BodySW() :
 
 	still_time = 0;
 	continuous_cd = false;
+	integrate_motion_pending = false;
+	integrate_shapes_pending = false;
+	integrate_deactivate_pending = false;
 	can_sleep = false;
 	fi_callback = NULL;
 }
@@ -92,6 +92,13 @@ class BodySW : public CollisionObjectSW {
 	bool continuous_cd;
 	bool can_sleep;
 	bool first_time_kinematic;
+
+	// Changes computed by the integration, applied to the space in post_integrate_*().
+	Vector3 integrate_motion;
+	bool integrate_motion_pending;
+	bool integrate_shapes_pending;
+	bool integrate_deactivate_pending;
+
 	void _update_inertia();
 	virtual void _shapes_changed();
 	Transform new_transform;
@@ -305,8 +312,11 @@ public:
 	void set_axis_lock(PhysicsServer::BodyAxis p_axis, bool lock);
 	bool is_axis_locked(PhysicsServer::BodyAxis p_axis) const;
 
+	// Safe to call for several bodies in parallel, as long as post_integrate_*() is called for each of them afterwards from a single thread.
 	void integrate_forces(real_t p_step);
 	void integrate_velocities(real_t p_step);
+	void post_integrate_forces();
+	void post_integrate_velocities();
 
 	_FORCE_INLINE_ Vector3 get_velocity_in_local_point(const Vector3 &rel_pos) const {
 
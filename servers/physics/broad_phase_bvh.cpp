@@ -0,0 +1,584 @@
+/*************************************************************************/
+/*  broad_phase_bvh.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "broad_phase_bvh.h"
+#include "collision_object_sw.h"
+
+int BroadPhaseBVH::_alloc_node() {
+
+	int idx;
+	if (free_nodes.size()) {
+		idx = free_nodes[free_nodes.size() - 1];
+		free_nodes.resize(free_nodes.size() - 1);
+	} else {
+		idx = nodes.size();
+		nodes.resize(idx + 1);
+	}
+
+	Node &n = nodes.write[idx];
+	n.parent = NODE_NULL;
+	n.children[0] = NODE_NULL;
+	n.children[1] = NODE_NULL;
+	n.height = 0;
+	n.element = 0;
+	return idx;
+}
+
+void BroadPhaseBVH::_free_node(int p_node) {
+
+	free_nodes.push_back(p_node);
+}
+
+void BroadPhaseBVH::_insert_leaf(int p_leaf) {
+
+	if (root == NODE_NULL) {
+		root = p_leaf;
+		nodes.write[root].parent = NODE_NULL;
+		return;
+	}
+
+	Node *n = nodes.ptrw();
+	const AABB leaf_aabb = n[p_leaf].aabb;
+
+	// descend to the sibling that grows the tree surface the least
+	int index = root;
+	while (!n[index].is_leaf()) {
+
+		real_t surface = _get_surface(n[index].aabb);
+		real_t combined_surface = _get_surface(n[index].aabb.merge(leaf_aabb));
+
+		real_t cost = 2.0 * combined_surface;
+		real_t inheritance_cost = 2.0 * (combined_surface - surface);
+
+		real_t child_cost[2];
+		for (int i = 0; i < 2; i++) {
+			const Node &child = n[n[index].children[i]];
+			real_t merged = _get_surface(child.aabb.merge(leaf_aabb));
+			child_cost[i] = (child.is_leaf() ? merged : merged - _get_surface(child.aabb)) + inheritance_cost;
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1])
+			break;
+
+		index = child_cost[0] < child_cost[1] ? n[index].children[0] : n[index].children[1];
+	}
+
+	int sibling = index;
+	int new_parent = _alloc_node();
+	n = nodes.ptrw();
+
+	int old_parent = n[sibling].parent;
+	n[new_parent].parent = old_parent;
+	n[new_parent].aabb = leaf_aabb.merge(n[sibling].aabb);
+	n[new_parent].height = n[sibling].height + 1;
+	n[new_parent].children[0] = sibling;
+	n[new_parent].children[1] = p_leaf;
+	n[sibling].parent = new_parent;
+	n[p_leaf].parent = new_parent;
+
+	if (old_parent != NODE_NULL) {
+		if (n[old_parent].children[0] == sibling) {
+			n[old_parent].children[0] = new_parent;
+		} else {
+			n[old_parent].children[1] = new_parent;
+		}
+	} else {
+		root = new_parent;
+	}
+
+	_refit(new_parent);
+}
+
+void BroadPhaseBVH::_remove_leaf(int p_leaf) {
+
+	if (p_leaf == root) {
+		root = NODE_NULL;
+		return;
+	}
+
+	Node *n = nodes.ptrw();
+
+	int parent = n[p_leaf].parent;
+	int grand_parent = n[parent].parent;
+	int sibling = n[parent].children[0] == p_leaf ? n[parent].children[1] : n[parent].children[0];
+
+	if (grand_parent != NODE_NULL) {
+		if (n[grand_parent].children[0] == parent) {
+			n[grand_parent].children[0] = sibling;
+		} else {
+			n[grand_parent].children[1] = sibling;
+		}
+		n[sibling].parent = grand_parent;
+		_free_node(parent);
+		_refit(grand_parent);
+	} else {
+		root = sibling;
+		n[sibling].parent = NODE_NULL;
+		_free_node(parent);
+	}
+
+	n[p_leaf].parent = NODE_NULL;
+}
+
+int BroadPhaseBVH::_balance(int p_node) {
+
+	Node *n = nodes.ptrw();
+	Node *a = &n[p_node];
+
+	if (a->is_leaf() || a->height < 2)
+		return p_node;
+
+	int ib = a->children[0];
+	int ic = a->children[1];
+	Node *b = &n[ib];
+	Node *c = &n[ic];
+
+	int balance = c->height - b->height;
+
+	if (balance > 1) {
+		// rotate c up
+		int if_ = c->children[0];
+		int ig = c->children[1];
+		Node *f = &n[if_];
+		Node *g = &n[ig];
+
+		c->children[0] = p_node;
+		c->parent = a->parent;
+		a->parent = ic;
+
+		if (c->parent != NODE_NULL) {
+			if (n[c->parent].children[0] == p_node) {
+				n[c->parent].children[0] = ic;
+			} else {
+				n[c->parent].children[1] = ic;
+			}
+		} else {
+			root = ic;
+		}
+
+		if (f->height > g->height) {
+			c->children[1] = if_;
+			a->children[1] = ig;
+			g->parent = p_node;
+			a->aabb = b->aabb.merge(g->aabb);
+			c->aabb = a->aabb.merge(f->aabb);
+			a->height = 1 + MAX(b->height, g->height);
+			c->height = 1 + MAX(a->height, f->height);
+		} else {
+			c->children[1] = ig;
+			a->children[1] = if_;
+			f->parent = p_node;
+			a->aabb = b->aabb.merge(f->aabb);
+			c->aabb = a->aabb.merge(g->aabb);
+			a->height = 1 + MAX(b->height, f->height);
+			c->height = 1 + MAX(a->height, g->height);
+		}
+
+		return ic;
+	}
+
+	if (balance < -1) {
+		// rotate b up
+		int id = b->children[0];
+		int ie = b->children[1];
+		Node *d = &n[id];
+		Node *e = &n[ie];
+
+		b->children[0] = p_node;
+		b->parent = a->parent;
+		a->parent = ib;
+
+		if (b->parent != NODE_NULL) {
+			if (n[b->parent].children[0] == p_node) {
+				n[b->parent].children[0] = ib;
+			} else {
+				n[b->parent].children[1] = ib;
+			}
+		} else {
+			root = ib;
+		}
+
+		if (d->height > e->height) {
+			b->children[1] = id;
+			a->children[0] = ie;
+			e->parent = p_node;
+			a->aabb = c->aabb.merge(e->aabb);
+			b->aabb = a->aabb.merge(d->aabb);
+			a->height = 1 + MAX(c->height, e->height);
+			b->height = 1 + MAX(a->height, d->height);
+		} else {
+			b->children[1] = ie;
+			a->children[0] = id;
+			d->parent = p_node;
+			a->aabb = c->aabb.merge(d->aabb);
+			b->aabb = a->aabb.merge(e->aabb);
+			a->height = 1 + MAX(c->height, d->height);
+			b->height = 1 + MAX(a->height, e->height);
+		}
+
+		return ib;
+	}
+
+	return p_node;
+}
+
+void BroadPhaseBVH::_refit(int p_node) {
+
+	int index = p_node;
+	while (index != NODE_NULL) {
+
+		index = _balance(index);
+
+		Node *n = nodes.ptrw();
+		const Node &c0 = n[n[index].children[0]];
+		const Node &c1 = n[n[index].children[1]];
+
+		n[index].height = 1 + MAX(c0.height, c1.height);
+		n[index].aabb = c0.aabb.merge(c1.aabb);
+
+		index = n[index].parent;
+	}
+}
+
+void BroadPhaseBVH::_mark_moved(ID p_id) {
+
+	Element &e = elements.write[p_id - 1];
+	if (!e.moved) {
+		e.moved = true;
+		moved_elements.push_back(p_id);
+	}
+}
+
+void BroadPhaseBVH::_pair(ID p_a, ID p_b) {
+
+	Element *e = elements.ptrw();
+	Element &a = e[p_a - 1];
+	Element &b = e[p_b - 1];
+
+	void *data = NULL;
+	if (pair_callback)
+		data = pair_callback(a.owner, a.subindex, b.owner, b.subindex, pair_userdata);
+
+	pair_map.set(_get_pair_key(p_a, p_b), data);
+	a.pairs.push_back(p_b);
+	b.pairs.push_back(p_a);
+}
+
+void BroadPhaseBVH::_unpair(ID p_a, ID p_b) {
+
+	Element *e = elements.ptrw();
+	Element &a = e[p_a - 1];
+	Element &b = e[p_b - 1];
+
+	uint64_t key = _get_pair_key(p_a, p_b);
+	void **data = pair_map.getptr(key);
+	ERR_FAIL_COND(!data);
+
+	if (unpair_callback)
+		unpair_callback(a.owner, a.subindex, b.owner, b.subindex, *data, unpair_userdata);
+
+	pair_map.erase(key);
+
+	// order of pairs doesn't matter, so swap with the last one
+	int idx = a.pairs.find(p_b);
+	a.pairs.write[idx] = a.pairs[a.pairs.size() - 1];
+	a.pairs.resize(a.pairs.size() - 1);
+
+	idx = b.pairs.find(p_a);
+	b.pairs.write[idx] = b.pairs[b.pairs.size() - 1];
+	b.pairs.resize(b.pairs.size() - 1);
+}
+
+BroadPhaseSW::ID BroadPhaseBVH::create(CollisionObjectSW *p_object, int p_subindex) {
+
+	ERR_FAIL_COND_V(p_object == NULL, 0);
+
+	ID id;
+	if (free_elements.size()) {
+		id = free_elements[free_elements.size() - 1];
+		free_elements.resize(free_elements.size() - 1);
+	} else {
+		elements.resize(elements.size() + 1);
+		id = elements.size();
+	}
+
+	Element &e = elements.write[id - 1];
+	e.owner = p_object;
+	e.subindex = p_subindex;
+	e._static = false;
+	e.moved = false;
+	e.aabb = AABB();
+	e.leaf = NODE_NULL;
+	e.pairs.clear();
+
+	return id;
+}
+
+void BroadPhaseBVH::move(ID p_id, const AABB &p_aabb) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (ID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.owner);
+
+	e.aabb = p_aabb;
+
+	if (e.leaf == NODE_NULL) {
+		e.leaf = _alloc_node();
+		Node &n = nodes.write[e.leaf];
+		n.element = p_id;
+		n.aabb = p_aabb.grow(margin);
+		_insert_leaf(e.leaf);
+	} else if (!nodes[e.leaf].aabb.encloses(p_aabb)) {
+		_remove_leaf(e.leaf);
+		nodes.write[e.leaf].aabb = p_aabb.grow(margin);
+		_insert_leaf(e.leaf);
+	}
+
+	_mark_moved(p_id);
+}
+
+void BroadPhaseBVH::set_static(ID p_id, bool p_static) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (ID)elements.size());
+	Element &e = elements.write[p_id - 1];
+	ERR_FAIL_COND(!e.owner);
+
+	if (e._static == p_static)
+		return;
+
+	e._static = p_static;
+	_mark_moved(p_id);
+}
+
+void BroadPhaseBVH::remove(ID p_id) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > (ID)elements.size());
+	ERR_FAIL_COND(!elements[p_id - 1].owner);
+
+	//unpair must be done immediately on removal to avoid potential invalid pointers
+	while (elements[p_id - 1].pairs.size()) {
+		_unpair(p_id, elements[p_id - 1].pairs[0]);
+	}
+
+	Element &e = elements.write[p_id - 1];
+	if (e.leaf != NODE_NULL) {
+		_remove_leaf(e.leaf);
+		_free_node(e.leaf);
+	}
+
+	e.owner = NULL;
+	e.moved = false;
+	e.leaf = NODE_NULL;
+	free_elements.push_back(p_id);
+}
+
+CollisionObjectSW *BroadPhaseBVH::get_object(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (ID)elements.size(), NULL);
+	CollisionObjectSW *it = elements[p_id - 1].owner;
+	ERR_FAIL_COND_V(!it, NULL);
+	return it;
+}
+bool BroadPhaseBVH::is_static(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (ID)elements.size(), false);
+	return elements[p_id - 1]._static;
+}
+int BroadPhaseBVH::get_subindex(ID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > (ID)elements.size(), -1);
+	return elements[p_id - 1].subindex;
+}
+
+template <class T>
+int BroadPhaseBVH::_cull(const T &p_test, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	if (root == NODE_NULL)
+		return 0;
+
+	const Node *n = nodes.ptr();
+	const Element *e = elements.ptr();
+
+	int stack[STACK_MAX];
+	int stack_size = 0;
+	stack[stack_size++] = root;
+
+	int rc = 0;
+
+	while (stack_size && rc < p_max_results) {
+
+		const Node &node = n[stack[--stack_size]];
+		if (!p_test(node.aabb))
+			continue;
+
+		if (node.is_leaf()) {
+
+			const Element &elem = e[node.element - 1];
+			if (!p_test(elem.aabb))
+				continue;
+
+			p_results[rc] = elem.owner;
+			if (p_result_indices)
+				p_result_indices[rc] = elem.subindex;
+			rc++;
+		} else {
+
+			ERR_FAIL_COND_V(stack_size + 2 > STACK_MAX, rc);
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+
+	return rc;
+}
+
+struct _BVHCullPoint {
+
+	Vector3 point;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+};
+
+struct _BVHCullSegment {
+
+	Vector3 from;
+	Vector3 to;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+};
+
+struct _BVHCullAABB {
+
+	AABB aabb;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects(aabb); }
+};
+
+int BroadPhaseBVH::cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullPoint test;
+	test.point = p_point;
+	return _cull(test, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhaseBVH::cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullSegment test;
+	test.from = p_from;
+	test.to = p_to;
+	return _cull(test, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhaseBVH::cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices) {
+
+	_BVHCullAABB test;
+	test.aabb = p_aabb;
+	return _cull(test, p_results, p_max_results, p_result_indices);
+}
+
+void BroadPhaseBVH::set_pair_callback(PairCallback p_pair_callback, void *p_userdata) {
+
+	pair_callback = p_pair_callback;
+	pair_userdata = p_userdata;
+}
+void BroadPhaseBVH::set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) {
+
+	unpair_callback = p_unpair_callback;
+	unpair_userdata = p_userdata;
+}
+
+void BroadPhaseBVH::update() {
+
+	int stack[STACK_MAX];
+
+	for (int i = 0; i < moved_elements.size(); i++) {
+
+		ID id = moved_elements[i];
+
+		if (!elements[id - 1].moved)
+			continue; // removed since
+		elements.write[id - 1].moved = false;
+
+		if (elements[id - 1].leaf == NODE_NULL)
+			continue; // never placed
+
+		// drop pairs that no longer overlap, iterating backwards as _unpair() swaps with the last one
+		for (int j = elements[id - 1].pairs.size() - 1; j >= 0; j--) {
+
+			ID other = elements[id - 1].pairs[j];
+			if (!_test_pair(elements[id - 1], elements[other - 1])) {
+				_unpair(id, other);
+			}
+		}
+
+		// find new pairs
+		const AABB aabb = elements[id - 1].aabb;
+
+		int stack_size = 0;
+		stack[stack_size++] = root;
+
+		while (stack_size) {
+
+			const Node &node = nodes[stack[--stack_size]];
+			if (!node.aabb.intersects(aabb))
+				continue;
+
+			if (node.is_leaf()) {
+
+				ID other = node.element;
+				if (other == id || !_test_pair(elements[id - 1], elements[other - 1]))
+					continue;
+				if (pair_map.has(_get_pair_key(id, other)))
+					continue;
+
+				_pair(id, other);
+			} else {
+
+				ERR_BREAK(stack_size + 2 > STACK_MAX);
+				stack[stack_size++] = node.children[0];
+				stack[stack_size++] = node.children[1];
+			}
+		}
+	}
+
+	moved_elements.clear();
+}
+
+BroadPhaseSW *BroadPhaseBVH::_create() {
+
+	return memnew(BroadPhaseBVH);
+}
+
+BroadPhaseBVH::BroadPhaseBVH() {
+
+	root = NODE_NULL;
+	margin = 0.1;
+	pair_callback = NULL;
+	pair_userdata = NULL;
+	unpair_callback = NULL;
+	unpair_userdata = NULL;
+}
@@ -0,0 +1,137 @@
+/*************************************************************************/
+/*  broad_phase_bvh.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BROAD_PHASE_BVH_H
+#define BROAD_PHASE_BVH_H
+
+#include "broad_phase_sw.h"
+#include "core/hash_map.h"
+#include "core/vector.h"
+
+// Dynamic AABB tree. Leaves store a fattened AABB so small motions don't touch the tree,
+// and pairs are only recomputed for moved elements, in one batch on update().
+class BroadPhaseBVH : public BroadPhaseSW {
+
+	enum {
+		NODE_NULL = -1,
+		STACK_MAX = 128
+	};
+
+	struct Node {
+
+		AABB aabb;
+		int parent;
+		int children[2];
+		int height;
+		ID element; // 0 for internal nodes
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == NODE_NULL; }
+	};
+
+	struct Element {
+
+		CollisionObjectSW *owner; // NULL while unused
+		int subindex;
+		bool _static;
+		bool moved;
+		AABB aabb;
+		int leaf;
+		Vector<ID> pairs;
+	};
+
+	Vector<Node> nodes;
+	Vector<int> free_nodes;
+	int root;
+
+	Vector<Element> elements;
+	Vector<ID> free_elements;
+	Vector<ID> moved_elements;
+
+	HashMap<uint64_t, void *> pair_map;
+
+	PairCallback pair_callback;
+	void *pair_userdata;
+	UnpairCallback unpair_callback;
+	void *unpair_userdata;
+
+	real_t margin;
+
+	static _FORCE_INLINE_ real_t _get_surface(const AABB &p_aabb) {
+		const Vector3 &s = p_aabb.size;
+		return s.x * s.y + s.y * s.z + s.z * s.x;
+	}
+
+	static _FORCE_INLINE_ uint64_t _get_pair_key(ID p_a, ID p_b) {
+		return p_a < p_b ? (uint64_t(p_a) << 32) | p_b : (uint64_t(p_b) << 32) | p_a;
+	}
+
+	_FORCE_INLINE_ bool _test_pair(const Element &p_a, const Element &p_b) const {
+		return p_a.owner != p_b.owner && (!p_a._static || !p_b._static) && p_a.aabb.intersects(p_b.aabb);
+	}
+
+	int _alloc_node();
+	void _free_node(int p_node);
+	void _insert_leaf(int p_leaf);
+	void _remove_leaf(int p_leaf);
+	int _balance(int p_node);
+	void _refit(int p_node);
+
+	void _mark_moved(ID p_id);
+	void _pair(ID p_a, ID p_b);
+	void _unpair(ID p_a, ID p_b);
+
+	template <class T>
+	int _cull(const T &p_test, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices);
+
+public:
+	// 0 is an invalid ID
+	virtual ID create(CollisionObjectSW *p_object, int p_subindex = 0);
+	virtual void move(ID p_id, const AABB &p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObjectSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_point(const Vector3 &p_point, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_aabb(const AABB &p_aabb, CollisionObjectSW **p_results, int p_max_results, int *p_result_indices = NULL);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata);
+
+	virtual void update();
+
+	static BroadPhaseSW *_create();
+	BroadPhaseBVH();
+};
+
+#endif // BROAD_PHASE_BVH_H
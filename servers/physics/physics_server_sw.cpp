@@ -31,8 +31,10 @@
 #include "physics_server_sw.h"
 
 #include "broad_phase_basic.h"
+#include "broad_phase_bvh.h"
 #include "broad_phase_octree.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 #include "core/script_language.h"
 #include "joints/cone_twist_joint_sw.h"
 #include "joints/generic_6dof_joint_sw.h"
@@ -740,6 +742,19 @@ void PhysicsServerSW::body_set_state(RID p_body, BodyState p_state, const Varian
 	body->set_state(p_state, p_variant);
 };
 
+void PhysicsServerSW::bodies_set_state(const Vector<RID> &p_bodies, BodyState p_state, const Array &p_values) {
+
+	ERR_FAIL_COND(p_values.size() != p_bodies.size());
+
+	for (int i = 0; i < p_bodies.size(); i++) {
+
+		BodySW *body = body_owner.get(p_bodies[i]);
+		ERR_CONTINUE(!body);
+
+		body->set_state(p_state, p_values[i]);
+	}
+}
+
 Variant PhysicsServerSW::body_get_state(RID p_body, BodyState p_state) const {
 
 	BodySW *body = body_owner.get(p_body);
@@ -1588,7 +1603,17 @@ void PhysicsServerSW::_shape_col_cbk(const Vector3 &p_point_A, const Vector3 &p_
 PhysicsServerSW *PhysicsServerSW::singleton = NULL;
 PhysicsServerSW::PhysicsServerSW() {
 	singleton = this;
-	BroadPhaseSW::create_func = BroadPhaseOctree::_create;
+
+	String broadphase = GLOBAL_DEF_RST("physics/3d/broadphase", "BVH");
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/broadphase", PropertyInfo(Variant::STRING, "physics/3d/broadphase", PROPERTY_HINT_ENUM, "BVH,Octree,Basic"));
+	if (broadphase == "Octree") {
+		BroadPhaseSW::create_func = BroadPhaseOctree::_create;
+	} else if (broadphase == "Basic") {
+		BroadPhaseSW::create_func = BroadPhaseBasic::_create;
+	} else {
+		BroadPhaseSW::create_func = BroadPhaseBVH::_create;
+	}
+
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
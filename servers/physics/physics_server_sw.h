@@ -199,6 +199,7 @@ public:
 
 	virtual void body_set_state(RID p_body, BodyState p_state, const Variant &p_variant);
 	virtual Variant body_get_state(RID p_body, BodyState p_state) const;
+	virtual void bodies_set_state(const Vector<RID> &p_bodies, BodyState p_state, const Array &p_values);
 
 	virtual void body_set_applied_force(RID p_body, const Vector3 &p_force);
 	virtual Vector3 body_get_applied_force(RID p_body) const;
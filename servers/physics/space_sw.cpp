@@ -1147,6 +1147,9 @@ void SpaceSW::setup() {
 		inertia_update_list.first()->self()->update_inertias();
 		inertia_update_list.remove(inertia_update_list.first());
 	}
+
+	// pair objects moved through the server since the last step
+	broadphase->update();
 }
 
 void SpaceSW::update() {
@@ -1235,6 +1238,8 @@ SpaceSW::SpaceSW() {
 	direct_access = memnew(PhysicsDirectSpaceStateSW);
 	direct_access->space = this;
 
+	island_mutex = Mutex::create();
+
 	for (int i = 0; i < ELAPSED_TIME_MAX; i++)
 		elapsed_time[i] = 0;
 }
@@ -1243,4 +1248,5 @@ SpaceSW::~SpaceSW() {
 
 	memdelete(broadphase);
 	memdelete(direct_access);
+	memdelete(island_mutex);
 }
@@ -38,7 +38,9 @@
 #include "broad_phase_sw.h"
 #include "collision_object_sw.h"
 #include "core/hash_map.h"
+#include "core/os/mutex.h"
 #include "core/project_settings.h"
+#include "core/safe_refcount.h"
 #include "core/typedefs.h"
 
 class PhysicsDirectSpaceStateSW : public PhysicsDirectSpaceState {
@@ -120,7 +122,9 @@ private:
 	RID static_global_body;
 
 	Vector<Vector3> contact_debug;
-	int contact_debug_count;
+	uint32_t contact_debug_count;
+
+	Mutex *island_mutex;
 
 	friend class PhysicsDirectSpaceStateSW;
 
@@ -187,10 +191,15 @@ public:
 	void set_debug_contacts(int p_amount) { contact_debug.resize(p_amount); }
 	_FORCE_INLINE_ bool is_debugging_contacts() const { return !contact_debug.empty(); }
 	_FORCE_INLINE_ void add_debug_contact(const Vector3 &p_contact) {
-		if (contact_debug_count < contact_debug.size()) contact_debug.write[contact_debug_count++] = p_contact;
+		// Islands are set up in parallel, reserve the slot atomically.
+		uint32_t index = atomic_increment(&contact_debug_count) - 1;
+		if (index < (uint32_t)contact_debug.size()) contact_debug.write[index] = p_contact;
 	}
 	_FORCE_INLINE_ Vector<Vector3> get_debug_contacts() { return contact_debug; }
-	_FORCE_INLINE_ int get_debug_contact_count() { return contact_debug_count; }
+	_FORCE_INLINE_ int get_debug_contact_count() { return MIN((int)contact_debug_count, contact_debug.size()); }
+
+	// Guards objects that can be reached from more than one island (areas, static and kinematic bodies) while islands are processed in parallel.
+	_FORCE_INLINE_ Mutex *get_island_mutex() const { return island_mutex; }
 
 	void set_static_global_body(RID p_body) { static_global_body = p_body; }
 	RID get_static_global_body() { return static_global_body; }
@@ -32,6 +32,7 @@
 #include "joints_sw.h"
 
 #include "core/os/os.h"
+#include "core/project_settings.h"
 
 void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island) {
 
@@ -107,7 +108,7 @@ void StepSW::_solve_island(ConstraintSW *p_island, int p_iterations, real_t p_de
 	}
 }
 
-void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
+bool StepSW::_can_island_sleep(BodySW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
 
@@ -125,9 +126,14 @@ void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 		b = b->get_island_next();
 	}
 
+	return can_sleep;
+}
+
+void StepSW::_check_suspend(BodySW *p_island, bool p_can_sleep) {
+
 	//put all to sleep or wake up everyoen
 
-	b = p_island;
+	BodySW *b = p_island;
 	while (b) {
 
 		if (b->get_mode() == PhysicsServer::BODY_MODE_STATIC || b->get_mode() == PhysicsServer::BODY_MODE_KINEMATIC) {
@@ -137,19 +143,61 @@ void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 
 		bool active = b->is_active();
 
-		if (active == can_sleep)
-			b->set_active(!can_sleep);
+		if (active == p_can_sleep)
+			b->set_active(!p_can_sleep);
 
 		b = b->get_island_next();
 	}
 }
 
+void StepSW::_integrate_forces_task(uint32_t p_index, void *p_userdata) {
+
+	active_bodies[p_index]->integrate_forces(delta);
+}
+
+void StepSW::_setup_island_task(uint32_t p_index, void *p_userdata) {
+
+	_setup_island(constraint_islands[p_index], delta);
+}
+
+void StepSW::_solve_island_task(uint32_t p_index, void *p_userdata) {
+
+	//iterating each island separatedly improves cache efficiency
+	_solve_island(constraint_islands[p_index], iterations, delta);
+}
+
+void StepSW::_integrate_velocities_task(uint32_t p_index, void *p_userdata) {
+
+	active_bodies[p_index]->integrate_velocities(delta);
+}
+
+void StepSW::_check_suspend_task(uint32_t p_index, void *p_userdata) {
+
+	island_can_sleep.write[p_index] = _can_island_sleep(body_islands[p_index], delta);
+}
+
+void StepSW::_run_tasks(void (StepSW::*p_method)(uint32_t, void *), uint32_t p_count, bool p_threaded, int p_grain_size) {
+
+	if (p_threaded && p_count > 1) {
+		WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+		WorkerThreadPool::GroupID group = pool->add_template_group_task(this, p_method, (void *)NULL, p_count, p_grain_size);
+		pool->wait_for_group_task_completion(group);
+	} else {
+		for (uint32_t i = 0; i < p_count; i++) {
+			(this->*p_method)(i, NULL);
+		}
+	}
+}
+
 void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
 
 	p_space->setup(); //update inertias, etc
 
+	delta = p_delta;
+	iterations = p_iterations;
+
 	const SelfList<BodySW>::List *body_list = &p_space->get_active_body_list();
 
 	/* INTEGRATE FORCES */
@@ -157,14 +205,18 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	uint64_t profile_begtime = OS::get_singleton()->get_ticks_usec();
 	uint64_t profile_endtime = 0;
 
-	int active_count = 0;
+	active_bodies.clear();
+	for (const SelfList<BodySW> *b = body_list->first(); b; b = b->next()) {
+		active_bodies.push_back(b->self());
+	}
+
+	int active_count = active_bodies.size();
 
-	const SelfList<BodySW> *b = body_list->first();
-	while (b) {
+	// Bodies only touch their own state here, what needs the broadphase is done afterwards in list order.
+	_run_tasks(&StepSW::_integrate_forces_task, active_count, use_threads);
 
-		b->self()->integrate_forces(p_delta);
-		b = b->next();
-		active_count++;
+	for (int i = 0; i < active_count; i++) {
+		active_bodies[i]->post_integrate_forces();
 	}
 
 	p_space->set_active_objects(active_count);
@@ -177,9 +229,10 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* GENERATE CONSTRAINT ISLANDS */
 
-	BodySW *island_list = NULL;
-	ConstraintSW *constraint_island_list = NULL;
-	b = body_list->first();
+	body_islands.clear();
+	constraint_islands.clear();
+
+	const SelfList<BodySW> *b = body_list->first();
 
 	int island_count = 0;
 
@@ -192,12 +245,10 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 			ConstraintSW *constraint_island = NULL;
 			_populate_island(body, &island, &constraint_island);
 
-			island->set_island_list_next(island_list);
-			island_list = island;
+			body_islands.push_back(island);
 
 			if (constraint_island) {
-				constraint_island->set_island_list_next(constraint_island_list);
-				constraint_island_list = constraint_island;
+				constraint_islands.push_back(constraint_island);
 				island_count++;
 			}
 		}
@@ -216,8 +267,7 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 				continue;
 			c->set_island_step(_step);
 			c->set_island_next(NULL);
-			c->set_island_list_next(constraint_island_list);
-			constraint_island_list = c;
+			constraint_islands.push_back(c);
 		}
 		p_space->area_remove_from_moved_list((SelfList<AreaSW> *)aml.first()); //faster to remove here
 	}
@@ -230,14 +280,9 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
-	{
-		ConstraintSW *ci = constraint_island_list;
-		while (ci) {
-
-			_setup_island(ci, p_delta);
-			ci = ci->get_island_list_next();
-		}
-	}
+	// Islands share no dynamic bodies, but contacts reported to shared static and kinematic bodies
+	// would come in thread dependent order, so setup stays on one thread in deterministic mode.
+	_run_tasks(&StepSW::_setup_island_task, constraint_islands.size(), use_threads && !deterministic, 1);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -247,14 +292,7 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		ConstraintSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
-		}
-	}
+	_run_tasks(&StepSW::_solve_island_task, constraint_islands.size(), use_threads, 1);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -264,22 +302,19 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* INTEGRATE VELOCITIES */
 
-	b = body_list->first();
-	while (b) {
-		const SelfList<BodySW> *n = b->next();
-		b->self()->integrate_velocities(p_delta);
-		b = n;
+	_run_tasks(&StepSW::_integrate_velocities_task, active_count, use_threads);
+
+	for (int i = 0; i < active_count; i++) {
+		active_bodies[i]->post_integrate_velocities();
 	}
 
 	/* SLEEP / WAKE UP ISLANDS */
 
-	{
-		BodySW *bi = island_list;
-		while (bi) {
+	island_can_sleep.resize(body_islands.size());
+	_run_tasks(&StepSW::_check_suspend_task, body_islands.size(), use_threads);
 
-			_check_suspend(bi, p_delta);
-			bi = bi->get_island_list_next();
-		}
+	for (int i = 0; i < body_islands.size(); i++) {
+		_check_suspend(body_islands[i], island_can_sleep[i]);
 	}
 
 	{ //profile
@@ -296,4 +331,9 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 StepSW::StepSW() {
 
 	_step = 1;
+	delta = 0;
+	iterations = 0;
+
+	use_threads = GLOBAL_DEF("physics/3d/solver/use_threads", true);
+	deterministic = GLOBAL_DEF("physics/3d/solver/deterministic", false);
 }
@@ -33,14 +33,36 @@
 
 #include "space_sw.h"
 
+#include "core/os/worker_thread_pool.h"
+
 class StepSW {
 
 	uint64_t _step;
 
+	bool use_threads;
+	bool deterministic;
+
+	// Parameters and work lists of the step being processed, shared with the threaded tasks.
+	real_t delta;
+	int iterations;
+	Vector<BodySW *> active_bodies;
+	Vector<BodySW *> body_islands;
+	Vector<ConstraintSW *> constraint_islands;
+	Vector<bool> island_can_sleep;
+
 	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island);
 	void _setup_island(ConstraintSW *p_island, real_t p_delta);
 	void _solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta);
-	void _check_suspend(BodySW *p_island, real_t p_delta);
+	bool _can_island_sleep(BodySW *p_island, real_t p_delta);
+	void _check_suspend(BodySW *p_island, bool p_can_sleep);
+
+	void _integrate_forces_task(uint32_t p_index, void *p_userdata);
+	void _setup_island_task(uint32_t p_index, void *p_userdata);
+	void _solve_island_task(uint32_t p_index, void *p_userdata);
+	void _integrate_velocities_task(uint32_t p_index, void *p_userdata);
+	void _check_suspend_task(uint32_t p_index, void *p_userdata);
+
+	void _run_tasks(void (StepSW::*p_method)(uint32_t, void *), uint32_t p_count, bool p_threaded, int p_grain_size = -1);
 
 public:
 	void step(SpaceSW *p_space, real_t p_delta, int p_iterations);
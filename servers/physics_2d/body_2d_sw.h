@@ -79,6 +79,13 @@ class Body2DSW : public CollisionObject2DSW {
 	bool can_sleep;
 	bool first_time_kinematic;
 	bool first_integration;
+
+	// Changes computed by the integration, applied to the space in post_integrate_*().
+	Vector2 integrate_motion;
+	bool integrate_motion_pending;
+	bool integrate_shapes_pending;
+	bool integrate_deactivate_pending;
+
 	void _update_inertia();
 	virtual void _shapes_changed();
 	Transform2D new_transform;
@@ -272,8 +279,11 @@ public:
 	_FORCE_INLINE_ real_t get_linear_damp() const { return linear_damp; }
 	_FORCE_INLINE_ real_t get_angular_damp() const { return angular_damp; }
 
+	// Safe to call for several bodies in parallel, as long as post_integrate_*() is called for each of them afterwards from a single thread.
 	void integrate_forces(real_t p_step);
 	void integrate_velocities(real_t p_step);
+	void post_integrate_forces();
+	void post_integrate_velocities();
 
 	_FORCE_INLINE_ Vector2 get_motion() const {
 
@@ -394,13 +394,16 @@ bool BodyPair2DSW::setup(real_t p_step) {
 			global_A += offset_A;
 			global_B += offset_A;
 
+			// Static and kinematic bodies don't belong to a single island, other islands may be reporting to them at the same time.
 			if (gather_A) {
 				Vector2 crB(-B->get_angular_velocity() * c.rB.y, B->get_angular_velocity() * c.rB.x);
+				MutexLock lock(A->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC ? space->get_island_mutex() : NULL);
 				A->add_contact(global_A, -c.normal, depth, shape_A, global_B, shape_B, B->get_instance_id(), B->get_self(), crB + B->get_linear_velocity());
 			}
 			if (gather_B) {
 
 				Vector2 crA(-A->get_angular_velocity() * c.rA.y, A->get_angular_velocity() * c.rA.x);
+				MutexLock lock(B->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC ? space->get_island_mutex() : NULL);
 				B->add_contact(global_B, c.normal, depth, shape_B, global_A, shape_A, A->get_instance_id(), A->get_self(), crA + A->get_linear_velocity());
 			}
 		}
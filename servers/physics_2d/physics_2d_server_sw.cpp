@@ -849,6 +849,19 @@ void Physics2DServerSW::body_set_state(RID p_body, BodyState p_state, const Vari
 	body->set_state(p_state, p_variant);
 };
 
+void Physics2DServerSW::bodies_set_state(const Vector<RID> &p_bodies, BodyState p_state, const Array &p_values) {
+
+	ERR_FAIL_COND(p_values.size() != p_bodies.size());
+
+	for (int i = 0; i < p_bodies.size(); i++) {
+
+		Body2DSW *body = body_owner.get(p_bodies[i]);
+		ERR_CONTINUE(!body);
+
+		body->set_state(p_state, p_values[i]);
+	}
+}
+
 Variant Physics2DServerSW::body_get_state(RID p_body, BodyState p_state) const {
 
 	Body2DSW *body = body_owner.get(p_body);
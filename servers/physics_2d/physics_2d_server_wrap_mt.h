@@ -218,6 +218,7 @@ public:
 	FUNC2RC(real_t, body_get_param, RID, BodyParameter);
 
 	FUNC3(body_set_state, RID, BodyState, const Variant &);
+	FUNC3(bodies_set_state, const Vector<RID> &, BodyState, const Array &);
 	FUNC2RC(Variant, body_get_state, RID, BodyState);
 
 	FUNC2(body_set_applied_force, RID, const Vector2 &);
@@ -1360,6 +1360,8 @@ Space2DSW::Space2DSW() {
 	direct_access = memnew(Physics2DDirectSpaceStateSW);
 	direct_access->space = this;
 
+	island_mutex = Mutex::create();
+
 	for (int i = 0; i < ELAPSED_TIME_MAX; i++)
 		elapsed_time[i] = 0;
 }
@@ -1368,4 +1370,5 @@ Space2DSW::~Space2DSW() {
 
 	memdelete(broadphase);
 	memdelete(direct_access);
+	memdelete(island_mutex);
 }
@@ -30,6 +30,7 @@
 
 #include "step_2d_sw.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
 
@@ -94,7 +95,7 @@ void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t
 	}
 }
 
-void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
+bool Step2DSW::_can_island_sleep(Body2DSW *p_island, real_t p_delta) {
 
 	bool can_sleep = true;
 
@@ -112,9 +113,14 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 		b = b->get_island_next();
 	}
 
+	return can_sleep;
+}
+
+void Step2DSW::_check_suspend(Body2DSW *p_island, bool p_can_sleep) {
+
 	//put all to sleep or wake up everyoen
 
-	b = p_island;
+	Body2DSW *b = p_island;
 	while (b) {
 
 		if (b->get_mode() == Physics2DServer::BODY_MODE_STATIC || b->get_mode() == Physics2DServer::BODY_MODE_KINEMATIC) {
@@ -124,19 +130,68 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 
 		bool active = b->is_active();
 
-		if (active == can_sleep)
-			b->set_active(!can_sleep);
+		if (active == p_can_sleep)
+			b->set_active(!p_can_sleep);
 
 		b = b->get_island_next();
 	}
 }
 
+void Step2DSW::_integrate_forces_task(uint32_t p_index, void *p_userdata) {
+
+	active_bodies[p_index]->integrate_forces(delta);
+}
+
+void Step2DSW::_setup_island_task(uint32_t p_index, void *p_userdata) {
+
+	Constraint2DSW *island = constraint_islands[p_index];
+	if (_setup_island(island, delta)) {
+		//removed the root from the island graph because it is not to be processed, solve from the next one (if any)
+		constraint_islands.write[p_index] = island->get_island_next();
+	}
+}
+
+void Step2DSW::_solve_island_task(uint32_t p_index, void *p_userdata) {
+
+	//iterating each island separatedly improves cache efficiency
+	Constraint2DSW *island = constraint_islands[p_index];
+	if (island) {
+		_solve_island(island, iterations, delta);
+	}
+}
+
+void Step2DSW::_integrate_velocities_task(uint32_t p_index, void *p_userdata) {
+
+	active_bodies[p_index]->integrate_velocities(delta);
+}
+
+void Step2DSW::_check_suspend_task(uint32_t p_index, void *p_userdata) {
+
+	island_can_sleep.write[p_index] = _can_island_sleep(body_islands[p_index], delta);
+}
+
+void Step2DSW::_run_tasks(void (Step2DSW::*p_method)(uint32_t, void *), uint32_t p_count, bool p_threaded, int p_grain_size) {
+
+	if (p_threaded && p_count > 1) {
+		WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+		WorkerThreadPool::GroupID group = pool->add_template_group_task(this, p_method, (void *)NULL, p_count, p_grain_size);
+		pool->wait_for_group_task_completion(group);
+	} else {
+		for (uint32_t i = 0; i < p_count; i++) {
+			(this->*p_method)(i, NULL);
+		}
+	}
+}
+
 void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
 
 	p_space->setup(); //update inertias, etc
 
+	delta = p_delta;
+	iterations = p_iterations;
+
 	const SelfList<Body2DSW>::List *body_list = &p_space->get_active_body_list();
 
 	/* INTEGRATE FORCES */
@@ -144,14 +199,18 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	uint64_t profile_begtime = OS::get_singleton()->get_ticks_usec();
 	uint64_t profile_endtime = 0;
 
-	int active_count = 0;
+	active_bodies.clear();
+	for (const SelfList<Body2DSW> *b = body_list->first(); b; b = b->next()) {
+		active_bodies.push_back(b->self());
+	}
 
-	const SelfList<Body2DSW> *b = body_list->first();
-	while (b) {
+	int active_count = active_bodies.size();
 
-		b->self()->integrate_forces(p_delta);
-		b = b->next();
-		active_count++;
+	// Bodies only touch their own state here, what needs the broadphase is done afterwards in list order.
+	_run_tasks(&Step2DSW::_integrate_forces_task, active_count, use_threads);
+
+	for (int i = 0; i < active_count; i++) {
+		active_bodies[i]->post_integrate_forces();
 	}
 
 	p_space->set_active_objects(active_count);
@@ -164,9 +223,10 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* GENERATE CONSTRAINT ISLANDS */
 
-	Body2DSW *island_list = NULL;
-	Constraint2DSW *constraint_island_list = NULL;
-	b = body_list->first();
+	body_islands.clear();
+	constraint_islands.clear();
+
+	const SelfList<Body2DSW> *b = body_list->first();
 
 	int island_count = 0;
 
@@ -179,12 +239,10 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 			Constraint2DSW *constraint_island = NULL;
 			_populate_island(body, &island, &constraint_island);
 
-			island->set_island_list_next(island_list);
-			island_list = island;
+			body_islands.push_back(island);
 
 			if (constraint_island) {
-				constraint_island->set_island_list_next(constraint_island_list);
-				constraint_island_list = constraint_island;
+				constraint_islands.push_back(constraint_island);
 				island_count++;
 			}
 		}
@@ -203,8 +261,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 				continue;
 			c->set_island_step(_step);
 			c->set_island_next(NULL);
-			c->set_island_list_next(constraint_island_list);
-			constraint_island_list = c;
+			constraint_islands.push_back(c);
 		}
 		p_space->area_remove_from_moved_list((SelfList<Area2DSW> *)aml.first()); //faster to remove here
 	}
@@ -217,43 +274,9 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		Constraint2DSW *prev_ci = NULL;
-		while (ci) {
-
-			if (_setup_island(ci, p_delta)) {
-
-				//removed the root from the island graph because it is not to be processed
-
-				Constraint2DSW *next = ci->get_island_next();
-
-				if (next) {
-					//root from list being deleted no longer exists, replace by next
-					next->set_island_list_next(ci->get_island_list_next());
-					if (prev_ci) {
-						prev_ci->set_island_list_next(next);
-					} else {
-						constraint_island_list = next;
-					}
-					prev_ci = next;
-				} else {
-
-					//list is empty, just skip
-					if (prev_ci) {
-						prev_ci->set_island_list_next(ci->get_island_list_next());
-
-					} else {
-						constraint_island_list = ci->get_island_list_next();
-					}
-				}
-			} else {
-				prev_ci = ci;
-			}
-
-			ci = ci->get_island_list_next();
-		}
-	}
+	// Pair setup (narrowphase) runs per island. Islands share no dynamic bodies, but contacts reported to shared
+	// static and kinematic bodies would come in thread dependent order, so it stays on one thread in deterministic mode.
+	_run_tasks(&Step2DSW::_setup_island_task, constraint_islands.size(), use_threads && !deterministic, 1);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -263,14 +286,7 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
-		}
-	}
+	_run_tasks(&Step2DSW::_solve_island_task, constraint_islands.size(), use_threads, 1);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -280,23 +296,19 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* INTEGRATE VELOCITIES */
 
-	b = body_list->first();
-	while (b) {
+	_run_tasks(&Step2DSW::_integrate_velocities_task, active_count, use_threads);
 
-		const SelfList<Body2DSW> *n = b->next();
-		b->self()->integrate_velocities(p_delta);
-		b = n; // in case it shuts itself down
+	for (int i = 0; i < active_count; i++) {
+		active_bodies[i]->post_integrate_velocities();
 	}
 
 	/* SLEEP / WAKE UP ISLANDS */
 
-	{
-		Body2DSW *bi = island_list;
-		while (bi) {
+	island_can_sleep.resize(body_islands.size());
+	_run_tasks(&Step2DSW::_check_suspend_task, body_islands.size(), use_threads);
 
-			_check_suspend(bi, p_delta);
-			bi = bi->get_island_list_next();
-		}
+	for (int i = 0; i < body_islands.size(); i++) {
+		_check_suspend(body_islands[i], island_can_sleep[i]);
 	}
 
 	{ //profile
@@ -313,4 +325,9 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 Step2DSW::Step2DSW() {
 
 	_step = 1;
+	delta = 0;
+	iterations = 0;
+
+	use_threads = GLOBAL_DEF("physics/2d/solver/use_threads", true);
+	deterministic = GLOBAL_DEF("physics/2d/solver/deterministic", false);
 }
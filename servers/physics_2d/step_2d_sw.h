@@ -33,14 +33,36 @@
 
 #include "space_2d_sw.h"
 
+#include "core/os/worker_thread_pool.h"
+
 class Step2DSW {
 
 	uint64_t _step;
 
+	bool use_threads;
+	bool deterministic;
+
+	// Parameters and work lists of the step being processed, shared with the threaded tasks.
+	real_t delta;
+	int iterations;
+	Vector<Body2DSW *> active_bodies;
+	Vector<Body2DSW *> body_islands;
+	Vector<Constraint2DSW *> constraint_islands;
+	Vector<bool> island_can_sleep;
+
 	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
 	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
 	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
-	void _check_suspend(Body2DSW *p_island, real_t p_delta);
+	bool _can_island_sleep(Body2DSW *p_island, real_t p_delta);
+	void _check_suspend(Body2DSW *p_island, bool p_can_sleep);
+
+	void _integrate_forces_task(uint32_t p_index, void *p_userdata);
+	void _setup_island_task(uint32_t p_index, void *p_userdata);
+	void _solve_island_task(uint32_t p_index, void *p_userdata);
+	void _integrate_velocities_task(uint32_t p_index, void *p_userdata);
+	void _check_suspend_task(uint32_t p_index, void *p_userdata);
+
+	void _run_tasks(void (Step2DSW::*p_method)(uint32_t, void *), uint32_t p_count, bool p_threaded, int p_grain_size = -1);
 
 public:
 	void step(Space2DSW *p_space, real_t p_delta, int p_iterations);
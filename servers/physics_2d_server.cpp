@@ -537,6 +537,17 @@ bool Physics2DServer::_body_test_motion(RID p_body, const Transform2D &p_from, c
 	return body_test_motion(p_body, p_from, p_motion, p_infinite_inertia, p_margin, r);
 }
 
+void Physics2DServer::_bodies_set_state_bind(const Array &p_bodies, BodyState p_state, const Array &p_values) {
+
+	Vector<RID> bodies;
+	bodies.resize(p_bodies.size());
+	for (int i = 0; i < p_bodies.size(); i++) {
+		bodies.write[i] = p_bodies[i];
+	}
+
+	bodies_set_state(bodies, p_state, p_values);
+}
+
 void Physics2DServer::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("line_shape_create"), &Physics2DServer::line_shape_create);
@@ -641,6 +652,7 @@ void Physics2DServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("body_get_param", "body", "param"), &Physics2DServer::body_get_param);
 
 	ClassDB::bind_method(D_METHOD("body_set_state", "body", "state", "value"), &Physics2DServer::body_set_state);
+	ClassDB::bind_method(D_METHOD("bodies_set_state", "bodies", "state", "values"), &Physics2DServer::_bodies_set_state_bind);
 	ClassDB::bind_method(D_METHOD("body_get_state", "body", "state"), &Physics2DServer::body_get_state);
 
 	ClassDB::bind_method(D_METHOD("body_apply_central_impulse", "body", "impulse"), &Physics2DServer::body_apply_central_impulse);
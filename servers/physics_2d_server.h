@@ -452,6 +452,10 @@ public:
 	virtual void body_set_state(RID p_body, BodyState p_state, const Variant &p_variant) = 0;
 	virtual Variant body_get_state(RID p_body, BodyState p_state) const = 0;
 
+	// sets the same state on many bodies at once, p_values holds one value per body
+	virtual void bodies_set_state(const Vector<RID> &p_bodies, BodyState p_state, const Array &p_values) = 0;
+	void _bodies_set_state_bind(const Array &p_bodies, BodyState p_state, const Array &p_values);
+
 	//do something about it
 	virtual void body_set_applied_force(RID p_body, const Vector2 &p_force) = 0;
 	virtual Vector2 body_get_applied_force(RID p_body) const = 0;
@@ -403,6 +403,17 @@ void PhysicsShapeQueryResult::_bind_methods() {
 
 ///////////////////////////////////////
 
+void PhysicsServer::_bodies_set_state_bind(const Array &p_bodies, BodyState p_state, const Array &p_values) {
+
+	Vector<RID> bodies;
+	bodies.resize(p_bodies.size());
+	for (int i = 0; i < p_bodies.size(); i++) {
+		bodies.write[i] = p_bodies[i];
+	}
+
+	bodies_set_state(bodies, p_state, p_values);
+}
+
 void PhysicsServer::_bind_methods() {
 
 #ifndef _3D_DISABLED
@@ -495,6 +506,7 @@ void PhysicsServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("body_get_kinematic_safe_margin", "body"), &PhysicsServer::body_get_kinematic_safe_margin);
 
 	ClassDB::bind_method(D_METHOD("body_set_state", "body", "state", "value"), &PhysicsServer::body_set_state);
+	ClassDB::bind_method(D_METHOD("bodies_set_state", "bodies", "state", "values"), &PhysicsServer::_bodies_set_state_bind);
 	ClassDB::bind_method(D_METHOD("body_get_state", "body", "state"), &PhysicsServer::body_get_state);
 
 	ClassDB::bind_method(D_METHOD("body_add_central_force", "body", "force"), &PhysicsServer::body_add_central_force);
@@ -163,6 +163,7 @@ public:
 	BIND3(texture_set_detect_3d_callback, RID, TextureDetectCallback, void *)
 	BIND3(texture_set_detect_srgb_callback, RID, TextureDetectCallback, void *)
 	BIND3(texture_set_detect_normal_callback, RID, TextureDetectCallback, void *)
+	BIND3(texture_set_stream_callback, RID, TextureStreamCallback, void *)
 
 	BIND2(texture_set_path, RID, const String &)
 	BIND1RC(String, texture_get_path, RID)
@@ -548,6 +549,8 @@ public:
 
 	BIND2(instance_set_extra_visibility_margin, RID, real_t)
 
+	BIND2(instances_set_transform, const Vector<RID> &, const PoolVector<float> &)
+
 	// don't use these in a game!
 	BIND2RC(Vector<ObjectID>, instances_cull_aabb, const AABB &, RID)
 	BIND3RC(Vector<ObjectID>, instances_cull_ray, const Vector3 &, const Vector3 &, RID)
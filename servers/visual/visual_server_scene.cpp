@@ -30,6 +30,8 @@
 
 #include "visual_server_scene.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/project_settings.h"
 #include "visual_server_globals.h"
 #include "visual_server_raster.h"
 #include <new>
@@ -92,7 +94,7 @@ void VisualServerScene::camera_set_use_vertical_aspect(RID p_camera, bool p_enab
 
 /* SCENARIO API */
 
-void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int) {
+void *VisualServerScene::_instance_pair(void *p_self, BVHElementID, Instance *p_A, int, BVHElementID, Instance *p_B, int) {
 
 	//VisualServerScene *self = (VisualServerScene*)p_self;
 	Instance *A = p_A;
@@ -171,7 +173,7 @@ void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance
 
 	return NULL;
 }
-void VisualServerScene::_instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *udata) {
+void VisualServerScene::_instance_unpair(void *p_self, BVHElementID, Instance *p_A, int, BVHElementID, Instance *p_B, int, void *udata) {
 
 	//VisualServerScene *self = (VisualServerScene*)p_self;
 	Instance *A = p_A;
@@ -247,8 +249,8 @@ RID VisualServerScene::scenario_create() {
 	RID scenario_rid = scenario_owner.make_rid(scenario);
 	scenario->self = scenario_rid;
 
-	scenario->octree.set_pair_callback(_instance_pair, this);
-	scenario->octree.set_unpair_callback(_instance_unpair, this);
+	scenario->bvh.set_pair_callback(_instance_pair, this);
+	scenario->bvh.set_unpair_callback(_instance_unpair, this);
 	scenario->reflection_probe_shadow_atlas = VSG::scene_render->shadow_atlas_create();
 	VSG::scene_render->shadow_atlas_set_size(scenario->reflection_probe_shadow_atlas, 1024); //make enough shadows for close distance, don't bother with rest
 	VSG::scene_render->shadow_atlas_set_quadrant_subdivision(scenario->reflection_probe_shadow_atlas, 0, 4);
@@ -330,7 +332,7 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 
 		if (instance->base_type == VS::INSTANCE_GI_PROBE) {
 			//if gi probe is baking, wait until done baking, else race condition may happen when removing it
-			//from octree
+			//from bvh
 			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(instance->base_data);
 
 			//make sure probes are done baking
@@ -345,9 +347,9 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 			}
 		}
 
-		if (scenario && instance->octree_id) {
-			scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (scenario && instance->bvh_id) {
+			scenario->bvh.erase(instance->bvh_id); //make dependencies generated by the bvh go away
+			instance->bvh_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -496,9 +498,9 @@ void VisualServerScene::instance_set_scenario(RID p_instance, RID p_scenario) {
 
 		instance->scenario->instances.remove(&instance->scenario_item);
 
-		if (instance->octree_id) {
-			instance->scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (instance->bvh_id) {
+			instance->scenario->bvh.erase(instance->bvh_id); //make dependencies generated by the bvh go away
+			instance->bvh_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -593,6 +595,34 @@ void VisualServerScene::instance_set_transform(RID p_instance, const Transform &
 	instance->transform = p_transform;
 	_instance_queue_update(instance, true);
 }
+
+void VisualServerScene::instances_set_transform(const Vector<RID> &p_instances, const PoolVector<float> &p_transforms) {
+
+	ERR_FAIL_COND(p_transforms.size() != p_instances.size() * 12);
+
+	PoolVector<float>::Read r = p_transforms.read();
+	const float *src = r.ptr();
+
+	for (int i = 0; i < p_instances.size(); i++) {
+
+		Transform xform;
+		xform.basis.elements[0][0] = src[0];
+		xform.basis.elements[0][1] = src[1];
+		xform.basis.elements[0][2] = src[2];
+		xform.origin.x = src[3];
+		xform.basis.elements[1][0] = src[4];
+		xform.basis.elements[1][1] = src[5];
+		xform.basis.elements[1][2] = src[6];
+		xform.origin.y = src[7];
+		xform.basis.elements[2][0] = src[8];
+		xform.basis.elements[2][1] = src[9];
+		xform.basis.elements[2][2] = src[10];
+		xform.origin.z = src[11];
+		src += 12;
+
+		instance_set_transform(p_instances[i], xform);
+	}
+}
 void VisualServerScene::instance_attach_object_instance_id(RID p_instance, ObjectID p_ID) {
 
 	Instance *instance = instance_owner.get(p_instance);
@@ -648,26 +678,26 @@ void VisualServerScene::instance_set_visible(RID p_instance, bool p_visible) {
 
 	switch (instance->base_type) {
 		case VS::INSTANCE_LIGHT: {
-			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->bvh_id && instance->scenario) {
+				instance->scenario->bvh.set_pairable(instance->bvh_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_REFLECTION_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->bvh_id && instance->scenario) {
+				instance->scenario->bvh.set_pairable(instance->bvh_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_LIGHTMAP_CAPTURE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->bvh_id && instance->scenario) {
+				instance->scenario->bvh.set_pairable(instance->bvh_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_GI_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
+			if (instance->bvh_id && instance->scenario) {
+				instance->scenario->bvh.set_pairable(instance->bvh_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
 			}
 
 		} break;
@@ -770,7 +800,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_aabb(const AABB &p_aabb, RID
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_aabb(p_aabb, cull, 1024);
+	culled = scenario->bvh.cull_aabb(p_aabb, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -793,7 +823,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_ray(const Vector3 &p_from, co
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
+	culled = scenario->bvh.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 		Instance *instance = cull[i];
@@ -816,7 +846,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_convex(const Vector<Plane> &p
 	int culled = 0;
 	Instance *cull[1024];
 
-	culled = scenario->octree.cull_convex(p_convex, cull, 1024);
+	culled = scenario->bvh.cull_convex(p_convex, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -944,7 +974,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 		return;
 	}
 
-	if (p_instance->octree_id == 0) {
+	if (p_instance->bvh_id == 0) {
 
 		uint32_t base_type = 1 << p_instance->base_type;
 		uint32_t pairable_mask = 0;
@@ -962,8 +992,8 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			pairable = true;
 		}
 
-		// not inside octree
-		p_instance->octree_id = p_instance->scenario->octree.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
+		// not inside bvh
+		p_instance->bvh_id = p_instance->scenario->bvh.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
 
 	} else {
 
@@ -972,7 +1002,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			return;
 		*/
 
-		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
+		p_instance->scenario->bvh.move(p_instance->bvh_id, new_aabb);
 	}
 }
 
@@ -1283,7 +1313,7 @@ void VisualServerScene::_update_instance_lightmap_captures(Instance *p_instance)
 	}
 }
 
-bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario) {
+bool VisualServerScene::_light_instance_update_directional_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario) {
 
 	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
 
@@ -1292,264 +1322,271 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 	bool animated_material_found = false;
 
-	switch (VSG::storage->light_get_type(p_instance->base)) {
+	float max_distance = p_cam_projection.get_z_far();
+	float shadow_max = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_SHADOW_MAX_DISTANCE);
+	if (shadow_max > 0 && !p_cam_orthogonal) { //its impractical (and leads to unwanted behaviors) to set max distance in orthogonal camera
+		max_distance = MIN(shadow_max, max_distance);
+	}
+	max_distance = MAX(max_distance, p_cam_projection.get_z_near() + 0.001);
+	float min_distance = MIN(p_cam_projection.get_z_near(), max_distance);
 
-		case VS::LIGHT_DIRECTIONAL: {
+	VS::LightDirectionalShadowDepthRangeMode depth_range_mode = VSG::storage->light_directional_get_shadow_depth_range_mode(p_instance->base);
+
+	if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
+		//optimize min/max
+		Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
+		int cull_count = p_scenario->bvh.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+		Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
+		//check distance max and min
 
-			float max_distance = p_cam_projection.get_z_far();
-			float shadow_max = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_SHADOW_MAX_DISTANCE);
-			if (shadow_max > 0 && !p_cam_orthogonal) { //its impractical (and leads to unwanted behaviors) to set max distance in orthogonal camera
-				max_distance = MIN(shadow_max, max_distance);
+		bool found_items = false;
+		float z_max = -1e20;
+		float z_min = 1e20;
+
+		for (int i = 0; i < cull_count; i++) {
+
+			Instance *instance = instance_shadow_cull_result[i];
+			if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+				continue;
 			}
-			max_distance = MAX(max_distance, p_cam_projection.get_z_near() + 0.001);
-			float min_distance = MIN(p_cam_projection.get_z_near(), max_distance);
 
-			VS::LightDirectionalShadowDepthRangeMode depth_range_mode = VSG::storage->light_directional_get_shadow_depth_range_mode(p_instance->base);
+			if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
+				animated_material_found = true;
+			}
 
-			if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
-				//optimize min/max
-				Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
-				int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-				Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
-				//check distance max and min
+			float max, min;
+			instance->transformed_aabb.project_range_in_plane(base, min, max);
 
-				bool found_items = false;
-				float z_max = -1e20;
-				float z_min = 1e20;
+			if (max > z_max) {
+				z_max = max;
+			}
 
-				for (int i = 0; i < cull_count; i++) {
+			if (min < z_min) {
+				z_min = min;
+			}
 
-					Instance *instance = instance_shadow_cull_result[i];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						continue;
-					}
+			found_items = true;
+		}
 
-					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-						animated_material_found = true;
-					}
+		if (found_items) {
+			min_distance = MAX(min_distance, z_min);
+			max_distance = MIN(max_distance, z_max);
+		}
+	}
 
-					float max, min;
-					instance->transformed_aabb.project_range_in_plane(base, min, max);
+	float range = max_distance - min_distance;
 
-					if (max > z_max) {
-						z_max = max;
-					}
+	int splits = 0;
+	switch (VSG::storage->light_directional_get_shadow_mode(p_instance->base)) {
+		case VS::LIGHT_DIRECTIONAL_SHADOW_ORTHOGONAL: splits = 1; break;
+		case VS::LIGHT_DIRECTIONAL_SHADOW_PARALLEL_2_SPLITS: splits = 2; break;
+		case VS::LIGHT_DIRECTIONAL_SHADOW_PARALLEL_4_SPLITS: splits = 4; break;
+	}
 
-					if (min < z_min) {
-						z_min = min;
-					}
+	float distances[5];
 
-					found_items = true;
-				}
+	distances[0] = min_distance;
+	for (int i = 0; i < splits; i++) {
+		distances[i + 1] = min_distance + VSG::storage->light_get_param(p_instance->base, VS::LightParam(VS::LIGHT_PARAM_SHADOW_SPLIT_1_OFFSET + i)) * range;
+	};
 
-				if (found_items) {
-					min_distance = MAX(min_distance, z_min);
-					max_distance = MIN(max_distance, z_max);
-				}
-			}
+	distances[splits] = max_distance;
 
-			float range = max_distance - min_distance;
+	float texture_size = VSG::scene_render->get_directional_light_shadow_size(light->instance);
 
-			int splits = 0;
-			switch (VSG::storage->light_directional_get_shadow_mode(p_instance->base)) {
-				case VS::LIGHT_DIRECTIONAL_SHADOW_ORTHOGONAL: splits = 1; break;
-				case VS::LIGHT_DIRECTIONAL_SHADOW_PARALLEL_2_SPLITS: splits = 2; break;
-				case VS::LIGHT_DIRECTIONAL_SHADOW_PARALLEL_4_SPLITS: splits = 4; break;
-			}
+	bool overlap = VSG::storage->light_directional_get_blend_splits(p_instance->base);
 
-			float distances[5];
+	float first_radius = 0.0;
 
-			distances[0] = min_distance;
-			for (int i = 0; i < splits; i++) {
-				distances[i + 1] = min_distance + VSG::storage->light_get_param(p_instance->base, VS::LightParam(VS::LIGHT_PARAM_SHADOW_SPLIT_1_OFFSET + i)) * range;
-			};
+	for (int i = 0; i < splits; i++) {
 
-			distances[splits] = max_distance;
+		// setup a camera matrix for that range!
+		CameraMatrix camera_matrix;
 
-			float texture_size = VSG::scene_render->get_directional_light_shadow_size(light->instance);
+		float aspect = p_cam_projection.get_aspect();
 
-			bool overlap = VSG::storage->light_directional_get_blend_splits(p_instance->base);
+		if (p_cam_orthogonal) {
 
-			float first_radius = 0.0;
+			float w, h;
+			p_cam_projection.get_viewport_size(w, h);
+			camera_matrix.set_orthogonal(w, aspect, distances[(i == 0 || !overlap) ? i : i - 1], distances[i + 1], false);
+		} else {
 
-			for (int i = 0; i < splits; i++) {
+			float fov = p_cam_projection.get_fov();
+			camera_matrix.set_perspective(fov, aspect, distances[(i == 0 || !overlap) ? i : i - 1], distances[i + 1], false);
+		}
 
-				// setup a camera matrix for that range!
-				CameraMatrix camera_matrix;
+		//obtain the frustum endpoints
 
-				float aspect = p_cam_projection.get_aspect();
+		Vector3 endpoints[8]; // frustum plane endpoints
+		bool res = camera_matrix.get_endpoints(p_cam_transform, endpoints);
+		ERR_CONTINUE(!res);
 
-				if (p_cam_orthogonal) {
+		// obtain the light frustm ranges (given endpoints)
 
-					float w, h;
-					p_cam_projection.get_viewport_size(w, h);
-					camera_matrix.set_orthogonal(w, aspect, distances[(i == 0 || !overlap) ? i : i - 1], distances[i + 1], false);
-				} else {
+		Transform transform = light_transform; //discard scale and stabilize light
 
-					float fov = p_cam_projection.get_fov();
-					camera_matrix.set_perspective(fov, aspect, distances[(i == 0 || !overlap) ? i : i - 1], distances[i + 1], false);
-				}
+		Vector3 x_vec = transform.basis.get_axis(Vector3::AXIS_X).normalized();
+		Vector3 y_vec = transform.basis.get_axis(Vector3::AXIS_Y).normalized();
+		Vector3 z_vec = transform.basis.get_axis(Vector3::AXIS_Z).normalized();
+		//z_vec points agsint the camera, like in default opengl
 
-				//obtain the frustum endpoints
+		float x_min = 0.f, x_max = 0.f;
+		float y_min = 0.f, y_max = 0.f;
+		float z_min = 0.f, z_max = 0.f;
 
-				Vector3 endpoints[8]; // frustum plane endpoints
-				bool res = camera_matrix.get_endpoints(p_cam_transform, endpoints);
-				ERR_CONTINUE(!res);
+		// FIXME: z_max_cam is defined, computed, but not used below when setting up
+		// ortho_camera. Commented out for now to fix warnings but should be investigated.
+		float x_min_cam = 0.f, x_max_cam = 0.f;
+		float y_min_cam = 0.f, y_max_cam = 0.f;
+		float z_min_cam = 0.f;
+		//float z_max_cam = 0.f;
 
-				// obtain the light frustm ranges (given endpoints)
+		float bias_scale = 1.0;
 
-				Transform transform = light_transform; //discard scale and stabilize light
+		//used for culling
 
-				Vector3 x_vec = transform.basis.get_axis(Vector3::AXIS_X).normalized();
-				Vector3 y_vec = transform.basis.get_axis(Vector3::AXIS_Y).normalized();
-				Vector3 z_vec = transform.basis.get_axis(Vector3::AXIS_Z).normalized();
-				//z_vec points agsint the camera, like in default opengl
+		for (int j = 0; j < 8; j++) {
 
-				float x_min = 0.f, x_max = 0.f;
-				float y_min = 0.f, y_max = 0.f;
-				float z_min = 0.f, z_max = 0.f;
+			float d_x = x_vec.dot(endpoints[j]);
+			float d_y = y_vec.dot(endpoints[j]);
+			float d_z = z_vec.dot(endpoints[j]);
 
-				// FIXME: z_max_cam is defined, computed, but not used below when setting up
-				// ortho_camera. Commented out for now to fix warnings but should be investigated.
-				float x_min_cam = 0.f, x_max_cam = 0.f;
-				float y_min_cam = 0.f, y_max_cam = 0.f;
-				float z_min_cam = 0.f;
-				//float z_max_cam = 0.f;
+			if (j == 0 || d_x < x_min)
+				x_min = d_x;
+			if (j == 0 || d_x > x_max)
+				x_max = d_x;
 
-				float bias_scale = 1.0;
+			if (j == 0 || d_y < y_min)
+				y_min = d_y;
+			if (j == 0 || d_y > y_max)
+				y_max = d_y;
 
-				//used for culling
+			if (j == 0 || d_z < z_min)
+				z_min = d_z;
+			if (j == 0 || d_z > z_max)
+				z_max = d_z;
+		}
 
-				for (int j = 0; j < 8; j++) {
+		{
+			//camera viewport stuff
 
-					float d_x = x_vec.dot(endpoints[j]);
-					float d_y = y_vec.dot(endpoints[j]);
-					float d_z = z_vec.dot(endpoints[j]);
+			Vector3 center;
 
-					if (j == 0 || d_x < x_min)
-						x_min = d_x;
-					if (j == 0 || d_x > x_max)
-						x_max = d_x;
+			for (int j = 0; j < 8; j++) {
 
-					if (j == 0 || d_y < y_min)
-						y_min = d_y;
-					if (j == 0 || d_y > y_max)
-						y_max = d_y;
+				center += endpoints[j];
+			}
+			center /= 8.0;
 
-					if (j == 0 || d_z < z_min)
-						z_min = d_z;
-					if (j == 0 || d_z > z_max)
-						z_max = d_z;
-				}
+			//center=x_vec*(x_max-x_min)*0.5 + y_vec*(y_max-y_min)*0.5 + z_vec*(z_max-z_min)*0.5;
 
-				{
-					//camera viewport stuff
+			float radius = 0;
 
-					Vector3 center;
+			for (int j = 0; j < 8; j++) {
 
-					for (int j = 0; j < 8; j++) {
+				float d = center.distance_to(endpoints[j]);
+				if (d > radius)
+					radius = d;
+			}
 
-						center += endpoints[j];
-					}
-					center /= 8.0;
+			radius *= texture_size / (texture_size - 2.0); //add a texel by each side
 
-					//center=x_vec*(x_max-x_min)*0.5 + y_vec*(y_max-y_min)*0.5 + z_vec*(z_max-z_min)*0.5;
+			if (i == 0) {
+				first_radius = radius;
+			} else {
+				bias_scale = radius / first_radius;
+			}
 
-					float radius = 0;
+			x_max_cam = x_vec.dot(center) + radius;
+			x_min_cam = x_vec.dot(center) - radius;
+			y_max_cam = y_vec.dot(center) + radius;
+			y_min_cam = y_vec.dot(center) - radius;
+			//z_max_cam = z_vec.dot(center) + radius;
+			z_min_cam = z_vec.dot(center) - radius;
 
-					for (int j = 0; j < 8; j++) {
+			if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_STABLE) {
+				//this trick here is what stabilizes the shadow (make potential jaggies to not move)
+				//at the cost of some wasted resolution. Still the quality increase is very well worth it
 
-						float d = center.distance_to(endpoints[j]);
-						if (d > radius)
-							radius = d;
-					}
+				float unit = radius * 2.0 / texture_size;
 
-					radius *= texture_size / (texture_size - 2.0); //add a texel by each side
+				x_max_cam = Math::stepify(x_max_cam, unit);
+				x_min_cam = Math::stepify(x_min_cam, unit);
+				y_max_cam = Math::stepify(y_max_cam, unit);
+				y_min_cam = Math::stepify(y_min_cam, unit);
+			}
+		}
 
-					if (i == 0) {
-						first_radius = radius;
-					} else {
-						bias_scale = radius / first_radius;
-					}
+		//now that we now all ranges, we can proceed to make the light frustum planes, for culling bvh
 
-					x_max_cam = x_vec.dot(center) + radius;
-					x_min_cam = x_vec.dot(center) - radius;
-					y_max_cam = y_vec.dot(center) + radius;
-					y_min_cam = y_vec.dot(center) - radius;
-					//z_max_cam = z_vec.dot(center) + radius;
-					z_min_cam = z_vec.dot(center) - radius;
+		Vector<Plane> light_frustum_planes;
+		light_frustum_planes.resize(6);
 
-					if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_STABLE) {
-						//this trick here is what stabilizes the shadow (make potential jaggies to not move)
-						//at the cost of some wasted resolution. Still the quality increase is very well worth it
+		//right/left
+		light_frustum_planes.write[0] = Plane(x_vec, x_max);
+		light_frustum_planes.write[1] = Plane(-x_vec, -x_min);
+		//top/bottom
+		light_frustum_planes.write[2] = Plane(y_vec, y_max);
+		light_frustum_planes.write[3] = Plane(-y_vec, -y_min);
+		//near/far
+		light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
+		light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
 
-						float unit = radius * 2.0 / texture_size;
+		int cull_count = p_scenario->bvh.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
 
-						x_max_cam = Math::stepify(x_max_cam, unit);
-						x_min_cam = Math::stepify(x_min_cam, unit);
-						y_max_cam = Math::stepify(y_max_cam, unit);
-						y_min_cam = Math::stepify(y_min_cam, unit);
-					}
-				}
+		// a pre pass will need to be needed to determine the actual z-near to be used
 
-				//now that we now all ranges, we can proceed to make the light frustum planes, for culling octree
+		Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
 
-				Vector<Plane> light_frustum_planes;
-				light_frustum_planes.resize(6);
+		for (int j = 0; j < cull_count; j++) {
 
-				//right/left
-				light_frustum_planes.write[0] = Plane(x_vec, x_max);
-				light_frustum_planes.write[1] = Plane(-x_vec, -x_min);
-				//top/bottom
-				light_frustum_planes.write[2] = Plane(y_vec, y_max);
-				light_frustum_planes.write[3] = Plane(-y_vec, -y_min);
-				//near/far
-				light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
-				light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
+			float min, max;
+			Instance *instance = instance_shadow_cull_result[j];
+			if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+				cull_count--;
+				SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
+				j--;
+				continue;
+			}
 
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+			instance->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
+			instance->depth = near_plane.distance_to(instance->transform.origin);
+			instance->depth_layer = 0;
+			if (max > z_max)
+				z_max = max;
+		}
 
-				// a pre pass will need to be needed to determine the actual z-near to be used
+		{
 
-				Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
+			CameraMatrix ortho_camera;
+			real_t half_x = (x_max_cam - x_min_cam) * 0.5;
+			real_t half_y = (y_max_cam - y_min_cam) * 0.5;
 
-				for (int j = 0; j < cull_count; j++) {
+			ortho_camera.set_orthogonal(-half_x, half_x, -half_y, half_y, 0, (z_max - z_min_cam));
 
-					float min, max;
-					Instance *instance = instance_shadow_cull_result[j];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						cull_count--;
-						SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-						j--;
-						continue;
-					}
+			Transform ortho_transform;
+			ortho_transform.basis = transform.basis;
+			ortho_transform.origin = x_vec * (x_min_cam + half_x) + y_vec * (y_min_cam + half_y) + z_vec * z_max;
 
-					instance->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-					if (max > z_max)
-						z_max = max;
-				}
+			VSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, 0, distances[i + 1], i, bias_scale);
+		}
 
-				{
+		VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+	}
 
-					CameraMatrix ortho_camera;
-					real_t half_x = (x_max_cam - x_min_cam) * 0.5;
-					real_t half_y = (y_max_cam - y_min_cam) * 0.5;
+	return animated_material_found;
+}
 
-					ortho_camera.set_orthogonal(-half_x, half_x, -half_y, half_y, 0, (z_max - z_min_cam));
+void VisualServerScene::_light_instance_add_shadow_jobs(Instance *p_instance) {
 
-					Transform ortho_transform;
-					ortho_transform.basis = transform.basis;
-					ortho_transform.origin = x_vec * (x_min_cam + half_x) + y_vec * (y_min_cam + half_y) + z_vec * z_max;
+	Transform light_transform = p_instance->transform;
+	light_transform.orthonormalize(); //scale does not count on lights
 
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, 0, distances[i + 1], i, bias_scale);
-				}
+	float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
 
-				VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
-			}
+	switch (VSG::storage->light_get_type(p_instance->base)) {
 
-		} break;
 		case VS::LIGHT_OMNI: {
 
 			VS::LightOmniShadowMode shadow_mode = VSG::storage->light_omni_get_shadow_mode(p_instance->base);
@@ -1558,52 +1595,24 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 				for (int i = 0; i < 2; i++) {
 
-					//using this one ensures that raster deferred will have it
-
-					float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
+					ShadowCullJob &job = _add_shadow_job(p_instance, i, CameraMatrix(), light_transform, radius);
 
 					float z = i == 0 ? -1 : 1;
-					Vector<Plane> planes;
-					planes.resize(5);
-					planes.write[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
-					planes.write[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
-					planes.write[2] = light_transform.xform(Plane(Vector3(-1, 0, z).normalized(), radius));
-					planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
-					planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
-
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-					Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
-
-					for (int j = 0; j < cull_count; j++) {
-
-						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-							cull_count--;
-							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-							j--;
-						} else {
-							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-								animated_material_found = true;
-							}
-
-							instance->depth = near_plane.distance_to(instance->transform.origin);
-							instance->depth_layer = 0;
-						}
-					}
-
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, i);
-					VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					job.planes.resize(5);
+					job.planes.write[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
+					job.planes.write[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
+					job.planes.write[2] = light_transform.xform(Plane(Vector3(-1, 0, z).normalized(), radius));
+					job.planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
+					job.planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
+					job.near_plane = Plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
 				}
 			} else { //shadow cube
 
-				float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
 				CameraMatrix cm;
 				cm.set_perspective(90, 1, 0.01, radius);
 
 				for (int i = 0; i < 6; i++) {
 
-					//using this one ensures that raster deferred will have it
-
 					static const Vector3 view_normals[6] = {
 						Vector3(-1, 0, 0),
 						Vector3(+1, 0, 0),
@@ -1623,71 +1632,210 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 					Transform xform = light_transform * Transform().looking_at(view_normals[i], view_up[i]);
 
-					Vector<Plane> planes = cm.get_projection_planes(xform);
-
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-
-					Plane near_plane(xform.origin, -xform.basis.get_axis(2));
-					for (int j = 0; j < cull_count; j++) {
-
-						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-							cull_count--;
-							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-							j--;
-						} else {
-							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-								animated_material_found = true;
-							}
-							instance->depth = near_plane.distance_to(instance->transform.origin);
-							instance->depth_layer = 0;
-						}
-					}
-
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i);
-					VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					ShadowCullJob &job = _add_shadow_job(p_instance, i, cm, xform, radius);
+					job.planes = cm.get_projection_planes(xform);
+					job.near_plane = Plane(xform.origin, -xform.basis.get_axis(2));
 				}
 
-				//restore the regular DP matrix
-				VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, 0);
+				//restore the regular DP matrix once the last face is rendered
+				ShadowCullJob &last = shadow_cull_jobs.write[shadow_cull_job_count - 1];
+				last.restore_transform = true;
+				last.light_transform = light_transform;
 			}
 
 		} break;
 		case VS::LIGHT_SPOT: {
 
-			float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
 			float angle = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_SPOT_ANGLE);
 
 			CameraMatrix cm;
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
-			Vector<Plane> planes = cm.get_projection_planes(light_transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+			ShadowCullJob &job = _add_shadow_job(p_instance, 0, cm, light_transform, radius);
+			job.planes = cm.get_projection_planes(light_transform);
+			job.near_plane = Plane(light_transform.origin, -light_transform.basis.get_axis(2));
 
-			Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
-			for (int j = 0; j < cull_count; j++) {
+		} break;
+		default: {
+			ERR_PRINT("Invalid Light Type");
+		}
+	}
+}
 
-				Instance *instance = instance_shadow_cull_result[j];
-				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-					cull_count--;
-					SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-					j--;
-				} else {
-					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-						animated_material_found = true;
-					}
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-				}
+VisualServerScene::ShadowCullJob &VisualServerScene::_add_shadow_job(Instance *p_light, int p_pass, const CameraMatrix &p_projection, const Transform &p_transform, float p_radius) {
+
+	if (shadow_cull_job_count == shadow_cull_jobs.size()) {
+		shadow_cull_jobs.resize(shadow_cull_job_count + 1);
+	}
+
+	// jobs are reused between frames so their caster buffers keep their size
+	ShadowCullJob &job = shadow_cull_jobs.write[shadow_cull_job_count++];
+	job.light = p_light;
+	job.pass = p_pass;
+	job.projection = p_projection;
+	job.transform = p_transform;
+	job.radius = p_radius;
+	job.restore_transform = false;
+	job.caster_count = 0;
+	job.animated_material_found = false;
+	return job;
+}
+
+void VisualServerScene::_shadow_cull_task(uint32_t p_index, Scenario *p_scenario) {
+
+	ShadowCullJob &job = shadow_cull_jobs.write[p_index];
+
+	if (job.casters.size() == 0) {
+		job.casters.resize(1024);
+	}
+
+	int cull_count;
+	while (true) {
+		cull_count = p_scenario->bvh.cull_convex(job.planes, job.casters.ptrw(), job.casters.size(), VS::INSTANCE_GEOMETRY_MASK);
+		if (cull_count < job.casters.size() || job.casters.size() >= MAX_INSTANCE_CULL)
+			break;
+		job.casters.resize(MIN(job.casters.size() * 2, (int)MAX_INSTANCE_CULL));
+	}
+
+	Instance **casters = job.casters.ptrw();
+	int count = 0;
+
+	for (int i = 0; i < cull_count; i++) {
+
+		Instance *instance = casters[i];
+		if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+			continue;
+		}
+
+		if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
+			job.animated_material_found = true;
+		}
+
+		casters[count++] = instance;
+	}
+
+	job.caster_count = count;
+}
+
+void VisualServerScene::_render_shadow_jobs(RID p_shadow_atlas) {
+
+	for (int i = 0; i < shadow_cull_job_count; i++) {
+		static_cast<InstanceLightData *>(shadow_cull_jobs[i].light->base_data)->shadow_dirty = false;
+	}
+
+	for (int i = 0; i < shadow_cull_job_count; i++) {
+
+		ShadowCullJob &job = shadow_cull_jobs.write[i];
+		InstanceLightData *light = static_cast<InstanceLightData *>(job.light->base_data);
+
+		// instances are shared between lights, so depth is only written right before rendering
+		Instance **casters = job.casters.ptrw();
+		for (int j = 0; j < job.caster_count; j++) {
+			casters[j]->depth = job.near_plane.distance_to(casters[j]->transform.origin);
+			casters[j]->depth_layer = 0;
+		}
+
+		VSG::scene_render->light_instance_set_shadow_transform(light->instance, job.projection, job.transform, job.radius, 0, job.pass);
+		VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, job.pass, (RasterizerScene::InstanceBase **)casters, job.caster_count);
+
+		if (job.restore_transform) {
+			VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), job.light_transform, job.radius, 0, 0);
+		}
+
+		if (job.animated_material_found) {
+			light->shadow_dirty = true;
+		}
+	}
+
+	shadow_cull_job_count = 0;
+}
+
+void VisualServerScene::_instance_cull_task(uint32_t p_index, const InstanceCullData *p_data) {
+
+	Instance *ins = instance_cull_result[p_index];
+	uint8_t flags = 0;
+
+	if ((p_data->camera_layer_mask & ins->layer_mask) == 0) {
+
+		//failure
+	} else if (((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
+
+		flags = INSTANCE_CULL_KEEP;
+
+		if (ins->redraw_if_visible || ins->base_type == VS::INSTANCE_PARTICLES) {
+			flags |= INSTANCE_CULL_SERIAL;
+		}
+
+		InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
+
+		if (geom->lighting_dirty) {
+			int l = 0;
+			//only called when lights AABB enter/exit this geometry
+			ins->light_instances.resize(geom->lighting.size());
+
+			for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
+
+				InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+
+				ins->light_instances.write[l++] = light->instance;
 			}
 
-			VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0);
-			VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+			geom->lighting_dirty = false;
+		}
 
-		} break;
+		if (geom->reflection_dirty) {
+			int l = 0;
+			//only called when reflection probe AABB enter/exit this geometry
+			ins->reflection_probe_instances.resize(geom->reflection_probes.size());
+
+			for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
+
+				InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
+
+				ins->reflection_probe_instances.write[l++] = reflection_probe->instance;
+			}
+
+			geom->reflection_dirty = false;
+		}
+
+		if (geom->gi_probes_dirty) {
+			int l = 0;
+			//only called when reflection probe AABB enter/exit this geometry
+			ins->gi_probe_instances.resize(geom->gi_probes.size());
+
+			for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+
+				InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
+
+				ins->gi_probe_instances.write[l++] = gi_probe->probe_instance;
+			}
+
+			geom->gi_probes_dirty = false;
+		}
+
+		ins->depth = p_data->near_plane.distance_to(ins->transform.origin);
+		ins->depth_layer = CLAMP(int(ins->depth * 16 / p_data->z_far), 0, 15);
+	} else {
+
+		// lights, probes and such touch shared lists
+		flags = INSTANCE_CULL_SERIAL;
 	}
 
-	return animated_material_found;
+	instance_cull_flags[p_index] = flags;
+}
+
+template <class T>
+void VisualServerScene::_run_cull_tasks(void (VisualServerScene::*p_method)(uint32_t, T), T p_userdata, uint32_t p_count, int p_grain_size) {
+
+	if (threaded_culling && p_count > 1) {
+		WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+		WorkerThreadPool::GroupID group = pool->add_template_group_task(this, p_method, p_userdata, p_count, p_grain_size);
+		pool->wait_for_group_task_completion(group);
+	} else {
+		for (uint32_t i = 0; i < p_count; i++) {
+			(this->*p_method)(i, p_userdata);
+		}
+	}
 }
 
 void VisualServerScene::render_camera(RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas) {
@@ -1834,7 +1982,7 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+	instance_cull_count = scenario->bvh.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -1843,9 +1991,8 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 	/*
 	print_line("OT: "+rtos( (OS::get_singleton()->get_ticks_usec()-t)/1000.0));
-	print_line("OTO: "+itos(p_scenario->octree.get_octant_count()));
-	print_line("OTE: "+itos(p_scenario->octree.get_elem_count()));
-	print_line("OTP: "+itos(p_scenario->octree.get_pair_count()));
+	print_line("OTE: "+itos(p_scenario->bvh.get_elem_count()));
+	print_line("OTP: "+itos(p_scenario->bvh.get_pair_count()));
 	*/
 
 	/* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
@@ -1853,15 +2000,44 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
 
+	// Geometry is prepared in parallel. Everything touching shared state (lights, probes,
+	// particles, redraw requests) is then handled here in cull order, so results don't
+	// depend on the number of threads.
+	InstanceCullData cull_data;
+	cull_data.camera_layer_mask = camera_layer_mask;
+	cull_data.near_plane = near_plane;
+	cull_data.z_far = z_far;
+
+	_run_cull_tasks(&VisualServerScene::_instance_cull_task, (const InstanceCullData *)&cull_data, instance_cull_count);
+
+	int keep_count = 0;
+
 	for (int i = 0; i < instance_cull_count; i++) {
 
 		Instance *ins = instance_cull_result[i];
 
-		bool keep = false;
+		bool keep = instance_cull_flags[i] & INSTANCE_CULL_KEEP;
+
+		if (!(instance_cull_flags[i] & INSTANCE_CULL_SERIAL)) {
 
-		if ((camera_layer_mask & ins->layer_mask) == 0) {
+			//nothing else to do
+		} else if (keep) {
+
+			if (ins->redraw_if_visible) {
+				VisualServerRaster::redraw_request();
+			}
 
-			//failure
+			if (ins->base_type == VS::INSTANCE_PARTICLES) {
+				//particles visible? process them
+				if (VSG::storage->particles_is_inactive(ins->base)) {
+					//but if nothing is going on, don't do it.
+					keep = false;
+				} else {
+					VSG::storage->particles_request_process(ins->base);
+					//particles visible? request redraw
+					VisualServerRaster::redraw_request();
+				}
+			}
 		} else if (ins->base_type == VS::INSTANCE_LIGHT && ins->visible) {
 
 			if (ins->visible && light_cull_count < MAX_LIGHTS_CULLED) {
@@ -1914,90 +2090,20 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 			if (!gi_probe->update_element.in_list()) {
 				gi_probe_update_list.add(&gi_probe->update_element);
 			}
-
-		} else if (((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
-
-			keep = true;
-
-			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
-
-			if (ins->redraw_if_visible) {
-				VisualServerRaster::redraw_request();
-			}
-
-			if (ins->base_type == VS::INSTANCE_PARTICLES) {
-				//particles visible? process them
-				if (VSG::storage->particles_is_inactive(ins->base)) {
-					//but if nothing is going on, don't do it.
-					keep = false;
-				} else {
-					VSG::storage->particles_request_process(ins->base);
-					//particles visible? request redraw
-					VisualServerRaster::redraw_request();
-				}
-			}
-
-			if (geom->lighting_dirty) {
-				int l = 0;
-				//only called when lights AABB enter/exit this geometry
-				ins->light_instances.resize(geom->lighting.size());
-
-				for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
-
-					InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
-
-					ins->light_instances.write[l++] = light->instance;
-				}
-
-				geom->lighting_dirty = false;
-			}
-
-			if (geom->reflection_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->reflection_probe_instances.resize(geom->reflection_probes.size());
-
-				for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
-
-					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
-
-					ins->reflection_probe_instances.write[l++] = reflection_probe->instance;
-				}
-
-				geom->reflection_dirty = false;
-			}
-
-			if (geom->gi_probes_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->gi_probe_instances.resize(geom->gi_probes.size());
-
-				for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
-
-					InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
-
-					ins->gi_probe_instances.write[l++] = gi_probe->probe_instance;
-				}
-
-				geom->gi_probes_dirty = false;
-			}
-
-			ins->depth = near_plane.distance_to(ins->transform.origin);
-			ins->depth_layer = CLAMP(int(ins->depth * 16 / z_far), 0, 15);
 		}
 
 		if (!keep) {
 			// remove, no reason to keep
-			instance_cull_count--;
-			SWAP(instance_cull_result[i], instance_cull_result[instance_cull_count]);
-			i--;
 			ins->last_render_pass = 0; // make invalid
 		} else {
 
+			instance_cull_result[keep_count++] = ins;
 			ins->last_render_pass = render_pass;
 		}
 	}
 
+	instance_cull_count = keep_count;
+
 	/* STEP 5 - PROCESS LIGHTS */
 
 	RID *directional_light_ptr = &light_instance_cull_result[light_cull_count];
@@ -2035,7 +2141,7 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 		for (int i = 0; i < directional_shadow_count; i++) {
 
-			_light_instance_update_shadow(lights_with_shadow[i], p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
+			_light_instance_update_directional_shadow(lights_with_shadow[i], p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
 		}
 	}
 
@@ -2134,9 +2240,13 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 			if (redraw) {
 				//must redraw!
-				light->shadow_dirty = _light_instance_update_shadow(ins, p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
+				_light_instance_add_shadow_jobs(ins);
 			}
 		}
+
+		// cull the casters of all lights at once, then render them in order
+		_run_cull_tasks(&VisualServerScene::_shadow_cull_task, scenario, shadow_cull_job_count, 1);
+		_render_shadow_jobs(p_shadow_atlas);
 	}
 }
 
@@ -3490,6 +3600,9 @@ VisualServerScene::VisualServerScene() {
 
 	render_pass = 1;
 	singleton = this;
+
+	shadow_cull_job_count = 0;
+	threaded_culling = GLOBAL_DEF("rendering/threads/threaded_culling", true);
 }
 
 VisualServerScene::~VisualServerScene() {
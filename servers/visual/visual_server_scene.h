@@ -34,7 +34,7 @@
 #include "servers/visual/rasterizer.h"
 
 #include "core/math/geometry.h"
-#include "core/math/octree.h"
+#include "core/math/bvh.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
 #include "core/self_list.h"
@@ -120,7 +120,7 @@ public:
 		VS::ScenarioDebugMode debug;
 		RID self;
 
-		Octree<Instance, true> octree;
+		BVH<Instance> bvh;
 
 		List<Instance *> directional_lights;
 		RID environment;
@@ -135,8 +135,8 @@ public:
 
 	mutable RID_Owner<Scenario> scenario_owner;
 
-	static void *_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int);
-	static void _instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *);
+	static void *_instance_pair(void *p_self, BVHElementID, Instance *p_A, int, BVHElementID, Instance *p_B, int);
+	static void _instance_unpair(void *p_self, BVHElementID, Instance *p_A, int, BVHElementID, Instance *p_B, int, void *);
 
 	virtual RID scenario_create();
 
@@ -156,7 +156,7 @@ public:
 
 		RID self;
 		//scenario stuff
-		OctreeElementID octree_id;
+		BVHElementID bvh_id;
 		Scenario *scenario;
 		SelfList<Instance> scenario_item;
 
@@ -167,7 +167,6 @@ public:
 		SelfList<Instance> update_item;
 
 		AABB aabb;
-		AABB transformed_aabb;
 		AABB *custom_aabb; // <Zylann> would using aabb directly with a bool be better?
 		float extra_margin;
 		uint32_t object_ID;
@@ -199,7 +198,7 @@ public:
 				scenario_item(this),
 				update_item(this) {
 
-			octree_id = 0;
+			bvh_id = 0;
 			scenario = NULL;
 
 			update_aabb = false;
@@ -436,6 +435,7 @@ public:
 
 	int instance_cull_count;
 	Instance *instance_cull_result[MAX_INSTANCE_CULL];
+	uint8_t instance_cull_flags[MAX_INSTANCE_CULL];
 	Instance *instance_shadow_cull_result[MAX_INSTANCE_CULL]; //used for generating shadowmaps
 	Instance *light_cull_result[MAX_LIGHTS_CULLED];
 	RID light_instance_cull_result[MAX_LIGHTS_CULLED];
@@ -453,6 +453,7 @@ public:
 	virtual void instance_set_scenario(RID p_instance, RID p_scenario); // from can be mesh, light, poly, area and portal so far.
 	virtual void instance_set_layer_mask(RID p_instance, uint32_t p_mask);
 	virtual void instance_set_transform(RID p_instance, const Transform &p_transform);
+	virtual void instances_set_transform(const Vector<RID> &p_instances, const PoolVector<float> &p_transforms);
 	virtual void instance_attach_object_instance_id(RID p_instance, ObjectID p_ID);
 	virtual void instance_set_blend_shape_weight(RID p_instance, int p_shape, float p_weight);
 	virtual void instance_set_surface_material(RID p_instance, int p_surface, RID p_material);
@@ -483,7 +484,49 @@ public:
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_lightmap_captures(Instance *p_instance);
 
-	_FORCE_INLINE_ bool _light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
+	enum {
+		INSTANCE_CULL_KEEP = 1,
+		INSTANCE_CULL_SERIAL = 2 // needs more work on the render thread
+	};
+
+	struct InstanceCullData {
+
+		uint32_t camera_layer_mask;
+		Plane near_plane;
+		float z_far;
+	};
+
+	// One shadow pass (cube face, paraboloid or spot) of an omni or spot light.
+	struct ShadowCullJob {
+
+		Instance *light;
+		int pass;
+		Vector<Plane> planes;
+		CameraMatrix projection;
+		Transform transform;
+		float radius;
+		Plane near_plane;
+		bool restore_transform;
+		Transform light_transform;
+
+		Vector<Instance *> casters;
+		int caster_count;
+		bool animated_material_found;
+	};
+
+	bool threaded_culling;
+	Vector<ShadowCullJob> shadow_cull_jobs;
+	int shadow_cull_job_count;
+
+	template <class T>
+	void _run_cull_tasks(void (VisualServerScene::*p_method)(uint32_t, T), T p_userdata, uint32_t p_count, int p_grain_size = -1);
+	void _instance_cull_task(uint32_t p_index, const InstanceCullData *p_data);
+
+	_FORCE_INLINE_ bool _light_instance_update_directional_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
+	void _light_instance_add_shadow_jobs(Instance *p_instance);
+	ShadowCullJob &_add_shadow_job(Instance *p_light, int p_pass, const CameraMatrix &p_projection, const Transform &p_transform, float p_radius);
+	void _shadow_cull_task(uint32_t p_index, Scenario *p_scenario);
+	void _render_shadow_jobs(RID p_shadow_atlas);
 
 	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe);
 	void _render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass);
@@ -124,6 +124,17 @@ Array VisualServer::_instances_cull_convex_bind(const Array &p_convex, RID p_sce
 	return to_array(ids);
 }
 
+void VisualServer::_instances_set_transform_bind(const Array &p_instances, const PoolVector<float> &p_transforms) {
+
+	Vector<RID> instances;
+	instances.resize(p_instances.size());
+	for (int i = 0; i < p_instances.size(); ++i) {
+		instances.write[i] = p_instances[i];
+	}
+
+	instances_set_transform(instances, p_transforms);
+}
+
 RID VisualServer::get_test_texture() {
 
 	if (test_texture.is_valid()) {
@@ -1935,6 +1946,7 @@ void VisualServer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("instance_set_scenario", "instance", "scenario"), &VisualServer::instance_set_scenario);
 	ClassDB::bind_method(D_METHOD("instance_set_layer_mask", "instance", "mask"), &VisualServer::instance_set_layer_mask);
 	ClassDB::bind_method(D_METHOD("instance_set_transform", "instance", "transform"), &VisualServer::instance_set_transform);
+	ClassDB::bind_method(D_METHOD("instances_set_transform", "instances", "transforms"), &VisualServer::_instances_set_transform_bind);
 	ClassDB::bind_method(D_METHOD("instance_attach_object_instance_id", "instance", "id"), &VisualServer::instance_attach_object_instance_id);
 	ClassDB::bind_method(D_METHOD("instance_set_blend_shape_weight", "instance", "shape", "weight"), &VisualServer::instance_set_blend_shape_weight);
 	ClassDB::bind_method(D_METHOD("instance_set_surface_material", "instance", "surface", "material"), &VisualServer::instance_set_surface_material);
@@ -152,6 +152,11 @@ public:
 	virtual void texture_set_detect_srgb_callback(RID p_texture, TextureDetectCallback p_callback, void *p_userdata) = 0;
 	virtual void texture_set_detect_normal_callback(RID p_texture, TextureDetectCallback p_callback, void *p_userdata) = 0;
 
+	// called whenever the texture is drawn, with roughly how many pixels it spans on screen
+	typedef void (*TextureStreamCallback)(void *, int);
+
+	virtual void texture_set_stream_callback(RID p_texture, TextureStreamCallback p_callback, void *p_userdata) = 0;
+
 	struct TextureInfo {
 		RID texture;
 		uint32_t width;
@@ -826,6 +831,9 @@ public:
 
 	virtual void instance_set_extra_visibility_margin(RID p_instance, real_t p_margin) = 0;
 
+	// transforms are packed as 12 floats each, in the same layout as multimesh_set_as_bulk_array
+	virtual void instances_set_transform(const Vector<RID> &p_instances, const PoolVector<float> &p_transforms) = 0;
+
 	// don't use these in a game!
 	virtual Vector<ObjectID> instances_cull_aabb(const AABB &p_aabb, RID p_scenario = RID()) const = 0;
 	virtual Vector<ObjectID> instances_cull_ray(const Vector3 &p_from, const Vector3 &p_to, RID p_scenario = RID()) const = 0;
@@ -834,6 +842,7 @@ public:
 	Array _instances_cull_aabb_bind(const AABB &p_aabb, RID p_scenario = RID()) const;
 	Array _instances_cull_ray_bind(const Vector3 &p_from, const Vector3 &p_to, RID p_scenario = RID()) const;
 	Array _instances_cull_convex_bind(const Array &p_convex, RID p_scenario = RID()) const;
+	void _instances_set_transform_bind(const Array &p_instances, const PoolVector<float> &p_transforms);
 
 	enum InstanceFlags {
 		INSTANCE_FLAG_USE_BAKED_LIGHT,